@@ -12,6 +12,7 @@
 #include "Engine/Texture2D.h"
 #include "Serialization/LargeMemoryReader.h"
 #include "Serialization/LargeMemoryWriter.h"
+#include "Hash/CityHash.h"
 
 UVoxelDataAsset::UVoxelDataAsset()
 {
@@ -28,6 +29,14 @@ TVoxelSharedRef<FVoxelTransformableGeneratorInstance> UVoxelDataAsset::GetTransf
 	return MakeVoxelShared<TVoxelTransformableGeneratorHelper<FVoxelDataAssetInstance>>(GetInstanceImpl(), bSubtractiveAsset);
 }
 
+uint64 UVoxelDataAsset::GetGeneratorHash(const TMap<FName, FString>& Parameters) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// SetData always saves, so the compressed data is up to date. Else reimporting data with the same size would keep the same hash
+	return CityHash64WithSeed(reinterpret_cast<const char*>(CompressedData.GetData()), CompressedData.Num(), Super::GetGeneratorHash(Parameters));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -10,7 +10,7 @@
 #include "VoxelGenerators/VoxelTransformableGeneratorHelper.h"
 
 #include "Serialization/LargeMemoryReader.h"
-#include "Serialization/LargeMemoryWriter.h"
+#include "Hash/CityHash.h"
 
 #include "Engine/Texture2D.h"
 #include "Misc/ScopedSlowTask.h"
@@ -19,6 +19,27 @@
 
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelHeightmapAssetMemory);
 
+static TAutoConsoleVariable<int32> CVarMaxResidentSizeMB(
+	TEXT("voxel.heightmaps.MaxResidentSizeMB"),
+	1024,
+	TEXT("Heightmap assets bigger than this once decompressed are decompressed by tiles on demand instead of entirely on load"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarTileCacheSizeMB(
+	TEXT("voxel.heightmaps.TileCacheSizeMB"),
+	256,
+	TEXT("Max size of the decompressed tiles kept in memory, per paged heightmap asset"),
+	ECVF_Default);
+
+int64 FVoxelHeightmapAssetTilesParameters::GetMaxResidentSize()
+{
+	return int64(CVarMaxResidentSizeMB.GetValueOnAnyThread()) << 20;
+}
+int64 FVoxelHeightmapAssetTilesParameters::GetTileCacheSize()
+{
+	return int64(CVarTileCacheSizeMB.GetValueOnAnyThread()) << 20;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -44,6 +65,15 @@ VOXEL_API TVoxelHeightmapAssetSamplerWrapper<float>::TVoxelHeightmapAssetSampler
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+uint64 UVoxelHeightmapAsset::GetGeneratorHash(const TMap<FName, FString>& Parameters) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// The data is always saved after being imported/edited, so the compressed data is up to date
+	// Else reimporting a heightmap with the same size would keep the same hash
+	return CityHash64WithSeed(reinterpret_cast<const char*>(CompressedData->GetData()), CompressedData->Num(), Super::GetGeneratorHash(Parameters));
+}
+
 template<typename T>
 void UVoxelHeightmapAsset::TryLoad(TVoxelHeightmapAssetData<T>& Data)
 {
@@ -57,23 +87,23 @@ void UVoxelHeightmapAsset::TryLoad(TVoxelHeightmapAssetData<T>& Data)
 template<typename T>
 void UVoxelHeightmapAsset::SaveData(const TVoxelHeightmapAssetData<T>& Data)
 {
+	if (Data.IsPaged())
+	{
+		// Paged data is made resident on edit, so it's still what was loaded from CompressedData
+		ensure(VoxelCustomVersion >= FVoxelHeightmapAssetDataVersion::TiledStorage);
+		SyncProperties(Data);
+		return;
+	}
+
 	Modify();
-	
-	FVoxelScopedSlowTask Saving(2.f);
 
 	VoxelCustomVersion = FVoxelHeightmapAssetDataVersion::LatestVersion;
 	MaterialConfigFlag = GVoxelMaterialConfigFlag;
 
-	Saving.EnterProgressFrame(1.f, VOXEL_LOCTEXT("Serializing"));
-
-	FLargeMemoryWriter MemoryWriter(Data.GetAllocatedSize());
-	
-	bool bNeedToSave = false;
-	const_cast<TVoxelHeightmapAssetData<T>&>(Data).Serialize(MemoryWriter, MaterialConfigFlag, FVoxelHeightmapAssetDataVersion::Type(VoxelCustomVersion), bNeedToSave);
-	ensure(!bNeedToSave);
-	
-	Saving.EnterProgressFrame(1.f, VOXEL_LOCTEXT("Compressing"));
-	FVoxelSerializationUtilities::CompressData(MemoryWriter, CompressedData);
+	// Don't modify the existing array, it might be used by paged data
+	const auto NewCompressedData = MakeVoxelShared<TArray<uint8>>();
+	Data.SaveTiled(*NewCompressedData);
+	CompressedData = NewCompressedData;
 
 	SyncProperties(Data);
 
@@ -87,13 +117,26 @@ void UVoxelHeightmapAsset::SaveData(const TVoxelHeightmapAssetData<T>& Data)
 template<typename T>
 void UVoxelHeightmapAsset::LoadData(TVoxelHeightmapAssetData<T>& Data)
 {
-	if (CompressedData.Num() == 0)
+	if (CompressedData->Num() == 0)
 	{
 		// Nothing to load
 		return;
 	}
+
+	if (VoxelCustomVersion >= FVoxelHeightmapAssetDataVersion::TiledStorage)
+	{
+		if (!Data.LoadTiled(CompressedData))
+		{
+			FVoxelMessages::Error("Decompression failed, data is corrupted", this);
+			Data.ClearData();
+			return;
+		}
+		SyncProperties(Data);
+		return;
+	}
+
 	TArray64<uint8> UncompressedData;
-	if (!FVoxelSerializationUtilities::DecompressData(CompressedData, UncompressedData))
+	if (!FVoxelSerializationUtilities::DecompressData(*CompressedData, UncompressedData))
 	{
 		FVoxelMessages::Error("Decompression failed, data is corrupted", this);
 		return;
@@ -155,14 +198,20 @@ void UVoxelHeightmapAsset::Serialize(FArchive& Ar)
 
 	if ((Ar.IsLoading() || Ar.IsSaving()) && !Ar.IsTransacting())
 	{
+		if (Ar.IsLoading())
+		{
+			// The previous array might be used by paged data
+			CompressedData = MakeVoxelShared<TArray<uint8>>();
+		}
+
 		if (VoxelCustomVersion == FVoxelHeightmapAssetDataVersion::BeforeCustomVersionWasAdded)
 		{
 			Ar << MaterialConfigFlag;
-			Ar << CompressedData;
+			Ar << *CompressedData;
 		}
 		else
 		{
-			CompressedData.BulkSerialize(Ar);
+			CompressedData->BulkSerialize(Ar);
 		}
 	}
 }
@@ -0,0 +1,157 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelBlockPool.h"
+#include "Misc/ScopeLock.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/ThreadSafeCounter.h"
+
+FVoxelBlockPool& FVoxelBlockPool::Get(uint32 BlockSize)
+{
+	// Only called once per block size & module, see TVoxelBlockPool
+	static FCriticalSection* PoolsSection = new FCriticalSection();
+	static TMap<uint32, FVoxelBlockPool*>* Pools = new TMap<uint32, FVoxelBlockPool*>();
+
+	BlockSize = Align(BlockSize, Alignment);
+
+	FScopeLock Lock(PoolsSection);
+	FVoxelBlockPool*& Pool = Pools->FindOrAdd(BlockSize);
+	if (!Pool)
+	{
+		Pool = new FVoxelBlockPool(BlockSize);
+	}
+	return *Pool;
+}
+
+FVoxelBlockPool::FVoxelBlockPool(uint32 BlockSize)
+	: BlockSize(BlockSize)
+{
+	check(BlockSize % Alignment == 0);
+	check(BlockSize >= sizeof(FFreeBlock));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void* FVoxelBlockPool::Allocate()
+{
+	FShard& Shard = GetShard();
+	FScopeLock Lock(&Shard.Section);
+	if (!Shard.FreeList)
+	{
+		AllocateSlab(Shard);
+	}
+	FFreeBlock* Block = Shard.FreeList;
+	Shard.FreeList = Block->Next;
+	return Block;
+}
+
+void FVoxelBlockPool::Free(void* Ptr)
+{
+	checkVoxelSlow(Ptr);
+	FShard& Shard = GetShard();
+	FScopeLock Lock(&Shard.Section);
+	FFreeBlock* Block = static_cast<FFreeBlock*>(Ptr);
+	Block->Next = Shard.FreeList;
+	Shard.FreeList = Block;
+}
+
+void FVoxelBlockPool::Trim()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	// A slab can be freed only if all its blocks are free, in any of the shards
+	for (FShard& Shard : Shards)
+	{
+		Shard.Section.Lock();
+	}
+	ON_SCOPE_EXIT
+	{
+		for (FShard& Shard : Shards)
+		{
+			Shard.Section.Unlock();
+		}
+	};
+	FScopeLock Lock(&SlabsSection);
+
+	if (Slabs.Num() == 0)
+	{
+		return;
+	}
+
+	// Sorted to find the slab of a block with a binary search
+	Slabs.Sort();
+	const auto GetSlabIndex = [&](const FFreeBlock* Block)
+	{
+		const int32 SlabIndex = Algo::UpperBound(Slabs, reinterpret_cast<const uint8*>(Block)) - 1;
+		checkVoxelSlow(Slabs.IsValidIndex(SlabIndex) && reinterpret_cast<const uint8*>(Block) < Slabs[SlabIndex] + BlockSize * BlocksPerSlab);
+		return SlabIndex;
+	};
+
+	TArray<uint32> NumFreeBlocks;
+	NumFreeBlocks.SetNumZeroed(Slabs.Num());
+	for (const FShard& Shard : Shards)
+	{
+		for (const FFreeBlock* Block = Shard.FreeList; Block; Block = Block->Next)
+		{
+			NumFreeBlocks[GetSlabIndex(Block)]++;
+		}
+	}
+
+	// Remove the blocks of the unused slabs from the free lists before freeing them
+	for (FShard& Shard : Shards)
+	{
+		FFreeBlock* NewFreeList = nullptr;
+		for (FFreeBlock* Block = Shard.FreeList; Block;)
+		{
+			FFreeBlock* const Next = Block->Next;
+			if (NumFreeBlocks[GetSlabIndex(Block)] != BlocksPerSlab)
+			{
+				Block->Next = NewFreeList;
+				NewFreeList = Block;
+			}
+			Block = Next;
+		}
+		Shard.FreeList = NewFreeList;
+	}
+
+	for (int32 SlabIndex = Slabs.Num() - 1; SlabIndex >= 0; SlabIndex--)
+	{
+		if (NumFreeBlocks[SlabIndex] == BlocksPerSlab)
+		{
+			FMemory::Free(Slabs[SlabIndex]);
+			Slabs.RemoveAt(SlabIndex, 1, false);
+		}
+	}
+	Slabs.Shrink();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelBlockPool::FShard& FVoxelBlockPool::GetShard()
+{
+	// Threads are assigned a shard round robin, the same for all the pools
+	static FThreadSafeCounter NextShardIndex;
+	static thread_local const int32 ShardIndex = NextShardIndex.Increment() % NumShards;
+	return Shards[ShardIndex];
+}
+
+void FVoxelBlockPool::AllocateSlab(FShard& Shard)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	uint8* Slab = static_cast<uint8*>(FMemory::Malloc(BlockSize * BlocksPerSlab, Alignment));
+	{
+		FScopeLock Lock(&SlabsSection);
+		Slabs.Add(Slab);
+	}
+
+	for (int32 Index = BlocksPerSlab - 1; Index >= 0; Index--)
+	{
+		FFreeBlock* Block = reinterpret_cast<FFreeBlock*>(Slab + Index * BlockSize);
+		Block->Next = Shard.FreeList;
+		Shard.FreeList = Block;
+	}
+}
\ No newline at end of file
@@ -129,11 +129,11 @@ FIntVector UVoxelSimpleInvokerComponent::GetInvokerVoxelPosition_Implementation(
 FVoxelInvokerSettings UVoxelSimpleInvokerComponent::GetInvokerSettings_Implementation(AVoxelWorldInterface* VoxelWorld) const
 {
 	const FVector InvokerGlobalPosition = GetInvokerGlobalPosition();
-	const auto GetVoxelBounds = [&](float Distance)
+	const auto GetVoxelBounds = [&](const FVector& Position, float Distance)
 	{
 		return FVoxelIntBox::SafeConstruct(
-			VoxelWorld->GlobalToLocal(InvokerGlobalPosition - Distance, EVoxelWorldCoordinatesRounding::RoundDown),
-			VoxelWorld->GlobalToLocal(InvokerGlobalPosition + Distance, EVoxelWorldCoordinatesRounding::RoundUp)
+			VoxelWorld->GlobalToLocal(Position - Distance, EVoxelWorldCoordinatesRounding::RoundDown),
+			VoxelWorld->GlobalToLocal(Position + Distance, EVoxelWorldCoordinatesRounding::RoundUp)
 		);
 	};
 
@@ -141,13 +141,22 @@ FVoxelInvokerSettings UVoxelSimpleInvokerComponent::GetInvokerSettings_Implement
 	
 	Settings.bUseForLOD = bUseForLOD;
 	Settings.LODToSet = LODToSet;
-	Settings.LODBounds = GetVoxelBounds(LODRange);
+	Settings.LODBounds = GetVoxelBounds(InvokerGlobalPosition, LODRange);
+
+	if (bEnablePrefetch)
+	{
+		const FVector PredictedGlobalPosition = InvokerGlobalPosition + GetInvokerGlobalVelocity() * PrefetchTime;
+		Settings.PrefetchOffset = VoxelWorld->GlobalToLocal(PredictedGlobalPosition) - VoxelWorld->GlobalToLocal(InvokerGlobalPosition);
+		// The octree LOD only depends on the distance to the bounds, so this covers the whole path
+		// Collisions & navmesh are only needed where the invoker is
+		Settings.LODBounds = Settings.LODBounds.Union(GetVoxelBounds(PredictedGlobalPosition, LODRange));
+	}
 
 	Settings.bUseForCollisions = bUseForCollisions;
-	Settings.CollisionsBounds = GetVoxelBounds(CollisionsRange);
+	Settings.CollisionsBounds = GetVoxelBounds(InvokerGlobalPosition, CollisionsRange);
 
 	Settings.bUseForNavmesh = bUseForNavmesh;
-	Settings.NavmeshBounds = GetVoxelBounds(NavmeshRange);
+	Settings.NavmeshBounds = GetVoxelBounds(InvokerGlobalPosition, NavmeshRange);
 
 	return Settings;
 }
@@ -157,6 +166,12 @@ FVector UVoxelSimpleInvokerComponent::GetInvokerGlobalPosition_Implementation()
 	return GetComponentLocation();
 }
 
+FVector UVoxelSimpleInvokerComponent::GetInvokerGlobalVelocity_Implementation() const
+{
+	auto* Owner = GetOwner();
+	return Owner ? Owner->GetVelocity() : FVector::ZeroVector;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
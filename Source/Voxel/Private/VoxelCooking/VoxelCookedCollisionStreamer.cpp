@@ -0,0 +1,234 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelCooking/VoxelCookedCollisionStreamer.h"
+#include "VoxelCooking/VoxelCookedDataFile.h"
+#include "VoxelComponents/VoxelInvokerComponent.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
+#include "VoxelWorldRootComponent.h"
+#include "VoxelWorld.h"
+
+#include "Async/Async.h"
+#include "Containers/Queue.h"
+#include "PhysXIncludes.h"
+#include "Engine/Private/PhysicsEngine/PhysXSupport.h" // For FPhysXInputStream
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Cooked Collision Chunks Loaded"), STAT_VoxelCookedCollisionChunksLoaded, STATGROUP_VoxelCounters);
+
+struct FVoxelCookedCollisionStreamer::FLoadResults
+{
+	// Index, mesh. Mesh is null if it couldn't be loaded
+	TQueue<TPair<int32, physx::PxTriangleMesh*>, EQueueMode::Mpsc> Queue;
+
+	~FLoadResults()
+	{
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+		// Results that were never applied
+		TPair<int32, physx::PxTriangleMesh*> Result;
+		while (Queue.Dequeue(Result))
+		{
+			if (Result.Value)
+			{
+				Result.Value->release();
+			}
+		}
+#endif
+	}
+};
+
+FVoxelCookedCollisionStreamer::FVoxelCookedCollisionStreamer(const TVoxelSharedRef<FVoxelCookedDataFile>& File)
+	: File(File)
+	, LoadResults(MakeVoxelShared<FLoadResults>())
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (File->Num() > 0)
+	{
+		const FIntVector& Position = File->GetChunkPosition(0);
+		GridOffset = Position - FVoxelUtilities::DivideFloor(Position, RENDER_CHUNK_SIZE) * RENDER_CHUNK_SIZE;
+	}
+
+	GridToChunk.Reserve(File->Num());
+	for (int32 Index = 0; Index < File->Num(); Index++)
+	{
+		const FIntVector Position = File->GetChunkPosition(Index) - GridOffset;
+		const FIntVector GridPosition = FVoxelUtilities::DivideFloor(Position, RENDER_CHUNK_SIZE);
+		ensureMsgf(GridPosition * RENDER_CHUNK_SIZE == Position, TEXT("Chunk %s of %s isn't on the chunk grid"), *Position.ToString(), *File->Path);
+		GridToChunk.Add(GridPosition, Index);
+	}
+}
+
+FVoxelCookedCollisionStreamer::~FVoxelCookedCollisionStreamer()
+{
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	// If the root is already destroyed, its body setups release the meshes when garbage collected
+	if (WorldRoot.IsValid())
+	{
+		for (const int32 Index : LoadedChunks)
+		{
+			WorldRoot->RemoveCookedChunk(Index);
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_VoxelCookedCollisionChunksLoaded, LoadedChunks.Num());
+#endif
+	// The load tasks still running release their mesh when done, see FLoadResults
+}
+
+void FVoxelCookedCollisionStreamer::Tick(AVoxelWorld& World)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	UVoxelWorldRootComponent& Root = World.GetWorldRoot();
+	ensure(!WorldRoot.IsValid() || WorldRoot.Get() == &Root);
+	WorldRoot = &Root;
+
+	ApplyLoadResults(Root);
+
+	TArray<FVoxelIntBox> NewInvokersBounds;
+	for (auto& Invoker : UVoxelInvokerComponentBase::GetInvokers(&World))
+	{
+		if (!Invoker.IsValid())
+		{
+			continue;
+		}
+
+		const FVoxelInvokerSettings InvokerSettings = Invoker->GetInvokerSettings(&World);
+		if (InvokerSettings.bUseForCollisions)
+		{
+			NewInvokersBounds.Add(InvokerSettings.CollisionsBounds);
+		}
+	}
+
+	if (!bFirstTick && NewInvokersBounds == InvokersBounds)
+	{
+		return;
+	}
+	bFirstTick = false;
+	InvokersBounds = MoveTemp(NewInvokersBounds);
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	TSet<int32> NewRelevantChunks;
+	FindRelevantChunks(NewRelevantChunks);
+
+	// Only the chunks that left or entered the bounds are touched
+	for (const int32 Index : RelevantChunks)
+	{
+		if (!NewRelevantChunks.Contains(Index) && LoadedChunks.Remove(Index) == 1)
+		{
+			Root.RemoveCookedChunk(Index);
+			DEC_DWORD_STAT(STAT_VoxelCookedCollisionChunksLoaded);
+		}
+	}
+	for (const int32 Index : NewRelevantChunks)
+	{
+		if (!RelevantChunks.Contains(Index) && !LoadedChunks.Contains(Index) && !PendingChunks.Contains(Index))
+		{
+			StartLoad(Index);
+		}
+	}
+
+	RelevantChunks = MoveTemp(NewRelevantChunks);
+
+	LOG_VOXEL(Verbose, TEXT("Cooked collision: %d/%d chunks loaded, %d loading"), LoadedChunks.Num(), File->Num(), PendingChunks.Num());
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelCookedCollisionStreamer::FindRelevantChunks(TSet<int32>& OutChunks) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	for (const FVoxelIntBox& Bounds : InvokersBounds)
+	{
+		// Grid positions of the chunks intersecting Bounds
+		const FIntVector Min = FVoxelUtilities::DivideFloor(Bounds.Min - GridOffset, RENDER_CHUNK_SIZE);
+		const FIntVector Max = FVoxelUtilities::DivideCeil(Bounds.Max - GridOffset, RENDER_CHUNK_SIZE);
+
+		const int64 NumCells = int64(Max.X - Min.X) * int64(Max.Y - Min.Y) * int64(Max.Z - Min.Z);
+		if (NumCells > GridToChunk.Num())
+		{
+			// Faster to go through all the chunks
+			for (auto& It : GridToChunk)
+			{
+				if (It.Key.X >= Min.X && It.Key.X < Max.X &&
+					It.Key.Y >= Min.Y && It.Key.Y < Max.Y &&
+					It.Key.Z >= Min.Z && It.Key.Z < Max.Z)
+				{
+					OutChunks.Add(It.Value);
+				}
+			}
+			continue;
+		}
+
+		for (int32 X = Min.X; X < Max.X; X++)
+		{
+			for (int32 Y = Min.Y; Y < Max.Y; Y++)
+			{
+				for (int32 Z = Min.Z; Z < Max.Z; Z++)
+				{
+					if (const int32* Index = GridToChunk.Find(FIntVector(X, Y, Z)))
+					{
+						OutChunks.Add(*Index);
+					}
+				}
+			}
+		}
+	}
+}
+
+void FVoxelCookedCollisionStreamer::StartLoad(int32 Index)
+{
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	PendingChunks.Add(Index);
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [File = File, LoadResults = LoadResults, Index]()
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Load Cooked Collision Chunk");
+
+		physx::PxTriangleMesh* TriMesh = nullptr;
+		File->ReadChunk(Index, [&](TArrayView<const uint8> Data)
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("createTriangleMesh");
+			FPhysXInputStream Buffer(Data.GetData(), Data.Num());
+			TriMesh = GPhysXSDK->createTriangleMesh(Buffer);
+		});
+
+		LoadResults->Queue.Enqueue({ Index, TriMesh });
+	});
+#endif
+}
+
+void FVoxelCookedCollisionStreamer::ApplyLoadResults(UVoxelWorldRootComponent& Root)
+{
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	VOXEL_FUNCTION_COUNTER();
+
+	TPair<int32, physx::PxTriangleMesh*> Result;
+	while (LoadResults->Queue.Dequeue(Result))
+	{
+		const int32 Index = Result.Key;
+		physx::PxTriangleMesh* const TriMesh = Result.Value;
+		ensure(PendingChunks.Remove(Index) == 1);
+
+		if (!TriMesh)
+		{
+			LOG_VOXEL(Warning, TEXT("Failed to load the cooked collision of chunk %s from %s"), *File->GetChunkPosition(Index).ToString(), *File->Path);
+			continue;
+		}
+		if (!RelevantChunks.Contains(Index))
+		{
+			// Left the invokers bounds while loading
+			TriMesh->release();
+			continue;
+		}
+
+		// The root takes ownership of the mesh
+		Root.AddCookedChunk(Index, TriMesh);
+		LoadedChunks.Add(Index);
+		INC_DWORD_STAT(STAT_VoxelCookedCollisionChunksLoaded);
+	}
+#endif
+}
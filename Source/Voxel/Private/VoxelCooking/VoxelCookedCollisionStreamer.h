@@ -0,0 +1,61 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelIntBox.h"
+
+class AVoxelWorld;
+class FVoxelCookedDataFile;
+class UVoxelWorldRootComponent;
+
+namespace physx
+{
+	class PxTriangleMesh;
+}
+
+/**
+ * Creates the collision of the chunks of a cooked data file only once they are in the collision bounds of an invoker,
+ * and releases it once they aren't anymore. Used by voxel worlds that aren't created, see UVoxelCookingLibrary::LoadCookedVoxelDataFromFile
+ * The meshes are created on background threads, and added to/removed from the world root one chunk at a time
+ * Game thread only
+ */
+class FVoxelCookedCollisionStreamer
+{
+public:
+	explicit FVoxelCookedCollisionStreamer(const TVoxelSharedRef<FVoxelCookedDataFile>& File);
+	~FVoxelCookedCollisionStreamer();
+
+	UE_NONCOPYABLE(FVoxelCookedCollisionStreamer);
+
+	void Tick(AVoxelWorld& World);
+
+private:
+	const TVoxelSharedRef<FVoxelCookedDataFile> File;
+
+	// The chunks are on a grid of RENDER_CHUNK_SIZE starting at GridOffset
+	FIntVector GridOffset = FIntVector::ZeroValue;
+	// Grid position to chunk index, so that finding the chunks in some bounds doesn't need to go through all of them
+	TMap<FIntVector, int32> GridToChunk;
+
+	bool bFirstTick = true;
+	TArray<FVoxelIntBox> InvokersBounds;
+
+	// Chunks in the invokers bounds
+	TSet<int32> RelevantChunks;
+	// Chunks added to the world root
+	TSet<int32> LoadedChunks;
+	// Chunks whose mesh is being created. Discarded when done if they aren't relevant anymore
+	TSet<int32> PendingChunks;
+
+	// Shared with the load tasks, as they can outlive us
+	struct FLoadResults;
+	const TVoxelSharedRef<FLoadResults> LoadResults;
+
+	TWeakObjectPtr<UVoxelWorldRootComponent> WorldRoot;
+
+	void FindRelevantChunks(TSet<int32>& OutChunks) const;
+	void StartLoad(int32 Index);
+	void ApplyLoadResults(UVoxelWorldRootComponent& Root);
+};
\ No newline at end of file
@@ -19,7 +19,15 @@ bool FVoxelCookedDataImpl::Serialize(FArchive& Ar)
 
 		Ar << Version;
 		Ar << Guid;
-		Ar << Chunks;		
+		Ar << Chunks;
+		
+		if (Version >= FVoxelCookedDataVersion::AddChunkPositions)
+		{
+			for (FChunk& Chunk : Chunks)
+			{
+				Ar << Chunk.Position;
+			}
+		}
 		
 		UpdateAllocatedSize();
 	}
@@ -0,0 +1,267 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelCooking/VoxelCookedDataFile.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Serialization/MemoryReader.h"
+
+// Magic, Version, NumChunks, IndexOffset
+static constexpr int64 CookedDataFileHeaderSize = sizeof(uint32) + sizeof(uint32) + sizeof(int32) + sizeof(int64);
+// Position, Offset, Size
+static constexpr int64 CookedDataFileEntrySize = sizeof(FIntVector) + sizeof(int64) + sizeof(int32);
+
+TVoxelSharedPtr<FVoxelCookedDataFileWriter> FVoxelCookedDataFileWriter::Create(const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Write to a temporary file first, so that a failed cook never leaves a partial file at Path
+	const FString TempPath = Path + TEXT(".tmp");
+	TUniquePtr<FArchive> Archive = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*TempPath));
+	if (!Archive)
+	{
+		LOG_VOXEL(Error, TEXT("Failed to create %s"), *TempPath);
+		return nullptr;
+	}
+
+	const auto Writer = TVoxelSharedPtr<FVoxelCookedDataFileWriter>(new FVoxelCookedDataFileWriter(Path, TempPath, MoveTemp(Archive)));
+	// Placeholder, written again once the index offset is known
+	Writer->WriteHeader(0);
+	return Writer;
+}
+
+FVoxelCookedDataFileWriter::~FVoxelCookedDataFileWriter()
+{
+	if (Archive)
+	{
+		// Not finished
+		Archive.Reset();
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+	}
+}
+
+void FVoxelCookedDataFileWriter::AddChunk(const FIntVector& Position, const TArray<uint8>& Data)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (Data.Num() == 0)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&Section);
+	check(Archive);
+
+	FVoxelCookedDataFileFormat::FChunkEntry Entry;
+	Entry.Position = Position;
+	Entry.Offset = Archive->Tell();
+	Entry.Size = Data.Num();
+	Entries.Add(Entry);
+
+	Archive->Serialize(const_cast<uint8*>(Data.GetData()), Data.Num());
+}
+
+bool FVoxelCookedDataFileWriter::Finish()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FScopeLock Lock(&Section);
+	check(Archive);
+
+	const int64 IndexOffset = Archive->Tell();
+	for (auto& Entry : Entries)
+	{
+		*Archive << Entry;
+	}
+
+	Archive->Seek(0);
+	WriteHeader(IndexOffset);
+
+	const bool bError = Archive->IsError();
+	Archive->Close();
+	Archive.Reset();
+
+	if (bError)
+	{
+		LOG_VOXEL(Error, TEXT("Failed to write %s"), *TempPath);
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+		return false;
+	}
+	if (!IFileManager::Get().Move(*Path, *TempPath, true, true))
+	{
+		LOG_VOXEL(Error, TEXT("Failed to move %s to %s"), *TempPath, *Path);
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+		return false;
+	}
+	return true;
+}
+
+FVoxelCookedDataFileWriter::FVoxelCookedDataFileWriter(const FString& Path, const FString& TempPath, TUniquePtr<FArchive> Archive)
+	: Path(Path)
+	, TempPath(TempPath)
+	, Archive(MoveTemp(Archive))
+{
+}
+
+void FVoxelCookedDataFileWriter::WriteHeader(int64 IndexOffset)
+{
+	uint32 Magic = FVoxelCookedDataFileFormat::Magic;
+	uint32 Version = FVoxelCookedDataFileFormat::Version;
+	int32 NumChunks = Entries.Num();
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << NumChunks;
+	*Archive << IndexOffset;
+	ensure(Archive->Tell() == CookedDataFileHeaderSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelSharedPtr<FVoxelCookedDataFile> FVoxelCookedDataFile::Open(const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const auto File = TVoxelSharedPtr<FVoxelCookedDataFile>(new FVoxelCookedDataFile(Path));
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	File->MappedHandle = TUniquePtr<IMappedFileHandle>(PlatformFile.OpenMapped(*Path));
+	if (File->MappedHandle)
+	{
+		File->MappedRegion = TUniquePtr<IMappedFileRegion>(File->MappedHandle->MapRegion());
+	}
+	if (!File->MappedRegion)
+	{
+		File->MappedHandle.Reset();
+		File->FileHandle = TUniquePtr<IFileHandle>(PlatformFile.OpenRead(*Path));
+		if (!File->FileHandle)
+		{
+			LOG_VOXEL(Error, TEXT("Failed to open %s"), *Path);
+			return nullptr;
+		}
+	}
+
+	const int64 FileSize = File->GetFileSize();
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 NumChunks = 0;
+	int64 IndexOffset = 0;
+	bool bValidHeader = false;
+	if (FileSize >= CookedDataFileHeaderSize)
+	{
+		File->Read(0, CookedDataFileHeaderSize, [&](TArrayView<const uint8> Data)
+		{
+			const TArray<uint8> Header(Data.GetData(), Data.Num());
+			FMemoryReader Reader(Header);
+			Reader << Magic;
+			Reader << Version;
+			Reader << NumChunks;
+			Reader << IndexOffset;
+			bValidHeader = !Reader.IsError();
+		});
+	}
+
+	if (!bValidHeader ||
+		Magic != FVoxelCookedDataFileFormat::Magic ||
+		Version != FVoxelCookedDataFileFormat::Version ||
+		NumChunks < 0 ||
+		IndexOffset < CookedDataFileHeaderSize ||
+		IndexOffset + NumChunks * CookedDataFileEntrySize != FileSize)
+	{
+		LOG_VOXEL(Error, TEXT("%s is not a valid voxel cooked data file"), *Path);
+		return nullptr;
+	}
+
+	// Only read the index: the chunks are read when needed
+	bool bValidIndex = NumChunks == 0;
+	File->Read(IndexOffset, NumChunks * CookedDataFileEntrySize, [&](TArrayView<const uint8> Data)
+	{
+		const TArray<uint8> Index(Data.GetData(), Data.Num());
+		FMemoryReader Reader(Index);
+		File->Entries.SetNum(NumChunks);
+		for (auto& Entry : File->Entries)
+		{
+			Reader << Entry;
+		}
+		bValidIndex = !Reader.IsError();
+	});
+
+	for (auto& Entry : File->Entries)
+	{
+		if (Entry.Offset < CookedDataFileHeaderSize || Entry.Size <= 0 || Entry.Offset + Entry.Size > IndexOffset)
+		{
+			bValidIndex = false;
+		}
+	}
+
+	if (!bValidIndex)
+	{
+		LOG_VOXEL(Error, TEXT("Corrupted voxel cooked data file %s"), *Path);
+		return nullptr;
+	}
+
+	LOG_VOXEL(Log, TEXT("Opened voxel cooked data file %s: %d chunks, %s"), *Path, NumChunks, File->IsMapped() ? TEXT("memory mapped") : TEXT("not memory mapped"));
+
+	return File;
+}
+
+FVoxelCookedDataFile::~FVoxelCookedDataFile()
+{
+	// Region must be destroyed before its handle
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+}
+
+bool FVoxelCookedDataFile::ReadChunk(int32 Index, TFunctionRef<void(TArrayView<const uint8> Data)> Lambda) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (!ensure(Entries.IsValidIndex(Index)))
+	{
+		return false;
+	}
+
+	const auto& Entry = Entries[Index];
+	return Read(Entry.Offset, Entry.Size, Lambda);
+}
+
+FVoxelCookedDataFile::FVoxelCookedDataFile(const FString& Path)
+	: Path(Path)
+{
+}
+
+bool FVoxelCookedDataFile::Read(int64 Offset, int64 Size, TFunctionRef<void(TArrayView<const uint8> Data)> Lambda) const
+{
+	if (!ensure(0 <= Offset && 0 <= Size && Size <= MAX_int32 && Offset + Size <= GetFileSize()))
+	{
+		return false;
+	}
+
+	if (MappedRegion)
+	{
+		// No copy: the OS pages the data in when it's accessed
+		Lambda(TArrayView<const uint8>(MappedRegion->GetMappedPtr() + Offset, Size));
+		return true;
+	}
+
+	TArray<uint8> Data;
+	Data.SetNumUninitialized(Size);
+	{
+		FScopeLock Lock(&FileHandleSection);
+		if (!FileHandle->Seek(Offset) || !FileHandle->Read(Data.GetData(), Size))
+		{
+			LOG_VOXEL(Warning, TEXT("Failed to read %s"), *Path);
+			return false;
+		}
+	}
+	Lambda(Data);
+	return true;
+}
+
+int64 FVoxelCookedDataFile::GetFileSize() const
+{
+	return MappedRegion ? MappedRegion->GetMappedSize() : FileHandle->Size();
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 // Copyright 2020 Phyronnaz
 
 #include "VoxelCooking/VoxelCookingLibrary.h"
+#include "VoxelCooking/VoxelCookedDataFile.h"
+#include "VoxelCooking/VoxelCookedCollisionStreamer.h"
 
 #include "VoxelWorld.h"
 #include "VoxelMessages.h"
@@ -25,7 +27,9 @@
 struct FVoxelCookingTaskData
 {
 	IVoxelRenderer& Renderer;
-	FVoxelCookedDataImpl& CookedData;
+	// Exactly one of these is set
+	FVoxelCookedDataImpl* const CookedData;
+	FVoxelCookedDataFileWriter* const FileWriter;
 	IPhysXCooking& PhysXCooking;
 	
 	const int32 NumChunksToBuild;
@@ -37,15 +41,20 @@ struct FVoxelCookingTaskData
 	FThreadSafeCounter64 MeshingTime;
 	FThreadSafeCounter64 CollisionTime;
 
-	FVoxelCookingTaskData(IVoxelRenderer& Renderer, FVoxelCookedDataImpl& CookedData, int32 NumChunksToBuild, const FVoxelCookingSettings& CookingSettings)
+	FVoxelCookingTaskData(IVoxelRenderer& Renderer, FVoxelCookedDataImpl* CookedData, FVoxelCookedDataFileWriter* FileWriter, int32 NumChunksToBuild, const FVoxelCookingSettings& CookingSettings)
 		: Renderer(Renderer)
 		, CookedData(CookedData)
+		, FileWriter(FileWriter)
 		, PhysXCooking(*GetPhysXCookingModule()->GetPhysXCooking())
 		, NumChunksToBuild(NumChunksToBuild)
 		, CookingSettings(CookingSettings)
 		, DoneEvent(FPlatformProcess::GetSynchEventFromPool())
 	{
-		CookedData.SetNumChunks(NumChunksToBuild);
+		check(!CookedData != !FileWriter);
+		if (CookedData)
+		{
+			CookedData->SetNumChunks(NumChunksToBuild);
+		}
 	}
 	~FVoxelCookingTaskData()
 	{
@@ -53,15 +62,27 @@ struct FVoxelCookingTaskData
 		FPlatformProcess::ReturnSynchEventToPool(DoneEvent);
 	}
 
-	void ChunkDone(TArray<uint8>&& Data)
+	void ChunkDone(const FIntVector& ChunkPosition, TArray<uint8>&& Data)
 	{
+		if (FileWriter)
+		{
+			// Written right away, so that the cooked chunks don't pile up in memory
+			FileWriter->AddChunk(ChunkPosition, Data);
+			Data.Empty();
+		}
+
 		const int32 NumBuilt = NumChunksBuilt.Increment();
 		if (CookingSettings.bLogProgress)
 		{
 			LOG_VOXEL(Log, TEXT("VOXEL COOKING: %d/%d"), NumBuilt, NumChunksToBuild);
 		}
 
-		CookedData.GetChunk(NumBuilt - 1).Data = MoveTemp(Data);
+		if (CookedData)
+		{
+			auto& Chunk = CookedData->GetChunk(NumBuilt - 1);
+			Chunk.Position = ChunkPosition;
+			Chunk.Data = MoveTemp(Data);
+		}
 
 		if (NumBuilt == NumChunksToBuild)
 		{
@@ -144,7 +165,7 @@ public:
 			}
 		}
 
-		TaskData.ChunkDone(MoveTemp(Buffer));
+		TaskData.ChunkDone(ChunkPosition, MoveTemp(Buffer));
 		delete this;
 	}
 	virtual void Abandon() override
@@ -158,7 +179,8 @@ public:
 };
 #endif
 
-FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSettings& Settings, const FVoxelUncompressedWorldSaveImpl* Save)
+// Exactly one of CookedData and FileWriter must be set
+static bool CookVoxelDataImpl_Internal(const FVoxelCookingSettings& Settings, const FVoxelUncompressedWorldSaveImpl* Save, FVoxelCookedDataImpl* CookedData, FVoxelCookedDataFileWriter* FileWriter)
 {
 	VOXEL_FUNCTION_COUNTER();
 	check(IsInGameThread());
@@ -166,7 +188,7 @@ FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSett
 	if (!Settings.Generator.IsValid())
 	{
 		FVoxelMessages::Error(FUNCTION_ERROR("Invalid generator"));
-		return {};
+		return false;
 	}
 
 	AVoxelWorld* VoxelWorld = NewObject<AVoxelWorld>();
@@ -205,16 +227,16 @@ FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSett
 	if (TotalNumChunks > MAX_int32)
 	{
 		FVoxelMessages::Error(FUNCTION_ERROR("Depth too high"));
-		return {};
+		return false;
 	}
 
 	const double StartTime = FPlatformTime::Seconds();
 	LOG_VOXEL(Log, TEXT("VOXEL COOKING: Starting cooking with %lld tasks"), TotalNumChunks);
 
-	FVoxelCookedData CookedData;
+	bool bSuccess = false;
 	
 #if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
-	FVoxelCookingTaskData TaskData(*Renderer, CookedData.Mutable(), TotalNumChunks, Settings);
+	FVoxelCookingTaskData TaskData(*Renderer, CookedData, FileWriter, TotalNumChunks, Settings);
 
 	for (int32 X = Min.X; X < Max.X; X += RENDER_CHUNK_SIZE)
 	{
@@ -235,8 +257,12 @@ FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSett
 
 	const double EndTime = FPlatformTime::Seconds();
 
-	TaskData.CookedData.RemoveEmptyChunks();
-	TaskData.CookedData.UpdateAllocatedSize();
+	if (CookedData)
+	{
+		CookedData->RemoveEmptyChunks();
+		CookedData->UpdateAllocatedSize();
+	}
+	bSuccess = true;
 
 	const double GameThreadTime = EndTime - StartTime;
 	const double MeshingTime = TaskData.MeshingTime.GetValue() * FPlatformTime::GetSecondsPerCycle64();
@@ -254,9 +280,72 @@ FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSett
 	Renderer->Destroy();
 	DebugManager->Destroy();
 	
+	return bSuccess;
+}
+
+FVoxelCookedData UVoxelCookingLibrary::CookVoxelDataImpl(const FVoxelCookingSettings& Settings, const FVoxelUncompressedWorldSaveImpl* Save)
+{
+	FVoxelCookedData CookedData;
+	CookVoxelDataImpl_Internal(Settings, Save, &CookedData.Mutable(), nullptr);
 	return CookedData;
 }
 
+bool UVoxelCookingLibrary::CookVoxelDataToFileImpl(const FVoxelCookingSettings& Settings, const FString& Path, const FVoxelUncompressedWorldSaveImpl* Save)
+{
+	VOXEL_FUNCTION_COUNTER();
+	
+	const auto FileWriter = FVoxelCookedDataFileWriter::Create(Path);
+	if (!FileWriter)
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR(FString::Printf(TEXT("Failed to create %s"), *Path)));
+		return false;
+	}
+
+	if (!CookVoxelDataImpl_Internal(Settings, Save, nullptr, FileWriter.Get()))
+	{
+		return false;
+	}
+
+	if (!FileWriter->Finish())
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR(FString::Printf(TEXT("Failed to write %s"), *Path)));
+		return false;
+	}
+
+	LOG_VOXEL(Log, TEXT("VOXEL COOKING: Wrote %d chunks to %s"), FileWriter->GetNumChunks(), *Path);
+	return true;
+}
+
+bool UVoxelCookingLibrary::SaveCookedVoxelDataToFile(FVoxelCookedData CookedData, const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!CookedData.Const().HasChunkPositions())
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR("Cooked data is too old and doesn't have the chunk positions, please cook it again"));
+		return false;
+	}
+	
+	const auto FileWriter = FVoxelCookedDataFileWriter::Create(Path);
+	if (!FileWriter)
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR(FString::Printf(TEXT("Failed to create %s"), *Path)));
+		return false;
+	}
+
+	for (auto& Chunk : CookedData.Const().GetChunks())
+	{
+		FileWriter->AddChunk(Chunk.Position, Chunk.Data);
+	}
+
+	if (!FileWriter->Finish())
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR(FString::Printf(TEXT("Failed to write %s"), *Path)));
+		return false;
+	}
+	return true;
+}
+
 FVoxelCookingSettings UVoxelCookingLibrary::MakeVoxelCookingSettingsFromVoxelWorld(AVoxelWorld* World, int32 ThreadCount)
 {
 	if (!World)
@@ -316,4 +405,43 @@ void UVoxelCookingLibrary::LoadCookedVoxelData(FVoxelCookedData CookedData, AVox
 	World->ApplyCollisionSettingsToRoot();
 	
 	LOG_VOXEL(Log, TEXT("VOXEL COOKING: Loaded cooked data"));
+}
+
+bool UVoxelCookingLibrary::LoadCookedVoxelDataFromFile(const FString& Path, AVoxelWorld* World)
+{
+	VOXEL_FUNCTION_COUNTER();
+	
+	if (!World)
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR("Invalid voxel world!"));
+		return false;
+	}
+	if (World->IsCreated())
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR("Voxel world is already created!"));
+		return false;
+	}
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	const auto File = FVoxelCookedDataFile::Open(Path);
+	if (!File)
+	{
+		FVoxelMessages::Error(FUNCTION_ERROR(FString::Printf(TEXT("Failed to open %s"), *Path)));
+		return false;
+	}
+
+	// The chunk bodies copy the root collision settings
+	World->ApplyCollisionSettingsToRoot();
+
+	const auto Streamer = MakeVoxelShared<FVoxelCookedCollisionStreamer>(File.ToSharedRef());
+	World->SetCookedCollisionStreamer(Streamer);
+	// Start loading the chunks around the invokers right away
+	Streamer->Tick(*World);
+	
+	LOG_VOXEL(Log, TEXT("VOXEL COOKING: Streaming cooked data from %s"), *Path);
+	return true;
+#else
+	ensure(false);
+	return false;
+#endif
 }
\ No newline at end of file
@@ -12,10 +12,12 @@
 #include "VoxelEnums.h"
 #include "VoxelWorld.h"
 #include "VoxelQueryZone.h"
+#include "VoxelGenerators/VoxelGenerator.h"
 #include "VoxelGenerators/VoxelGeneratorHelpers.h"
 #include "VoxelPlaceableItems/VoxelPlaceableItem.h"
 
 #include "Misc/ScopeLock.h"
+#include "Hash/CityHash.h"
 #include "Async/Async.h"
 
 VOXEL_API TAutoConsoleVariable<int32> CVarMaxPlaceableItemsPerOctree(
@@ -31,6 +33,12 @@ VOXEL_API TAutoConsoleVariable<int32> CVarStoreSpecialValueForGeneratorValuesInS
 		TEXT("Important: must be the same when saving & loading!"),
 		ECVF_Default);
 
+VOXEL_API TAutoConsoleVariable<int32> CVarCacheBoundsBatchSize(
+		TEXT("voxel.data.CacheBoundsBatchSize"),
+		4,
+		TEXT("When caching, leaves without items are generated by batches of CacheBoundsBatchSize^3 leaves. 1 to generate them one by one"),
+		ECVF_Default);
+
 DEFINE_STAT(STAT_NumVoxelAssetItems);
 DEFINE_STAT(STAT_NumVoxelDisableEditsItems);
 DEFINE_STAT(STAT_NumVoxelDataItems);
@@ -46,6 +54,33 @@ inline auto CreateGenerator(const AVoxelWorld* World)
 	return GeneratorInstance;
 }
 
+inline uint64 GetGeneratorHash(const AVoxelWorld* World)
+{
+	const UVoxelGenerator* Generator = World->Generator.GetGenerator();
+	if (!Generator)
+	{
+		return 0;
+	}
+
+	const uint64 Hash = Generator->GetGeneratorHash(World->Generator.Parameters);
+	if (Hash == 0)
+	{
+		return 0;
+	}
+
+	// The generator output also depends on its init
+	const FVoxelGeneratorInit Init = World->GetGeneratorInit();
+	const FString InitString = FString::Printf(
+		TEXT("%f %d %d %d %s"),
+		Init.VoxelSize,
+		Init.WorldSize,
+		int32(Init.RenderType),
+		int32(Init.MaterialConfig),
+		*GetPathNameSafe(Init.MaterialCollection));
+	
+	return CityHash64WithSeed(reinterpret_cast<const char*>(*InitString), InitString.Len() * sizeof(TCHAR), Hash);
+}
+
 inline int32 ClampDataDepth(int32 Depth)
 {
 	return FMath::Max(1, FVoxelUtilities::ClampDepth<DATA_CHUNK_SIZE>(Depth));
@@ -57,6 +92,7 @@ FVoxelDataSettings::FVoxelDataSettings(const AVoxelWorld* World, EVoxelPlayType
 	, Generator(CreateGenerator(World))
 	, bEnableMultiplayer(false)
 	, bEnableUndoRedo(PlayType == EVoxelPlayType::Game ? World->bEnableUndoRedo : true)
+	, GeneratorHash(GetGeneratorHash(World))
 {
 }
 
@@ -70,6 +106,7 @@ FVoxelDataSettings::FVoxelDataSettings(
 	, Generator(Generator)
 	, bEnableMultiplayer(bEnableMultiplayer)
 	, bEnableUndoRedo(bEnableUndoRedo)
+	, GeneratorHash(0)
 {
 
 }
@@ -84,6 +121,7 @@ FVoxelDataSettings::FVoxelDataSettings(
 	, Generator(Generator)
 	, bEnableMultiplayer(bEnableMultiplayer)
 	, bEnableUndoRedo(bEnableUndoRedo)
+	, GeneratorHash(0)
 {
 
 }
@@ -94,6 +132,7 @@ FVoxelDataSettings::FVoxelDataSettings(
 
 FVoxelData::FVoxelData(const FVoxelDataSettings& Settings)
 	: IVoxelData(Settings.Depth, Settings.WorldBounds, Settings.bEnableMultiplayer, Settings.bEnableUndoRedo, Settings.Generator)
+	, GeneratorHash(Settings.GeneratorHash)
 	, Octree(MakeUnique<FVoxelDataOctreeParent>(Depth))
 {
 	check(Depth > 0);
@@ -111,7 +150,7 @@ TVoxelSharedRef<FVoxelData> FVoxelData::Create(const FVoxelDataSettings& Setting
 		{
 			if (!Chunk.IsLeaf() && Settings.Depth - Chunk.Height < DataOctreeInitialSubdivisionDepth)
 			{
-				Chunk.AsParent().CreateChildren();
+				Chunk.AsParent().CreateChildren(Data->LeafIndex);
 			}
 		});
 	}
@@ -310,10 +349,15 @@ void FVoxelData::ClearData()
 		ensure(GetCachedMemory().Values.GetValue() == 0);
 		ensure(GetCachedMemory().Materials.GetValue() == 0);
 
+		// No lookups are running as we have the main lock
+		LeafIndex.Reset();
 		Octree = MakeUnique<FVoxelDataOctreeParent>(Depth);
 	}
 	MainLock.Unlock(EVoxelLockType::Write);
 
+	// The pools are shared by all the worlds: only the slabs that no other octree uses are freed
+	FVoxelDataOctreeParent::TrimChildrenPools();
+
 	UndoRedo = {};
 	MarkAsDirty();
 
@@ -393,11 +437,11 @@ void FVoxelData::Get(TVoxelQueryZone<T>& GlobalQueryZone, int32 LOD) const
 			{
 				VOXEL_SLOW_SCOPE_COUNTER("Copy Data");
 				const FIntVector Min = InOctree.GetMin();
-				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 				{
 					for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 					{
-						for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+						for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 						{
 							const int32 Index = FVoxelDataOctreeUtilities::IndexFromGlobalCoordinates(Min, X, Y, Z);
 							QueryZone.Set(X, Y, Z, Data.Get(Index));
@@ -422,11 +466,11 @@ void FVoxelData::Get(TVoxelQueryZone<T>& GlobalQueryZone, int32 LOD) const
 		{
 			check(LocalBounds.IsMultipleOf(GlobalQueryZone.Step));
 			auto LocalQueryZone = GlobalQueryZone.ShrinkTo(LocalBounds);
-			for (VOXEL_QUERY_ZONE_ITERATE(LocalQueryZone, X))
+			for (VOXEL_QUERY_ZONE_ITERATE(LocalQueryZone, Z))
 			{
 				for (VOXEL_QUERY_ZONE_ITERATE(LocalQueryZone, Y))
 				{
-					for (VOXEL_QUERY_ZONE_ITERATE(LocalQueryZone, Z))
+					for (VOXEL_QUERY_ZONE_ITERATE(LocalQueryZone, X))
 					{
 						// Get will handle clamping to the world bounds
 						LocalQueryZone.Set(X, Y, Z, Get<T>(X, Y, Z, LOD));
@@ -523,6 +567,51 @@ TVoxelRange<FVoxelValue> FVoxelData::GetValueRange(const FVoxelIntBox& InBounds,
 	return Result.Get(FVoxelValue::Empty());
 }
 
+EVoxelEmptyState FVoxelData::GetEmptyState(const FVoxelIntBox& Bounds, int32 LOD, int32 MinSize) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	
+	const auto Range = GetValueRange(Bounds, LOD);
+	if (Range.Min.IsEmpty())
+	{
+		return EVoxelEmptyState::Empty;
+	}
+	if (!Range.Max.IsEmpty())
+	{
+		return EVoxelEmptyState::Full;
+	}
+
+	const FIntVector Size = Bounds.Size() / (1 << LOD);
+	if (MinSize <= 0 || Size.GetMin() < 2 * MinSize)
+	{
+		return EVoxelEmptyState::Unknown;
+	}
+
+	const FIntVector Center = Bounds.Min + Size / 2 * (1 << LOD);
+	
+	TOptional<EVoxelEmptyState> State;
+	for (int32 Index = 0; Index < 8; Index++)
+	{
+		const FIntVector Min(
+			Index & 0x1 ? Center.X : Bounds.Min.X,
+			Index & 0x2 ? Center.Y : Bounds.Min.Y,
+			Index & 0x4 ? Center.Z : Bounds.Min.Z);
+		const FIntVector Max(
+			Index & 0x1 ? Bounds.Max.X : Center.X,
+			Index & 0x2 ? Bounds.Max.Y : Center.Y,
+			Index & 0x4 ? Bounds.Max.Z : Center.Z);
+		
+		const EVoxelEmptyState OctantState = GetEmptyState(FVoxelIntBox(Min, Max), LOD, MinSize);
+		// An empty octant next to a full one has a surface in between
+		if (OctantState == EVoxelEmptyState::Unknown || (State.IsSet() && State.GetValue() != OctantState))
+		{
+			return EVoxelEmptyState::Unknown;
+		}
+		State = OctantState;
+	}
+	return State.GetValue();
+}
+
 TVoxelRange<v_flt> FVoxelData::GetCustomOutputRange(TVoxelRange<v_flt> DefaultValue, FName Name, const FVoxelIntBox& InBounds, int32 LOD) const
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
@@ -590,75 +679,139 @@ TVoxelRange<v_flt> FVoxelData::GetCustomOutputRange(TVoxelRange<v_flt> DefaultVa
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-void FVoxelData::GetSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects)
+bool FVoxelData::GetSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects, FVoxelDataProgress* Progress)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
-	
-	FVoxelReadScopeLock Lock(*this, FVoxelIntBox::Infinite, "GetSave");
+
+	const bool bDiffGenerator = CVarStoreSpecialValueForGeneratorValuesInSaves.GetValueOnAnyThread() != 0;
+
+	// Copies of the dirty leaves data: edits made after the copy don't affect the save,
+	// so that the lock is only held while copying and not while diffing/building the save
+	struct FLeafSnapshot
+	{
+		FIntVector Position;
+		FVoxelIntBox Bounds;
+		// Null if not dirty
+		TUniquePtr<TVoxelDataOctreeLeafData<FVoxelValue>> Values;
+		TUniquePtr<TVoxelDataOctreeLeafData<FVoxelMaterial>> Materials;
+	};
+	TArray<FLeafSnapshot> Snapshots;
 
 	FVoxelSaveBuilder Builder(Depth);
 
-	TArray<TUniquePtr<TVoxelDataOctreeLeafData<FVoxelValue>>> BuffersToDelete;
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Snapshot");
+		FVoxelReadScopeLock Lock(*this, FVoxelIntBox::Infinite, "GetSave");
+
+		Snapshots.Reserve(LeafIndex.GetNum());
+		FVoxelOctreeUtilities::IterateAllLeaves(*Octree, [&](FVoxelDataOctreeLeaf& Leaf)
+		{
+			FLeafSnapshot& Snapshot = Snapshots.Emplace_GetRef();
+			Snapshot.Position = Leaf.Position;
+			Snapshot.Bounds = Leaf.GetBounds();
+
+			if (Leaf.Values.IsDirty())
+			{
+				Snapshot.Values = MakeUnique<TVoxelDataOctreeLeafData<FVoxelValue>>();
+				Snapshot.Values->CreateData(*this, Leaf.Values);
+				Snapshot.Values->SetIsDirty(true, *this);
+			}
+			if (Leaf.Materials.IsDirty())
+			{
+				Snapshot.Materials = MakeUnique<TVoxelDataOctreeLeafData<FVoxelMaterial>>();
+				Snapshot.Materials->CreateData(*this, Leaf.Materials);
+				Snapshot.Materials->SetIsDirty(true, *this);
+			}
+		});
+
+		for (auto& Item : AssetItemsData.Items)
+		{
+			Builder.AddAssetItem(Item->Item);
+		}
+	}
 
-	FVoxelOctreeUtilities::IterateAllLeaves(*Octree, [&](FVoxelDataOctreeLeaf& Leaf)
+	if (Progress)
 	{
-		TVoxelDataOctreeLeafData<FVoxelValue>* ValuesPtr = &Leaf.Values;
-		
-		if (CVarStoreSpecialValueForGeneratorValuesInSaves.GetValueOnGameThread() != 0)
+		Progress->NumLeaves.Set(Snapshots.Num());
+	}
+
+	if (bDiffGenerator)
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Diffing with generator");
+
+		ParallelFor(Snapshots.Num(), [&](int32 Index)
 		{
-			VOXEL_ASYNC_SCOPE_COUNTER("Diffing with generator");
-			
+			if (Progress && Progress->bCancel)
+			{
+				return;
+			}
+
+			auto* Values = Snapshots[Index].Values.Get();
 			// Only if dirty and not compressed to a single value
-			if (Leaf.Values.IsDirty() && !Leaf.Values.IsSingleValue())
+			if (Values && !Values->IsSingleValue())
 			{
-				auto UniquePtr = MakeUnique<TVoxelDataOctreeLeafData<FVoxelValue>>();
-				UniquePtr->CreateData(*this);
-				UniquePtr->SetIsDirty(true, *this);
+				TVoxelStaticArray<FVoxelValue, VOXELS_PER_DATA_CHUNK> GeneratorValues;
+				TVoxelQueryZone<FVoxelValue> QueryZone(Snapshots[Index].Bounds, GeneratorValues);
+				// Empty stack: items not loaded when loading in LoadFromSave
+				Generator->Get(QueryZone, 0, FVoxelItemStack::Empty);
 
-				const FVoxelIntBox LeafBounds = Leaf.GetBounds();
-				LeafBounds.Iterate([&](int32 X, int32 Y, int32 Z)
+				for (int32 ValueIndex = 0; ValueIndex < VOXELS_PER_DATA_CHUNK; ValueIndex++)
 				{
-					const FVoxelCellIndex Index = FVoxelDataOctreeUtilities::IndexFromGlobalCoordinates(LeafBounds.Min, X, Y, Z);
-					const FVoxelValue Value = Leaf.Values.Get(Index);
-					// Empty stack: items not loaded when loading in LoadFromSave
-					const FVoxelValue GeneratorValue = Generator->Get<FVoxelValue>(X, Y, Z, 0, FVoxelItemStack::Empty);
-
-					if (GeneratorValue == Value)
+					FVoxelValue& Value = Values->GetRef(ValueIndex);
+					if (Value == GeneratorValues[ValueIndex])
 					{
-						UniquePtr->GetRef(Index) = FVoxelValue::Special();
+						Value = FVoxelValue::Special();
 					}
-					else
-					{
-						UniquePtr->GetRef(Index) = Value;
-					}
-				});
+				}
 
-				UniquePtr->TryCompressToSingleValue(*this);
-				ValuesPtr = UniquePtr.Get();
-				BuffersToDelete.Emplace(MoveTemp(UniquePtr));
+				Values->TryCompressToSingleValue(*this);
 			}
-		}
-		
-		Builder.AddChunk(Leaf.Position, *ValuesPtr, Leaf.Materials);
-	});
 
+			if (Progress)
+			{
+				Progress->NumLeavesDone.Increment();
+			}
+		});
+	}
+
+	const bool bCancelled = Progress && Progress->bCancel;
+	if (!bCancelled)
 	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Items");
-		
-		for (auto& Item : AssetItemsData.Items)
+		// Used for leaves that aren't dirty
+		const TVoxelDataOctreeLeafData<FVoxelValue> EmptyValues;
+		const TVoxelDataOctreeLeafData<FVoxelMaterial> EmptyMaterials;
+
+		for (auto& Snapshot : Snapshots)
 		{
-			Builder.AddAssetItem(Item->Item);
+			Builder.AddChunk(
+				Snapshot.Position,
+				Snapshot.Values.IsValid() ? *Snapshot.Values : EmptyValues,
+				Snapshot.Materials.IsValid() ? *Snapshot.Materials : EmptyMaterials);
 		}
-	}
 
-	Builder.Save(OutSave, OutObjects);
+		Builder.Save(OutSave, OutObjects);
+
+		if (Progress)
+		{
+			Progress->NumLeavesDone.Set(Snapshots.Num());
+		}
+	}
 	
 	VOXEL_ASYNC_SCOPE_COUNTER("ClearData");
-	for (auto& Buffer : BuffersToDelete)
+	for (auto& Snapshot : Snapshots)
 	{
 		// For correct memory reports
-		Buffer->ClearData(*this);
+		if (Snapshot.Values.IsValid())
+		{
+			Snapshot.Values->ClearData(*this);
+		}
+		if (Snapshot.Materials.IsValid())
+		{
+			Snapshot.Materials->ClearData(*this);
+		}
 	}
+
+	return !bCancelled;
 }
 
 bool FVoxelData::LoadFromSave(const FVoxelUncompressedWorldSaveImpl& Save, const FVoxelPlaceableItemLoadInfo& LoadInfo, TArray<FVoxelIntBox>* OutBoundsToUpdate)
@@ -743,7 +896,7 @@ bool FVoxelData::LoadFromSave(const FVoxelUncompressedWorldSaveImpl& Save, const
 			auto& Parent = Tree.AsParent();
 			if (OctreeBounds.Contains(CurrentPosition) && !Parent.HasChildren())
 			{
-				Parent.CreateChildren();
+				Parent.CreateChildren(LeafIndex);
 			}
 		}
 	});
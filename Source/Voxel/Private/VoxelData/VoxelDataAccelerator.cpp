@@ -8,10 +8,10 @@ static TAutoConsoleVariable<int32> CVarCacheSize(
 	8,
 	TEXT("Size of the data accelerator cache"),
 	ECVF_Default);
-static TAutoConsoleVariable<int32> CVarUseAcceleratorMap(
-	TEXT("voxel.data.DataAccelerator.UseMap"),
+static TAutoConsoleVariable<int32> CVarUseLeafIndex(
+	TEXT("voxel.data.DataAccelerator.UseLeafIndex"),
 	1,
-	TEXT("Whether to cache the leaves in a map"),
+	TEXT("Whether to find the leaves using the data leaf index on cache misses, instead of going down the octree"),
 	ECVF_Default);
 static TAutoConsoleVariable<int32> CVarShowStats(
 	TEXT("voxel.data.DataAccelerator.LogStats"),
@@ -23,9 +23,9 @@ int32 FVoxelDataAcceleratorParameters::GetDefaultCacheSize()
 {
 	return CVarCacheSize.GetValueOnAnyThread();
 }
-bool FVoxelDataAcceleratorParameters::GetUseAcceleratorMap()
+bool FVoxelDataAcceleratorParameters::GetUseLeafIndex()
 {
-	return CVarUseAcceleratorMap.GetValueOnAnyThread() != 0;
+	return CVarUseLeafIndex.GetValueOnAnyThread() != 0;
 }
 bool FVoxelDataAcceleratorParameters::GetShowStats()
 {
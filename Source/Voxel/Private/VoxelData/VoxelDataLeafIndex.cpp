@@ -0,0 +1,149 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelData/VoxelDataLeafIndex.h"
+#include "VoxelData/VoxelDataOctree.h"
+
+FVoxelDataLeafIndex::~FVoxelDataLeafIndex()
+{
+	Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDataLeafIndex::Add(FVoxelDataOctreeLeaf& Leaf)
+{
+	FScopeLock Lock(&WriteSection);
+
+	// Keep the load factor below 1/2, as the probe sequences get long quickly with linear probing
+	FTable* LocalTable = Table.Load();
+	if (!LocalTable || 2 * (Num + 1) > LocalTable->Capacity)
+	{
+		// Doesn't modify the current table: no need for BeginWrite
+		Grow();
+		LocalTable = Table.Load();
+	}
+
+	BeginWrite();
+	Insert(*LocalTable, Leaf.GetMin() / DATA_CHUNK_SIZE, &Leaf);
+	EndWrite();
+
+	Num++;
+}
+
+void FVoxelDataLeafIndex::Remove(FVoxelDataOctreeLeaf& Leaf)
+{
+	FScopeLock Lock(&WriteSection);
+
+	FTable& LocalTable = *Table.Load();
+	FSlot* const Slots = LocalTable.Slots;
+
+	const FIntVector Key = Leaf.GetMin() / DATA_CHUNK_SIZE;
+	const uint32 Mask = LocalTable.Capacity - 1;
+
+	uint32 Hole = GetHash(Key) & Mask;
+	while (Slots[Hole].Key != Key)
+	{
+		check(Slots[Hole].Leaf);
+		Hole = (Hole + 1) & Mask;
+	}
+	check(Slots[Hole].Leaf == &Leaf);
+
+	BeginWrite();
+	// Backward shift deletion: no tombstones, so lookups stay a single probe sequence
+	for (uint32 Index = (Hole + 1) & Mask; Slots[Index].Leaf; Index = (Index + 1) & Mask)
+	{
+		const uint32 Ideal = GetHash(Slots[Index].Key) & Mask;
+		// Can only be moved back if the hole is between its ideal slot and its current slot
+		if (((Index - Ideal) & Mask) >= ((Index - Hole) & Mask))
+		{
+			Slots[Hole] = Slots[Index];
+			Hole = Index;
+		}
+	}
+	Slots[Hole].Leaf = nullptr;
+	EndWrite();
+
+	Num--;
+}
+
+void FVoxelDataLeafIndex::Reset()
+{
+	FScopeLock Lock(&WriteSection);
+
+	BeginWrite();
+	FTable* const OldTable = Table.Exchange(nullptr);
+	EndWrite();
+
+	if (OldTable)
+	{
+		RetiredTables.Add(OldTable);
+	}
+	for (FTable* RetiredTable : RetiredTables)
+	{
+		FreeTable(RetiredTable);
+	}
+	RetiredTables.Empty();
+
+	Num = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelDataLeafIndex::FTable* FVoxelDataLeafIndex::AllocateTable(uint32 Capacity)
+{
+	const int64 Size = sizeof(FTable) + (Capacity - 1) * sizeof(FSlot);
+	FTable* NewTable = static_cast<FTable*>(FMemory::Malloc(Size));
+	FMemory::Memzero(NewTable, Size);
+	NewTable->Capacity = Capacity;
+	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataOctreesMemory, Size);
+	return NewTable;
+}
+
+void FVoxelDataLeafIndex::FreeTable(FTable* Table)
+{
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataOctreesMemory, sizeof(FTable) + (Table->Capacity - 1) * sizeof(FSlot));
+	FMemory::Free(Table);
+}
+
+void FVoxelDataLeafIndex::Insert(FTable& Table, const FIntVector& Key, FVoxelDataOctreeLeaf* Leaf)
+{
+	checkVoxelSlow(Leaf);
+
+	const uint32 Mask = Table.Capacity - 1;
+
+	uint32 Index = GetHash(Key) & Mask;
+	while (Table.Slots[Index].Leaf)
+	{
+		checkVoxelSlow(Table.Slots[Index].Key != Key);
+		Index = (Index + 1) & Mask;
+	}
+	Table.Slots[Index] = { Key, Leaf };
+}
+
+void FVoxelDataLeafIndex::Grow()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	FTable* const OldTable = Table.Load();
+	FTable* const NewTable = AllocateTable(OldTable ? 2 * OldTable->Capacity : 1024);
+
+	if (OldTable)
+	{
+		for (uint32 Index = 0; Index < OldTable->Capacity; Index++)
+		{
+			if (OldTable->Slots[Index].Leaf)
+			{
+				Insert(*NewTable, OldTable->Slots[Index].Key, OldTable->Slots[Index].Leaf);
+			}
+		}
+		// Lookups might still be reading it. Capacities double, so this is at most as big as the current table
+		RetiredTables.Add(OldTable);
+	}
+
+	// Publish the fully built table
+	Table.Store(NewTable);
+}
\ No newline at end of file
@@ -9,6 +9,7 @@ DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreesMemory);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelUndoRedoMemory);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelMultiplayerMemory);
 DEFINE_STAT(STAT_VoxelDataOctreesCount);
+DEFINE_STAT(STAT_VoxelDataLeafAllocationsAvoided);
 
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreeDirtyValuesMemory);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreeDirtyMaterialsMemory);
@@ -16,6 +17,8 @@ DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreeDirtyMaterialsMemory);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreeCachedValuesMemory);
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelDataOctreeCachedMaterialsMemory);
 
+const FVoxelPlaceableItemHolder FVoxelDataOctreeBase::EmptyItemHolder;
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -26,16 +29,16 @@ T FVoxelDataOctreeBase::GetFromGeneratorAndAssets(const FVoxelGeneratorInstance&
 	ensureThreadSafe(IsLockedForRead());
 	check(IsLeafOrHasNoChildren());
 	
-	const auto& Assets = ItemHolder->GetAssetItems();
+	const auto& Assets = GetItemHolder().GetAssetItems();
 	for (int32 Index = Assets.Num() - 1; Index >= 0; Index--)
 	{
 		auto& Asset = *Assets[Index];
 		if (Asset.Bounds.ContainsTemplate(X, Y, Z))
 		{
-			return Asset.Generator->Get_Transform<T>(Asset.LocalToWorld, X, Y, Z, LOD, FVoxelItemStack(*ItemHolder, Generator, Index));
+			return Asset.Generator->Get_Transform<T>(Asset.LocalToWorld, X, Y, Z, LOD, FVoxelItemStack(GetItemHolder(), Generator, Index));
 		}
 	}
-	return Generator.Get<T>(X, Y, Z, LOD, FVoxelItemStack(*ItemHolder));
+	return Generator.Get<T>(X, Y, Z, LOD, FVoxelItemStack(GetItemHolder()));
 }
 
 template VOXEL_API v_flt          FVoxelDataOctreeBase::GetFromGeneratorAndAssets<v_flt         , v_flt>(const FVoxelGeneratorInstance& Generator, v_flt X, v_flt Y, v_flt Z, int32 LOD) const;
@@ -49,12 +52,12 @@ void FVoxelDataOctreeBase::GetFromGeneratorAndAssets(const FVoxelGeneratorInstan
 	ensureThreadSafe(IsLockedForRead());
 	check(IsLeafOrHasNoChildren());
 	
-	const auto& Assets = ItemHolder->GetAssetItems();
+	const auto& Assets = GetItemHolder().GetAssetItems();
 
 	if (Assets.Num() == 0)
 	{
 		VOXEL_SLOW_SCOPE_COUNTER("Query Generator");
-		Generator.Get(QueryZone, LOD, FVoxelItemStack(*ItemHolder));
+		Generator.Get(QueryZone, LOD, FVoxelItemStack(GetItemHolder()));
 		return;
 	}
 
@@ -64,7 +67,7 @@ void FVoxelDataOctreeBase::GetFromGeneratorAndAssets(const FVoxelGeneratorInstan
 		if (QueryZone.Bounds.Contains(Asset.Bounds))
 		{
 			VOXEL_SLOW_SCOPE_COUNTER("Query Asset");
-			Asset.Generator->Get_Transform<T>(Asset.LocalToWorld, QueryZone, LOD, FVoxelItemStack(*ItemHolder, Generator, Index));
+			Asset.Generator->Get_Transform<T>(Asset.LocalToWorld, QueryZone, LOD, FVoxelItemStack(GetItemHolder(), Generator, Index));
 			return;
 		}
 		if (QueryZone.Bounds.Intersect(Asset.Bounds))
@@ -73,31 +76,8 @@ void FVoxelDataOctreeBase::GetFromGeneratorAndAssets(const FVoxelGeneratorInstan
 		}
 	}
 
-	VOXEL_SLOW_SCOPE_COUNTER("Individual Asset & Generator Queries");
-	for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
-	{
-		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
-		{
-			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
-			{
-				T Value;
-				for (int32 Index = Assets.Num() - 1; Index >= 0; Index--)
-				{
-					auto& Asset = *Assets[Index];
-					if (Asset.Bounds.Contains(X, Y, Z))
-					{
-						Value = Asset.Generator->Get_Transform<T>(Asset.LocalToWorld, X, Y, Z, LOD, FVoxelItemStack(*ItemHolder, Generator, Index));
-						break;
-					}
-					if (Index == 0)
-					{
-						Value = Generator.Get<T>(X, Y, Z, LOD, FVoxelItemStack(*ItemHolder));
-					}
-				}
-				QueryZone.Set(X, Y, Z, Value);
-			}
-		}
-	}
+	VOXEL_SLOW_SCOPE_COUNTER("Batched Asset & Generator Queries");
+	FVoxelItemStack(GetItemHolder(), Generator, Assets.Num() - 1).Get(QueryZone, LOD);
 }
 
 template VOXEL_API void FVoxelDataOctreeBase::GetFromGeneratorAndAssets<FVoxelValue   >(const FVoxelGeneratorInstance& Generator, TVoxelQueryZone<FVoxelValue   >& QueryZone, int32 LOD) const;
@@ -109,16 +89,16 @@ T FVoxelDataOctreeBase::GetCustomOutput(const FVoxelGeneratorInstance& Generator
 	ensureThreadSafe(IsLockedForRead());
 	check(IsLeafOrHasNoChildren());
 	
-	const auto& Assets = ItemHolder->GetAssetItems();
+	const auto& Assets = GetItemHolder().GetAssetItems();
 	for (int32 Index = Assets.Num() - 1; Index >= 0; Index--)
 	{
 		auto& Asset = *Assets[Index];
 		if (Asset.Bounds.ContainsTemplate(X, Y, Z))
 		{
-			return Asset.Generator->GetCustomOutput_Transform(Asset.LocalToWorld, DefaultValue, Name, X, Y, Z, LOD, FVoxelItemStack(*ItemHolder, Generator, Index));
+			return Asset.Generator->GetCustomOutput_Transform(Asset.LocalToWorld, DefaultValue, Name, X, Y, Z, LOD, FVoxelItemStack(GetItemHolder(), Generator, Index));
 		}
 	}
-	return Generator.GetCustomOutput<T>(DefaultValue, Name, X, Y, Z, LOD, FVoxelItemStack(*ItemHolder));
+	return Generator.GetCustomOutput<T>(DefaultValue, Name, X, Y, Z, LOD, FVoxelItemStack(GetItemHolder()));
 }
 
 template VOXEL_API v_flt FVoxelDataOctreeBase::GetCustomOutput<v_flt>(const FVoxelGeneratorInstance&, v_flt, FName, v_flt, v_flt, v_flt, int32) const;
@@ -128,7 +108,55 @@ template VOXEL_API int32 FVoxelDataOctreeBase::GetCustomOutput<int32>(const FVox
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-void FVoxelDataOctreeParent::CreateChildren()
+bool FVoxelDataOctreeUtilities::GetSingleValueFromRange(const FVoxelGeneratorInstance& Generator, const FVoxelIntBox& Bounds, const FVoxelItemStack& Items, FVoxelValue& OutValue)
+{
+	VOXEL_SLOW_FUNCTION_COUNTER();
+
+	const TVoxelRange<FVoxelValue> Range(Generator.GetValueRange(Bounds, 0, Items));
+	if (Range.Min != Range.Max)
+	{
+		return false;
+	}
+	OutValue = Range.Min;
+	return true;
+}
+
+template<typename T>
+void FVoxelDataOctreeLeaf::CreateDataFromGenerator(const IVoxelData& Data)
+{
+	VOXEL_SLOW_FUNCTION_COUNTER();
+	ensureThreadSafe(IsLockedForWrite());
+
+	auto& DataHolder = GetData<T>();
+	check(!DataHolder.HasData());
+
+	// Assets aren't part of the generator range
+	if (GetItemHolder().GetAssetItems().Num() == 0)
+	{
+		T SingleValue;
+		if (FVoxelDataOctreeUtilities::GetSingleValueFromRange(*Data.Generator, GetBounds(), FVoxelItemStack(GetItemHolder()), SingleValue))
+		{
+			DataHolder.SetSingleValue(SingleValue);
+			INC_DWORD_STAT(STAT_VoxelDataLeafAllocationsAvoided);
+			return;
+		}
+	}
+
+	CreateDataFromGeneratorForWrite<T>(Data);
+
+	// The range is often too conservative, eg for noise far above the surface: check the actual output
+	// Not counted in STAT_VoxelDataLeafAllocationsAvoided, as the data was allocated
+	DataHolder.TryCompressToSingleValue(Data);
+}
+
+template VOXEL_API void FVoxelDataOctreeLeaf::CreateDataFromGenerator<FVoxelValue   >(const IVoxelData&);
+template VOXEL_API void FVoxelDataOctreeLeaf::CreateDataFromGenerator<FVoxelMaterial>(const IVoxelData&);
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDataOctreeParent::CreateChildren(FVoxelDataLeafIndex& LeafIndex)
 {
 	TVoxelOctreeParent::CreateChildren();
 
@@ -139,7 +167,7 @@ void FVoxelDataOctreeParent::CreateChildren()
 	}
 #endif
 
-	if (ItemHolder->NumItems() > 0)
+	if (ItemHolder.IsValid() && ItemHolder->NumItems() > 0)
 	{
 		for (auto& Child : AsParent().GetChildren())
 		{
@@ -148,19 +176,44 @@ void FVoxelDataOctreeParent::CreateChildren()
 			{
 				if (Item.Bounds.Intersect(ChildBounds))
 				{
-					Child.ItemHolder->AddItem(Item);
+					Child.GetOrCreateItemHolder().AddItem(Item);
 				}
 			});
 		}
 	}
-	ItemHolder.Reset();
+	ResetItemHolder();
+
+	if (Height == 1)
+	{
+		for (auto& Child : AsParent().GetChildren())
+		{
+			LeafIndex.Add(Child.AsLeaf());
+		}
+	}
 }
 
-void FVoxelDataOctreeParent::DestroyChildren()
+void FVoxelDataOctreeParent::DestroyChildren(FVoxelDataLeafIndex& LeafIndex)
 {
+	if (Height == 1)
+	{
+		for (auto& Child : AsParent().GetChildren())
+		{
+			LeafIndex.Remove(Child.AsLeaf());
+		}
+	}
+	else
+	{
+		// The base class would destroy the grandchildren without removing their leaves
+		for (auto& Child : AsParent().GetChildren())
+		{
+			if (Child.AsParent().HasChildren())
+			{
+				Child.AsParent().DestroyChildren(LeafIndex);
+			}
+		}
+	}
+
 	TVoxelOctreeParent::DestroyChildren();
 
 	check(!ItemHolder.IsValid());
-	// Always valid on a node with no children
-	ItemHolder = MakeUnique<FVoxelPlaceableItemHolder>();
 }
\ No newline at end of file
@@ -92,12 +92,7 @@ void FVoxelDataOctreeLeafUndoRedo::UndoRedo(const IVoxelData& Data, FVoxelDataOc
 		if (!DataHolder.HasData())
 		{
 			// Data was reverted to generator value
-			
-			DataHolder.CreateData(Data, [&](T* RESTRICT DataPtr)
-			{
-				TVoxelQueryZone<T> QueryZone(Leaf.GetBounds(), DataPtr);
-				Leaf.GetFromGeneratorAndAssets(*Data.Generator, QueryZone, 0);
-			});
+			Leaf.CreateDataFromGeneratorForWrite<T>(Data);
 		}
 		DataHolder.PrepareForWrite(Data);
 
@@ -114,6 +114,36 @@ void FVoxelSaveBuilder::Save(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FV
 					}
 				}
 			}
+			else if (Chunk.Materials->Palette_DataPtr)
+			{
+				const FVoxelMaterial* RESTRICT const Palette = Chunk.Materials->Palette_GetMaterials();
+				const int32 PaletteNum = Chunk.Materials->Palette_Num;
+				
+				for (int32 Channel = 0; Channel < FVoxelMaterial::NumChannels; Channel++)
+				{
+					bool bIsSingleValue = true;
+					for (int32 PaletteIndex = 1; PaletteIndex < PaletteNum; PaletteIndex++)
+					{
+						bIsSingleValue &= Palette[PaletteIndex].GetRaw(Channel) == Palette[0].GetRaw(Channel);
+					}
+					
+					if (bIsSingleValue)
+					{
+						// Channels that are the same in the whole palette can be saved as single values
+						MaterialIndices.GetRaw(Channel) = OutSave.SingleMaterials64.Add(Palette[0].GetRaw(Channel));
+						MaterialIndices.GetRaw(Channel) |= FVoxelUncompressedWorldSaveImpl::MaterialIndexSingleValueFlag;
+					}
+					else
+					{
+						const int32 BufferIndex = OutSave.MaterialBuffers64.AddUninitialized(VOXELS_PER_DATA_CHUNK);
+						for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+						{
+							OutSave.MaterialBuffers64[BufferIndex + Index] = Chunk.Materials->GetFromPalette(Index).GetRaw(Channel);
+						}
+						MaterialIndices.GetRaw(Channel) = BufferIndex;
+					}
+				}
+			}
 			else
 			{
 				check(Chunk.Materials->Main_DataPtr);
@@ -14,11 +14,13 @@
 #include "VoxelWorld.h"
 #include "IVoxelPool.h"
 #include "VoxelThreadPool.h"
+#include "VoxelLatencyStats.h"
 
 #include "Engine/Engine.h"
 #include "EngineUtils.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
+#include "Misc/Paths.h"
 
 static TAutoConsoleVariable<int32> CVarShowUpdatedChunks(
 	TEXT("voxel.renderer.ShowUpdatedChunks"),
@@ -306,6 +308,35 @@ static FAutoConsoleCommand CmdLogThreadPoolStats(
     TEXT(""),
 	FConsoleCommandDelegate::CreateLambda([](){ FVoxelQueuedThreadPoolStats::Get().LogTimes(); }));
 
+static FAutoConsoleCommand CmdLogLatencyStats(
+    TEXT("voxel.threading.LogLatencyStats"),
+    TEXT("Log the queue wait & execution time percentiles of each task type, and the chunks request to mesh latency"),
+	FConsoleCommandDelegate::CreateLambda([](){ FVoxelLatencyStats::Get().LogStats(); }));
+
+static FAutoConsoleCommand CmdResetLatencyStats(
+    TEXT("voxel.threading.ResetLatencyStats"),
+    TEXT(""),
+	FConsoleCommandDelegate::CreateLambda([](){ FVoxelLatencyStats::Get().Reset(); }));
+
+static FAutoConsoleCommand CmdStartTrace(
+    TEXT("voxel.threading.StartTrace"),
+    TEXT("Start recording the voxel tasks. Optional argument: max number of tasks to record, default 1000000"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FVoxelTraceCapture::Get().Start(Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000000);
+	}));
+
+static FAutoConsoleCommand CmdStopTrace(
+    TEXT("voxel.threading.StopTrace"),
+    TEXT("Stop recording the voxel tasks and save them as a Chrome trace json. Optional argument: file path, default Saved/Profiling/Voxel/VoxelTrace-Date.json"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Path = Args.Num() > 0
+			? Args[0]
+			: FPaths::ProfilingDir() / TEXT("Voxel") / FString::Printf(TEXT("VoxelTrace-%s.json"), *FDateTime::Now().ToString());
+		FVoxelTraceCapture::Get().StopAndSave(Path);
+	}));
+
 static FAutoConsoleCommand CmdLogMemoryStats(
     TEXT("voxel.LogMemoryStats"),
     TEXT(""),
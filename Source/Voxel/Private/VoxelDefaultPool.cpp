@@ -55,11 +55,16 @@ TVoxelSharedRef<FVoxelDefaultPool> FVoxelDefaultPool::Create(
 
 void FVoxelDefaultPool::QueueTask(EVoxelTaskType Type, IVoxelQueuedWork* Task)
 {
+	Task->TaskType = Type;
 	Pool->AddQueuedWork(Task, PriorityCategories[uint8(Type)], PriorityOffsets[uint8(Type)]);
 }
 
 void FVoxelDefaultPool::QueueTasks(EVoxelTaskType Type, const TArray<IVoxelQueuedWork*>& Tasks)
 {
+	for (IVoxelQueuedWork* Task : Tasks)
+	{
+		Task->TaskType = Type;
+	}
 	Pool->AddQueuedWorks(Tasks, PriorityCategories[uint8(Type)], PriorityOffsets[uint8(Type)]);
 }
 
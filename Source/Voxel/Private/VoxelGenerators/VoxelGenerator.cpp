@@ -9,6 +9,11 @@
 #include "UObject/Package.h"
 #include "UObject/MetaData.h"
 #include "UObject/PropertyPortFlags.h"
+#include "UObject/UObjectHash.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "Modules/ModuleManager.h"
 
 void UVoxelGenerator::ApplyParameters(const TMap<FName, FString>& Parameters)
 {
@@ -88,6 +93,158 @@ TVoxelSharedRef<FVoxelGeneratorInstance> UVoxelGenerator::GetInstance()
 	return TVoxelSharedPtr<FVoxelGeneratorInstance>().ToSharedRef();
 }
 
+uint64 UVoxelGenerator::GetGeneratorHash(const TMap<FName, FString>& Parameters) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Generators can reference each other through generator pickers
+	static thread_local TArray<const UVoxelGenerator*> GeneratorsBeingHashed;
+	GeneratorsBeingHashed.Add(this);
+
+	FString String = GetClass()->GetPathName();
+	String += TEXT("|");
+	String += GetNativeCodeVersion(GetClass());
+
+	bool bCanHash = true;
+	TSet<const UObject*> HashedObjects;
+	TFunction<void(const UObject&)> AddObject;
+	
+	const auto AddGenerator = [&](const UVoxelGenerator& Generator)
+	{
+		String += TEXT("|");
+		if (GeneratorsBeingHashed.Contains(&Generator))
+		{
+			String += Generator.GetPathName();
+			return;
+		}
+		
+		const uint64 Hash = Generator.GetGeneratorHash({});
+		bCanHash &= Hash != 0;
+		String += FString::Printf(TEXT("%016llx"), Hash);
+	};
+	const auto AddReference = [&](const UObject* Object)
+	{
+		if (!Object)
+		{
+			return;
+		}
+		
+		if (const UClass* Class = Cast<UClass>(Object))
+		{
+			// Eg C++ generators picked by class
+			if (Class->IsChildOf(UVoxelGenerator::StaticClass()) && !Class->HasAnyClassFlags(CLASS_Abstract))
+			{
+				AddGenerator(*Class->GetDefaultObject<UVoxelGenerator>());
+			}
+			return;
+		}
+		if (const UVoxelGenerator* Generator = Cast<UVoxelGenerator>(Object))
+		{
+			// Eg generator pickers of graph nodes. Their own hash includes data that isn't in properties, eg heightmaps
+			AddGenerator(*Generator);
+			return;
+		}
+		if (Object->IsA<UField>())
+		{
+			// Enums, structs...
+			return;
+		}
+
+		// Eg curves
+		AddObject(*Object);
+	};
+	
+	AddObject = [&](const UObject& Object)
+	{
+		bool bIsInSet = false;
+		HashedObjects.Add(&Object, &bIsInSet);
+		if (bIsInSet)
+		{
+			return;
+		}
+		
+		String += TEXT("|");
+		String += Object.GetPathName();
+		for (TFieldIterator<FProperty> It(Object.GetClass()); It; ++It)
+		{
+			auto* Property = *It;
+			if (Property->HasAnyPropertyFlags(CPF_Transient))
+			{
+				continue;
+			}
+			for (int32 Index = 0; Index < Property->ArrayDim; Index++)
+			{
+				String += TEXT("|");
+				String += Property->GetName();
+				String += TEXT("=");
+				Property->ExportTextItem(String, Property->ContainerPtrToValuePtr<void>(&Object, Index), nullptr, nullptr, PPF_None);
+			}
+		}
+
+		// The exported text only has the path of the referenced objects, not their content
+		for (TPropertyValueIterator<FObjectProperty> It(Object.GetClass(), &Object); It; ++It)
+		{
+			if (!It.Key()->HasAnyPropertyFlags(CPF_Transient))
+			{
+				AddReference(It.Key()->GetObjectPropertyValue(It.Value()));
+			}
+		}
+
+		// Graphs store their nodes as subobjects
+		TArray<UObject*> Subobjects;
+		GetObjectsWithOuter(&Object, Subobjects, false);
+		Subobjects.Sort([](const UObject& A, const UObject& B) { return A.GetPathName() < B.GetPathName(); });
+		for (auto* Subobject : Subobjects)
+		{
+			AddObject(*Subobject);
+		}
+	};
+
+	AddObject(*this);
+
+	TArray<FName> Names;
+	Parameters.GetKeys(Names);
+	Names.Sort(FNameLexicalLess());
+	for (auto& Name : Names)
+	{
+		String += TEXT("|");
+		String += Name.ToString();
+		String += TEXT("=");
+		String += Parameters[Name];
+	}
+
+	check(GeneratorsBeingHashed.Last() == this);
+	GeneratorsBeingHashed.Pop();
+
+	if (!bCanHash)
+	{
+		return 0;
+	}
+	return CityHash64(reinterpret_cast<const char*>(*String), String.Len() * sizeof(TCHAR));
+}
+
+FString UVoxelGenerator::GetNativeCodeVersion(const UClass* Class)
+{
+	while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+	{
+		Class = Class->GetSuperClass();
+	}
+	if (!Class)
+	{
+		return {};
+	}
+
+	// Native classes are in /Script/ModuleName
+	const FName ModuleName = FPackageName::GetShortFName(Class->GetOutermost()->GetFName());
+	FString Filename = FModuleManager::Get().GetModuleFilename(ModuleName);
+	if (Filename.IsEmpty())
+	{
+		// Monolithic builds
+		Filename = FPlatformProcess::ExecutablePath();
+	}
+	return IFileManager::Get().GetTimeStamp(*Filename).ToString();
+}
+
 TMap<FName, FString> UVoxelGenerator::ApplyParametersInternal(const TMap<FName, FString>& Parameters)
 {
 	TMap<FName, FString> ParametersBackup;
@@ -0,0 +1,271 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelLatencyStats.h"
+#include "IVoxelPool.h"
+
+#include "HAL/PlatformTLS.h"
+#include "Misc/FileHelper.h"
+
+void FVoxelLatencyHistogram::Add(double Seconds)
+{
+	const int64 Microseconds = int64(FMath::Clamp(Seconds * 1e6, 0., double(MAX_int64 / 2)));
+
+	FPlatformAtomics::InterlockedIncrement(&Buckets[GetBucket(Microseconds)]);
+	FPlatformAtomics::InterlockedAdd(&TotalMicroseconds, Microseconds);
+
+	int64 Max = FPlatformAtomics::AtomicRead(&MaxMicroseconds);
+	while (Microseconds > Max)
+	{
+		const int64 PreviousMax = FPlatformAtomics::InterlockedCompareExchange(&MaxMicroseconds, Microseconds, Max);
+		if (PreviousMax == Max)
+		{
+			break;
+		}
+		Max = PreviousMax;
+	}
+}
+
+void FVoxelLatencyHistogram::Reset()
+{
+	for (int64& Bucket : Buckets)
+	{
+		FPlatformAtomics::InterlockedExchange(&Bucket, 0);
+	}
+	FPlatformAtomics::InterlockedExchange(&TotalMicroseconds, 0);
+	FPlatformAtomics::InterlockedExchange(&MaxMicroseconds, 0);
+}
+
+int64 FVoxelLatencyHistogram::GetNum() const
+{
+	int64 Num = 0;
+	for (const int64& Bucket : Buckets)
+	{
+		Num += FPlatformAtomics::AtomicRead(&Bucket);
+	}
+	return Num;
+}
+
+double FVoxelLatencyHistogram::GetPercentile(double Percentile) const
+{
+	// Take a copy, as other threads might be adding values
+	int64 LocalBuckets[NumBuckets];
+	int64 Num = 0;
+	for (int32 Index = 0; Index < NumBuckets; Index++)
+	{
+		LocalBuckets[Index] = FPlatformAtomics::AtomicRead(&Buckets[Index]);
+		Num += LocalBuckets[Index];
+	}
+	if (Num == 0)
+	{
+		return 0;
+	}
+
+	const int64 Rank = FMath::Clamp<int64>(FMath::CeilToDouble(Percentile * Num), 1, Num);
+
+	int64 Count = 0;
+	for (int32 Index = 0; Index < NumBuckets; Index++)
+	{
+		Count += LocalBuckets[Index];
+		if (Count >= Rank)
+		{
+			// The last bucket has no upper bound
+			return Index == NumBuckets - 1 ? GetMax() : GetBucketUpperBound(Index) / 1e6;
+		}
+	}
+	checkVoxelSlow(false);
+	return GetMax();
+}
+
+double FVoxelLatencyHistogram::GetMax() const
+{
+	return FPlatformAtomics::AtomicRead(&MaxMicroseconds) / 1e6;
+}
+
+double FVoxelLatencyHistogram::GetAverage() const
+{
+	const int64 Num = GetNum();
+	return Num > 0 ? FPlatformAtomics::AtomicRead(&TotalMicroseconds) / 1e6 / Num : 0.;
+}
+
+FString FVoxelLatencyHistogram::ToString() const
+{
+	return FString::Printf(
+		TEXT("%lld samples, average %.3fms, p50 %.3fms, p95 %.3fms, p99 %.3fms, max %.3fms"),
+		GetNum(),
+		GetAverage() * 1000,
+		GetPercentile(0.50) * 1000,
+		GetPercentile(0.95) * 1000,
+		GetPercentile(0.99) * 1000,
+		GetMax() * 1000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static_assert(int32(EVoxelTaskType::RenderOctree) + 1 == FVoxelLatencyStats::NumTaskTypes, "Update NumTaskTypes");
+
+FVoxelLatencyStats& FVoxelLatencyStats::Get()
+{
+	// Never destroyed, as tasks might still be running on exit
+	static FVoxelLatencyStats* Stats = new FVoxelLatencyStats();
+	return *Stats;
+}
+
+void FVoxelLatencyStats::ReportTask(EVoxelTaskType Type, double QueueWaitTime, double ExecutionTime)
+{
+	const int32 Index = FMath::Min<int32>(int32(Type), NumTaskTypes - 1);
+	QueueWait[Index].Add(QueueWaitTime);
+	Execution[Index].Add(ExecutionTime);
+}
+
+void FVoxelLatencyStats::ReportChunkLatency(double Time)
+{
+	ChunkLatency.Add(Time);
+}
+
+void FVoxelLatencyStats::LogStats() const
+{
+	LOG_VOXEL(Log, TEXT("#############################################"));
+	LOG_VOXEL(Log, TEXT("########## Voxel Latency Stats ##############"));
+	LOG_VOXEL(Log, TEXT("#############################################"));
+	for (int32 Index = 0; Index < NumTaskTypes; Index++)
+	{
+		if (Execution[Index].GetNum() == 0)
+		{
+			continue;
+		}
+
+		const FString Name = StaticEnum<EVoxelTaskType>()->GetNameStringByValue(Index);
+		LOG_VOXEL(Log, TEXT("%s queue wait: %s"), *Name, *QueueWait[Index].ToString());
+		LOG_VOXEL(Log, TEXT("%s execution: %s"), *Name, *Execution[Index].ToString());
+	}
+	LOG_VOXEL(Log, TEXT("Chunks request to mesh: %s"), *ChunkLatency.ToString());
+}
+
+void FVoxelLatencyStats::Reset()
+{
+	for (int32 Index = 0; Index < NumTaskTypes; Index++)
+	{
+		QueueWait[Index].Reset();
+		Execution[Index].Reset();
+	}
+	ChunkLatency.Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelTraceCapture& FVoxelTraceCapture::Get()
+{
+	static FVoxelTraceCapture* Capture = new FVoxelTraceCapture();
+	return *Capture;
+}
+
+void FVoxelTraceCapture::AddTask(FName Name, EVoxelTaskType Type, uint64 QueuedCycles, uint64 StartCycles, uint64 EndCycles)
+{
+	// NumWriters makes sure Events isn't freed while we're writing to it
+	FPlatformAtomics::InterlockedIncrement(&NumWriters);
+	if (IsCapturing())
+	{
+		// Stop incrementing once the buffer is full, so that NumEvents can't wrap around on long captures
+		// Concurrent writers can still push it past the capacity by at most the number of threads
+		const int32 Index = FPlatformAtomics::AtomicRead(&NumEvents) < Events.Num() ? FPlatformAtomics::InterlockedIncrement(&NumEvents) - 1 : -1;
+		if (0 <= Index && Index < Events.Num())
+		{
+			Events.GetData()[Index] = { Name, Type, FPlatformTLS::GetCurrentThreadId(), QueuedCycles, StartCycles, EndCycles };
+		}
+		else
+		{
+			FPlatformAtomics::InterlockedIncrement(&NumDropped);
+		}
+	}
+	FPlatformAtomics::InterlockedDecrement(&NumWriters);
+}
+
+void FVoxelTraceCapture::Start(int32 MaxEvents)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	if (IsCapturing())
+	{
+		LOG_VOXEL(Warning, TEXT("Voxel trace capture already started"));
+		return;
+	}
+	ensure(FPlatformAtomics::AtomicRead(&NumWriters) == 0);
+
+	Events.Empty(MaxEvents);
+	Events.SetNumUninitialized(MaxEvents);
+	CaptureStartCycles = FPlatformTime::Cycles64();
+	NumEvents = 0;
+	NumDropped = 0;
+
+	FPlatformAtomics::InterlockedExchange(&bCapturing, 1);
+
+	LOG_VOXEL(Log, TEXT("Voxel trace capture started, recording up to %d tasks"), MaxEvents);
+}
+
+bool FVoxelTraceCapture::StopAndSave(const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	if (!IsCapturing())
+	{
+		LOG_VOXEL(Warning, TEXT("Voxel trace capture not started"));
+		return false;
+	}
+
+	FPlatformAtomics::InterlockedExchange(&bCapturing, 0);
+	while (FPlatformAtomics::AtomicRead(&NumWriters) != 0)
+	{
+		FPlatformProcess::Yield();
+	}
+
+	const int32 NumWritten = FMath::Min(NumEvents, Events.Num());
+	const double SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+	const auto ToMicroseconds = [&](uint64 Cycles)
+	{
+		return (int64(Cycles) - int64(CaptureStartCycles)) * SecondsPerCycle * 1e6;
+	};
+
+	FString Json;
+	Json.Reserve(NumWritten * 200);
+	Json += TEXT("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (int32 Index = 0; Index < NumWritten; Index++)
+	{
+		const FEvent& Event = Events[Index];
+		const double Start = ToMicroseconds(Event.StartCycles);
+		const double End = ToMicroseconds(Event.EndCycles);
+		const double QueueWait = Event.QueuedCycles != 0 ? Start - ToMicroseconds(Event.QueuedCycles) : 0.;
+
+		Json += FString::Printf(
+			TEXT("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"queue_wait_us\":%.3f}}%s\n"),
+			*Event.Name.ToString(),
+			*StaticEnum<EVoxelTaskType>()->GetNameStringByValue(int64(Event.Type)),
+			Event.ThreadId,
+			Start,
+			End - Start,
+			QueueWait,
+			Index == NumWritten - 1 ? TEXT("") : TEXT(","));
+	}
+	Json += TEXT("]}\n");
+
+	Events.Empty();
+
+	if (NumDropped > 0)
+	{
+		LOG_VOXEL(Warning, TEXT("Voxel trace capture: %lld tasks were dropped, increase MaxEvents"), NumDropped);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Json, *Path))
+	{
+		LOG_VOXEL(Error, TEXT("Failed to write voxel trace to %s"), *Path);
+		return false;
+	}
+
+	LOG_VOXEL(Log, TEXT("Voxel trace with %d tasks saved to %s"), NumWritten, *Path);
+	return true;
+}
\ No newline at end of file
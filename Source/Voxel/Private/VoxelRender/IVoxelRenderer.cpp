@@ -4,6 +4,7 @@
 #include "VoxelRender/VoxelProceduralMeshComponent.h"
 #include "VoxelRender/MaterialCollections/VoxelMaterialCollectionBase.h"
 #include "VoxelRender/VoxelMaterialIndices.h"
+#include "VoxelRender/VoxelMeshDiskCache.h"
 #include "VoxelData/VoxelData.h"
 #include "VoxelMessages.h"
 #include "VoxelPriorityHandler.h"
@@ -43,6 +44,8 @@ FVoxelRendererSettingsBase::FVoxelRendererSettingsBase(
 	, CollisionTraceFlag(InWorld->CollisionTraceFlag)
 	, NumConvexHullsPerAxis(InWorld->NumConvexHullsPerAxis)
 	, bCleanCollisionMeshes(InWorld->bCleanCollisionMeshes)
+	, CollisionDecimationMinLOD(InWorld->bEnableCollisionDecimation ? InWorld->CollisionDecimationMinLOD : MAX_int32)
+	, CollisionDecimationMaxError(FMath::Max(0.f, InWorld->CollisionDecimationMaxError))
 
 	, RenderType(InWorld->RenderType)
 	, RenderSharpness(FMath::Max(0, InWorld->RenderSharpness))
@@ -53,6 +56,9 @@ FVoxelRendererSettingsBase::FVoxelRendererSettingsBase(
 	, ChunksDitheringDuration(InWorld->ChunksDitheringDuration)
 
 	, bOptimizeIndices(InWorld->bOptimizeIndices)
+	, bQuantizeMeshVertices(InWorld->bQuantizeMeshVertices)
+	, MeshDecimationMinLOD(InWorld->bEnableMeshDecimation && InWorld->RenderType != EVoxelRenderType::Cubic ? InWorld->MeshDecimationMinLOD : MAX_int32)
+	, MeshDecimationMaxError(FMath::Max(0.f, InWorld->MeshDecimationMaxError))
 
 	, MaxDistanceFieldLOD(InWorld->bGenerateDistanceFields ? InWorld->MaxDistanceFieldLOD : -1)
 	, DistanceFieldBoundsExtension(InWorld->DistanceFieldBoundsExtension)
@@ -107,6 +113,9 @@ FVoxelRendererSettings::FVoxelRendererSettings(
 	, ToolRenderingManager(ToolRenderingManager)
 	, TexturePool(TexturePool)
 	, DebugManager(DebugManager)
+	, MeshDiskCache(PlayType == EVoxelPlayType::Game && World->bEnableMeshDiskCache && !bUseDataSettings
+		? FVoxelMeshDiskCache::Create(*this, *Data)
+		: nullptr)
 {
 
 }
@@ -117,13 +126,13 @@ IVoxelRenderer::IVoxelRenderer(const FVoxelRendererSettings& Settings)
 {
 }
 
-void IVoxelRenderer::SetInvokersPositionsForPriorities(const TArray<FIntVector>& NewInvokersPositionsForPriorities)
+void IVoxelRenderer::SetInvokersPositionsForPriorities(const TArray<FIntVector>& NewInvokersPositionsForPriorities, const TArray<FIntVector>& PrefetchOffsets)
 {
 	while (InvokersPositionsForPriorities->GetMax() < NewInvokersPositionsForPriorities.Num())
 	{
 		InvokersPositionsForPriorities = MakeVoxelShared<FInvokerPositionsArray>(2 * InvokersPositionsForPriorities->GetMax());
 	}
-	InvokersPositionsForPriorities->Set(NewInvokersPositionsForPriorities);
+	InvokersPositionsForPriorities->Set(NewInvokersPositionsForPriorities, PrefetchOffsets);
 }
 
 inline UObject* GetRootOwner(const TWeakObjectPtr<UPrimitiveComponent>& RootComponent)
@@ -0,0 +1,472 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/LODManager/VoxelClipmapLODManager.h"
+#include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelComponents/VoxelInvokerComponent.h"
+#include "VoxelUtilities/VoxelMathUtilities.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
+#include "VoxelWorldInterface.h"
+#include "VoxelDirection.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Clipmap Chunk Updates"), STAT_VoxelClipmapChunkUpdates, STATGROUP_VoxelCounters);
+
+inline int32 GetClipmapMaxRingLOD(int32 RingRadius)
+{
+	int32 LOD = 0;
+	while (LOD < 30 && (int64(RENDER_CHUNK_SIZE) << (LOD + 1)) * (RingRadius + 2) < MAX_int32 / 2)
+	{
+		LOD++;
+	}
+	return LOD;
+}
+
+FVoxelClipmapRings::FVoxelClipmapRings(int32 RingRadius)
+	: RingRadius(FMath::Max(MinRingRadius, FMath::DivideAndRoundUp(RingRadius, 2) * 2))
+	, MaxRingLOD(GetClipmapMaxRingLOD(this->RingRadius))
+{
+	Rings.SetNum(MaxRingLOD + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelIntBox FVoxelClipmapRings::GetRingBounds(int32 LOD, const FIntVector& Position) const
+{
+	const int32 ChunkSize = GetChunkSize(LOD);
+	// Snap to the next LOD chunks, so that this cube is exactly a hole in the next ring
+	const FIntVector Center = FVoxelUtilities::DivideFloor(Position, 2 * ChunkSize) * (2 * ChunkSize);
+	return FVoxelIntBox(Center - RingRadius * ChunkSize, Center + RingRadius * ChunkSize);
+}
+
+FVoxelChunkSettings FVoxelClipmapRings::GetChunkSettings(const FSettings& Settings, int32 LOD, const FIntVector& ChunkPosition, const FRing& Ring, bool bHasOuterRing)
+{
+	FVoxelChunkSettings ChunkSettings{};
+
+	const int32 ChunkSize = GetChunkSize(LOD);
+	const auto IsInWorld = [&](const FIntVector& Position)
+	{
+		return Settings.WorldBounds.Intersect(FVoxelIntBox(Position, Position + ChunkSize));
+	};
+	const auto IsInInnerRings = [&](const FIntVector& Position)
+	{
+		return Ring.InnerBounds.IsValid() && Ring.InnerBounds.Contains(Position);
+	};
+
+	if (!Ring.Bounds.Contains(ChunkPosition) || IsInInnerRings(ChunkPosition) || !IsInWorld(ChunkPosition))
+	{
+		return ChunkSettings;
+	}
+
+	ChunkSettings.bVisible = Settings.bEnableRender;
+	ChunkSettings.bEnableCollisions = Settings.bEnableCollisions && LOD <= Settings.CollisionsMaxLOD;
+	ChunkSettings.bEnableNavmesh = Settings.bEnableNavmesh && LOD <= Settings.NavmeshMaxLOD;
+
+	if (ChunkSettings.bVisible && Settings.bEnableTransitions)
+	{
+		for (int32 DirectionIndex = 0; DirectionIndex < 6; DirectionIndex++)
+		{
+			FIntVector Offset(0);
+			Offset[DirectionIndex / 2] = DirectionIndex % 2 == 0 ? -ChunkSize : ChunkSize;
+
+			const FIntVector AdjacentPosition = ChunkPosition + Offset;
+			if (!IsInWorld(AdjacentPosition))
+			{
+				continue;
+			}
+
+			// The cubes are inside each other with a margin of a chunk, so adjacent chunks are at most one LOD apart
+			const bool bAdjacentIsFiner = IsInInnerRings(AdjacentPosition);
+			const bool bAdjacentIsCoarser = !Ring.Bounds.Contains(AdjacentPosition) && bHasOuterRing;
+			if (Settings.bInvertTransitions ? bAdjacentIsCoarser : bAdjacentIsFiner)
+			{
+				ChunkSettings.TransitionsMask |= EVoxelDirectionFlag::Type(1 << DirectionIndex);
+			}
+		}
+	}
+
+	return ChunkSettings;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelClipmapRings::Update(const FSettings& Settings, int32 MinLOD, int32 MaxLOD, const FIntVector& Position, bool bForce, TArray<FVoxelChunkUpdate>& OutChunkUpdates)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(0 <= MinLOD && MinLOD <= MaxLOD && MaxLOD <= MaxRingLOD);
+
+	// Compute all the cubes first: the outer rings need the new inner cubes
+	TArray<FVoxelIntBox, TInlineAllocator<32>> NewBounds;
+	NewBounds.SetNum(Rings.Num());
+	for (int32 LOD = MinLOD; LOD <= MaxLOD; LOD++)
+	{
+		NewBounds[LOD] = GetRingBounds(LOD, Position);
+	}
+
+	// Chunks removed by this update, so that the chunks replacing them can dither them out
+	TArray<TMap<FIntVector, uint64>, TInlineAllocator<32>> RemovedChunks;
+	RemovedChunks.SetNum(Rings.Num());
+
+	struct FAddedChunk
+	{
+		int32 LOD;
+		FIntVector Position;
+		int32 ChunkUpdateIndex;
+	};
+	TArray<FAddedChunk> AddedChunks;
+
+	for (int32 LOD = 0; LOD < Rings.Num(); LOD++)
+	{
+		FRing& Ring = Rings[LOD];
+		const FVoxelIntBox NewRingBounds = NewBounds[LOD];
+		const FVoxelIntBox NewInnerBounds = LOD > 0 ? NewBounds[LOD - 1] : FVoxelIntBox();
+
+		if (!bForce && Ring.Bounds == NewRingBounds && Ring.InnerBounds == NewInnerBounds)
+		{
+			continue;
+		}
+
+		const int32 ChunkSize = GetChunkSize(LOD);
+
+		// Chunks that might have changed: the strips between the old & new cubes
+		TSet<FIntVector> ChunksToCheck;
+		if (bForce)
+		{
+			for (auto& It : Ring.Chunks)
+			{
+				ChunksToCheck.Add(It.Key);
+			}
+			if (NewRingBounds.IsValid())
+			{
+				NewRingBounds.Iterate(ChunkSize, [&](int32 X, int32 Y, int32 Z) { ChunksToCheck.Add(FIntVector(X, Y, Z)); });
+			}
+		}
+		else
+		{
+			const auto AddDifference = [&](const FVoxelIntBox& A, const FVoxelIntBox& B)
+			{
+				if (!A.IsValid())
+				{
+					return;
+				}
+
+				const auto AddBox = [&](const FVoxelIntBox& Box)
+				{
+					// Extend by a chunk as the neighbors transitions might have changed
+					Box.Extend(ChunkSize).Iterate(ChunkSize, [&](int32 X, int32 Y, int32 Z) { ChunksToCheck.Add(FIntVector(X, Y, Z)); });
+				};
+
+				if (!B.IsValid())
+				{
+					AddBox(A);
+					return;
+				}
+				for (const FVoxelIntBox& Box : A.Difference(B))
+				{
+					AddBox(Box);
+				}
+			};
+			AddDifference(Ring.Bounds, NewRingBounds);
+			AddDifference(NewRingBounds, Ring.Bounds);
+			AddDifference(Ring.InnerBounds, NewInnerBounds);
+			AddDifference(NewInnerBounds, Ring.InnerBounds);
+		}
+
+		Ring.Bounds = NewRingBounds;
+		Ring.InnerBounds = NewInnerBounds;
+
+		for (const FIntVector& ChunkPosition : ChunksToCheck)
+		{
+			const FVoxelChunkSettings NewSettings = GetChunkSettings(Settings, LOD, ChunkPosition, Ring, LOD < MaxLOD);
+			FRingChunk* Chunk = Ring.Chunks.Find(ChunkPosition);
+			if (Chunk ? Chunk->Settings == NewSettings : !NewSettings.HasRenderChunk())
+			{
+				continue;
+			}
+
+			FVoxelChunkUpdate ChunkUpdate;
+			ChunkUpdate.LOD = LOD;
+			ChunkUpdate.Bounds = FVoxelUtilities::GetBoundsFromPositionAndDepth<RENDER_CHUNK_SIZE>(ChunkPosition, LOD);
+			ChunkUpdate.NewSettings = NewSettings;
+
+			if (Chunk)
+			{
+				ChunkUpdate.Id = Chunk->Id;
+				ChunkUpdate.OldSettings = Chunk->Settings;
+
+				if (NewSettings.HasRenderChunk())
+				{
+					Chunk->Settings = NewSettings;
+				}
+				else
+				{
+					RemovedChunks[LOD].Add(ChunkPosition, Chunk->Id);
+					Ring.Chunks.Remove(ChunkPosition);
+				}
+			}
+			else
+			{
+				ChunkUpdate.Id = VOXEL_UNIQUE_ID();
+				ChunkUpdate.OldSettings = {};
+				Ring.Chunks.Add(ChunkPosition, { ChunkUpdate.Id, NewSettings });
+
+				if (NewSettings.bVisible)
+				{
+					AddedChunks.Add({ LOD, ChunkPosition, OutChunkUpdates.Num() });
+				}
+			}
+
+			OutChunkUpdates.Add(MoveTemp(ChunkUpdate));
+		}
+	}
+
+	// The chunks of the other LODs that were at the position of the new ones are dithered out once the new ones are built
+	for (const FAddedChunk& AddedChunk : AddedChunks)
+	{
+		auto& PreviousChunks = OutChunkUpdates[AddedChunk.ChunkUpdateIndex].PreviousChunks;
+		const int32 ChunkSize = GetChunkSize(AddedChunk.LOD);
+
+		if (AddedChunk.LOD + 1 < Rings.Num())
+		{
+			const int32 ParentSize = 2 * ChunkSize;
+			if (const uint64* Id = RemovedChunks[AddedChunk.LOD + 1].Find(FVoxelUtilities::DivideFloor(AddedChunk.Position, ParentSize) * ParentSize))
+			{
+				PreviousChunks.Add(*Id);
+			}
+		}
+		if (AddedChunk.LOD > 0)
+		{
+			const int32 ChildSize = ChunkSize / 2;
+			for (int32 ChildIndex = 0; ChildIndex < 8; ChildIndex++)
+			{
+				const FIntVector ChildOffset(ChildIndex & 0x1, (ChildIndex >> 1) & 0x1, (ChildIndex >> 2) & 0x1);
+				if (const uint64* Id = RemovedChunks[AddedChunk.LOD - 1].Find(AddedChunk.Position + ChildOffset * ChildSize))
+				{
+					PreviousChunks.Add(*Id);
+				}
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelSharedRef<FVoxelClipmapLODManager> FVoxelClipmapLODManager::Create(
+	const FVoxelLODSettings& LODSettings,
+	const TVoxelSharedRef<FVoxelLODDynamicSettings>& DynamicSettings,
+	int32 RingRadius)
+{
+	return MakeShareable(new FVoxelClipmapLODManager(LODSettings, DynamicSettings, RingRadius));
+}
+
+FVoxelClipmapLODManager::FVoxelClipmapLODManager(
+	const FVoxelLODSettings& LODSettings,
+	const TVoxelSharedRef<FVoxelLODDynamicSettings>& DynamicSettings,
+	int32 RingRadius)
+	: IVoxelLODManager(LODSettings)
+	, DynamicSettings(DynamicSettings)
+	, Rings(RingRadius)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int32 FVoxelClipmapLODManager::UpdateBounds(const FVoxelIntBox& Bounds, const FVoxelOnChunkUpdateFinished& FinishDelegate)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	TArray<uint64> ChunksToUpdate;
+	GetChunksToUpdate(Bounds.Extend(2), ChunksToUpdate); // For normals
+	return Settings.Renderer->UpdateChunks(Bounds, ChunksToUpdate, FinishDelegate);
+}
+
+int32 FVoxelClipmapLODManager::UpdateBounds(const TArray<FVoxelIntBox>& Bounds, const FVoxelOnChunkUpdateFinished& FinishDelegate)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	if (Bounds.Num() == 0)
+	{
+		return 0;
+	}
+
+	TArray<uint64> ChunksToUpdate;
+	FVoxelIntBox GlobalBounds = Bounds[0];
+	for (auto& BoundsToUpdate : Bounds)
+	{
+		GlobalBounds = GlobalBounds + BoundsToUpdate;
+		GetChunksToUpdate(BoundsToUpdate.Extend(2), ChunksToUpdate); // For normals
+	}
+	return Settings.Renderer->UpdateChunks(GlobalBounds, ChunksToUpdate, FinishDelegate);
+}
+
+void FVoxelClipmapLODManager::ForceLODsUpdate()
+{
+	bLODUpdateQueued = true;
+}
+
+bool FVoxelClipmapLODManager::AreCollisionsEnabled(const FIntVector& Position, uint8& OutLOD) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// The cubes are nested: the first one containing Position is the ring Position is in
+	const auto& RingsArray = Rings.GetRings();
+	for (int32 LOD = 0; LOD < RingsArray.Num(); LOD++)
+	{
+		const FVoxelClipmapRings::FRing& Ring = RingsArray[LOD];
+		if (!Ring.Bounds.Contains(Position))
+		{
+			continue;
+		}
+
+		const int32 ChunkSize = FVoxelClipmapRings::GetChunkSize(LOD);
+		const FVoxelClipmapRings::FRingChunk* Chunk = Ring.Chunks.Find(FVoxelUtilities::DivideFloor(Position, ChunkSize) * ChunkSize);
+		if (Chunk && Chunk->Settings.bEnableCollisions)
+		{
+			OutLOD = LOD;
+			return true;
+		}
+		return false;
+	}
+	return false;
+}
+
+void FVoxelClipmapLODManager::Destroy()
+{
+	if (IsTicking())
+	{
+		StopTicking();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelClipmapLODManager::Tick(float DeltaTime)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const double Time = FPlatformTime::Seconds();
+	if (Time - LastLODUpdateTime < Settings.MinDelayBetweenLODUpdates)
+	{
+		return;
+	}
+
+	FIntVector NewInvokerPosition;
+	FIntVector NewInvokerPrefetchOffset;
+	if (!FindInvokerPosition(NewInvokerPosition, NewInvokerPrefetchOffset))
+	{
+		return;
+	}
+
+	const bool bMoved = !bHasInvokerPosition || NewInvokerPosition != InvokerPosition;
+	if (bMoved || NewInvokerPrefetchOffset != InvokerPrefetchOffset)
+	{
+		// The rings are not extended along the predicted path, but the tasks there are still prioritized
+		InvokerPrefetchOffset = NewInvokerPrefetchOffset;
+		Settings.Renderer->SetInvokersPositionsForPriorities({ NewInvokerPosition }, { NewInvokerPrefetchOffset });
+	}
+
+	if (!bLODUpdateQueued && (!bMoved || Settings.bConstantLOD))
+	{
+		return;
+	}
+
+	const bool bForce = bLODUpdateQueued;
+	bLODUpdateQueued = false;
+	bHasInvokerPosition = true;
+	InvokerPosition = NewInvokerPosition;
+	LastLODUpdateTime = Time;
+
+	UpdateLODs(bForce);
+
+	if (Settings.bStaticWorld && UpdateIndex > 0)
+	{
+		// The renderer can only be updated once
+		StopTicking();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FVoxelClipmapLODManager::FindInvokerPosition(FIntVector& OutPosition, FIntVector& OutPrefetchOffset) const
+{
+	auto* VoxelWorldInterface = Settings.VoxelWorldInterface.Get();
+	if (!VoxelWorldInterface)
+	{
+		return false;
+	}
+
+	for (auto& Invoker : UVoxelInvokerComponentBase::GetInvokers(VoxelWorldInterface))
+	{
+		if (!Invoker.IsValid() || !Invoker->IsLocalInvoker())
+		{
+			continue;
+		}
+		
+		const FVoxelInvokerSettings InvokerSettings = Invoker->GetInvokerSettings(VoxelWorldInterface);
+		if (InvokerSettings.bUseForLOD)
+		{
+			OutPosition = Invoker->GetInvokerVoxelPosition(VoxelWorldInterface);
+			OutPrefetchOffset = InvokerSettings.PrefetchOffset;
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelClipmapLODManager::UpdateLODs(bool bForce)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const int32 MaxLOD = FMath::Min(DynamicSettings->MaxLOD, Rings.MaxRingLOD);
+	const int32 MinLOD = FMath::Min(DynamicSettings->MinLOD, MaxLOD);
+
+	FVoxelClipmapRings::FSettings RingsSettings;
+	RingsSettings.WorldBounds = Settings.WorldBounds;
+	RingsSettings.bEnableTransitions = Settings.bEnableTransitions;
+	RingsSettings.bInvertTransitions = Settings.bInvertTransitions;
+	RingsSettings.bEnableRender = DynamicSettings->bEnableRender;
+	RingsSettings.bEnableCollisions = DynamicSettings->bEnableCollisions && DynamicSettings->bComputeVisibleChunksCollisions;
+	RingsSettings.CollisionsMaxLOD = DynamicSettings->VisibleChunksCollisionsMaxLOD;
+	RingsSettings.bEnableNavmesh = DynamicSettings->bEnableNavmesh && DynamicSettings->bComputeVisibleChunksNavmesh;
+	RingsSettings.NavmeshMaxLOD = DynamicSettings->VisibleChunksNavmeshMaxLOD;
+
+	TArray<FVoxelChunkUpdate> ChunkUpdates;
+	Rings.Update(RingsSettings, MinLOD, MaxLOD, InvokerPosition, bForce, ChunkUpdates);
+
+	if (ChunkUpdates.Num() == 0)
+	{
+		return;
+	}
+
+	LOG_VOXEL(Verbose, TEXT("Clipmap LOD update: %d chunk updates"), ChunkUpdates.Num());
+	INC_DWORD_STAT_BY(STAT_VoxelClipmapChunkUpdates, ChunkUpdates.Num());
+
+	UpdateIndex++;
+	Settings.Renderer->UpdateLODs(UpdateIndex, ChunkUpdates);
+}
+
+void FVoxelClipmapLODManager::GetChunksToUpdate(const FVoxelIntBox& Bounds, TArray<uint64>& ChunksToUpdate) const
+{
+	const auto& RingsArray = Rings.GetRings();
+	for (int32 LOD = 0; LOD < RingsArray.Num(); LOD++)
+	{
+		const FVoxelClipmapRings::FRing& Ring = RingsArray[LOD];
+		if (Ring.Chunks.Num() == 0 || !Ring.Bounds.Intersect(Bounds))
+		{
+			continue;
+		}
+
+		const int32 ChunkSize = FVoxelClipmapRings::GetChunkSize(LOD);
+		Ring.Bounds.Overlap(Bounds).MakeMultipleOfBigger(ChunkSize).Iterate(ChunkSize, [&](int32 X, int32 Y, int32 Z)
+		{
+			const FIntVector ChunkPosition(X, Y, Z);
+			if (const FVoxelClipmapRings::FRingChunk* Chunk = Ring.Chunks.Find(ChunkPosition))
+			{
+				OnChunkUpdate.Broadcast(FVoxelUtilities::GetBoundsFromPositionAndDepth<RENDER_CHUNK_SIZE>(ChunkPosition, LOD));
+				ChunksToUpdate.Add(Chunk->Id);
+			}
+		});
+	}
+}
\ No newline at end of file
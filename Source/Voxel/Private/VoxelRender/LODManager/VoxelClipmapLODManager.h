@@ -0,0 +1,132 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelTickable.h"
+#include "VoxelRender/IVoxelLODManager.h"
+#include "VoxelRender/VoxelChunkToUpdate.h"
+#include "VoxelRender/LODManager/VoxelDefaultLODManager.h"
+#include "VoxelMinimal.h"
+
+/**
+ * The rings of the clipmap LOD manager, without the renderer & the invokers
+ * The ring of LOD L is the cube of 2 * RingRadius chunks of LOD L centered on the position, minus the cube of LOD L - 1
+ * When the position moves, the cubes scroll by whole chunks and only the strips of chunks entering/leaving the rings (and their neighbors, for transitions) are updated
+ */
+class FVoxelClipmapRings
+{
+public:
+	// RingRadius must be even so that the cubes are aligned on the next LOD chunks, and >= 6 so that each cube is inside the next one with a margin of a chunk
+	static constexpr int32 MinRingRadius = 6;
+	
+	struct FSettings
+	{
+		FVoxelIntBox WorldBounds;
+		bool bEnableTransitions = false;
+		bool bInvertTransitions = false;
+
+		bool bEnableRender = false;
+		// Up to CollisionsMaxLOD/NavmeshMaxLOD
+		bool bEnableCollisions = false;
+		int32 CollisionsMaxLOD = 0;
+		bool bEnableNavmesh = false;
+		int32 NavmeshMaxLOD = 0;
+	};
+	
+	struct FRingChunk
+	{
+		uint64 Id = 0;
+		FVoxelChunkSettings Settings{};
+	};
+	struct FRing
+	{
+		// Cube of this LOD, invalid if the LOD isn't used
+		FVoxelIntBox Bounds;
+		// Cube of the previous LOD, invalid if none
+		FVoxelIntBox InnerBounds;
+		// Key: chunk min corner
+		TMap<FIntVector, FRingChunk> Chunks;
+	};
+
+	const int32 RingRadius;
+	// Above this LOD the cubes would overflow
+	const int32 MaxRingLOD;
+
+	explicit FVoxelClipmapRings(int32 RingRadius);
+
+	// Moves the cubes of MinLOD to MaxLOD around Position, and appends the changes to OutChunkUpdates
+	// bForce: re-evaluate all the chunks instead of only the strips between the old & new cubes, eg if the settings changed
+	void Update(const FSettings& Settings, int32 MinLOD, int32 MaxLOD, const FIntVector& Position, bool bForce, TArray<FVoxelChunkUpdate>& OutChunkUpdates);
+
+	// Index: LOD
+	const TArray<FRing>& GetRings() const
+	{
+		return Rings;
+	}
+
+	static int32 GetChunkSize(int32 LOD)
+	{
+		return RENDER_CHUNK_SIZE << LOD;
+	}
+
+private:
+	TArray<FRing> Rings;
+
+	FVoxelIntBox GetRingBounds(int32 LOD, const FIntVector& Position) const;
+	// Ring must have its new bounds
+	static FVoxelChunkSettings GetChunkSettings(const FSettings& Settings, int32 LOD, const FIntVector& ChunkPosition, const FRing& Ring, bool bHasOuterRing);
+};
+
+/**
+ * Clipmap LOD manager: around a single invoker, each LOD has a ring of fixed size chunks, see FVoxelClipmapRings
+ * The update cost doesn't depend on the view distance, unlike the render octree which is rebuilt from scratch
+ *
+ * The invoker is the first local invoker used for LODs. Its LOD/collisions/navmesh bounds are ignored:
+ * collisions & navmesh are computed for the visible chunks up to VisibleChunksCollisionsMaxLOD/VisibleChunksNavmeshMaxLOD
+ */
+class FVoxelClipmapLODManager : public IVoxelLODManager, public FVoxelTickable, public TVoxelSharedFromThis<FVoxelClipmapLODManager>
+{
+public:
+	static TVoxelSharedRef<FVoxelClipmapLODManager> Create(
+		const FVoxelLODSettings& LODSettings,
+		const TVoxelSharedRef<FVoxelLODDynamicSettings>& DynamicSettings,
+		int32 RingRadius);
+
+	//~ Begin IVoxelLODManager Interface
+	virtual int32 UpdateBounds(const FVoxelIntBox& Bounds, const FVoxelOnChunkUpdateFinished& FinishDelegate) override final;
+	virtual int32 UpdateBounds(const TArray<FVoxelIntBox>& Bounds, const FVoxelOnChunkUpdateFinished& FinishDelegate) override final;
+
+	virtual void ForceLODsUpdate() override final;
+	virtual bool AreCollisionsEnabled(const FIntVector& Position, uint8& OutLOD) const override final;
+
+	virtual void Destroy() override final;
+	//~ End IVoxelLODManager Interface
+
+	//~ Begin FVoxelTickable Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickableInEditor() const override { return true; }
+	//~ End FVoxelTickable Interface
+
+private:
+	FVoxelClipmapLODManager(
+		const FVoxelLODSettings& LODSettings,
+		const TVoxelSharedRef<FVoxelLODDynamicSettings>& DynamicSettings,
+		int32 RingRadius);
+
+	const TVoxelSharedRef<FVoxelLODDynamicSettings> DynamicSettings;
+	FVoxelClipmapRings Rings;
+
+	uint64 UpdateIndex = 0;
+	bool bLODUpdateQueued = true;
+	double LastLODUpdateTime = 0;
+
+	bool bHasInvokerPosition = false;
+	FIntVector InvokerPosition{ ForceInit };
+	FIntVector InvokerPrefetchOffset{ ForceInit };
+
+	bool FindInvokerPosition(FIntVector& OutPosition, FIntVector& OutPrefetchOffset) const;
+
+	void UpdateLODs(bool bForce);
+	void GetChunksToUpdate(const FVoxelIntBox& Bounds, TArray<uint64>& ChunksToUpdate) const;
+};
\ No newline at end of file
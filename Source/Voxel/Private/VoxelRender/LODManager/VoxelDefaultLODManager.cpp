@@ -12,6 +12,8 @@
 #include "Lightmass/LightmassImportanceVolume.h"
 
 DECLARE_DWORD_COUNTER_STAT(TEXT("Voxel Chunk Updates"), STAT_VoxelChunkUpdates, STATGROUP_VoxelCounters);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Invoker Chunk Entries"), STAT_VoxelInvokerChunkEntries, STATGROUP_VoxelCounters);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Invoker Unmeshed Chunk Entries"), STAT_VoxelInvokerUnmeshedChunkEntries, STATGROUP_VoxelCounters);
 
 static TAutoConsoleVariable<int32> CVarFreezeLODs(
 	TEXT("voxel.lod.FreezeLODs"),
@@ -149,6 +151,7 @@ void FVoxelDefaultLODManager::Tick(float DeltaTime)
 	{
 		LastInvokersUpdateTime = Time;
 		UpdateInvokers();
+		UpdateInvokersChunksStats();
 	}
 
 	if (bAsyncTaskWorking && Task->IsDone())
@@ -275,6 +278,11 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 					LOG_VOXEL(Verbose, TEXT("Tiggering LOD Update: Invoker Component moved"));
 					bNeedUpdate = true;
 				}
+				else if (FVoxelUtilities::SquaredSize(OldSettings.PrefetchOffset - NewSettings.PrefetchOffset) > SquaredDistanceThreshold)
+				{
+					LOG_VOXEL(Verbose, TEXT("Tiggering LOD Update: Invoker Component predicted position moved"));
+					bNeedUpdate = true;
+				}
 			}
 		}
 	}
@@ -290,14 +298,16 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 		InvokerComponentsInfos = MoveTemp(NewInvokerComponentsInfos);
 
 		TArray<FIntVector> InvokersPositionsForPriorities;
+		TArray<FIntVector> InvokersPrefetchOffsets;
 		for (auto& It : InvokerComponentsInfos)
 		{
 			if (It.Key->bUseForPriorities)
 			{
 				InvokersPositionsForPriorities.Add(It.Value.LocalPosition);
+				InvokersPrefetchOffsets.Add(It.Value.Settings.PrefetchOffset);
 			}
 		}
-		Settings.Renderer->SetInvokersPositionsForPriorities(InvokersPositionsForPriorities);
+		Settings.Renderer->SetInvokersPositionsForPriorities(InvokersPositionsForPriorities, InvokersPrefetchOffsets);
 	}
 
 	ensure(SortedInvokerComponents.Num() == InvokerComponentsInfos.Num());
@@ -311,6 +321,55 @@ void FVoxelDefaultLODManager::UpdateInvokers()
 	}
 }
 
+void FVoxelDefaultLODManager::UpdateInvokersChunksStats()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!Octree.IsValid())
+	{
+		return;
+	}
+
+	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, uint64> NewInvokersChunks;
+	for (auto& It : InvokerComponentsInfos)
+	{
+		// Only look at the local invokers used for LODs, ie the players
+		if (!It.Value.Settings.bUseForLOD || !Octree->IsInOctree(It.Value.LocalPosition))
+		{
+			continue;
+		}
+
+		// Find the visible chunk the invoker is in
+		auto* Ptr = Octree.Get();
+		uint64 ChunkId = Ptr->GetSettings().bVisible ? Ptr->ChunkId : 0;
+		while (Ptr->HasChildren())
+		{
+			Ptr = &Ptr->GetChild(It.Value.LocalPosition);
+			if (Ptr->GetSettings().bVisible)
+			{
+				ChunkId = Ptr->ChunkId;
+			}
+		}
+		if (ChunkId == 0)
+		{
+			continue;
+		}
+
+		NewInvokersChunks.Add(It.Key, ChunkId);
+
+		if (InvokersChunks.FindRef(It.Key) != ChunkId)
+		{
+			INC_DWORD_STAT(STAT_VoxelInvokerChunkEntries);
+			if (!Settings.Renderer->IsChunkMeshed(ChunkId))
+			{
+				INC_DWORD_STAT(STAT_VoxelInvokerUnmeshedChunkEntries);
+				LOG_VOXEL(Verbose, TEXT("Invoker %s entered chunk %llu before it was meshed"), *It.Key->GetName(), ChunkId);
+			}
+		}
+	}
+	InvokersChunks = MoveTemp(NewInvokersChunks);
+}
+
 void FVoxelDefaultLODManager::UpdateLODs()
 {
 	VOXEL_FUNCTION_COUNTER();
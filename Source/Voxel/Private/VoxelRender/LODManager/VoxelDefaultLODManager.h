@@ -77,12 +77,17 @@ private:
 	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, FVoxelInvokerInfo> InvokerComponentsInfos;
 	TArray<TWeakObjectPtr<UVoxelInvokerComponentBase>> SortedInvokerComponents;
 
+	// Visible chunk each invoker used for LODs was in, for the prefetch stats
+	TMap<TWeakObjectPtr<UVoxelInvokerComponentBase>, uint64> InvokersChunks;
+
 	bool bAsyncTaskWorking = false;
 	bool bLODUpdateQueued = true;
 	double LastLODUpdateTime = 0;
 	double LastInvokersUpdateTime = 0;
 
 	void UpdateInvokers();
+	// Counts how often an invoker enters a chunk that isn't meshed yet
+	void UpdateInvokersChunksStats();
 	void UpdateLODs();
 
 	void ClearInvokerComponents();
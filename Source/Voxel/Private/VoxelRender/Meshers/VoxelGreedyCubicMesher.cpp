@@ -82,6 +82,16 @@ void FVoxelGreedyCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, T
 	constexpr int32 NumVoxels = RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE;
 	constexpr int32 NumVoxelsWithNeighbors = CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS * CUBIC_CHUNK_SIZE_WITH_NEIGHBORS;
 
+	// When a face row fits in a word, the faces are found a whole row at a time from columns of voxels along each axis
+	constexpr bool bUseWords = RENDER_CHUNK_SIZE == 32;
+	constexpr int32 ColumnSize = CUBIC_CHUNK_SIZE_WITH_NEIGHBORS;
+	static_assert(!bUseWords || ColumnSize <= 64, "");
+	
+	// Bit N of a column is the voxel at N - 1
+	TVoxelStaticArray<uint64, ColumnSize * ColumnSize> ColumnsX; // Index: Y + Z * ColumnSize
+	TVoxelStaticArray<uint64, ColumnSize * ColumnSize> ColumnsY; // Index: X + Z * ColumnSize
+	TVoxelStaticArray<uint64, ColumnSize * ColumnSize> ColumnsZ; // Index: X + Y * ColumnSize
+
 	TVoxelStaticBitArray<NumVoxelsWithNeighbors> ValuesBitArray;
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("Query Data");
@@ -89,13 +99,45 @@ void FVoxelGreedyCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, T
 		TVoxelStaticArray<FVoxelValue, NumVoxelsWithNeighbors> Values;
 
 		TVoxelQueryZone<FVoxelValue> QueryZone(GetBoundsToCheckIsEmptyOn(), FIntVector(CUBIC_CHUNK_SIZE_WITH_NEIGHBORS), LOD, Values);
-		MESHER_TIME_INLINE_VALUES(NumVoxelsWithNeighbors, Data.Get<FVoxelValue>(QueryZone, LOD));
+		MESHER_TIME_INLINE_VALUES(NumVoxelsWithNeighbors, QueryValues(QueryZone));
 
 		for (int32 Index = 0; Index < NumVoxelsWithNeighbors; Index++)
 		{
 			ValuesBitArray.Set(Index, !Values[Index].IsEmpty());
 		}
+
+		if (bUseWords)
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("Build columns");
+			
+			ColumnsX.Memzero();
+			ColumnsY.Memzero();
+			ColumnsZ.Memzero();
+
+			int32 Index = 0;
+			for (int32 Z = 0; Z < ColumnSize; Z++)
+			{
+				for (int32 Y = 0; Y < ColumnSize; Y++)
+				{
+					for (int32 X = 0; X < ColumnSize; X++)
+					{
+						if (!Values[Index++].IsEmpty())
+						{
+							ColumnsX[Y + Z * ColumnSize] |= uint64(1) << X;
+							ColumnsY[X + Z * ColumnSize] |= uint64(1) << Y;
+							ColumnsZ[X + Y * ColumnSize] |= uint64(1) << Z;
+						}
+					}
+				}
+			}
+		}
 	}
+
+	// Bits 1 to RENDER_CHUNK_SIZE of the column, ie the voxels inside the chunk
+	const auto GetRow = [](uint64 Column)
+	{
+		return uint32(Column >> 1);
+	};
 	
 	const auto GetValue = [&](int32 X, int32 Y, int32 Z)
 	{
@@ -108,6 +150,55 @@ void FVoxelGreedyCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, T
 	TVoxelStaticArray<TVoxelStaticBitArray<NumVoxels>, 6> FacesBitArrays;
 	FacesBitArrays.Memzero();
 	
+	if (bUseWords)
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Find faces");
+
+		// Same layouts as below: for each direction, word Row + Layer * RENDER_CHUNK_SIZE
+		uint32* RESTRICT const Faces[6] =
+		{
+			FacesBitArrays[0].GetData(),
+			FacesBitArrays[1].GetData(),
+			FacesBitArrays[2].GetData(),
+			FacesBitArrays[3].GetData(),
+			FacesBitArrays[4].GetData(),
+			FacesBitArrays[5].GetData()
+		};
+
+		for (int32 Layer = 0; Layer < RENDER_CHUNK_SIZE; Layer++)
+		{
+			for (int32 Row = 0; Row < RENDER_CHUNK_SIZE; Row++)
+			{
+				const int32 Word = Row + Layer * RENDER_CHUNK_SIZE;
+				
+				// X faces: layer X, row Z, bit Y
+				{
+					const int32 X = Layer + 1;
+					const int32 Z = Row + 1;
+					const uint64 Column = ColumnsY[X + Z * ColumnSize];
+					Faces[0][Word] = GetRow(Column & ~ColumnsY[(X - 1) + Z * ColumnSize]);
+					Faces[1][Word] = GetRow(Column & ~ColumnsY[(X + 1) + Z * ColumnSize]);
+				}
+				// Y faces: layer Y, row X, bit Z
+				{
+					const int32 Y = Layer + 1;
+					const int32 X = Row + 1;
+					const uint64 Column = ColumnsZ[X + Y * ColumnSize];
+					Faces[2][Word] = GetRow(Column & ~ColumnsZ[X + (Y - 1) * ColumnSize]);
+					Faces[3][Word] = GetRow(Column & ~ColumnsZ[X + (Y + 1) * ColumnSize]);
+				}
+				// Z faces: layer Z, row Y, bit X
+				{
+					const int32 Z = Layer + 1;
+					const int32 Y = Row + 1;
+					const uint64 Column = ColumnsX[Y + Z * ColumnSize];
+					Faces[4][Word] = GetRow(Column & ~ColumnsX[Y + (Z - 1) * ColumnSize]);
+					Faces[5][Word] = GetRow(Column & ~ColumnsX[Y + (Z + 1) * ColumnSize]);
+				}
+			}
+		}
+	}
+	else
 	{
 		VOXEL_ASYNC_SCOPE_COUNTER("Find faces");
 
@@ -159,13 +250,26 @@ void FVoxelGreedyCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, T
 			TVoxelStaticBitArray<NumVoxels> BitArray;
 			{
 				VOXEL_ASYNC_SCOPE_COUNTER("Copy");
-				for (int32 Z = 0; Z < RENDER_CHUNK_SIZE; Z++)
+				if (bUseWords)
+				{
+					for (int32 Z = 0; Z < RENDER_CHUNK_SIZE; Z++)
+					{
+						for (int32 Y = 0; Y < RENDER_CHUNK_SIZE; Y++)
+						{
+							BitArray.GetInternal(Y + Z * RENDER_CHUNK_SIZE) = GetRow(ColumnsX[(Y + 1) + (Z + 1) * ColumnSize]);
+						}
+					}
+				}
+				else
 				{
-					for (int32 Y = 0; Y < RENDER_CHUNK_SIZE; Y++)
+					for (int32 Z = 0; Z < RENDER_CHUNK_SIZE; Z++)
 					{
-						for (int32 X = 0; X < RENDER_CHUNK_SIZE; X++)
+						for (int32 Y = 0; Y < RENDER_CHUNK_SIZE; Y++)
 						{
-							BitArray.Set(X + RENDER_CHUNK_SIZE * Y + RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * Z, GetValue(X, Y, Z));
+							for (int32 X = 0; X < RENDER_CHUNK_SIZE; X++)
+							{
+								BitArray.Set(X + RENDER_CHUNK_SIZE * Y + RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * Z, GetValue(X, Y, Z));
+							}
 						}
 					}
 				}
@@ -235,6 +339,62 @@ void FVoxelGreedyCubicMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times, T
 
 template<uint32 GridSize, typename Allocator>
 FORCEINLINE void FVoxelGreedyCubicMesher::GreedyMeshing2D(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& InFaces, TArray<FCubicQuad, Allocator>& OutQuads)
+{
+	if (GridSize != InFaces.NumBitsPerWord)
+	{
+		GreedyMeshing2D_Generic<GridSize>(InFaces, OutQuads);
+		return;
+	}
+	
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	// Same iteration order as GreedyMeshing2D_Generic, but each row is a word: Y is the word index in the layer, X the bit index
+	for (uint32 Layer = 0; Layer < GridSize; Layer++)
+	{
+		uint32* RESTRICT const Rows = InFaces.GetData() + Layer * GridSize;
+
+		// Bits are only ever cleared, so no other X can be set
+		uint32 RowsOr = 0;
+		for (uint32 Y = 0; Y < GridSize; Y++)
+		{
+			RowsOr |= Rows[Y];
+		}
+
+		while (RowsOr)
+		{
+			const uint32 X = FMath::CountTrailingZeros(RowsOr);
+			RowsOr &= RowsOr - 1;
+			
+			for (uint32 Y = 0; Y < GridSize;)
+			{
+				if (!(Rows[Y] & (1u << X)))
+				{
+					Y++;
+					continue;
+				}
+
+				// Length of the run of ones starting at X. CountTrailingZeros(0) is 32
+				const uint32 Width = FMath::CountTrailingZeros(~(Rows[Y] >> X));
+				const uint32 Mask = (Width == 32 ? 0xFFFFFFFFu : (1u << Width) - 1) << X;
+				Rows[Y] &= ~Mask;
+
+				uint32 Height = 1;
+				while (Y + Height < GridSize && (Rows[Y + Height] & Mask) == Mask)
+				{
+					Rows[Y + Height] &= ~Mask;
+					Height++;
+				}
+
+				OutQuads.Add(FCubicQuad{ Layer, X, Y, Width, Height });
+
+				Y += Height;
+			}
+		}
+	}
+}
+
+template<uint32 GridSize, typename Allocator>
+void FVoxelGreedyCubicMesher::GreedyMeshing2D_Generic(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& InFaces, TArray<FCubicQuad, Allocator>& OutQuads)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
@@ -307,6 +467,92 @@ FORCEINLINE void FVoxelGreedyCubicMesher::GreedyMeshing2D(TVoxelStaticBitArray<G
 
 template<uint32 GridSize, typename Allocator>
 void FVoxelGreedyCubicMesher::GreedyMeshing3D(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& Data, TArray<FVoxelIntBox, Allocator>& OutCubes)
+{
+	if (GridSize != Data.NumBitsPerWord)
+	{
+		GreedyMeshing3D_Generic<GridSize>(Data, OutCubes);
+		return;
+	}
+	
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	// Same iteration order as GreedyMeshing3D_Generic, but each X row is a word
+	uint32* RESTRICT const Rows = Data.GetData();
+	
+	const auto GetRow = [&](uint32 Y, uint32 Z) -> uint32&
+	{
+		checkVoxelSlow(Y < GridSize);
+		checkVoxelSlow(Z < GridSize);
+		
+		return Rows[Y + Z * GridSize];
+	};
+	
+	// Bits are only ever cleared, so no other X can be set
+	uint32 RowsOr = 0;
+	for (uint32 Index = 0; Index < GridSize * GridSize; Index++)
+	{
+		RowsOr |= Rows[Index];
+	}
+
+	while (RowsOr)
+	{
+		const uint32 X = FMath::CountTrailingZeros(RowsOr);
+		RowsOr &= RowsOr - 1;
+		
+		for (uint32 Y = 0; Y < GridSize; Y++)
+		{
+			for (uint32 Z = 0; Z < GridSize;)
+			{
+				if (!(GetRow(Y, Z) & (1u << X)))
+				{
+					Z++;
+					continue;
+				}
+
+				// Length of the run of ones starting at X. CountTrailingZeros(0) is 32
+				const uint32 SizeX = FMath::CountTrailingZeros(~(GetRow(Y, Z) >> X));
+				const uint32 Mask = (SizeX == 32 ? 0xFFFFFFFFu : (1u << SizeX) - 1) << X;
+				GetRow(Y, Z) &= ~Mask;
+
+				uint32 SizeY = 1;
+				while (Y + SizeY < GridSize && (GetRow(Y + SizeY, Z) & Mask) == Mask)
+				{
+					GetRow(Y + SizeY, Z) &= ~Mask;
+					SizeY++;
+				}
+
+				uint32 SizeZ = 1;
+				while (Z + SizeZ < GridSize)
+				{
+					bool bFullBlock = true;
+					for (uint32 Index = 0; Index < SizeY && bFullBlock; Index++)
+					{
+						bFullBlock = (GetRow(Y + Index, Z + SizeZ) & Mask) == Mask;
+					}
+					if (!bFullBlock)
+					{
+						break;
+					}
+					
+					for (uint32 Index = 0; Index < SizeY; Index++)
+					{
+						GetRow(Y + Index, Z + SizeZ) &= ~Mask;
+					}
+					SizeZ++;
+				}
+
+				const auto Min = FIntVector(X, Y, Z);
+				const auto Max = Min + FIntVector(SizeX, SizeY, SizeZ);
+				OutCubes.Add(FVoxelIntBox(Min, Max));
+
+				Z += SizeZ;
+			}
+		}
+	}
+}
+
+template<uint32 GridSize, typename Allocator>
+void FVoxelGreedyCubicMesher::GreedyMeshing3D_Generic(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& Data, TArray<FVoxelIntBox, Allocator>& OutCubes)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
@@ -390,6 +636,39 @@ void FVoxelGreedyCubicMesher::GreedyMeshing3D(TVoxelStaticBitArray<GridSize * Gr
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+void FVoxelGreedyCubicMesher::GreedyMeshChunk(
+	bool bGeneric,
+	TVoxelStaticArray<FChunkBitArray, 6>& Faces,
+	FChunkBitArray& Solid,
+	TArray<FCubicQuad>& OutQuads,
+	TArray<FVoxelIntBox>& OutCubes)
+{
+	for (int32 Direction = 0; Direction < 6; Direction++)
+	{
+		if (bGeneric)
+		{
+			GreedyMeshing2D_Generic<RENDER_CHUNK_SIZE>(Faces[Direction], OutQuads);
+		}
+		else
+		{
+			GreedyMeshing2D<RENDER_CHUNK_SIZE>(Faces[Direction], OutQuads);
+		}
+	}
+
+	if (bGeneric)
+	{
+		GreedyMeshing3D_Generic<RENDER_CHUNK_SIZE>(Solid, OutCubes);
+	}
+	else
+	{
+		GreedyMeshing3D<RENDER_CHUNK_SIZE>(Solid, OutCubes);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 template<typename T>
 FORCEINLINE void FVoxelGreedyCubicMesher::AddFace(
 	FVoxelMesherTimes& Times,
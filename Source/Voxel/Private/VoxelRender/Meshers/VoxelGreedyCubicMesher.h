@@ -26,7 +26,8 @@ private:
 	
 	template<typename T>
 	void CreateGeometryTemplate(FVoxelMesherTimes& Times, TArray<uint32>& Indices, TArray<T>& Vertices, TArray<FColor>* TextureData, TArray<FVoxelIntBox>* CollisionCubes);
-	
+
+public:
 	struct FCubicQuad
 	{
 		uint32 Layer;
@@ -36,11 +37,31 @@ private:
 		uint32 SizeY;
 	};
 
+private:
+	// If GridSize is the word size, each row is a single word and the runs are found & cleared with masks
+	// Else, falls back to the generic versions. Both give exactly the same quads/cubes
+	template<uint32 GridSize, typename Allocator>
+	static void GreedyMeshing2D(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& InFaces, TArray<FCubicQuad, Allocator>& OutQuads);
 	template<uint32 GridSize, typename Allocator>
-	void GreedyMeshing2D(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& InFaces, TArray<FCubicQuad, Allocator>& OutQuads);
+	static void GreedyMeshing3D(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& Data, TArray<FVoxelIntBox, Allocator>& OutCubes);
 
+	// Bit by bit versions
 	template<uint32 GridSize, typename Allocator>
-	void GreedyMeshing3D(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& Data, TArray<FVoxelIntBox, Allocator>& OutCubes);
+	static void GreedyMeshing2D_Generic(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& InFaces, TArray<FCubicQuad, Allocator>& OutQuads);
+	template<uint32 GridSize, typename Allocator>
+	static void GreedyMeshing3D_Generic(TVoxelStaticBitArray<GridSize * GridSize * GridSize>& Data, TArray<FVoxelIntBox, Allocator>& OutCubes);
+
+public:
+	using FChunkBitArray = TVoxelStaticBitArray<RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE * RENDER_CHUNK_SIZE>;
+	
+	// Greedy meshing of a chunk with the same layouts as CreateGeometryTemplate, using the word or the bit by bit (bGeneric) versions
+	// Clears Faces & Solid. Used by the tests
+	static void GreedyMeshChunk(
+		bool bGeneric,
+		TVoxelStaticArray<FChunkBitArray, 6>& Faces,
+		FChunkBitArray& Solid,
+		TArray<FCubicQuad>& OutQuads,
+		TArray<FVoxelIntBox>& OutCubes);
 
 public:
 	template<typename T>
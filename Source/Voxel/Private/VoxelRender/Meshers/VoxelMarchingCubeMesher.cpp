@@ -452,7 +452,7 @@ bool FVoxelMarchingCubeMesher::CreateGeometryTemplate(FVoxelMesherTimes& Times,
 		BoundsToQuery = BoundsToQuery.Extend(1);
 	}
 	TVoxelQueryZone<FVoxelValue> QueryZone(BoundsToQuery, FIntVector(DataSize), LOD, CachedValues);
-	MESHER_TIME_INLINE_VALUES(DataSize * DataSize * DataSize, Data.Get<FVoxelValue>(QueryZone, LOD));
+	MESHER_TIME_INLINE_VALUES(DataSize * DataSize * DataSize, QueryValues(QueryZone));
 	
 	Accelerator = MakeUnique<FVoxelConstDataAccelerator>(Data, GetBoundsToLock());
 
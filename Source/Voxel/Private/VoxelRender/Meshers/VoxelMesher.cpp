@@ -3,6 +3,8 @@
 #include "VoxelRender/Meshers/VoxelMesher.h"
 #include "VoxelRender/VoxelMesherAsyncWork.h"
 #include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelRender/VoxelMeshOptimization.h"
+#include "VoxelRender/VoxelMeshDiskCache.h"
 #include "VoxelRender/IVoxelRenderer.h"
 #include "VoxelData/VoxelDataIncludes.h"
 #include "VoxelDebug/VoxelDebugManager.h"
@@ -17,6 +19,12 @@ static TAutoConsoleVariable<int32> CVarDoNotSkipEmptyChunks(
 	TEXT("If true, all chunks will be computed"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<int32> CVarEmptyCheckMinSize(
+	TEXT("voxel.mesher.EmptyCheckMinSize"),
+	8,
+	TEXT("When the range analysis of a chunk is inconclusive, it is subdivided until this size (in voxels) to try to prove it empty. 0 to only check the whole chunk"),
+	ECVF_Default);
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -75,6 +83,11 @@ struct FVoxelMesherStats
 		uint64 TotalMaterialsAccesses = 0;
 
 		double TotalDistanceFieldsTime = 0;
+
+		uint64 TotalNumTriangles = 0;
+		uint64 TotalNumVertices = 0;
+		uint64 TotalNumVertexTransforms = 0;
+		uint64 TotalMeshMemory = 0;
 		
 		const auto Print = [&](const TArray<FChunkStats>& Stats)
 		{
@@ -95,6 +108,11 @@ struct FVoxelMesherStats
 
 				uint64 ValuesAccesses = 0;
 				uint64 MaterialsAccesses = 0;
+
+				uint64 NumTriangles = 0;
+				uint64 NumVertices = 0;
+				uint64 NumVertexTransforms = 0;
+				uint64 MeshMemory = 0;
 			};
 			TMap<int32, FMean> LODToMeans;
 			double GlobalTotalTime = 0;
@@ -116,13 +134,18 @@ struct FVoxelMesherStats
 
 				Mean.ValuesAccesses += Stat.Times._ValuesAccesses;
 				Mean.MaterialsAccesses += Stat.Times._MaterialsAccesses;
+
+				Mean.NumTriangles += Stat.Times._NumTriangles;
+				Mean.NumVertices += Stat.Times._NumVertices;
+				Mean.NumVertexTransforms += Stat.Times._NumVertexTransforms;
+				Mean.MeshMemory += Stat.Times._MeshMemory;
 				
 				GlobalTotalTime += Stat.Time;
 			}
 
 			LODToMeans.KeySort(TLess<int32>());
 
-			LOG_VOXEL(Log, TEXT("\tLOD; Chunks (%%)     ; Total (%%)         ; Avg       ; Values (%%)        , Per Voxel ; Materials (%%)     , Per Voxel ; Normals (%%)       ; UVs (%%)           ; CreateChunk (%%)   ; FinishCreatingChunk (%%); DistanceFields (%%)"));
+			LOG_VOXEL(Log, TEXT("\tLOD; Chunks (%%)     ; Total (%%)         ; Avg       ; Values (%%)        , Per Voxel ; Materials (%%)     , Per Voxel ; Normals (%%)       ; UVs (%%)           ; CreateChunk (%%)   ; FinishCreatingChunk (%%); DistanceFields (%%); ACMR ; ATVR ; Memory/Chunk; Bytes/Vertex"));
 			for (auto& It : LODToMeans)
 			{
 				auto& V = It.Value;
@@ -133,8 +156,13 @@ struct FVoxelMesherStats
 				TotalMaterialsAccesses += V.MaterialsAccesses;
 
 				TotalDistanceFieldsTime += V.DistanceFieldTime;
+
+				TotalNumTriangles += V.NumTriangles;
+				TotalNumVertices += V.NumVertices;
+				TotalNumVertexTransforms += V.NumVertexTransforms;
+				TotalMeshMemory += V.MeshMemory;
 				
-				LOG_VOXEL(Log, TEXT("\t %2d: %6d (%5.2f%%); %8.3fs (%5.2f%%); %8.3fms; %8.3fs (%5.2f%%), %8.1fns; %8.3fs (%5.2f%%), %8.1fns; %8.3fs (%5.2f%%); %8.3fs (%5.2f%%); %8.3fs (%5.2f%%);      %8.3fs (%5.2f%%); %8.3fs (%5.2f%%)"),
+				LOG_VOXEL(Log, TEXT("\t %2d: %6d (%5.2f%%); %8.3fs (%5.2f%%); %8.3fms; %8.3fs (%5.2f%%), %8.1fns; %8.3fs (%5.2f%%), %8.1fns; %8.3fs (%5.2f%%); %8.3fs (%5.2f%%); %8.3fs (%5.2f%%);      %8.3fs (%5.2f%%); %8.3fs (%5.2f%%); %5.3f; %5.3f; %8.1fKB    ; %5.1f"),
 					It.Key,
 					V.Count,
 					V.Count / double(Stats.Num()) * 100,
@@ -163,7 +191,13 @@ struct FVoxelMesherStats
 					V.FinishCreatingChunkTime / V.TotalTime * 100,
 					
 					V.DistanceFieldTime,
-					V.DistanceFieldTime / V.TotalTime * 100);
+					V.DistanceFieldTime / V.TotalTime * 100,
+					
+					V.NumTriangles > 0 ? double(V.NumVertexTransforms) / V.NumTriangles : 0,
+					V.NumVertices > 0 ? double(V.NumVertexTransforms) / V.NumVertices : 0,
+					
+					V.MeshMemory / double(V.Count) / 1024,
+					V.NumVertices > 0 ? double(V.MeshMemory) / V.NumVertices : 0);
 			}
 
 			return GlobalTotalTime;
@@ -195,6 +229,14 @@ struct FVoxelMesherStats
 		LOG_VOXEL(Log, TEXT("------------------------------"));
 		LOG_VOXEL(Log, TEXT("Values: %llu reads in %fs, avg %.1fns/voxel"), TotalValuesAccesses, TotalValuesTime, TotalValuesTime / TotalValuesAccesses * 1e9);
 		LOG_VOXEL(Log, TEXT("Materials: %llu reads in %fs, avg %.1fns/voxel"), TotalMaterialsAccesses, TotalMaterialsTime, TotalMaterialsTime / TotalMaterialsAccesses * 1e9);
+		LOG_VOXEL(Log, TEXT("Vertex Cache: %llu triangles, %llu vertices, ACMR %.3f, ATVR %.3f"),
+			TotalNumTriangles,
+			TotalNumVertices,
+			TotalNumTriangles > 0 ? double(TotalNumVertexTransforms) / TotalNumTriangles : 0,
+			TotalNumVertices > 0 ? double(TotalNumVertexTransforms) / TotalNumVertices : 0);
+		LOG_VOXEL(Log, TEXT("Mesh Memory: %fMB, avg %.1f bytes/vertex"),
+			TotalMeshMemory / double(1 << 20),
+			TotalNumVertices > 0 ? double(TotalMeshMemory) / TotalNumVertices : 0);
 	}
 };
 
@@ -238,15 +280,71 @@ void FVoxelMesherBase::UnlockData()
 	Data.Unlock(MoveTemp(LockInfo));
 }
 
-void FVoxelMesherBase::LockData()
+void FVoxelMesherBase::QueryValues(TVoxelQueryZone<FVoxelValue>& QueryZone) const
+{
+	if (!SnapshotBounds.IsValid() || !SnapshotBounds.Contains(QueryZone.Bounds))
+	{
+		Data.Get<FVoxelValue>(QueryZone, LOD);
+		return;
+	}
+
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	check(int32(QueryZone.Step) == Step);
+	
+	const FIntVector SnapshotSize = SnapshotBounds.Size() / Step;
+	for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+	{
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+		{
+			const int32 Index = FVoxelUtilities::Get3DIndex(SnapshotSize, (FIntVector(QueryZone.Bounds.Min.X, Y, Z) - SnapshotBounds.Min) / Step);
+			int32 LocalX = 0;
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+			{
+				QueryZone.Set(X, Y, Z, SnapshotValues[Index + LocalX++]);
+			}
+		}
+	}
+}
+
+void FVoxelMesherBase::LockData(const FVoxelIntBox& AdditionalBounds)
 {
-	LockInfo = Data.Lock(EVoxelLockType::Read, GetBoundsToLock(), "Mesher");
+	const FVoxelIntBox BoundsToLock = GetBoundsToLock();
+	LockInfo = Data.Lock(EVoxelLockType::Read, AdditionalBounds.IsValid() ? BoundsToLock.Union(AdditionalBounds) : BoundsToLock, "Mesher");
+}
+
+void FVoxelMesherBase::TakeSnapshot(const FVoxelIntBox& Bounds)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	check(Bounds.IsMultipleOf(Step));
+	
+	const FIntVector Size = Bounds.Size() / Step;
+	SnapshotBounds = Bounds;
+	SnapshotValues.Empty(Size.X * Size.Y * Size.Z);
+	SnapshotValues.SetNumUninitialized(Size.X * Size.Y * Size.Z);
+	
+	TVoxelQueryZone<FVoxelValue> QueryZone(Bounds, Size, LOD, SnapshotValues);
+	Data.Get<FVoxelValue>(QueryZone, LOD);
 }
 
 bool FVoxelMesherBase::IsEmpty() const
 {
 	const FVoxelIntBox Bounds = GetBoundsToCheckIsEmptyOn();
-	const bool bIsEmpty = CVarDoNotSkipEmptyChunks.GetValueOnAnyThread() != 0 ? false : Data.IsEmpty(Bounds, LOD);
+
+	bool bIsEmpty = false;
+	if (CVarDoNotSkipEmptyChunks.GetValueOnAnyThread() == 0)
+	{
+		EVoxelEmptyState State = EVoxelEmptyState::Unknown;
+		uint64 Token = 0;
+		if (!EmptyStateCache.IsValid() || !EmptyStateCache->Get(State, Token))
+		{
+			State = Data.GetEmptyState(Bounds, LOD, CVarEmptyCheckMinSize.GetValueOnAnyThread());
+			if (EmptyStateCache.IsValid())
+			{
+				EmptyStateCache->Set(State, Token);
+			}
+		}
+		bIsEmpty = State != EVoxelEmptyState::Unknown;
+	}
 
 	if (!bIsTransitions)
 	{
@@ -284,15 +382,63 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesherBase::CreateEmptyChunk() const
 
 void FVoxelMesherBase::FinishCreatingChunk(FVoxelChunkMesh& Chunk) const
 {
+	if (!bIsTransitions && LOD >= Settings.MeshDecimationMinLOD)
+	{
+		Chunk.IterateBuffers([&](FVoxelChunkMeshBuffers& Buffer) { Buffer.Decimate(LOD, Settings.MeshDecimationMaxError); });
+	}
 	if (Settings.bOptimizeIndices)
 	{
 		Chunk.IterateBuffers([](auto& Buffer) { Buffer.OptimizeIndices(); });
 	}
 	Chunk.IterateBuffers([](FVoxelChunkMeshBuffers& Buffer) { Buffer.Shrink(); });
 	Chunk.IterateBuffers([](FVoxelChunkMeshBuffers& Buffer) { Buffer.ComputeBounds(); });
+	if (Settings.bQuantizeMeshVertices)
+	{
+		Chunk.IterateBuffers([&](FVoxelChunkMeshBuffers& Buffer) { Buffer.Pack(LOD, Settings.bHalfPrecisionCoordinates); });
+	}
 	Chunk.IterateBuffers([](FVoxelChunkMeshBuffers& Buffer) { Buffer.Guid = FGuid::NewGuid(); });
 }
 
+TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesherBase::LoadFromDiskCache(uint8 TransitionsMask)
+{
+	if (!Settings.MeshDiskCache.IsValid())
+	{
+		return nullptr;
+	}
+
+	// Chunks with edits or items bypass the cache, so that edits never need to invalidate it
+	bCanUseDiskCache = FVoxelMeshDiskCache::IsGeneratorOnly(Data, GetBoundsToLock());
+	if (!bCanUseDiskCache)
+	{
+		return nullptr;
+	}
+
+	// Done under the data lock, as else the chunk could be edited before it's meshed & saved
+	return Settings.MeshDiskCache->Load(LOD, ChunkPosition, TransitionsMask);
+}
+
+void FVoxelMesherBase::SaveToDiskCache(const FVoxelChunkMesh& Chunk, uint8 TransitionsMask) const
+{
+	if (bCanUseDiskCache && !Chunk.IsEmpty())
+	{
+		Settings.MeshDiskCache->Save(LOD, ChunkPosition, TransitionsMask, Chunk);
+	}
+}
+
+void FVoxelMesherBase::ComputeChunkStats(const FVoxelChunkMesh& Chunk, FVoxelMesherTimes& Times) const
+{
+#if ENABLE_MESHER_STATS
+	Chunk.IterateBuffers([&](const FVoxelChunkMeshBuffers& Buffer)
+	{
+		const auto Stats = FVoxelMeshOptimization::AnalyzeVertexCache(Buffer.Indices, Buffer.GetNumVertices());
+		Times._NumTriangles += Buffer.Indices.Num() / 3;
+		Times._NumVertices += Buffer.GetNumVertices();
+		Times._NumVertexTransforms += Stats.NumTransforms;
+	});
+	Times._MeshMemory += Chunk.GetAllocatedSize();
+#endif
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -314,7 +460,11 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesher::CreateFullChunk()
 		Data.Generator->InitArea(FVoxelIntBox(ChunkPosition, ChunkPosition + Step * RENDER_CHUNK_SIZE), LOD);
 	}
 
-	LockData();
+	const bool bBuildDistanceField = LOD <= Settings.MaxDistanceFieldLOD;
+	const FVoxelIntBox DistanceFieldBounds = bBuildDistanceField ? FVoxelChunkMesh::GetDistanceFieldValuesBounds(LOD, ChunkPosition, Settings) : FVoxelIntBox();
+	
+	// Lock the distance field values too, so that everything is read under a single lock
+	LockData(DistanceFieldBounds);
 
 	TVoxelSharedPtr<FVoxelChunkMesh> Chunk;
 	if (IsEmpty())
@@ -323,10 +473,33 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesher::CreateFullChunk()
 		FinishCreatingChunk(*Chunk);
 		UnlockData();
 	}
+	else if (const auto CachedChunk = LoadFromDiskCache(0))
+	{
+		Chunk = CachedChunk;
+
+		if (bBuildDistanceField)
+		{
+			// Still under the lock: the distance field won't have to lock the data again
+			TakeSnapshot(DistanceFieldBounds);
+		}
+		UnlockData();
+
+		if (bBuildDistanceField)
+		{
+			Chunk->BuildDistanceField(LOD, ChunkPosition, Data, Settings, SnapshotBounds, SnapshotValues.GetData());
+		}
+	}
 	else
 	{
 		const double StartTime = FPlatformTime::Seconds();
 		FVoxelMesherTimes Times;
+
+		{
+			// The mesher & the distance field values overlap: query them all at once
+			const FVoxelIntBox Bounds = bBuildDistanceField ? GetBoundsToLock().Union(DistanceFieldBounds) : GetBoundsToLock();
+			MESHER_TIME_SCOPE_VALUES(Bounds.Count() / (Step * Step * Step));
+			TakeSnapshot(Bounds);
+		}
 		
 		Chunk = CreateFullChunkImpl(Times);
 		check(!LockInfo.IsValid());
@@ -337,11 +510,14 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMesher::CreateFullChunk()
 				MESHER_TIME_SCOPE(FinishCreatingChunk)
 				FinishCreatingChunk(*Chunk);
 			}
+			ComputeChunkStats(*Chunk, Times);
+			SaveToDiskCache(*Chunk, 0);
 
-			if (LOD <= Settings.MaxDistanceFieldLOD)
+			if (bBuildDistanceField)
 			{
 				MESHER_TIME_SCOPE(DistanceField)
-				Chunk->BuildDistanceField(LOD, ChunkPosition, Data, Settings);
+				// Covered by the snapshot: won't lock the data again
+				Chunk->BuildDistanceField(LOD, ChunkPosition, Data, Settings, SnapshotBounds, SnapshotValues.GetData());
 			}
 		}
 
@@ -371,6 +547,12 @@ void FVoxelMesher::CreateGeometry(TArray<uint32>& Indices, TArray<FVector>& Vert
 	{
 		const double StartTime = FPlatformTime::Seconds();
 		FVoxelMesherTimes Times;
+		{
+			// Same snapshot as CreateFullChunk, so that collision/navmesh only chunks read the values the same way
+			const FVoxelIntBox Bounds = GetBoundsToLock();
+			MESHER_TIME_SCOPE_VALUES(Bounds.Count() / (Step * Step * Step));
+			TakeSnapshot(Bounds);
+		}
 		CreateGeometryImpl(Times, Indices, Vertices);
 		check(!LockInfo.IsValid());
 		const double EndTime = FPlatformTime::Seconds();
@@ -409,6 +591,11 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelTransitionsMesher::CreateFullChunk()
 		FinishCreatingChunk(*Chunk);
 		UnlockData();
 	}
+	else if (const auto CachedChunk = LoadFromDiskCache(TransitionsMask))
+	{
+		Chunk = CachedChunk;
+		UnlockData();
+	}
 	else
 	{
 		const double StartTime = FPlatformTime::Seconds();
@@ -419,8 +606,12 @@ TVoxelSharedPtr<FVoxelChunkMesh> FVoxelTransitionsMesher::CreateFullChunk()
 
 		if (Chunk.IsValid())
 		{
-			MESHER_TIME_SCOPE(FinishCreatingChunk)
-			FinishCreatingChunk(*Chunk);
+			{
+				MESHER_TIME_SCOPE(FinishCreatingChunk)
+				FinishCreatingChunk(*Chunk);
+			}
+			ComputeChunkStats(*Chunk, Times);
+			SaveToDiskCache(*Chunk, TransitionsMask);
 		}
 		
 		const double EndTime = FPlatformTime::Seconds();
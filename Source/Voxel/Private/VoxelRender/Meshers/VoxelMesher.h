@@ -5,11 +5,16 @@
 #include "CoreMinimal.h"
 #include "VoxelIntBox.h"
 #include "VoxelMinimal.h"
+#include "VoxelValue.h"
 
 struct FVoxelRendererSettings;
 struct FVoxelChunkMesh;
 class FVoxelData;
 class FVoxelDataLockInfo;
+class FVoxelChunkEmptyStateCache;
+
+template<typename T>
+class TVoxelQueryZone;
 
 #if ENABLE_MESHER_STATS
 struct FVoxelScopedMesherTime
@@ -60,6 +65,13 @@ struct FVoxelMesherTimes
 	
 	uint64 FinishCreatingChunk = 0;
 	uint64 DistanceField = 0;
+
+	// Not times: simulated post-transform vertex cache, see FVoxelMeshOptimization::AnalyzeVertexCache
+	uint64 _NumTriangles = 0;
+	uint64 _NumVertices = 0;
+	uint64 _NumVertexTransforms = 0;
+	// Not times: CPU memory used by the chunk mesh, in bytes
+	uint64 _MeshMemory = 0;
 };
 
 class FVoxelMesherBase
@@ -80,6 +92,9 @@ public:
 		bool bIsTransitions);
 	virtual ~FVoxelMesherBase();
 
+	// Optional, used by IsEmpty
+	TVoxelSharedPtr<FVoxelChunkEmptyStateCache> EmptyStateCache;
+
 	virtual TVoxelSharedPtr<FVoxelChunkMesh> CreateFullChunk() = 0;
 	virtual void CreateGeometry(TArray<uint32>& Indices, TArray<FVector>& Vertices) = 0;
 	
@@ -91,12 +106,32 @@ protected:
 
 	void UnlockData();
 	
+	// Queries the values, copying them from the snapshot if it covers QueryZone. Requires the data to be locked if it doesn't
+	void QueryValues(TVoxelQueryZone<FVoxelValue>& QueryZone) const;
+	
 private:
 	TUniquePtr<FVoxelDataLockInfo> LockInfo;
 
-	void LockData();
+	// Values of everything the task will read, queried once under the data lock by CreateFullChunk and CreateGeometry
+	// Shared by QueryValues and the distance field. Materials are read sparsely through the accelerator and are not part of it
+	// Invalid bounds if not used (eg transitions)
+	FVoxelIntBox SnapshotBounds;
+	TArray<FVoxelValue> SnapshotValues;
+
+	// Set by LoadFromDiskCache if the chunk only depends on the generator
+	bool bCanUseDiskCache = false;
+
+	// AdditionalBounds: locked in the same lock as GetBoundsToLock
+	void LockData(const FVoxelIntBox& AdditionalBounds = FVoxelIntBox());
+	// Requires the snapshot bounds to be locked
+	void TakeSnapshot(const FVoxelIntBox& Bounds);
 	bool IsEmpty() const;
 	void FinishCreatingChunk(FVoxelChunkMesh& Chunk) const;
+	// Requires the data to be locked. Null if the disk cache is disabled or doesn't have the chunk
+	TVoxelSharedPtr<FVoxelChunkMesh> LoadFromDiskCache(uint8 TransitionsMask);
+	// Only saves the chunk if LoadFromDiskCache found it was only depending on the generator
+	void SaveToDiskCache(const FVoxelChunkMesh& Chunk, uint8 TransitionsMask) const;
+	void ComputeChunkStats(const FVoxelChunkMesh& Chunk, FVoxelMesherTimes& Times) const;
 
 	friend class FVoxelMesher;
 	friend class FVoxelTransitionsMesher;
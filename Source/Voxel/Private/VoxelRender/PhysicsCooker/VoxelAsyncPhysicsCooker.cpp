@@ -3,11 +3,14 @@
 #include "VoxelRender/PhysicsCooker/VoxelAsyncPhysicsCooker.h"
 #include "VoxelRender/PhysicsCooker/VoxelAsyncPhysicsCooker_PhysX.h"
 #include "VoxelRender/PhysicsCooker/VoxelAsyncPhysicsCooker_Chaos.h"
+#include "VoxelRender/PhysicsCooker/VoxelCollisionCookingCache.h"
 #include "VoxelRender/VoxelProceduralMeshComponent.h"
 #include "VoxelRender/VoxelProcMeshBuffers.h"
 #include "VoxelRender/IVoxelProceduralMeshComponent_PhysicsCallbackHandler.h"
+#include "VoxelRender/VoxelMeshDecimation.h"
 #include "VoxelUtilities/VoxelThreadingUtilities.h"
 #include "PhysicsEngine/PhysicsSettings.h"
+#include "Hash/CityHash.h"
 
 double GTotalVoxelCollisionCookingTime = 0;
 
@@ -52,6 +55,7 @@ IVoxelAsyncPhysicsCooker::IVoxelAsyncPhysicsCooker(UVoxelProceduralMeshComponent
 	, bCleanCollisionMesh(Component->bCleanCollisionMesh)
     , bSimpleCubicCollision(Component->bSimpleCubicCollision)
 	, NumConvexHullsPerAxis(Component->NumConvexHullsPerAxis)
+	, CollisionDecimationMaxError(Component->CollisionDecimationMaxError)
 	, Buffers([&]()
 		{
 			TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>> TmpBuffers;
@@ -66,6 +70,12 @@ IVoxelAsyncPhysicsCooker::IVoxelAsyncPhysicsCooker(UVoxelProceduralMeshComponent
 			return TmpBuffers;
 		}())
 	, LocalToRoot(Component->GetRelativeTransform())
+	, CookingCaches([&]()
+		{
+			const auto Handler = Component->PhysicsCallbackHandler.Pin();
+			// Only invalid if the renderer is being destroyed, in which case there's nothing to share the caches with
+			return Handler.IsValid() ? Handler->CookingCaches : MakeVoxelShared<FVoxelCollisionCookingCaches>();
+		}())
 {
 	check(IsInGameThread());
 	ensure(CollisionTraceFlag != ECollisionTraceFlag::CTF_UseDefault);
@@ -112,6 +122,90 @@ void IVoxelAsyncPhysicsCooker::PostDoWork()
 	}
 }
 
+void IVoxelAsyncPhysicsCooker::DecimateSections()
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (CollisionDecimationMaxError <= 0 || DecimatedSections.Num() > 0)
+	{
+		return;
+	}
+
+	DecimatedSections.SetNum(Buffers.Num());
+	for (int32 SectionIndex = 0; SectionIndex < Buffers.Num(); SectionIndex++)
+	{
+		auto& Buffer = *Buffers[SectionIndex];
+		auto& Section = DecimatedSections[SectionIndex];
+
+		auto& PositionBuffer = Buffer.VertexBuffers.PositionVertexBuffer;
+		Section.Vertices.SetNumUninitialized(PositionBuffer.GetNumVertices());
+		for (uint32 Index = 0; Index < PositionBuffer.GetNumVertices(); Index++)
+		{
+			Section.Vertices[Index] = PositionBuffer.VertexPosition(Index);
+		}
+		Buffer.IndexBuffer.GetCopy(Section.Indices);
+
+		DecimateMesh(Section.Vertices, Section.Indices);
+	}
+}
+
+void IVoxelAsyncPhysicsCooker::DecimateMesh(TArray<FVector>& Vertices, TArray<uint32>& Indices) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (CollisionDecimationMaxError <= 0)
+	{
+		return;
+	}
+	
+	FVoxelMeshDecimation::FSettings DecimationSettings;
+	DecimationSettings.MaxError = CollisionDecimationMaxError * (1 << LOD);
+	
+	// No need to lock anything else: chunk borders are open edges, and are locked by the decimation
+	TArray<int32> VertexRemap;
+	const int32 NewNumVertices = FVoxelMeshDecimation::Decimate(Indices, Vertices, {}, DecimationSettings, VertexRemap);
+	FVoxelMeshDecimation::ApplyVertexRemap(Vertices, VertexRemap, NewNumVertices);
+}
+
+void IVoxelAsyncPhysicsCooker::GetChunkMesh(const FVoxelProcMeshBuffers& Buffer, const FVoxelProcMeshBuffersChunkRange& Range, TArray<FVector>& OutVertices, TArray<uint32>& OutIndices)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	auto& PositionBuffer = Buffer.VertexBuffers.PositionVertexBuffer;
+	check(Range.FirstVertex + Range.NumVertices <= int32(PositionBuffer.GetNumVertices()));
+	check(Range.FirstIndex + Range.NumIndices <= Buffer.GetNumIndices());
+	
+	OutVertices.SetNumUninitialized(Range.NumVertices);
+	for (int32 Index = 0; Index < Range.NumVertices; Index++)
+	{
+		OutVertices[Index] = PositionBuffer.VertexPosition(Range.FirstVertex + Index);
+	}
+	
+	OutIndices.SetNumUninitialized(Range.NumIndices);
+	for (int32 Index = 0; Index < Range.NumIndices; Index++)
+	{
+		const uint32 VertexIndex = Buffer.IndexBuffer.GetIndex(Range.FirstIndex + Index);
+		checkVoxelSlow(uint32(Range.FirstVertex) <= VertexIndex && VertexIndex < uint32(Range.FirstVertex + Range.NumVertices));
+		OutIndices[Index] = VertexIndex - Range.FirstVertex;
+	}
+}
+
+FVoxelCollisionCookingCacheKey IVoxelAsyncPhysicsCooker::GetTriMeshCacheKey(const TArray<FVector>& Vertices, const TArray<uint32>& Indices) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	// The decimation output only depends on its input and on the max error
+	const float DecimationMaxError = CollisionDecimationMaxError > 0 ? CollisionDecimationMaxError * (1 << LOD) : 0.f;
+	
+	FVoxelCollisionCookingCacheKey Key;
+	Key.Hash = FVoxelUtilities::MurmurHash64(*reinterpret_cast<const uint32*>(&DecimationMaxError));
+	Key.Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Vertices.GetData()), Vertices.Num() * sizeof(FVector), Key.Hash);
+	Key.Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Indices.GetData()), Indices.Num() * sizeof(uint32), Key.Hash);
+	Key.NumVertices = Vertices.Num();
+	Key.NumIndices = Indices.Num();
+	return Key;
+}
+
 uint32 IVoxelAsyncPhysicsCooker::GetPriority() const
 {
 	return PriorityHandler.GetPriority();
@@ -6,15 +6,52 @@
 #include "VoxelMinimal.h"
 #include "VoxelAsyncWork.h"
 #include "VoxelPriorityHandler.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
 #include "PhysicsEngine/BodySetup.h"
 #include "UObject/WeakObjectPtrTemplates.h"
 
 struct FVoxelProcMeshBuffers;
+struct FVoxelProcMeshBuffersChunkRange;
 struct FVoxelProceduralMeshComponentMemoryUsage;
 class UBodySetup;
+struct FVoxelCollisionCookingCaches;
+struct FVoxelCollisionCookingCacheKey;
 class UVoxelProceduralMeshComponent;
 class IVoxelProceduralMeshComponent_PhysicsCallbackHandler;
 
+// Grid of the convex hulls of the simple collision
+// The cells are on a fixed grid in component space and not relative to the mesh bounds, so that an edit only changes the cells it touches
+// The hulls of the other cells are then found in the cache
+// Works with buffers of any size, eg the ones of merged chunks
+struct FVoxelConvexHullsGrid
+{
+	float CellSize = 0;
+	// In cells
+	FIntVector Min = FIntVector::ZeroValue;
+	FIntVector Size = FIntVector::ZeroValue;
+
+	FVoxelConvexHullsGrid(const FBox& Bounds, int32 ChunkSize, int32 NumConvexHullsPerAxis)
+	{
+		CellSize = float(ChunkSize) / FMath::Max(NumConvexHullsPerAxis, 1);
+		Min = FVoxelUtilities::FloorToInt(Bounds.Min / CellSize);
+		// Vertices on the max border of a cell belong to it, so that the border vertices of a chunk don't get their own cells
+		Size = FVoxelUtilities::ComponentMax(FIntVector(1), FVoxelUtilities::CeilToInt(Bounds.Max / CellSize) - Min);
+	}
+
+	FORCEINLINE int32 Num() const
+	{
+		return Size.X * Size.Y * Size.Z;
+	}
+	FORCEINLINE FIntVector GetCell(const FVector& Position) const
+	{
+		return FVoxelUtilities::Clamp(FVoxelUtilities::FloorToInt(Position / CellSize) - Min, FIntVector(0), Size - 1);
+	}
+	FORCEINLINE int32 GetIndex(const FIntVector& Cell) const
+	{
+		return Cell.X + Size.X * Cell.Y + Size.X * Size.Y * Cell.Z;
+	}
+};
+
 class IVoxelAsyncPhysicsCooker : public FVoxelAsyncWork
 {
 public:
@@ -28,8 +65,11 @@ public:
 	const bool bCleanCollisionMesh;
 	const bool bSimpleCubicCollision;
 	const int32 NumConvexHullsPerAxis;
+	const float CollisionDecimationMaxError;
 	const TArray<TVoxelSharedPtr<const FVoxelProcMeshBuffers>> Buffers;
 	const FTransform LocalToRoot;
+	// The caches of the renderer, kept alive if it's destroyed while we're cooking
+	const TVoxelSharedRef<FVoxelCollisionCookingCaches> CookingCaches;
 
 	explicit IVoxelAsyncPhysicsCooker(UVoxelProceduralMeshComponent* Component);
 
@@ -42,6 +82,27 @@ protected:
 	virtual void CookMesh() = 0;
 	//~ End IVoxelAsyncPhysicsCooker Interface
 
+protected:
+	struct FDecimatedSection
+	{
+		TArray<FVector> Vertices;
+		TArray<uint32> Indices;
+	};
+	// Only filled by DecimateSections if CollisionDecimationMaxError > 0, in which case it has the same size as Buffers
+	// Must be used instead of the buffers to build the triangle meshes
+	TArray<FDecimatedSection> DecimatedSections;
+
+	// Must be called before building the triangle meshes from the buffers
+	void DecimateSections();
+	// In place. Does nothing if CollisionDecimationMaxError <= 0
+	void DecimateMesh(TArray<FVector>& Vertices, TArray<uint32>& Indices) const;
+
+	// Copies one of the chunk meshes merged in Buffer, with indices relative to its first vertex
+	static void GetChunkMesh(const FVoxelProcMeshBuffers& Buffer, const FVoxelProcMeshBuffersChunkRange& Range, TArray<FVector>& OutVertices, TArray<uint32>& OutIndices);
+	// Hash of the content of a chunk mesh, before decimation, and of the decimation settings
+	// Chunk meshes are rebuilt with new guids even when they didn't change, eg around an edit: their content is the same
+	FVoxelCollisionCookingCacheKey GetTriMeshCacheKey(const TArray<FVector>& Vertices, const TArray<uint32>& Indices) const;
+
 protected:
 	//~ Begin FVoxelAsyncWork Interface
 	virtual void DoWork() override;
@@ -1,6 +1,7 @@
 // Copyright 2020 Phyronnaz
 
 #include "VoxelRender/PhysicsCooker/VoxelAsyncPhysicsCooker_Chaos.h"
+#include "VoxelRender/PhysicsCooker/VoxelCollisionCookingCache.h"
 #include "VoxelRender/VoxelProcMeshBuffers.h"
 #include "VoxelUtilities/VoxelMathUtilities.h"
 
@@ -56,106 +57,99 @@ void FVoxelAsyncPhysicsCooker_Chaos::CookMesh()
 void FVoxelAsyncPhysicsCooker_Chaos::CreateTriMesh()
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
-				
-	int32 NumIndices = 0;
-	int32 NumVertices = 0;
+
+	// Chaos has no convex decomposition here: cache the triangle meshes instead
+	// One per merged chunk, so that the chunks of a cluster that an edit didn't change are found in the cache
+	auto& Cache = CookingCaches->TriMeshes;
+	
+	TArray<FVector> Vertices;
+	TArray<uint32> Indices;
 	for (auto& Buffer : Buffers)
 	{
-		NumIndices += Buffer->GetNumIndices();
-		NumVertices += Buffer->GetNumVertices();
+		TArray<FVoxelProcMeshBuffersChunkRange> ChunkRanges = Buffer->ChunkRanges;
+		if (ChunkRanges.Num() == 0 && Buffer->GetNumVertices() > 0)
+		{
+			ChunkRanges.Add({ 0, Buffer->GetNumVertices(), 0, Buffer->GetNumIndices() });
+		}
+		
+		for (auto& Range : ChunkRanges)
+		{
+			if (Range.NumIndices == 0)
+			{
+				continue;
+			}
+			
+			GetChunkMesh(*Buffer, Range, Vertices, Indices);
+
+			const FVoxelCollisionCookingCacheKey Key = GetTriMeshCacheKey(Vertices, Indices);
+			TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe> TriMesh;
+			if (!Cache.Find(Key, TriMesh))
+			{
+				DecimateMesh(Vertices, Indices);
+				TriMesh = BuildTriMesh(Vertices, Indices);
+				Cache.Add(Key, TriMesh);
+			}
+			TriMeshes.Add(TriMesh);
+		}
 	}
+}
 
+TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe> FVoxelAsyncPhysicsCooker_Chaos::BuildTriMesh(const TArray<FVector>& Vertices, const TArray<uint32>& Indices)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	
 	const auto Process = [&](auto& Triangles)
 	{
 		Chaos::TParticles<Chaos::FReal, 3> Particles;
 
 		{
-			VOXEL_ASYNC_SCOPE_COUNTER("Copy data from buffers");
+			VOXEL_ASYNC_SCOPE_COUNTER("Copy data");
 
 			{
 				VOXEL_ASYNC_SCOPE_COUNTER("Allocate");
-				ensure(NumIndices % 3 == 0);
-				Triangles.SetNumUninitialized(NumIndices / 3);
-				Particles.AddParticles(NumVertices);
+				ensure(Indices.Num() % 3 == 0);
+				Triangles.SetNumUninitialized(Indices.Num() / 3);
+				Particles.AddParticles(Vertices.Num());
 			}
 
-			int32 IndexIndex = 0;
-			int32 VertexIndex = 0;
-			for (int32 SectionIndex = 0; SectionIndex < Buffers.Num(); SectionIndex++)
+			for (int32 Index = 0; Index < Vertices.Num(); Index++)
 			{
-				auto& Buffer = *Buffers[SectionIndex];
-
-				const int32 VertexOffset = VertexIndex;
-
-				{
-					VOXEL_ASYNC_SCOPE_COUNTER("Copy vertices");
-					
-					auto& PositionBuffer = Buffer.VertexBuffers.PositionVertexBuffer;
-					for (uint32 Index = 0; Index < PositionBuffer.GetNumVertices(); Index++)
-					{
-						Particles.X(VertexIndex++) = PositionBuffer.VertexPosition(Index);
-					}
-				}
-
-				{
-					VOXEL_ASYNC_SCOPE_COUNTER("Copy triangles");
-					
-					auto& IndexBuffer = Buffer.IndexBuffer;
-
-					ensure(IndexBuffer.GetNumIndices() % 3 == 0);
-					const int32 NumTriangles = IndexBuffer.GetNumIndices() / 3;
-
-					const auto Lambda = [&](const auto* RESTRICT Data)
-					{
-						for (int32 Index = 0; Index < NumTriangles; Index++)
-						{
-							checkVoxelSlow(3 * Index + 2 < IndexBuffer.GetNumIndices());
-
-							const Chaos::TVector<int32, 3> Triangle{
-									int32(Data[3 * Index + 2]) + VertexOffset,
-									int32(Data[3 * Index + 1]) + VertexOffset,
-									int32(Data[3 * Index + 0]) + VertexOffset
-							};
-
-							FVoxelUtilities::Get(Triangles, IndexIndex++) = Triangle;
-
-	#if VOXEL_DEBUG
-							const auto A = Particles.X(Triangle.X);
-							const auto B = Particles.X(Triangle.Y);
-							const auto C = Particles.X(Triangle.Z);
-							ensure(Chaos::FConvexBuilder::IsValidTriangle(A, B, C));
-	#endif
-						}
-					};
-					if (IndexBuffer.Is32Bit())
-					{
-						Lambda(IndexBuffer.GetData_32());
-					}
-					else
-					{
-						Lambda(IndexBuffer.GetData_16());
-					}
-				}
+				Particles.X(Index) = Vertices[Index];
+			}
+
+			for (int32 Index = 0; Index < Triangles.Num(); Index++)
+			{
+				const Chaos::TVector<int32, 3> Triangle{
+						int32(Indices[3 * Index + 2]),
+						int32(Indices[3 * Index + 1]),
+						int32(Indices[3 * Index + 0])
+				};
+				FVoxelUtilities::Get(Triangles, Index) = Triangle;
+
+#if VOXEL_DEBUG
+				const auto A = Particles.X(Triangle.X);
+				const auto B = Particles.X(Triangle.Y);
+				const auto C = Particles.X(Triangle.Z);
+				ensure(Chaos::FConvexBuilder::IsValidTriangle(A, B, C));
+#endif
 			}
-			check(IndexIndex == Triangles.Num());
-			check(VertexIndex == Particles.Size());
 		}
 
 		TArray<uint16> MaterialIndices;
 		
 		VOXEL_ASYNC_SCOPE_COUNTER("Build Tri Mesh");
-		TriMeshes.Emplace(new Chaos::FTriangleMeshImplicitObject(MoveTemp(Particles), MoveTemp(Triangles), MoveTemp(MaterialIndices)));
+		return TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe>(new Chaos::FTriangleMeshImplicitObject(MoveTemp(Particles), MoveTemp(Triangles), MoveTemp(MaterialIndices)));
 	};
 	
-	if (NumVertices < TNumericLimits<uint16>::Max())
+	if (Vertices.Num() < TNumericLimits<uint16>::Max())
 	{
 		TArray<Chaos::TVector<uint16, 3>> TrianglesSmallIdx;
-		Process(TrianglesSmallIdx);
+		return Process(TrianglesSmallIdx);
 	}
 	else
 	{
 		TArray<Chaos::TVector<int32, 3>> TrianglesLargeIdx;
-		Process(TrianglesLargeIdx);
+		return Process(TrianglesLargeIdx);
 	}
 }
 #endif
\ No newline at end of file
@@ -32,6 +32,7 @@ protected:
 	
 private:
 	void CreateTriMesh();
+	static TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe> BuildTriMesh(const TArray<FVector>& Vertices, const TArray<uint32>& Indices);
 
 	TArray<TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe>> TriMeshes;
 };
@@ -1,6 +1,7 @@
 // Copyright 2020 Phyronnaz
 
 #include "VoxelRender/PhysicsCooker/VoxelAsyncPhysicsCooker_PhysX.h"
+#include "VoxelRender/PhysicsCooker/VoxelCollisionCookingCache.h"
 #include "VoxelRender/VoxelProcMeshBuffers.h"
 #include "VoxelRender/VoxelProceduralMeshComponent.h"
 #include "VoxelPhysXHelpers.h"
@@ -91,6 +92,8 @@ void FVoxelAsyncPhysicsCooker_PhysX::CreateTriMesh()
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
+	DecimateSections();
+
 	TArray<FVector> Vertices;
 	TArray<FTriIndices> Indices;
 	TArray<uint16> MaterialIndices;
@@ -102,10 +105,21 @@ void FVoxelAsyncPhysicsCooker_PhysX::CreateTriMesh()
 		{
 			int32 NumIndices = 0;
 			int32 NumVertices = 0;
-			for (auto& Buffer : Buffers)
+			if (DecimatedSections.Num() > 0)
+			{
+				for (auto& Section : DecimatedSections)
+				{
+					NumIndices += Section.Indices.Num();
+					NumVertices += Section.Vertices.Num();
+				}
+			}
+			else
 			{
-				NumIndices += Buffer->GetNumIndices();
-				NumVertices += Buffer->GetNumVertices();
+				for (auto& Buffer : Buffers)
+				{
+					NumIndices += Buffer->GetNumIndices();
+					NumVertices += Buffer->GetNumVertices();
+				}
 			}
 			VOXEL_ASYNC_SCOPE_COUNTER("Reserve");
 			Vertices.Reserve(NumVertices);
@@ -126,6 +140,28 @@ void FVoxelAsyncPhysicsCooker_PhysX::CreateTriMesh()
 #endif
 			};
 
+			if (DecimatedSections.Num() > 0)
+			{
+				VOXEL_ASYNC_SCOPE_COUNTER("Copy decimated section");
+
+				auto& Section = DecimatedSections[SectionIndex];
+				Vertices.Append(Section.Vertices);
+
+				const int32 NumTriangles = Section.Indices.Num() / 3;
+				for (int32 Index = 0; Index < NumTriangles; Index++)
+				{
+					FTriIndices TriIndices;
+					TriIndices.v0 = Section.Indices[3 * Index + 0] + VertexOffset;
+					TriIndices.v1 = Section.Indices[3 * Index + 1] + VertexOffset;
+					TriIndices.v2 = Section.Indices[3 * Index + 2] + VertexOffset;
+					Indices.Add(TriIndices);
+					MaterialIndices.Add(SectionIndex);
+				}
+
+				VertexOffset = Vertices.Num();
+				continue;
+			}
+
 			// Copy vertices
 			{
 				auto& PositionBuffer = Buffer.VertexBuffers.PositionVertexBuffer;
@@ -263,15 +299,11 @@ void FVoxelAsyncPhysicsCooker_PhysX::CreateSimpleCollision()
             }
         }
 
-        const int32 ChunkSize = RENDER_CHUNK_SIZE << LOD;
-        const FIntVector Size =
-            FVoxelUtilities::ComponentMax(
-                FIntVector(1),
-                FVoxelUtilities::CeilToInt(Box.GetSize() / ChunkSize * NumConvexHullsPerAxis));
+        const FVoxelConvexHullsGrid Grid(Box, RENDER_CHUNK_SIZE << LOD, NumConvexHullsPerAxis);
 
-        if (!ensure(Size.GetMax() <= 64)) return;
+        if (!ensure(Grid.Size.GetMax() <= 64)) return;
 
-        ConvexElems.SetNum(Size.X * Size.Y * Size.Z);
+        ConvexElems.SetNum(Grid.Num());
 
         for (auto& Buffer : Buffers)
         {
@@ -284,8 +316,7 @@ void FVoxelAsyncPhysicsCooker_PhysX::CreateSimpleCollision()
                 const auto Lambda = [&](int32 OffsetX, int32 OffsetY, int32 OffsetZ)
                 {
                     const FVector Offset = FVector(OffsetX, OffsetY, OffsetZ) * (1 << LOD); // 1 << LOD: should be max distance between the vertices
-                    FIntVector Position = FVoxelUtilities::FloorToInt((Vertex + Offset - Box.Min) / ChunkSize * NumConvexHullsPerAxis);
-                    Position = FVoxelUtilities::Clamp(Position, FIntVector(0), Size - 1);
+                    const FIntVector Position = Grid.GetCell(Vertex + Offset);
 
                     // Avoid adding too many duplicates by checking we're not in the center
                     if (OffsetX == 0 && OffsetY == 0 && OffsetZ == 0)
@@ -299,7 +330,7 @@ void FVoxelAsyncPhysicsCooker_PhysX::CreateSimpleCollision()
                             return;
                         }
                     }
-                    ConvexElems[Position.X + Size.X * Position.Y + Size.X * Size.Y * Position.Z].VertexData.Add(Vertex);
+                    ConvexElems[Grid.GetIndex(Position)].VertexData.Add(Vertex);
                 };
                 Lambda(0, 0, 0);
                 // Iterate possible neighbors to avoid holes between hulls
@@ -338,11 +369,27 @@ void FVoxelAsyncPhysicsCooker_PhysX::CreateSimpleCollision()
         }
 
 		// Finally, create the physx data
+		// Holds a reference to the meshes. Freed with the renderer, before PhysX is shut down
+		auto& Cache = CookingCaches->ConvexMeshes;
+		const EPhysXMeshCookFlags CookFlags = GetCookFlags();
 	    for (auto& Element : ConvexElems)
 	    {
-			VOXEL_ASYNC_SCOPE_COUNTER("CreateConvex");
             physx::PxConvexMesh*& Mesh = CookResult.SimpleCollisionData.ConvexMeshes.Add_GetRef(nullptr);
-		    const EPhysXCookingResult Result = PhysXCooking->CreateConvex(PhysXFormat, GetCookFlags(), Element.VertexData, Mesh);
+
+			FVoxelCollisionCookingCacheKey Key;
+			Key.Hash = FVoxelUtilities::MurmurHash64(FVoxelCollisionCookingCacheBase::HashVertexSet(Element.VertexData) ^ uint64(CookFlags));
+			Key.NumVertices = Element.VertexData.Num();
+			TVoxelSharedPtr<physx::PxConvexMesh> CachedMesh;
+			if (Cache.Find(Key, CachedMesh))
+			{
+				// Same as a newly cooked mesh, that has a reference owned by the cooker
+				Mesh = CachedMesh.Get();
+				Mesh->acquireReference();
+				continue;
+			}
+
+			VOXEL_ASYNC_SCOPE_COUNTER("CreateConvex");
+		    const EPhysXCookingResult Result = PhysXCooking->CreateConvex(PhysXFormat, CookFlags, Element.VertexData, Mesh);
 		    switch (Result)
 		    {
 		    case EPhysXCookingResult::Failed:
@@ -359,6 +406,12 @@ void FVoxelAsyncPhysicsCooker_PhysX::CreateSimpleCollision()
 		    case EPhysXCookingResult::Succeeded: break;
 		    default: ensure(false);
 		    }
+
+			if (Mesh && Result != EPhysXCookingResult::Failed)
+			{
+				Mesh->acquireReference();
+				Cache.Add(Key, MakeShareable(Mesh, [](physx::PxConvexMesh* MeshToRelease) { MeshToRelease->release(); }));
+			}
 	    }
 
 		// And update bounds
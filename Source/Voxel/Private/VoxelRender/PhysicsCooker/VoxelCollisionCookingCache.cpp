@@ -0,0 +1,42 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/PhysicsCooker/VoxelCollisionCookingCache.h"
+#include "VoxelUtilities/VoxelBaseUtilities.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Collision Cooking Cache Hits"), STAT_VoxelCollisionCookingCacheHits, STATGROUP_VoxelCounters);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Collision Cooking Cache Misses"), STAT_VoxelCollisionCookingCacheMisses, STATGROUP_VoxelCounters);
+
+static TAutoConsoleVariable<int32> CVarCookingCacheSize(
+	TEXT("voxel.collision.CookingCacheSize"),
+	4096,
+	TEXT("Max number of cooked convex hulls/triangle meshes to keep to avoid cooking them again when a chunk is edited. 0 to disable & clear the cache"),
+	ECVF_Default);
+
+int32 FVoxelCollisionCookingCacheBase::GetMaxNum()
+{
+	return CVarCookingCacheSize.GetValueOnAnyThread();
+}
+
+uint64 FVoxelCollisionCookingCacheBase::HashVertexSet(const TArray<FVector>& Vertices)
+{
+	uint64 Hash = 0;
+	for (const FVector& Vertex : Vertices)
+	{
+		const uint64 X = *reinterpret_cast<const uint32*>(&Vertex.X);
+		const uint64 Y = *reinterpret_cast<const uint32*>(&Vertex.Y);
+		const uint64 Z = *reinterpret_cast<const uint32*>(&Vertex.Z);
+		// Sum of the vertices hashes
+		Hash += FVoxelUtilities::MurmurHash64(FVoxelUtilities::MurmurHash64(X | (Y << 32)) ^ Z);
+	}
+	return FVoxelUtilities::MurmurHash64(Hash ^ uint64(Vertices.Num()));
+}
+
+void FVoxelCollisionCookingCacheBase::OnHit()
+{
+	INC_DWORD_STAT(STAT_VoxelCollisionCookingCacheHits);
+}
+
+void FVoxelCollisionCookingCacheBase::OnMiss()
+{
+	INC_DWORD_STAT(STAT_VoxelCollisionCookingCacheMisses);
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "Misc/ScopeLock.h"
+
+namespace physx
+{
+	class PxConvexMesh;
+}
+namespace Chaos
+{
+	class FTriangleMeshImplicitObject;
+}
+
+struct FVoxelCollisionCookingCacheKey
+{
+	uint64 Hash = 0;
+	// Compared on lookup so that a hash collision can't return a mesh of another size
+	int32 NumVertices = 0;
+	int32 NumIndices = 0;
+
+	bool operator==(const FVoxelCollisionCookingCacheKey& Other) const
+	{
+		return
+			Hash == Other.Hash &&
+			NumVertices == Other.NumVertices &&
+			NumIndices == Other.NumIndices;
+	}
+	friend uint32 GetTypeHash(const FVoxelCollisionCookingCacheKey& Key)
+	{
+		return uint32(Key.Hash);
+	}
+};
+
+class FVoxelCollisionCookingCacheBase
+{
+public:
+	// voxel.collision.CookingCacheSize
+	static int32 GetMaxNum();
+
+	// Order independent: the order of the vertices of a cell depends on the whole mesh
+	static uint64 HashVertexSet(const TArray<FVector>& Vertices);
+
+protected:
+	static void OnHit();
+	static void OnMiss();
+};
+
+/**
+ * Cooked collision objects, keyed by the data they were cooked from
+ * When a chunk is edited, the parts of its collision the edit didn't touch are found here instead of being cooked again
+ * Thread safe. The least recently used entries are removed once there are more than voxel.collision.CookingCacheSize
+ */
+template<typename T>
+class TVoxelCollisionCookingCache : public FVoxelCollisionCookingCacheBase
+{
+public:
+	bool Find(const FVoxelCollisionCookingCacheKey& Key, T& OutValue)
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		FScopeLock Lock(&Section);
+
+		if (GetMaxNum() <= 0)
+		{
+			Map.Empty();
+			return false;
+		}
+
+		FEntry* Entry = Map.Find(Key);
+		if (!Entry)
+		{
+			OnMiss();
+			return false;
+		}
+
+		Entry->LastUse = ++UseCounter;
+		OutValue = Entry->Value;
+		OnHit();
+		return true;
+	}
+	void Add(const FVoxelCollisionCookingCacheKey& Key, const T& Value)
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		const int32 MaxNum = GetMaxNum();
+		if (MaxNum <= 0)
+		{
+			return;
+		}
+
+		FScopeLock Lock(&Section);
+
+		Map.Add(Key, { Value, ++UseCounter });
+
+		if (Map.Num() > MaxNum)
+		{
+			// Remove a quarter at once so that the sort isn't done on every add
+			Trim(MaxNum - MaxNum / 4);
+		}
+	}
+
+private:
+	struct FEntry
+	{
+		T Value;
+		uint64 LastUse = 0;
+	};
+
+	FCriticalSection Section;
+	TMap<FVoxelCollisionCookingCacheKey, FEntry> Map;
+	uint64 UseCounter = 0;
+
+	void Trim(int32 NewNum)
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		TArray<uint64> LastUses;
+		LastUses.Reserve(Map.Num());
+		for (auto& It : Map)
+		{
+			LastUses.Add(It.Value.LastUse);
+		}
+		LastUses.Sort();
+
+		const uint64 Threshold = LastUses[FMath::Max(LastUses.Num() - NewNum, 0)];
+		for (auto It = Map.CreateIterator(); It; ++It)
+		{
+			if (It.Value().LastUse < Threshold)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+};
+
+/**
+ * The caches of a renderer, owned by its physics callback handler: the cooked objects are freed with the world
+ * instead of living until the process exits
+ */
+struct FVoxelCollisionCookingCaches
+{
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	TVoxelCollisionCookingCache<TVoxelSharedPtr<physx::PxConvexMesh>> ConvexMeshes;
+#endif
+#if WITH_CHAOS
+	TVoxelCollisionCookingCache<TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe>> TriMeshes;
+#endif
+};
\ No newline at end of file
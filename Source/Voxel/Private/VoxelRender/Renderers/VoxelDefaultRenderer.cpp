@@ -2,6 +2,7 @@
 
 #include "VoxelDefaultRenderer.h"
 #include "VoxelMessages.h"
+#include "VoxelLatencyStats.h"
 #include "IVoxelPool.h"
 #include "VoxelRender/VoxelMesherAsyncWork.h"
 #include "VoxelRender/Renderers/VoxelRendererMeshHandler.h"
@@ -23,6 +24,12 @@ static TAutoConsoleVariable<int32> CVarFreezeRenderer(
 	TEXT("Stops renderer tick"),
 	ECVF_Default);
 
+static TAutoConsoleVariable<float> CVarMeshUpdatesHistogramInterval(
+	TEXT("voxel.renderer.MeshUpdatesHistogramInterval"),
+	0,
+	TEXT("If > 0, every renderer will log a histogram of the game thread time spent applying mesh updates every this many seconds"),
+	ECVF_Default);
+
 FVoxelDefaultRenderer::FVoxelDefaultRenderer(const FVoxelRendererSettings& Settings)
 	: IVoxelRenderer(Settings)
 	, MeshHandler(Settings.bMergeChunks ? Settings.bDoNotMergeCollisionsAndNavmesh
@@ -102,6 +109,7 @@ int32 FVoxelDefaultRenderer::UpdateChunks(
 	{
 		auto& Chunk = ChunksMap.FindChecked(ChunkId);
 		Chunk.PendingUpdates.Add({ Time, FinishDelegate });
+		Chunk.EmptyStateCache->Invalidate();
 		// Trigger tasks if not already triggered: if they are, they will trigger new ones when their callback will be processed in Tick
 		StartTask<EMainOrTransitions::Main, EIfTaskExists::DoNothing>(Chunk);
 		StartTask<EMainOrTransitions::Transitions, EIfTaskExists::DoNothing>(Chunk);
@@ -374,6 +382,11 @@ void FVoxelDefaultRenderer::UpdateLODs(const uint64 InUpdateIndex, const TArray<
 
 				// Set UpdateIndex as we are being showed
 				Chunk.UpdateIndex = UpdateIndex;
+
+				if (!Chunk.BuiltData.MainChunk.IsValid())
+				{
+					Chunk.VisibleRequestTime = FPlatformTime::Seconds();
+				}
 				
 				Chunk.SetState(Settings.bDitherChunks ? EChunkState::DitheringIn : EChunkState::Showed, STATIC_FNAME("Turned visible"));
 				if (!Chunk.MeshId.IsValid())
@@ -700,6 +713,13 @@ void FVoxelDefaultRenderer::CreateGeometry_AnyThread(
 	FVoxelMesherAsyncWork::CreateGeometry_AnyThread(*this, LOD, ChunkPosition, OutIndices, OutVertices);
 }
 
+bool FVoxelDefaultRenderer::IsChunkMeshed(uint64 ChunkId) const
+{
+	check(IsInGameThread());
+	const FChunk* Chunk = ChunksMap.Find(ChunkId);
+	return Chunk && Chunk->BuiltData.MainChunkCreationTime > 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -722,7 +742,31 @@ void FVoxelDefaultRenderer::Tick(float)
 	}
 	
 	ProcessChunksToRemoveOrShow();
-	ProcessMeshUpdates(MaxTime);
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const int32 NumCallbacks = TasksCallbacksQueue.Num();
+		
+		ProcessMeshUpdates(MaxTime);
+		
+		const double EndTime = FPlatformTime::Seconds();
+		MeshUpdatesHistogram.Add(EndTime - StartTime, FMath::Max(0, NumCallbacks - TasksCallbacksQueue.Num()), EndTime > MaxTime && !TasksCallbacksQueue.IsEmpty());
+
+		const float HistogramInterval = CVarMeshUpdatesHistogramInterval.GetValueOnGameThread();
+		if (HistogramInterval <= 0)
+		{
+			MeshUpdatesHistogram = {};
+		}
+		else if (MeshUpdatesHistogram.StartTime == 0)
+		{
+			MeshUpdatesHistogram.StartTime = EndTime;
+		}
+		else if (EndTime - MeshUpdatesHistogram.StartTime > HistogramInterval)
+		{
+			LOG_VOXEL(Log, TEXT("Mesh updates: %s"), *MeshUpdatesHistogram.ToString());
+			MeshUpdatesHistogram = {};
+			MeshUpdatesHistogram.StartTime = EndTime;
+		}
+	}
 	FlushQueuedTasks();
 
 	if (!OnWorldLoadedFired && UpdateIndex > 0 && TaskCount.GetValue() == 0 && TasksCallbacksQueue.IsEmpty())
@@ -804,7 +848,9 @@ void FVoxelDefaultRenderer::StartTask(FChunk& Chunk)
 		Chunk.LOD,
 		Chunk.Bounds,
 		MainOrTransitions == EMainOrTransitions::Transitions,
-		MainOrTransitions == EMainOrTransitions::Transitions ? Chunk.Settings.TransitionsMask : 0));
+		MainOrTransitions == EMainOrTransitions::Transitions ? Chunk.Settings.TransitionsMask : 0,
+		GetCallbackPriority(Chunk.Settings),
+		MainOrTransitions == EMainOrTransitions::Main ? Chunk.EmptyStateCache : TVoxelSharedPtr<FVoxelChunkEmptyStateCache>()));
 	QueuedTasks[Chunk.Settings.bVisible][Chunk.Settings.bEnableCollisions].Emplace(Task.Get());
 }
 
@@ -1205,6 +1251,12 @@ void FVoxelDefaultRenderer::ProcessMeshUpdates(double MaxTime)
 		// Do nothing while the main chunk isn't valid - we don't want to have unneeded updates for transitions then main
 		if (BuiltData.MainChunk.IsValid())
 		{
+			if (Chunk->VisibleRequestTime != 0)
+			{
+				FVoxelLatencyStats::Get().ReportChunkLatency(FPlatformTime::Seconds() - Chunk->VisibleRequestTime);
+				Chunk->VisibleRequestTime = 0;
+			}
+
 			auto& MeshId = Chunk->MeshId;
 			const auto Update = [&]()
 			{
@@ -1354,8 +1406,75 @@ void FVoxelDefaultRenderer::CancelTask(TUniquePtr<FVoxelMesherAsyncWork, TVoxelA
 	}
 }
 
-void FVoxelDefaultRenderer::QueueChunkCallback_AnyThread(uint64 TaskId, uint64 ChunkId, bool bIsTransitionTask)
+void FVoxelDefaultRenderer::QueueChunkCallback_AnyThread(uint64 TaskId, uint64 ChunkId, bool bIsTransitionTask, uint8 CallbackPriority)
 {
 	ensure(TaskCount.Decrement() >= 0);
-	TasksCallbacksQueue.Enqueue({TaskId, ChunkId, bIsTransitionTask});
+	TasksCallbacksQueue.Enqueue({TaskId, ChunkId, bIsTransitionTask}, CallbackPriority);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDefaultRenderer::FTasksCallbacksQueue::Enqueue(const FVoxelTaskCallback& Callback, uint8 Priority)
+{
+	check(Priority < NumCallbackPriorities);
+	
+	// Increment first so that Num is never below the actual number of callbacks
+	QueueNum.Increment();
+	if (!Rings[Priority].Enqueue(Callback))
+	{
+		Overflows[Priority].Enqueue(Callback);
+	}
+}
+
+bool FVoxelDefaultRenderer::FTasksCallbacksQueue::Dequeue(FVoxelTaskCallback& OutCallback)
+{
+	for (int32 Priority = NumCallbackPriorities - 1; Priority >= 0; Priority--)
+	{
+		if (Rings[Priority].Dequeue(OutCallback) || Overflows[Priority].Dequeue(OutCallback))
+		{
+			ensure(QueueNum.Decrement() >= 0);
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelDefaultRenderer::FMeshUpdatesHistogram::Add(double Time, int32 InNumCallbacks, bool bOverBudget)
+{
+	const uint32 Microseconds = uint32(FMath::Min(Time * 1e6, double(MAX_uint32)));
+	Buckets[FMath::Min<uint32>(FMath::FloorLog2(Microseconds), NumBuckets - 1)]++;
+	
+	NumCalls++;
+	NumCallbacks += InNumCallbacks;
+	NumOverBudget += bOverBudget;
+	TotalTime += Time;
+	MaxTime = FMath::Max(MaxTime, Time);
+}
+
+FString FVoxelDefaultRenderer::FMeshUpdatesHistogram::ToString() const
+{
+	FString String = FString::Printf(
+		TEXT("%u calls, %u callbacks processed, %u over budget, average %.3fms, max %.3fms; "),
+		NumCalls,
+		NumCallbacks,
+		NumOverBudget,
+		NumCalls > 0 ? TotalTime / NumCalls * 1000 : 0.,
+		MaxTime * 1000);
+
+	for (int32 Index = 0; Index < NumBuckets; Index++)
+	{
+		if (Buckets[Index] > 0)
+		{
+			String += Index == NumBuckets - 1
+				? FString::Printf(TEXT(">=%uus: %u"), 1u << Index, Buckets[Index])
+				: FString::Printf(TEXT("<%uus: %u; "), 2u << Index, Buckets[Index]);
+		}
+	}
+	return String;
 }
\ No newline at end of file
@@ -8,7 +8,8 @@
 #include "VoxelRender/VoxelChunkToUpdate.h"
 #include "VoxelRendererMeshHandler.h"
 #include "VoxelTickable.h"
-#include "VoxelQueueWithNum.h"
+#include "VoxelBoundedMpscQueue.h"
+#include "Containers/Queue.h"
 
 struct FVoxelChunkMesh;
 
@@ -42,6 +43,8 @@ public:
 		const FIntVector& ChunkPosition,
 		TArray<uint32>& OutIndices,
 		TArray<FVector>& OutVertices) const override;
+
+	virtual bool IsChunkMeshed(uint64 ChunkId) const override;
 	//~ End IVoxelRender Interface
 
 	//~ Begin FVoxelTickable Interface
@@ -121,6 +124,9 @@ private:
 		};
 		FChunkBuiltData BuiltData;
 
+		// Whether the main mesher found the chunk empty, shared with its tasks
+		const TVoxelSharedRef<FVoxelChunkEmptyStateCache> EmptyStateCache = MakeVoxelShared<FVoxelChunkEmptyStateCache>();
+
 		IVoxelRendererMeshHandler::FChunkId MeshId;
 
 		// Settings to be applied once eg new chunks are spawned
@@ -147,6 +153,9 @@ private:
 		// This is needed to track if chunks in PreviousChunks are still valid and haven't been switched back to Show
 		// Else we'd be decreasing a wrong NumNewChunksLeft
 		uint64 UpdateIndex = 0;
+
+		// Time at which the chunk was turned visible without a mesh, for FVoxelLatencyStats::ReportChunkLatency. 0 if none
+		double VisibleRequestTime = 0;
 	};
 	TMap<uint64, FChunk> ChunksMap;
 
@@ -206,7 +215,14 @@ private:
 	void UpdateAllocatedSize();
 
 public:
-	void QueueChunkCallback_AnyThread(uint64 TaskId, uint64 ChunkId, bool bIsTransitionTask);
+	// Callbacks with a higher priority are processed first
+	static constexpr int32 NumCallbackPriorities = 4;
+	static uint8 GetCallbackPriority(const FVoxelChunkSettings& ChunkSettings)
+	{
+		return 2 * ChunkSettings.bVisible + ChunkSettings.bEnableCollisions;
+	}
+	
+	void QueueChunkCallback_AnyThread(uint64 TaskId, uint64 ChunkId, bool bIsTransitionTask, uint8 CallbackPriority);
 
 private:
 	struct FVoxelTaskCallback
@@ -215,7 +231,49 @@ private:
 		uint64 ChunkId;
 		bool bIsTransitionTask;
 	};
-	TVoxelQueueWithNum<FVoxelTaskCallback, EQueueMode::Mpsc> TasksCallbacksQueue;
+	// Mesher threads to game thread. Doesn't allocate unless a ring is full
+	class FTasksCallbacksQueue
+	{
+	public:
+		void Enqueue(const FVoxelTaskCallback& Callback, uint8 Priority);
+		bool Dequeue(FVoxelTaskCallback& OutCallback);
+		
+		int32 Num() const
+		{
+			return QueueNum.GetValue();
+		}
+		bool IsEmpty() const
+		{
+			return Num() == 0;
+		}
+
+	private:
+		FThreadSafeCounter QueueNum;
+		TVoxelBoundedMpscQueue<FVoxelTaskCallback, 1024> Rings[NumCallbackPriorities];
+		// Used when the ring of the priority is full
+		TQueue<FVoxelTaskCallback, EQueueMode::Mpsc> Overflows[NumCallbackPriorities];
+	};
+	FTasksCallbacksQueue TasksCallbacksQueue;
+
+	// Game thread time spent in ProcessMeshUpdates, see voxel.renderer.MeshUpdatesHistogramInterval
+	struct FMeshUpdatesHistogram
+	{
+		// Bucket N: [2^N, 2^(N+1)[ microseconds, the first one including 0 and the last one everything above
+		static constexpr int32 NumBuckets = 16;
+		
+		uint32 Buckets[NumBuckets] = {};
+		uint32 NumCalls = 0;
+		uint32 NumCallbacks = 0;
+		// Calls that were still processing when the budget ran out
+		uint32 NumOverBudget = 0;
+		double TotalTime = 0;
+		double MaxTime = 0;
+		double StartTime = 0;
+
+		void Add(double Time, int32 InNumCallbacks, bool bOverBudget);
+		FString ToString() const;
+	};
+	FMeshUpdatesHistogram MeshUpdatesHistogram;
 
 	void CancelTask(TUniquePtr<FVoxelMesherAsyncWork, TVoxelAsyncWorkDelete<FVoxelMesherAsyncWork>>& Task);
 };
\ No newline at end of file
@@ -18,15 +18,19 @@ FVoxelMesherAsyncWork::FVoxelMesherAsyncWork(
 	const int32 LOD,
 	const FVoxelIntBox& Bounds,
 	const bool bIsTransitionTask,
-	const uint8 TransitionsMask)
+	const uint8 TransitionsMask,
+	const uint8 CallbackPriority,
+	const TVoxelSharedPtr<FVoxelChunkEmptyStateCache>& EmptyStateCache)
 	: FVoxelAsyncWork(STATIC_FNAME("FVoxelMesherAsyncWork"), Renderer.Settings.PriorityDuration)
 	, ChunkId(ChunkId)
 	, LOD(LOD)
 	, ChunkPosition(Bounds.Min)
 	, bIsTransitionTask(bIsTransitionTask)
 	, TransitionsMask(TransitionsMask)
+	, CallbackPriority(CallbackPriority)
 	, Renderer(Renderer.AsShared())
 	, PriorityHandler(Bounds, Renderer.GetInvokersPositionsForPriorities())
+	, EmptyStateCache(EmptyStateCache)
 {
 	check(IsInGameThread());
 	ensure(!bIsTransitionTask || TransitionsMask != 0);
@@ -70,6 +74,7 @@ void FVoxelMesherAsyncWork::DoWork()
 		ChunkPosition,
 		bIsTransitionTask,
 		TransitionsMask);
+	Mesher->EmptyStateCache = EmptyStateCache;
 
 	CreationTime = FPlatformTime::Seconds();
 
@@ -112,7 +117,7 @@ void FVoxelMesherAsyncWork::PostDoWork()
 	auto RendererPtr = Renderer.Pin();
 	if (ensure(RendererPtr.IsValid()))
 	{
-		RendererPtr->QueueChunkCallback_AnyThread(TaskId, ChunkId, bIsTransitionTask);
+		RendererPtr->QueueChunkCallback_AnyThread(TaskId, ChunkId, bIsTransitionTask, CallbackPriority);
 		FVoxelUtilities::DeleteOnGameThread_AnyThread(RendererPtr);
 	}
 }
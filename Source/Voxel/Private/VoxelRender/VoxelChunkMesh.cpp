@@ -2,6 +2,8 @@
 
 #include "VoxelRender/VoxelChunkMesh.h"
 #include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelRender/VoxelMeshDecimation.h"
+#include "VoxelRender/VoxelMeshOptimization.h"
 #include "VoxelData/VoxelDataIncludes.h"
 #include "VoxelUtilities/VoxelDistanceFieldUtilities.h"
 
@@ -12,12 +14,14 @@
 #include "ThirdParty/nvtesslib/inc/nvtess.h"
 #endif
 
-#if ENABLE_OPTIMIZE_INDICES
-#include "ThirdParty/ForsythTriOO/Src/forsythtriangleorderoptimizer.h"
-#endif
-
 DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelChunkMeshMemory);
 
+static TAutoConsoleVariable<int32> CVarDistanceFieldUseJumpFlood(
+	TEXT("voxel.renderer.DistanceFieldUseJumpFlood"),
+	0,
+	TEXT("If true, will use jump flooding to compute the chunks distance fields instead of the exact distance transform"),
+	ECVF_Default);
+
 #if ENABLE_TESSELLATION
 /**
 * Provides static mesh render data to the NVIDIA tessellation library.
@@ -68,7 +72,17 @@ void FVoxelChunkMeshBuffers::BuildAdjacency(TArray<uint32>& OutAdjacencyIndices)
 #if ENABLE_TESSELLATION
 	if (Indices.Num())
 	{
-		FVoxelStaticMeshNvRenderBuffer StaticMeshRenderBuffer(Positions, Indices);
+		TArray<FVector> UnpackedPositions;
+		if (IsPacked())
+		{
+			UnpackedPositions.Reserve(GetNumVertices());
+			for (int32 Index = 0; Index < GetNumVertices(); Index++)
+			{
+				UnpackedPositions.Add(GetPosition(Index));
+			}
+		}
+		
+		FVoxelStaticMeshNvRenderBuffer StaticMeshRenderBuffer(IsPacked() ? UnpackedPositions : Positions, Indices);
 		nv::IndexBuffer* PnAENIndexBuffer = nv::tess::buildTessellationBuffer(&StaticMeshRenderBuffer, nv::DBM_PnAenDominantCorner, true);
 		check(PnAENIndexBuffer);
 		const int32 IndexCount = int32(PnAENIndexBuffer->getLength());
@@ -91,17 +105,70 @@ void FVoxelChunkMeshBuffers::BuildAdjacency(TArray<uint32>& OutAdjacencyIndices)
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+void FVoxelChunkMeshBuffers::Decimate(int32 LOD, float MaxError)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	check(!IsPacked());
+
+	if (Indices.Num() == 0 || TextureData.Num() > 0)
+	{
+		// Greedy meshes are already minimal, and their texture data is per quad
+		return;
+	}
+
+	const int32 Step = 1 << LOD;
+
+	// Same bounds as FVoxelMesherUtilities::GetTranslatedTransvoxel
+	const float LowerBound = Step;
+	const float UpperBound = (RENDER_CHUNK_SIZE - 1) * Step;
+
+	TBitArray<> LockedVertices(false, Positions.Num());
+	for (int32 Index = 0; Index < Positions.Num(); Index++)
+	{
+		const FVector& Position = Positions[Index];
+		if (Position.X < LowerBound || Position.X > UpperBound ||
+			Position.Y < LowerBound || Position.Y > UpperBound ||
+			Position.Z < LowerBound || Position.Z > UpperBound)
+		{
+			LockedVertices[Index] = true;
+		}
+	}
+
+	FVoxelMeshDecimation::FSettings DecimationSettings;
+	DecimationSettings.MaxError = MaxError * Step;
+
+	TArray<int32> VertexRemap;
+	const int32 NewNumVertices = FVoxelMeshDecimation::Decimate(Indices, Positions, LockedVertices, DecimationSettings, VertexRemap);
+
+	FVoxelMeshDecimation::ApplyVertexRemap(Positions, VertexRemap, NewNumVertices);
+	FVoxelMeshDecimation::ApplyVertexRemap(Normals, VertexRemap, NewNumVertices);
+	FVoxelMeshDecimation::ApplyVertexRemap(Tangents, VertexRemap, NewNumVertices);
+	FVoxelMeshDecimation::ApplyVertexRemap(Colors, VertexRemap, NewNumVertices);
+	for (auto& T : TextureCoordinates) FVoxelMeshDecimation::ApplyVertexRemap(T, VertexRemap, NewNumVertices);
+}
+
 void FVoxelChunkMeshBuffers::OptimizeIndices()
 {
-#if ENABLE_OPTIMIZE_INDICES
 	VOXEL_ASYNC_FUNCTION_COUNTER();
-	
-	TArray<uint32> OptimizedIndices;
-	OptimizedIndices.AddUninitialized(Indices.Num());
-	const uint16 CacheSize = 32;
-	Forsyth::OptimizeFaces(Indices.GetData(), Indices.Num(), GetNumVertices(), OptimizedIndices.GetData(), CacheSize);
-	Indices = MoveTemp(OptimizedIndices);
-#endif
+	check(!IsPacked());
+
+	if (Indices.Num() == 0)
+	{
+		return;
+	}
+
+	FVoxelMeshOptimization::OptimizeVertexCache(Indices, GetNumVertices());
+	// Allow the ACMR to get 5% worse for better overdraw
+	FVoxelMeshOptimization::OptimizeOverdraw(Indices, Positions, 1.05f);
+
+	TArray<int32> VertexRemap;
+	const int32 NewNumVertices = FVoxelMeshOptimization::OptimizeVertexFetch(Indices, GetNumVertices(), VertexRemap);
+
+	FVoxelMeshOptimization::RemapVertices(Positions, VertexRemap, NewNumVertices);
+	FVoxelMeshOptimization::RemapVertices(Normals, VertexRemap, NewNumVertices);
+	FVoxelMeshOptimization::RemapVertices(Tangents, VertexRemap, NewNumVertices);
+	FVoxelMeshOptimization::RemapVertices(Colors, VertexRemap, NewNumVertices);
+	for (auto& T : TextureCoordinates) FVoxelMeshOptimization::RemapVertices(T, VertexRemap, NewNumVertices);
 }
 
 void FVoxelChunkMeshBuffers::Shrink()
@@ -124,6 +191,138 @@ void FVoxelChunkMeshBuffers::ComputeBounds()
 	}
 }
 
+void FVoxelChunkMeshBuffers::Pack(int32 LOD, bool bHalfPrecisionTextureCoordinates)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	if (IsPacked() || Positions.Num() == 0 || Normals.Num() != Positions.Num() || Tangents.Num() != Positions.Num())
+	{
+		return;
+	}
+
+	const int32 Step = 1 << LOD;
+	const float Scale = float(FVoxelPackedChunkVertex::PositionPrecision) / Step;
+
+	TArray<FVoxelPackedChunkVertex> NewPackedVertices;
+	NewPackedVertices.Empty(Positions.Num());
+	NewPackedVertices.SetNumUninitialized(Positions.Num());
+
+	const auto PackUnitVector = [](const FVector& Vector, int16* RESTRICT OutPacked)
+	{
+		const FVector2D Octahedron = FVoxelUtilities::UnitVectorToOctahedron(Vector);
+		OutPacked[0] = FMath::RoundToInt(FMath::Clamp(Octahedron.X, -1.f, 1.f) * MAX_int16);
+		OutPacked[1] = FMath::RoundToInt(FMath::Clamp(Octahedron.Y, -1.f, 1.f) * MAX_int16);
+	};
+
+	for (int32 Index = 0; Index < Positions.Num(); Index++)
+	{
+		FVoxelPackedChunkVertex& Vertex = NewPackedVertices[Index];
+
+		const FVector Position = Positions[Index] * Scale + FVoxelPackedChunkVertex::PositionOffset;
+		if (!(0 <= Position.GetMin() && Position.GetMax() <= MAX_uint16))
+		{
+			// Keep the full precision buffers. Also catches NaNs
+			return;
+		}
+		Vertex.Position[0] = FMath::RoundToInt(Position.X);
+		Vertex.Position[1] = FMath::RoundToInt(Position.Y);
+		Vertex.Position[2] = FMath::RoundToInt(Position.Z);
+
+		PackUnitVector(Normals[Index], Vertex.Normal);
+		PackUnitVector(Tangents[Index].TangentX, Vertex.Tangent);
+		Vertex.Flags = Tangents[Index].bFlipTangentY ? 0x1 : 0x0;
+	}
+
+	PackedVertices = MoveTemp(NewPackedVertices);
+	PackedStep = Step;
+
+	Positions.Empty();
+	Normals.Empty();
+	Tangents.Empty();
+
+	if (bHalfPrecisionTextureCoordinates)
+	{
+		PackedTextureCoordinates.SetNum(TextureCoordinates.Num());
+		for (int32 Channel = 0; Channel < TextureCoordinates.Num(); Channel++)
+		{
+			const TArray<FVector2D>& Source = TextureCoordinates[Channel];
+			TArray<FVector2DHalf>& Destination = PackedTextureCoordinates[Channel];
+
+			Destination.Empty(Source.Num());
+			for (const FVector2D& TextureCoordinate : Source)
+			{
+				Destination.Emplace(TextureCoordinate);
+			}
+		}
+		TextureCoordinates.Empty();
+	}
+
+	UpdateStats();
+}
+
+template<typename T>
+inline void SerializeRawArray(FArchive& Ar, TArray<T>& Array)
+{
+	int32 Num = Array.Num();
+	Ar << Num;
+	if (Ar.IsLoading())
+	{
+		// Don't trust the size if the file is corrupted
+		if (Num < 0 || int64(Num) * sizeof(T) > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return;
+		}
+		Array.Empty(Num);
+		Array.SetNumUninitialized(Num);
+	}
+	Ar.Serialize(Array.GetData(), Num * sizeof(T));
+}
+
+template<typename T>
+inline void SerializeRawArrays(FArchive& Ar, TArray<TArray<T>>& Arrays)
+{
+	int32 Num = Arrays.Num();
+	Ar << Num;
+	if (Ar.IsLoading())
+	{
+		if (Num < 0 || Num > 256)
+		{
+			Ar.SetError();
+			return;
+		}
+		Arrays.SetNum(Num);
+	}
+	for (auto& Array : Arrays)
+	{
+		SerializeRawArray(Ar, Array);
+	}
+}
+
+void FVoxelChunkMeshBuffers::Serialize(FArchive& Ar)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	
+	SerializeRawArray(Ar, Indices);
+	SerializeRawArray(Ar, Positions);
+	SerializeRawArray(Ar, Normals);
+	SerializeRawArray(Ar, Tangents);
+	SerializeRawArray(Ar, Colors);
+	SerializeRawArrays(Ar, TextureCoordinates);
+	SerializeRawArray(Ar, TextureData);
+	SerializeRawArray(Ar, CollisionCubes);
+	SerializeRawArray(Ar, PackedVertices);
+	SerializeRawArrays(Ar, PackedTextureCoordinates);
+	Ar << Bounds;
+	Ar << PackedStep;
+
+	if (Ar.IsLoading())
+	{
+		Guid = FGuid::NewGuid();
+		UpdateStats();
+	}
+}
+
 void FVoxelChunkMeshBuffers::UpdateStats()
 {
 	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelChunkMeshMemory, LastAllocatedSize);
@@ -135,6 +334,8 @@ void FVoxelChunkMeshBuffers::UpdateStats()
 	for (auto& T : TextureCoordinates) LastAllocatedSize += T.GetAllocatedSize();
 	LastAllocatedSize += TextureData.GetAllocatedSize();
 	LastAllocatedSize += CollisionCubes.GetAllocatedSize();
+	LastAllocatedSize += PackedVertices.GetAllocatedSize();
+	for (auto& T : PackedTextureCoordinates) LastAllocatedSize += T.GetAllocatedSize();
 	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelChunkMeshMemory, LastAllocatedSize);
 }
 
@@ -142,7 +343,79 @@ void FVoxelChunkMeshBuffers::UpdateStats()
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position, const FVoxelData& Data, const FVoxelRendererSettingsBase& Settings)
+void FVoxelChunkMesh::Serialize(FArchive& Ar)
+{
+	Ar << bSingleBuffers;
+
+	if (bSingleBuffers)
+	{
+		if (Ar.IsLoading())
+		{
+			SingleBuffers = MakeVoxelShared<FVoxelChunkMeshBuffers>();
+		}
+		check(SingleBuffers.IsValid());
+		SingleBuffers->Serialize(Ar);
+		return;
+	}
+
+	int32 Num = Map.Num();
+	Ar << Num;
+	
+	const auto SerializeIndices = [&](FVoxelMaterialIndices& Indices)
+	{
+		Ar << Indices.NumIndices;
+		for (uint8& Index : Indices.SortedIndices)
+		{
+			Ar << Index;
+		}
+	};
+
+	if (Ar.IsLoading())
+	{
+		Map.Empty(FMath::Clamp(Num, 0, 256));
+		for (int32 Index = 0; Index < Num && !Ar.IsError(); Index++)
+		{
+			FVoxelMaterialIndices Indices;
+			SerializeIndices(Indices);
+			if (Indices.NumIndices > Indices.SortedIndices.Num())
+			{
+				Ar.SetError();
+				break;
+			}
+
+			auto Buffers = MakeVoxelShared<FVoxelChunkMeshBuffers>();
+			Buffers->Serialize(Ar);
+			Map.Add(Indices, Buffers);
+		}
+	}
+	else
+	{
+		for (auto& It : Map)
+		{
+			FVoxelMaterialIndices Indices = It.Key;
+			SerializeIndices(Indices);
+			It.Value->Serialize(Ar);
+		}
+	}
+}
+
+FVoxelIntBox FVoxelChunkMesh::GetDistanceFieldValuesBounds(int32 LOD, const FIntVector& Position, const FVoxelRendererSettingsBase& Settings)
+{
+	const int32 Extension = Settings.DistanceFieldBoundsExtension;
+	const int32 HighResSize = RENDER_CHUNK_SIZE + 1 + 2 * Extension;
+	const int32 Step = 1 << LOD;
+	
+	const FIntVector Start = Position - Extension * Step;
+	return FVoxelIntBox(Start, Start + HighResSize * Step).Extend(Step); // Extend: See GetSurfacePositionsFromDensities
+}
+
+void FVoxelChunkMesh::BuildDistanceField(
+	int32 LOD,
+	const FIntVector& Position,
+	const FVoxelData& Data,
+	const FVoxelRendererSettingsBase& Settings,
+	const FVoxelIntBox& CachedValuesBounds,
+	const FVoxelValue* CachedValues)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 	
@@ -168,12 +441,45 @@ void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position,
 		Values.Empty(NumValues);
 		Values.SetNumUninitialized(NumValues);
 		{
-			const FIntVector Start = Position - Extension * Step;
-			const FVoxelIntBox Bounds = FVoxelIntBox(Start, Start + HighResSize * Step).Extend(Step); // Extend: See GetSurfacePositionsFromDensities
+			const FVoxelIntBox Bounds = GetDistanceFieldValuesBounds(LOD, Position, Settings);
+			check(Bounds.Size() == FIntVector(ValuesSize * Step));
 
-			FVoxelReadScopeLock Lock(Data, Bounds, FUNCTION_FNAME);
 			TVoxelQueryZone<FVoxelValue> QueryZone(Bounds, FIntVector(ValuesSize), LOD, Values);
-			Data.Get<FVoxelValue>(QueryZone, LOD);
+
+			const FVoxelIntBox ReusedBounds = CachedValues && CachedValuesBounds.Intersect(Bounds) ? CachedValuesBounds.Overlap(Bounds) : FVoxelIntBox();
+			if (ReusedBounds.IsValid())
+			{
+				VOXEL_ASYNC_SCOPE_COUNTER("Copy Cached Values");
+				check(CachedValuesBounds.IsMultipleOf(Step));
+				
+				const FIntVector CachedValuesSize = CachedValuesBounds.Size() / Step;
+				for (int32 Z = ReusedBounds.Min.Z; Z < ReusedBounds.Max.Z; Z += Step)
+				{
+					for (int32 Y = ReusedBounds.Min.Y; Y < ReusedBounds.Max.Y; Y += Step)
+					{
+						for (int32 X = ReusedBounds.Min.X; X < ReusedBounds.Max.X; X += Step)
+						{
+							const FIntVector LocalPosition = (FIntVector(X, Y, Z) - CachedValuesBounds.Min) / Step;
+							QueryZone.Set(X, Y, Z, CachedValues[FVoxelUtilities::Get3DIndex(CachedValuesSize, LocalPosition)]);
+						}
+					}
+				}
+			}
+
+			if (!ReusedBounds.IsValid())
+			{
+				FVoxelReadScopeLock Lock(Data, Bounds, FUNCTION_FNAME);
+				Data.Get<FVoxelValue>(QueryZone, LOD);
+			}
+			else if (ReusedBounds != Bounds)
+			{
+				FVoxelReadScopeLock Lock(Data, Bounds, FUNCTION_FNAME);
+				for (auto& SubBounds : Bounds.Difference(ReusedBounds))
+				{
+					auto SubQueryZone = QueryZone.ShrinkTo(SubBounds);
+					Data.Get<FVoxelValue>(SubQueryZone, LOD);
+				}
+			}
 		}
 		
 		TArray<float> Distances;
@@ -182,7 +488,14 @@ void FVoxelChunkMesh::BuildDistanceField(int32 LOD, const FIntVector& Position,
 		
 		FVoxelDistanceFieldUtilities::GetSurfacePositionsFromDensities(SizeVector, Values, Distances, SurfacePositions);
 		FVoxelDistanceFieldUtilities::DownSample(SizeVector, Distances, SurfacePositions, Divisor, false);
-		FVoxelDistanceFieldUtilities::JumpFlood(SizeVector, SurfacePositions, EVoxelComputeDevice::CPU);
+		if (CVarDistanceFieldUseJumpFlood.GetValueOnAnyThread())
+		{
+			FVoxelDistanceFieldUtilities::JumpFlood(SizeVector, SurfacePositions, EVoxelComputeDevice::CPU);
+		}
+		else
+		{
+			FVoxelDistanceFieldUtilities::ExactDistanceTransform(SizeVector, SurfacePositions);
+		}
 		FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(SizeVector, SurfacePositions, Distances);
 
 		ensure(SizeVector.X == Size);
@@ -0,0 +1,526 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/VoxelMeshDecimation.h"
+
+struct FVoxelQuadric
+{
+	// Symmetric matrix
+	double XX = 0;
+	double XY = 0;
+	double XZ = 0;
+	double YY = 0;
+	double YZ = 0;
+	double ZZ = 0;
+
+	double X = 0;
+	double Y = 0;
+	double Z = 0;
+
+	double W = 0;
+
+	// Sum of the areas of the planes, used to normalize the error
+	double Weight = 0;
+
+	FVoxelQuadric() = default;
+	FVoxelQuadric(const FVector& Normal, const FVector& Point, double Area)
+	{
+		const double A = Normal.X;
+		const double B = Normal.Y;
+		const double C = Normal.Z;
+		const double D = -FVector::DotProduct(Normal, Point);
+
+		XX = Area * A * A;
+		XY = Area * A * B;
+		XZ = Area * A * C;
+		YY = Area * B * B;
+		YZ = Area * B * C;
+		ZZ = Area * C * C;
+
+		X = Area * A * D;
+		Y = Area * B * D;
+		Z = Area * C * D;
+
+		W = Area * D * D;
+
+		Weight = Area;
+	}
+
+	FORCEINLINE FVoxelQuadric& operator+=(const FVoxelQuadric& Other)
+	{
+		XX += Other.XX;
+		XY += Other.XY;
+		XZ += Other.XZ;
+		YY += Other.YY;
+		YZ += Other.YZ;
+		ZZ += Other.ZZ;
+		X += Other.X;
+		Y += Other.Y;
+		Z += Other.Z;
+		W += Other.W;
+		Weight += Other.Weight;
+		return *this;
+	}
+	FORCEINLINE FVoxelQuadric operator+(const FVoxelQuadric& Other) const
+	{
+		FVoxelQuadric Result = *this;
+		Result += Other;
+		return Result;
+	}
+
+	// Returns the weighted mean of the squared distances to the planes
+	FORCEINLINE double GetError(const FVector& Point) const
+	{
+		if (Weight <= 0)
+		{
+			return 0;
+		}
+
+		const double PX = Point.X;
+		const double PY = Point.Y;
+		const double PZ = Point.Z;
+
+		const double Error =
+			XX * PX * PX +
+			YY * PY * PY +
+			ZZ * PZ * PZ +
+			2 * (XY * PX * PY + XZ * PX * PZ + YZ * PY * PZ) +
+			2 * (X * PX + Y * PY + Z * PZ) +
+			W;
+
+		return FMath::Max(0., Error) / Weight;
+	}
+};
+
+int32 FVoxelMeshDecimation::Decimate(
+	TArray<uint32>& Indices,
+	TArrayView<const FVector> Positions,
+	const TBitArray<>& LockedVertices,
+	const FSettings& Settings,
+	TArray<int32>& OutVertexRemap)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const int32 NumVertices = Positions.Num();
+	check(Indices.Num() % 3 == 0);
+	check(LockedVertices.Num() == 0 || LockedVertices.Num() == NumVertices);
+
+	TBitArray<> Locked = LockedVertices.Num() > 0 ? LockedVertices : TBitArray<>(false, NumVertices);
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Lock seams");
+
+		// Vertices sharing their position are attribute seams (hard color transitions, unique UVs...): moving them would open cracks
+		TMap<FVector, int32> PositionToVertex;
+		PositionToVertex.Reserve(NumVertices);
+		for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+		{
+			if (const int32* ExistingVertex = PositionToVertex.Find(Positions[Vertex]))
+			{
+				Locked[Vertex] = true;
+				Locked[*ExistingVertex] = true;
+			}
+			else
+			{
+				PositionToVertex.Add(Positions[Vertex], Vertex);
+			}
+		}
+	}
+
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Lock open borders");
+
+		// Chunk borders and material borders are open edges: locking them keeps the mesh watertight with its neighbors
+		TMap<uint64, int32> EdgesCount;
+		EdgesCount.Reserve(Indices.Num());
+		for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+		{
+			for (int32 Edge = 0; Edge < 3; Edge++)
+			{
+				const uint32 A = Indices[Index + Edge];
+				const uint32 B = Indices[Index + (Edge + 1) % 3];
+				const uint64 Key = (uint64(FMath::Min(A, B)) << 32) | uint64(FMath::Max(A, B));
+				EdgesCount.FindOrAdd(Key)++;
+			}
+		}
+		for (auto& It : EdgesCount)
+		{
+			if (It.Value != 2)
+			{
+				Locked[int32(It.Key >> 32)] = true;
+				Locked[int32(It.Key & 0xFFFFFFFF)] = true;
+			}
+		}
+	}
+
+	TArray<FVoxelQuadric> Quadrics;
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Compute quadrics");
+
+		Quadrics.SetNum(NumVertices);
+		for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+		{
+			const FVector& A = Positions[Indices[Index + 0]];
+			const FVector& B = Positions[Indices[Index + 1]];
+			const FVector& C = Positions[Indices[Index + 2]];
+
+			const FVector Cross = FVector::CrossProduct(B - A, C - A);
+			const float DoubleArea = Cross.Size();
+			if (DoubleArea <= 0.f)
+			{
+				continue;
+			}
+
+			const FVoxelQuadric Quadric(Cross / DoubleArea, A, DoubleArea / 2);
+			Quadrics[Indices[Index + 0]] += Quadric;
+			Quadrics[Indices[Index + 1]] += Quadric;
+			Quadrics[Indices[Index + 2]] += Quadric;
+		}
+	}
+
+	const int32 TargetNumTriangles = FMath::FloorToInt(Indices.Num() / 3 * FMath::Clamp(Settings.TargetRatio, 0.f, 1.f));
+	const double MaxErrorSquared = FMath::Square(double(Settings.MaxError));
+
+	// Removed vertices are represented by the vertex they were collapsed to, and must stay within MaxError of its triangles
+	// Linked lists, so that collapsing a vertex appends its list to the one of the vertex it's collapsed to
+	TArray<int32> FirstRepresented;
+	TArray<int32> LastRepresented;
+	TArray<int32> NextRepresented;
+	FirstRepresented.Init(-1, NumVertices);
+	LastRepresented.Init(-1, NumVertices);
+	NextRepresented.Init(-1, NumVertices);
+
+	// Where a vertex has been collapsed to during the current pass
+	TArray<int32> Collapses;
+	Collapses.SetNumUninitialized(NumVertices);
+
+	// Vertex -> triangles adjacency
+	TArray<int32> VertexTrianglesOffsets;
+	TArray<int32> VertexTriangles;
+
+	struct FCollapse
+	{
+		int32 From;
+		int32 To;
+		double Error;
+	};
+	TArray<FCollapse> Candidates;
+
+	for (int32 Pass = 0; Pass < Settings.MaxPasses && Indices.Num() / 3 > TargetNumTriangles; Pass++)
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Pass");
+
+		const int32 NumTriangles = Indices.Num() / 3;
+
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("Build adjacency");
+
+			VertexTrianglesOffsets.Reset();
+			VertexTrianglesOffsets.SetNumZeroed(NumVertices + 1);
+			for (uint32 Vertex : Indices)
+			{
+				VertexTrianglesOffsets[Vertex + 1]++;
+			}
+			for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+			{
+				VertexTrianglesOffsets[Vertex + 1] += VertexTrianglesOffsets[Vertex];
+			}
+
+			VertexTriangles.Reset();
+			VertexTriangles.SetNumUninitialized(Indices.Num());
+
+			TArray<int32> WriteOffsets(VertexTrianglesOffsets.GetData(), NumVertices);
+			for (int32 Index = 0; Index < Indices.Num(); Index++)
+			{
+				VertexTriangles[WriteOffsets[Indices[Index]]++] = Index / 3;
+			}
+		}
+
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("Find candidates");
+
+			Candidates.Reset();
+			for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+			{
+				for (int32 Edge = 0; Edge < 3; Edge++)
+				{
+					const int32 A = Indices[Index + Edge];
+					const int32 B = Indices[Index + (Edge + 1) % 3];
+					// Interior edges are shared by 2 triangles with opposite winding: only consider them once
+					if (A > B)
+					{
+						continue;
+					}
+
+					const bool bCanMoveA = !Locked[A];
+					const bool bCanMoveB = !Locked[B];
+					if (!bCanMoveA && !bCanMoveB)
+					{
+						continue;
+					}
+
+					const FVoxelQuadric Quadric = Quadrics[A] + Quadrics[B];
+					const double ErrorAToB = bCanMoveA ? Quadric.GetError(Positions[B]) : MAX_dbl;
+					const double ErrorBToA = bCanMoveB ? Quadric.GetError(Positions[A]) : MAX_dbl;
+
+					const FCollapse Collapse = ErrorAToB <= ErrorBToA
+						? FCollapse{ A, B, ErrorAToB }
+						: FCollapse{ B, A, ErrorBToA };
+
+					// The quadric error is the mean of the squared distances to the planes of the original triangles:
+					// it orders the collapses and skips the hopeless ones, but the max error is checked by ExceedsMaxError
+					if (Collapse.Error <= MaxErrorSquared)
+					{
+						Candidates.Add(Collapse);
+					}
+				}
+			}
+		}
+
+		if (Candidates.Num() == 0)
+		{
+			break;
+		}
+
+		Candidates.Sort([](const FCollapse& A, const FCollapse& B) { return A.Error < B.Error; });
+
+		const auto HasTriangleFlips = [&](int32 From, int32 To)
+		{
+			for (int32 Offset = VertexTrianglesOffsets[From]; Offset < VertexTrianglesOffsets[From + 1]; Offset++)
+			{
+				const int32 Triangle = VertexTriangles[Offset];
+				const int32 A = Indices[3 * Triangle + 0];
+				const int32 B = Indices[3 * Triangle + 1];
+				const int32 C = Indices[3 * Triangle + 2];
+
+				if (A == To || B == To || C == To)
+				{
+					// Will be removed
+					continue;
+				}
+
+				const auto GetPosition = [&](int32 Vertex) -> const FVector& { return Positions[Vertex == From ? To : Vertex]; };
+
+				const FVector OldNormal = FVector::CrossProduct(Positions[B] - Positions[A], Positions[C] - Positions[A]);
+				const FVector NewNormal = FVector::CrossProduct(GetPosition(B) - GetPosition(A), GetPosition(C) - GetPosition(A));
+
+				// Also reject slivers, as they're unstable for physics and look bad
+				if (FVector::DotProduct(OldNormal, NewNormal) <= 0.25f * OldNormal.Size() * NewNormal.Size())
+				{
+					return true;
+				}
+			}
+			return false;
+		};
+
+		// Squared distance from Point to the triangles of Vertex once From is collapsed to To
+		const auto GetDistanceSquaredToTriangles = [&](int32 Vertex, const FVector& Point, int32 From, int32 To)
+		{
+			float MinDistanceSquared = MAX_flt;
+			const auto AddTriangles = [&](int32 TrianglesVertex)
+			{
+				for (int32 Offset = VertexTrianglesOffsets[TrianglesVertex]; Offset < VertexTrianglesOffsets[TrianglesVertex + 1]; Offset++)
+				{
+					const int32 Triangle = VertexTriangles[Offset];
+					int32 A = Indices[3 * Triangle + 0];
+					int32 B = Indices[3 * Triangle + 1];
+					int32 C = Indices[3 * Triangle + 2];
+					A = A == From ? To : A;
+					B = B == From ? To : B;
+					C = C == From ? To : C;
+					if (A == B || A == C || B == C)
+					{
+						// Removed by the collapse
+						continue;
+					}
+
+					const FVector ClosestPoint = FMath::ClosestPointOnTriangleToPoint(Point, Positions[A], Positions[B], Positions[C]);
+					const float DistanceSquared = FVector::DistSquared(Point, ClosestPoint);
+					if (DistanceSquared < MinDistanceSquared)
+					{
+						MinDistanceSquared = DistanceSquared;
+					}
+				}
+			};
+			AddTriangles(Vertex);
+			if (Vertex == To)
+			{
+				AddTriangles(From);
+			}
+			return MinDistanceSquared;
+		};
+		// Only the triangles of the vertices of the triangles of From are changed by the collapse:
+		// only the vertices these vertices represent need to be checked
+		const auto ExceedsMaxError = [&](int32 From, int32 To, TArrayView<const int32> Neighbors)
+		{
+			for (const int32 Neighbor : Neighbors)
+			{
+				for (int32 Represented = FirstRepresented[Neighbor]; Represented != -1; Represented = NextRepresented[Represented])
+				{
+					if (GetDistanceSquaredToTriangles(Neighbor, Positions[Represented], From, To) > MaxErrorSquared)
+					{
+						return true;
+					}
+				}
+			}
+			// From will be represented by To, same as the vertices it represents
+			if (GetDistanceSquaredToTriangles(To, Positions[From], From, To) > MaxErrorSquared)
+			{
+				return true;
+			}
+			for (int32 Represented = FirstRepresented[From]; Represented != -1; Represented = NextRepresented[Represented])
+			{
+				if (GetDistanceSquaredToTriangles(To, Positions[Represented], From, To) > MaxErrorSquared)
+				{
+					return true;
+				}
+			}
+			return false;
+		};
+
+		for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+		{
+			Collapses[Vertex] = Vertex;
+		}
+
+		int32 NumCollapsed = 0;
+		int32 NumRemainingTriangles = NumTriangles;
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("Collapse");
+
+			// Vertices whose triangles have been modified this pass
+			TBitArray<> Touched(false, NumVertices);
+			TArray<int32, TInlineAllocator<16>> Neighbors;
+			for (const FCollapse& Collapse : Candidates)
+			{
+				if (Touched[Collapse.From])
+				{
+					continue;
+				}
+
+				// The vertices of the triangles of From, including To
+				// Their triangles must be the ones of the adjacency: skip the collapse if they were modified by a previous one
+				Neighbors.Reset();
+				bool bNeighborTouched = false;
+				for (int32 Offset = VertexTrianglesOffsets[Collapse.From]; Offset < VertexTrianglesOffsets[Collapse.From + 1]; Offset++)
+				{
+					const int32 Triangle = VertexTriangles[Offset];
+					for (int32 Corner = 0; Corner < 3; Corner++)
+					{
+						const int32 Vertex = Indices[3 * Triangle + Corner];
+						if (Vertex != Collapse.From)
+						{
+							bNeighborTouched |= Touched[Vertex];
+							Neighbors.AddUnique(Vertex);
+						}
+					}
+				}
+				if (bNeighborTouched)
+				{
+					continue;
+				}
+				if (HasTriangleFlips(Collapse.From, Collapse.To))
+				{
+					continue;
+				}
+				if (ExceedsMaxError(Collapse.From, Collapse.To, Neighbors))
+				{
+					continue;
+				}
+
+				for (int32 Offset = VertexTrianglesOffsets[Collapse.From]; Offset < VertexTrianglesOffsets[Collapse.From + 1]; Offset++)
+				{
+					const int32 Triangle = VertexTriangles[Offset];
+					const int32 A = Indices[3 * Triangle + 0];
+					const int32 B = Indices[3 * Triangle + 1];
+					const int32 C = Indices[3 * Triangle + 2];
+
+					Touched[A] = true;
+					Touched[B] = true;
+					Touched[C] = true;
+
+					if (A == Collapse.To || B == Collapse.To || C == Collapse.To)
+					{
+						NumRemainingTriangles--;
+					}
+				}
+
+				Collapses[Collapse.From] = Collapse.To;
+				Quadrics[Collapse.To] += Quadrics[Collapse.From];
+				NumCollapsed++;
+
+				// Append From and the vertices it represents to the ones represented by To
+				NextRepresented[Collapse.From] = FirstRepresented[Collapse.From];
+				const int32 Last = LastRepresented[Collapse.From] != -1 ? LastRepresented[Collapse.From] : Collapse.From;
+				if (FirstRepresented[Collapse.To] == -1)
+				{
+					FirstRepresented[Collapse.To] = Collapse.From;
+				}
+				else
+				{
+					NextRepresented[LastRepresented[Collapse.To]] = Collapse.From;
+				}
+				LastRepresented[Collapse.To] = Last;
+
+				if (NumRemainingTriangles <= TargetNumTriangles)
+				{
+					break;
+				}
+			}
+		}
+
+		if (NumCollapsed == 0)
+		{
+			break;
+		}
+
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("Remove degenerate triangles");
+
+			int32 WriteIndex = 0;
+			for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+			{
+				// Collapses are independent within a pass, no need to follow chains
+				const uint32 A = Collapses[Indices[Index + 0]];
+				const uint32 B = Collapses[Indices[Index + 1]];
+				const uint32 C = Collapses[Indices[Index + 2]];
+
+				if (A == B || A == C || B == C)
+				{
+					continue;
+				}
+
+				Indices[WriteIndex++] = A;
+				Indices[WriteIndex++] = B;
+				Indices[WriteIndex++] = C;
+			}
+			Indices.SetNum(WriteIndex, false);
+		}
+	}
+
+	// Compact the vertices, keeping their order so that the remap can be applied in place
+	OutVertexRemap.Reset();
+	OutVertexRemap.SetNumUninitialized(NumVertices);
+	for (int32& NewIndex : OutVertexRemap)
+	{
+		NewIndex = -1;
+	}
+	for (uint32 Vertex : Indices)
+	{
+		OutVertexRemap[Vertex] = 0;
+	}
+
+	int32 NewNumVertices = 0;
+	for (int32& NewIndex : OutVertexRemap)
+	{
+		if (NewIndex != -1)
+		{
+			NewIndex = NewNumVertices++;
+		}
+	}
+	for (uint32& Vertex : Indices)
+	{
+		Vertex = OutVertexRemap[Vertex];
+	}
+
+	return NewNumVertices;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+namespace FVoxelMeshDecimation
+{
+	struct FSettings
+	{
+		// Max distance allowed from a vertex of the original mesh to the decimated one, in the positions space
+		float MaxError = 0.f;
+		// Will stop collapsing edges once the number of triangles is below this ratio of the original count
+		float TargetRatio = 0.f;
+		// Each pass collapses an independent set of edges
+		int32 MaxPasses = 16;
+	};
+
+	/**
+	 * Edge collapse ordered by quadric error. Edges are always collapsed into one of their vertices, so that vertex attributes never need to be interpolated.
+	 * A collapse is only done if all the removed vertices stay within MaxError of the triangles around the vertex they were collapsed to.
+	 * Vertices that are in LockedVertices, on an open border or sharing their position with another vertex (attribute seams) are never moved.
+	 * Degenerate triangles are removed from Indices, and the indices are remapped to the compacted vertices.
+	 *
+	 * @param	LockedVertices		Either empty or of size Positions.Num()
+	 * @param	OutVertexRemap		For each old vertex, its new index or -1 if it was removed. Preserves the vertices order: use ApplyVertexRemap to compact the vertex buffers
+	 * @return	The new number of vertices
+	 */
+	int32 Decimate(
+		TArray<uint32>& Indices,
+		TArrayView<const FVector> Positions,
+		const TBitArray<>& LockedVertices,
+		const FSettings& Settings,
+		TArray<int32>& OutVertexRemap);
+
+	template<typename T>
+	void ApplyVertexRemap(TArray<T>& Array, const TArray<int32>& VertexRemap, int32 NewNumVertices)
+	{
+		if (Array.Num() == 0)
+		{
+			// eg normals when not rendering
+			return;
+		}
+
+		check(Array.Num() == VertexRemap.Num());
+		for (int32 Index = 0; Index < VertexRemap.Num(); Index++)
+		{
+			const int32 NewIndex = VertexRemap[Index];
+			if (NewIndex != -1)
+			{
+				checkVoxelSlow(NewIndex <= Index);
+				Array[NewIndex] = Array[Index];
+			}
+		}
+		Array.SetNum(NewNumVertices, false);
+	}
+}
\ No newline at end of file
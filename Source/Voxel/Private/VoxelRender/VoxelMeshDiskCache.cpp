@@ -0,0 +1,348 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/VoxelMeshDiskCache.h"
+#include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelRender/IVoxelRenderer.h"
+#include "VoxelData/VoxelData.h"
+#include "VoxelData/VoxelDataOctree.h"
+#include "VoxelUtilities/VoxelOctreeUtilities.h"
+#include "VoxelPlaceableItems/VoxelPlaceableItem.h"
+#include "VoxelGenerators/VoxelGenerator.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/Async.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Hash/CityHash.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Mesh Disk Cache Hits"), STAT_VoxelMeshDiskCacheHits, STATGROUP_VoxelCounters);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Mesh Disk Cache Misses"), STAT_VoxelMeshDiskCacheMisses, STATGROUP_VoxelCounters);
+
+static FAutoConsoleCommand CmdClearMeshDiskCache(
+	TEXT("voxel.renderer.ClearMeshDiskCache"),
+	TEXT("Deletes the chunk meshes saved on disk by the worlds with bEnableMeshDiskCache"),
+	FConsoleCommandDelegate::CreateStatic(&FVoxelMeshDiskCache::ClearAll));
+
+static TAutoConsoleVariable<int32> CVarMeshDiskCacheVersion(
+	TEXT("voxel.renderer.MeshDiskCacheVersion"),
+	0,
+	TEXT("Part of the key of the meshes saved on disk. Bump it (eg in DefaultEngine.ini) when your generators depend on data that isn't hashed, see UVoxelGenerator::GetGeneratorHash"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMeshDiskCacheMaxSize(
+	TEXT("voxel.renderer.MeshDiskCacheMaxSize"),
+	1024,
+	TEXT("Max size of Saved/VoxelMeshCache, in MB. The least recently used meshes are deleted when a world using the cache is created. 0 for no limit"),
+	ECVF_Default);
+
+static const uint32 MeshDiskCacheMagic = 0x434D5856; // VXMC
+
+inline FString GetMeshDiskCacheRootDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("VoxelMeshCache");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelSharedPtr<FVoxelMeshDiskCache> FVoxelMeshDiskCache::Create(const FVoxelRendererSettingsBase& Settings, const FVoxelData& Data)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (Data.GeneratorHash == 0)
+	{
+		return nullptr;
+	}
+
+	// Everything the meshers output depends on, on top of the generator
+	FString SettingsString = FString::Printf(TEXT("%u %d %s"), Version, Data.Depth, *Data.WorldBounds.ToString());
+	const auto Add = [&](auto Value)
+	{
+		SettingsString += TEXT(" ");
+		SettingsString += LexToString(Value);
+	};
+	// The meshers code, in case Version wasn't bumped
+	Add(UVoxelGenerator::GetNativeCodeVersion(UVoxelGenerator::StaticClass()));
+	Add(FEngineVersion::Current().ToString());
+	Add(CVarMeshDiskCacheVersion.GetValueOnGameThread());
+	Add(int32(Settings.UVConfig));
+	Add(Settings.UVScale);
+	Add(int32(Settings.NormalConfig));
+	Add(int32(Settings.MaterialConfig));
+	Add(Settings.bHardColorTransitions);
+	Add(int32(Settings.RenderType));
+	Add(Settings.RenderSharpness);
+	Add(Settings.bOptimizeIndices);
+	Add(Settings.bQuantizeMeshVertices);
+	Add(Settings.MeshDecimationMinLOD);
+	Add(Settings.MeshDecimationMaxError);
+	Add(Settings.bOneMaterialPerCubeSide);
+	Add(Settings.bHalfPrecisionCoordinates);
+	Add(Settings.bInterpolateColors);
+	Add(Settings.bInterpolateUVs);
+	Add(Settings.bSRGBColors);
+	Add(Settings.bRenderWorld);
+	Add(Settings.bGreedyCubicMesher);
+	Add(Settings.bSimpleCubicCollision);
+
+	const uint64 Hash = CityHash64WithSeed(reinterpret_cast<const char*>(*SettingsString), SettingsString.Len() * sizeof(TCHAR), Data.GeneratorHash);
+	const FString Directory = GetMeshDiskCacheRootDirectory() / FString::Printf(TEXT("%016llx"), Hash);
+
+	const int64 MaxSize = int64(CVarMeshDiskCacheMaxSize.GetValueOnGameThread()) << 20;
+	if (MaxSize > 0)
+	{
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [MaxSize]() { Trim(MaxSize); });
+	}
+
+	return MakeShareable(new FVoxelMeshDiskCache(Directory, Settings.MaterialConfig == EVoxelMaterialConfig::MultiIndex, Settings.DynamicSettings));
+}
+
+void FVoxelMeshDiskCache::ClearAll()
+{
+	const FString Directory = GetMeshDiskCacheRootDirectory();
+	if (IFileManager::Get().DeleteDirectory(*Directory, false, true))
+	{
+		LOG_VOXEL(Log, TEXT("Deleted %s"), *Directory);
+	}
+	else
+	{
+		LOG_VOXEL(Warning, TEXT("Failed to delete %s"), *Directory);
+	}
+}
+
+void FVoxelMeshDiskCache::Trim(int64 MaxSize)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	struct FFile
+	{
+		FString Path;
+		int64 Size = 0;
+		FDateTime LastUse;
+	};
+	TArray<FFile> Files;
+	int64 TotalSize = 0;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.IterateDirectoryStatRecursively(*GetMeshDiskCacheRootDirectory(), [&](const TCHAR* Path, const FFileStatData& StatData)
+	{
+		if (!StatData.bIsDirectory)
+		{
+			// Load updates the modification time
+			Files.Add({ Path, StatData.FileSize, StatData.ModificationTime });
+			TotalSize += StatData.FileSize;
+		}
+		return true;
+	});
+
+	if (TotalSize <= MaxSize)
+	{
+		return;
+	}
+
+	// Go down to 3/4 of the max size, so that this isn't done every time a world is created
+	const int64 TargetSize = MaxSize - MaxSize / 4;
+	
+	Files.Sort([](const FFile& A, const FFile& B) { return A.LastUse < B.LastUse; });
+
+	int32 NumDeleted = 0;
+	for (const FFile& File : Files)
+	{
+		if (TotalSize <= TargetSize)
+		{
+			break;
+		}
+		if (IFileManager::Get().Delete(*File.Path, false, false, true))
+		{
+			TotalSize -= File.Size;
+			NumDeleted++;
+		}
+	}
+
+	LOG_VOXEL(Log, TEXT("Voxel mesh disk cache: deleted %d least recently used files, %lldMB left"), NumDeleted, TotalSize >> 20);
+}
+
+bool FVoxelMeshDiskCache::IsGeneratorOnly(const FVoxelData& Data, const FVoxelIntBox& Bounds)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	return FVoxelOctreeUtilities::IterateTreeInBoundsEarlyExit(Data.GetOctree(), Bounds, [&](FVoxelDataOctreeBase& Tree)
+	{
+		// Disable edits boxes don't change the values
+		const auto& ItemHolder = Tree.GetItemHolder();
+		if (ItemHolder.GetAssetItems().Num() > 0 || ItemHolder.GetDataItems().Num() > 0)
+		{
+			return false;
+		}
+
+		if (Tree.IsLeaf())
+		{
+			ensureThreadSafe(Tree.IsLockedForRead());
+			const auto& Leaf = Tree.AsLeaf();
+			return !Leaf.GetData<FVoxelValue>().IsDirty() && !Leaf.GetData<FVoxelMaterial>().IsDirty();
+		}
+
+		return true;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelSharedPtr<FVoxelChunkMesh> FVoxelMeshDiskCache::Load(int32 LOD, const FIntVector& ChunkPosition, uint8 TransitionsMask) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	const FString Path = GetPath(LOD, ChunkPosition, TransitionsMask);
+
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *Path, FILEREAD_Silent))
+	{
+		INC_DWORD_STAT(STAT_VoxelMeshDiskCacheMisses);
+		return nullptr;
+	}
+
+	const auto OnCorrupted = [&]()
+	{
+		LOG_VOXEL(Warning, TEXT("Corrupted voxel mesh cache file %s, deleting it"), *Path);
+		IFileManager::Get().Delete(*Path, false, false, true);
+		INC_DWORD_STAT(STAT_VoxelMeshDiskCacheMisses);
+		return nullptr;
+	};
+
+	FMemoryReader FileReader(FileData);
+
+	uint32 Magic = 0;
+	uint32 FileVersion = 0;
+	int32 FileLOD = 0;
+	FIntVector FileChunkPosition;
+	uint8 FileTransitionsMask = 0;
+	int32 UncompressedSize = 0;
+	FileReader << Magic;
+	FileReader << FileVersion;
+	FileReader << FileLOD;
+	FileReader << FileChunkPosition;
+	FileReader << FileTransitionsMask;
+	FileReader << UncompressedSize;
+
+	if (FileReader.IsError() ||
+		Magic != MeshDiskCacheMagic ||
+		FileVersion != Version ||
+		FileLOD != LOD ||
+		FileChunkPosition != ChunkPosition ||
+		FileTransitionsMask != TransitionsMask ||
+		UncompressedSize <= 0 ||
+		UncompressedSize > (256 << 20))
+	{
+		return OnCorrupted();
+	}
+
+	TArray<uint8> UncompressedData;
+	UncompressedData.SetNumUninitialized(UncompressedSize);
+
+	const int64 HeaderSize = FileReader.Tell();
+	if (!FCompression::UncompressMemory(NAME_Zlib, UncompressedData.GetData(), UncompressedSize, FileData.GetData() + HeaderSize, FileData.Num() - HeaderSize))
+	{
+		return OnCorrupted();
+	}
+
+	FMemoryReader Reader(UncompressedData);
+	const auto Chunk = MakeVoxelShared<FVoxelChunkMesh>();
+	Chunk->Serialize(Reader);
+
+	if (Reader.IsError() || !Reader.AtEnd())
+	{
+		return OnCorrupted();
+	}
+
+	// So that Trim deletes the least recently used files first
+	IFileManager::Get().SetTimeStamp(*Path, FDateTime::UtcNow());
+
+	INC_DWORD_STAT(STAT_VoxelMeshDiskCacheHits);
+	return Chunk;
+}
+
+void FVoxelMeshDiskCache::Save(int32 LOD, const FIntVector& ChunkPosition, uint8 TransitionsMask, const FVoxelChunkMesh& Chunk) const
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	TArray<uint8> UncompressedData;
+	{
+		FMemoryWriter Writer(UncompressedData);
+		// Serialize doesn't modify the chunk when saving
+		const_cast<FVoxelChunkMesh&>(Chunk).Serialize(Writer);
+	}
+
+	TArray<uint8> FileData;
+	{
+		FMemoryWriter Writer(FileData);
+
+		uint32 Magic = MeshDiskCacheMagic;
+		uint32 FileVersion = Version;
+		int32 FileLOD = LOD;
+		FIntVector FileChunkPosition = ChunkPosition;
+		uint8 FileTransitionsMask = TransitionsMask;
+		int32 UncompressedSize = UncompressedData.Num();
+		Writer << Magic;
+		Writer << FileVersion;
+		Writer << FileLOD;
+		Writer << FileChunkPosition;
+		Writer << FileTransitionsMask;
+		Writer << UncompressedSize;
+	}
+
+	const int32 HeaderSize = FileData.Num();
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedData.Num());
+	FileData.AddUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(NAME_Zlib, FileData.GetData() + HeaderSize, CompressedSize, UncompressedData.GetData(), UncompressedData.Num()))
+	{
+		return;
+	}
+	FileData.SetNum(HeaderSize + CompressedSize);
+
+	// Write to a temporary file first, so that another task loading the same chunk never sees a partial file
+	const FString Path = GetPath(LOD, ChunkPosition, TransitionsMask);
+	const FString TempPath = Path + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(FileData, *TempPath))
+	{
+		LOG_VOXEL(Verbose, TEXT("Failed to write %s"), *TempPath);
+		return;
+	}
+	if (!IFileManager::Get().Move(*Path, *TempPath, true, false, false, true))
+	{
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelMeshDiskCache::FVoxelMeshDiskCache(const FString& Directory, bool bMultiIndex, const TVoxelSharedRef<FVoxelRendererDynamicSettings>& DynamicSettings)
+	: Directory(Directory)
+	, bMultiIndex(bMultiIndex)
+	, DynamicSettings(DynamicSettings)
+{
+}
+
+FString FVoxelMeshDiskCache::GetPath(int32 LOD, const FIntVector& ChunkPosition, uint8 TransitionsMask) const
+{
+	FString Name = FString::Printf(TEXT("%d_%d_%d_%d"), LOD, ChunkPosition.X, ChunkPosition.Y, ChunkPosition.Z);
+	if (TransitionsMask != 0)
+	{
+		Name += FString::Printf(TEXT("_T%u"), TransitionsMask);
+	}
+	if (bMultiIndex)
+	{
+		// Changes with the material collection, see FVoxelMesherUtilities
+		Name += FString::Printf(TEXT("_M%d"), FMath::Clamp(DynamicSettings->LODData[LOD].MaxMaterialIndices.GetValue(), 1, 6));
+	}
+	return Directory / Name + TEXT(".voxelmesh");
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+class FVoxelData;
+struct FVoxelChunkMesh;
+struct FVoxelIntBox;
+struct FVoxelRendererSettingsBase;
+struct FVoxelRendererDynamicSettings;
+
+/**
+ * Chunk meshes saved on disk in Saved/VoxelMeshCache, so that they don't need to be generated again the next time the world is loaded
+ * Keyed by the generator hash (see UVoxelGenerator::GetGeneratorHash), the mesher settings & code version, the engine version,
+ * voxel.renderer.MeshDiskCacheVersion, the chunk position, LOD & transitions mask
+ * Limited to voxel.renderer.MeshDiskCacheMaxSize: the least recently used meshes are deleted first
+ *
+ * Only chunks made of generator values are cached: chunks with edits or asset/data items in their bounds always bypass the cache,
+ * so edits never need to invalidate it. Distance fields aren't cached, they are built again from the data
+ * Thread safe
+ */
+class FVoxelMeshDiskCache
+{
+public:
+	// Bump when the meshers output changes
+	static constexpr uint32 Version = 1;
+
+	// Null if the data generator hash is unknown
+	static TVoxelSharedPtr<FVoxelMeshDiskCache> Create(const FVoxelRendererSettingsBase& Settings, const FVoxelData& Data);
+
+	// Deletes the meshes of all the worlds
+	static void ClearAll();
+	// Deletes the least recently used meshes of all the worlds until the cache is smaller than MaxSize bytes
+	static void Trim(int64 MaxSize);
+
+	// True if the values & materials in Bounds are only coming from the generator
+	// Data must be locked for read in Bounds
+	static bool IsGeneratorOnly(const FVoxelData& Data, const FVoxelIntBox& Bounds);
+
+public:
+	// Null if not in the cache or if the file is corrupted
+	TVoxelSharedPtr<FVoxelChunkMesh> Load(int32 LOD, const FIntVector& ChunkPosition, uint8 TransitionsMask) const;
+	void Save(int32 LOD, const FIntVector& ChunkPosition, uint8 TransitionsMask, const FVoxelChunkMesh& Chunk) const;
+
+private:
+	// Unique to the generator & the settings
+	const FString Directory;
+	const bool bMultiIndex;
+	const TVoxelSharedRef<FVoxelRendererDynamicSettings> DynamicSettings;
+
+	FVoxelMeshDiskCache(const FString& Directory, bool bMultiIndex, const TVoxelSharedRef<FVoxelRendererDynamicSettings>& DynamicSettings);
+
+	FString GetPath(int32 LOD, const FIntVector& ChunkPosition, uint8 TransitionsMask) const;
+};
\ No newline at end of file
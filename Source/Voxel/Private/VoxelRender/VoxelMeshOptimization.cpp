@@ -0,0 +1,410 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelRender/VoxelMeshOptimization.h"
+
+namespace FVoxelMeshOptimizationImpl
+{
+	// Size of the simulated LRU cache. Larger than most hardware caches, but the scoring degrades gracefully
+	constexpr int32 CacheSize = 32;
+	constexpr int32 MaxValence = 32;
+
+	constexpr float CacheDecayPower = 1.5f;
+	constexpr float LastTriangleScore = 0.75f;
+	constexpr float ValenceBoostScale = 2.0f;
+	constexpr float ValenceBoostPower = 0.5f;
+
+	struct FScoreTables
+	{
+		float Cache[CacheSize];
+		float Valence[MaxValence + 1];
+
+		FScoreTables()
+		{
+			for (int32 Position = 0; Position < CacheSize; Position++)
+			{
+				if (Position < 3)
+				{
+					// Vertices of the last triangle: fixed score, else we would favor one of its edges
+					Cache[Position] = LastTriangleScore;
+				}
+				else
+				{
+					Cache[Position] = FMath::Pow(1.f - float(Position - 3) / (CacheSize - 3), CacheDecayPower);
+				}
+			}
+
+			Valence[0] = 0.f;
+			for (int32 NumTriangles = 1; NumTriangles <= MaxValence; NumTriangles++)
+			{
+				// Boost vertices with few triangles left, to avoid leaving lone triangles behind
+				Valence[NumTriangles] = ValenceBoostScale * FMath::Pow(float(NumTriangles), -ValenceBoostPower);
+			}
+		}
+	};
+
+	FORCEINLINE float GetVertexScore(const FScoreTables& Tables, int32 CachePosition, int32 NumRemainingTriangles)
+	{
+		if (NumRemainingTriangles == 0)
+		{
+			return -1.f;
+		}
+
+		const float CacheScore = CachePosition >= 0 ? Tables.Cache[CachePosition] : 0.f;
+		return CacheScore + Tables.Valence[FMath::Min(NumRemainingTriangles, MaxValence)];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelMeshOptimization::FVertexCacheStats FVoxelMeshOptimization::AnalyzeVertexCache(TArrayView<const uint32> Indices, int32 NumVertices, int32 CacheSize)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	FVertexCacheStats Stats;
+	if (Indices.Num() == 0 || NumVertices == 0)
+	{
+		return Stats;
+	}
+
+	// A vertex is in the FIFO if it was inserted less than CacheSize insertions ago
+	TArray<uint32> InsertionTimes;
+	InsertionTimes.SetNumZeroed(NumVertices);
+
+	uint32 Time = CacheSize + 1;
+	for (const uint32 Index : Indices)
+	{
+		checkVoxelSlow(Index < uint32(NumVertices));
+		if (Time - InsertionTimes[Index] > uint32(CacheSize))
+		{
+			InsertionTimes[Index] = Time++;
+			Stats.NumTransforms++;
+		}
+	}
+
+	Stats.ACMR = float(Stats.NumTransforms) / (Indices.Num() / 3);
+	Stats.ATVR = float(Stats.NumTransforms) / NumVertices;
+	return Stats;
+}
+
+void FVoxelMeshOptimization::OptimizeVertexCache(TArray<uint32>& Indices, int32 NumVertices)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	using namespace FVoxelMeshOptimizationImpl;
+
+	check(Indices.Num() % 3 == 0);
+	const int32 NumTriangles = Indices.Num() / 3;
+	if (NumTriangles == 0)
+	{
+		return;
+	}
+
+	static const FScoreTables Tables;
+
+	// Vertex -> triangles adjacency, stored as ranges in a single array. Emitted triangles are swapped out of the ranges
+	TArray<int32> NumRemainingTriangles;
+	NumRemainingTriangles.SetNumZeroed(NumVertices);
+	for (const uint32 Index : Indices)
+	{
+		checkVoxelSlow(Index < uint32(NumVertices));
+		NumRemainingTriangles[Index]++;
+	}
+
+	TArray<int32> AdjacencyOffsets;
+	AdjacencyOffsets.SetNumUninitialized(NumVertices);
+	{
+		int32 Offset = 0;
+		for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+		{
+			AdjacencyOffsets[Vertex] = Offset;
+			Offset += NumRemainingTriangles[Vertex];
+		}
+	}
+
+	TArray<int32> Adjacency;
+	Adjacency.SetNumUninitialized(Indices.Num());
+	{
+		TArray<int32> Cursors = AdjacencyOffsets;
+		for (int32 Triangle = 0; Triangle < NumTriangles; Triangle++)
+		{
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				Adjacency[Cursors[Indices[3 * Triangle + Corner]]++] = Triangle;
+			}
+		}
+	}
+
+	TArray<float> VertexScores;
+	VertexScores.SetNumUninitialized(NumVertices);
+	for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+	{
+		VertexScores[Vertex] = GetVertexScore(Tables, -1, NumRemainingTriangles[Vertex]);
+	}
+
+	TArray<float> TriangleScores;
+	TriangleScores.SetNumUninitialized(NumTriangles);
+	for (int32 Triangle = 0; Triangle < NumTriangles; Triangle++)
+	{
+		TriangleScores[Triangle] =
+			VertexScores[Indices[3 * Triangle + 0]] +
+			VertexScores[Indices[3 * Triangle + 1]] +
+			VertexScores[Indices[3 * Triangle + 2]];
+	}
+
+	TBitArray<> EmittedTriangles(false, NumTriangles);
+
+	// +3: the vertices of the new triangle are pushed before the old ones are evicted
+	int32 Cache[CacheSize + 3];
+	int32 NewCache[CacheSize + 3];
+	int32 CacheNum = 0;
+
+	TArray<uint32> NewIndices;
+	NewIndices.Reserve(Indices.Num());
+
+	int32 BestTriangle = -1;
+	int32 InputCursor = 0;
+	for (int32 NumEmitted = 0; NumEmitted < NumTriangles; NumEmitted++)
+	{
+		if (BestTriangle == -1)
+		{
+			// No triangle left around the cache: restart from the next triangle in input order
+			while (EmittedTriangles[InputCursor])
+			{
+				InputCursor++;
+			}
+			BestTriangle = InputCursor;
+		}
+
+		const uint32 A = Indices[3 * BestTriangle + 0];
+		const uint32 B = Indices[3 * BestTriangle + 1];
+		const uint32 C = Indices[3 * BestTriangle + 2];
+
+		NewIndices.Add(A);
+		NewIndices.Add(B);
+		NewIndices.Add(C);
+		EmittedTriangles[BestTriangle] = true;
+
+		for (const uint32 Vertex : { A, B, C })
+		{
+			int32* RESTRICT VertexTriangles = &Adjacency[AdjacencyOffsets[Vertex]];
+			int32& Num = NumRemainingTriangles[Vertex];
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				if (VertexTriangles[Index] == BestTriangle)
+				{
+					VertexTriangles[Index] = VertexTriangles[Num - 1];
+					break;
+				}
+			}
+			Num--;
+		}
+
+		// Move the triangle vertices to the front of the cache
+		int32 NewCacheNum = 0;
+		for (const uint32 Vertex : { A, B, C })
+		{
+			bool bAlreadyAdded = false;
+			for (int32 Index = 0; Index < NewCacheNum; Index++)
+			{
+				bAlreadyAdded |= NewCache[Index] == int32(Vertex);
+			}
+			if (!bAlreadyAdded)
+			{
+				NewCache[NewCacheNum++] = Vertex;
+			}
+		}
+		for (int32 Index = 0; Index < CacheNum; Index++)
+		{
+			const int32 Vertex = Cache[Index];
+			if (Vertex != int32(A) && Vertex != int32(B) && Vertex != int32(C))
+			{
+				NewCache[NewCacheNum++] = Vertex;
+			}
+		}
+
+		// Update the scores of the vertices whose cache position changed, including the evicted ones
+		for (int32 Index = 0; Index < NewCacheNum; Index++)
+		{
+			const int32 Vertex = NewCache[Index];
+			const int32 CachePosition = Index < CacheSize ? Index : -1;
+
+			const float NewScore = GetVertexScore(Tables, CachePosition, NumRemainingTriangles[Vertex]);
+			const float Delta = NewScore - VertexScores[Vertex];
+			VertexScores[Vertex] = NewScore;
+
+			const int32* RESTRICT VertexTriangles = &Adjacency[AdjacencyOffsets[Vertex]];
+			for (int32 TriangleIndex = 0; TriangleIndex < NumRemainingTriangles[Vertex]; TriangleIndex++)
+			{
+				TriangleScores[VertexTriangles[TriangleIndex]] += Delta;
+			}
+		}
+
+		CacheNum = FMath::Min(NewCacheNum, CacheSize);
+		FMemory::Memcpy(Cache, NewCache, CacheNum * sizeof(int32));
+
+		// Only look at the triangles using a cached vertex: this is what makes the algorithm linear
+		BestTriangle = -1;
+		float BestScore = -1.f;
+		for (int32 Index = 0; Index < CacheNum; Index++)
+		{
+			const int32 Vertex = Cache[Index];
+			const int32* RESTRICT VertexTriangles = &Adjacency[AdjacencyOffsets[Vertex]];
+			for (int32 TriangleIndex = 0; TriangleIndex < NumRemainingTriangles[Vertex]; TriangleIndex++)
+			{
+				const int32 Triangle = VertexTriangles[TriangleIndex];
+				checkVoxelSlow(!EmittedTriangles[Triangle]);
+				if (TriangleScores[Triangle] > BestScore)
+				{
+					BestScore = TriangleScores[Triangle];
+					BestTriangle = Triangle;
+				}
+			}
+		}
+	}
+
+	check(NewIndices.Num() == Indices.Num());
+	Indices = MoveTemp(NewIndices);
+}
+
+void FVoxelMeshOptimization::OptimizeOverdraw(TArray<uint32>& Indices, TArrayView<const FVector> Positions, float Threshold)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	check(Indices.Num() % 3 == 0);
+	const int32 NumTriangles = Indices.Num() / 3;
+	if (NumTriangles < 2)
+	{
+		return;
+	}
+
+	const int32 CacheSize = 16;
+
+	// Hard cluster boundaries: triangles that fully missed the cache, ie where the vertex cache optimizer restarted
+	// Reordering whole clusters keeps the cache efficiency of each cluster
+	TArray<int32> ClusterStarts;
+	{
+		TArray<uint32> InsertionTimes;
+		InsertionTimes.SetNumZeroed(Positions.Num());
+
+		uint32 Time = CacheSize + 1;
+		for (int32 Triangle = 0; Triangle < NumTriangles; Triangle++)
+		{
+			int32 NumMisses = 0;
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				const uint32 Index = Indices[3 * Triangle + Corner];
+				if (Time - InsertionTimes[Index] > uint32(CacheSize))
+				{
+					InsertionTimes[Index] = Time++;
+					NumMisses++;
+				}
+			}
+			if (NumMisses == 3 || Triangle == 0)
+			{
+				ClusterStarts.Add(Triangle);
+			}
+		}
+	}
+
+	if (ClusterStarts.Num() < 2)
+	{
+		return;
+	}
+	ClusterStarts.Add(NumTriangles);
+
+	struct FCluster
+	{
+		int32 Start;
+		int32 End;
+		FVector Centroid;
+		FVector Normal;
+		float SortKey;
+	};
+	TArray<FCluster> Clusters;
+	Clusters.Reserve(ClusterStarts.Num() - 1);
+
+	FVector MeshCentroid(0.f);
+	float MeshArea = 0.f;
+	for (int32 ClusterIndex = 0; ClusterIndex < ClusterStarts.Num() - 1; ClusterIndex++)
+	{
+		FCluster Cluster{ ClusterStarts[ClusterIndex], ClusterStarts[ClusterIndex + 1], FVector(0.f), FVector(0.f), 0.f };
+
+		float ClusterArea = 0.f;
+		for (int32 Triangle = Cluster.Start; Triangle < Cluster.End; Triangle++)
+		{
+			const FVector& A = Positions[Indices[3 * Triangle + 0]];
+			const FVector& B = Positions[Indices[3 * Triangle + 1]];
+			const FVector& C = Positions[Indices[3 * Triangle + 2]];
+
+			// Same winding as FVoxelMesherUtilities normals
+			const FVector Cross = FVector::CrossProduct(C - A, B - A);
+			const float Area = Cross.Size();
+
+			Cluster.Centroid += (A + B + C) / 3.f * Area;
+			Cluster.Normal += Cross;
+			ClusterArea += Area;
+		}
+
+		MeshCentroid += Cluster.Centroid;
+		MeshArea += ClusterArea;
+
+		if (ClusterArea > 0)
+		{
+			Cluster.Centroid /= ClusterArea;
+		}
+		Clusters.Add(Cluster);
+	}
+
+	if (MeshArea <= 0)
+	{
+		return;
+	}
+	MeshCentroid /= MeshArea;
+
+	for (FCluster& Cluster : Clusters)
+	{
+		// Clusters facing away from the mesh center are more likely to occlude the others
+		Cluster.SortKey = FVector::DotProduct(Cluster.Centroid - MeshCentroid, Cluster.Normal.GetSafeNormal());
+	}
+	Clusters.StableSort([](const FCluster& A, const FCluster& B) { return A.SortKey > B.SortKey; });
+
+	TArray<uint32> NewIndices;
+	NewIndices.Reserve(Indices.Num());
+	for (const FCluster& Cluster : Clusters)
+	{
+		NewIndices.Append(&Indices[3 * Cluster.Start], 3 * (Cluster.End - Cluster.Start));
+	}
+	check(NewIndices.Num() == Indices.Num());
+
+	const float OldACMR = AnalyzeVertexCache(Indices, Positions.Num(), CacheSize).ACMR;
+	const float NewACMR = AnalyzeVertexCache(NewIndices, Positions.Num(), CacheSize).ACMR;
+	if (NewACMR > OldACMR * Threshold)
+	{
+		return;
+	}
+
+	Indices = MoveTemp(NewIndices);
+}
+
+int32 FVoxelMeshOptimization::OptimizeVertexFetch(TArray<uint32>& Indices, int32 NumVertices, TArray<int32>& OutVertexRemap)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	OutVertexRemap.Init(-1, NumVertices);
+
+	int32 NewNumVertices = 0;
+	for (uint32& Index : Indices)
+	{
+		checkVoxelSlow(Index < uint32(NumVertices));
+		int32& NewIndex = OutVertexRemap[Index];
+		if (NewIndex == -1)
+		{
+			NewIndex = NewNumVertices++;
+		}
+		Index = NewIndex;
+	}
+
+	return NewNumVertices;
+}
\ No newline at end of file
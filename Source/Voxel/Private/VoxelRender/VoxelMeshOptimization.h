@@ -0,0 +1,72 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+namespace FVoxelMeshOptimization
+{
+	struct FVertexCacheStats
+	{
+		// Number of vertex shader invocations
+		int32 NumTransforms = 0;
+		// Average cache miss ratio: transforms per triangle. 0.5 is the best possible value for a regular grid, 3 the worst
+		float ACMR = 0.f;
+		// Average transform to vertex ratio: transforms per vertex. 1 is optimal
+		float ATVR = 0.f;
+	};
+
+	/**
+	 * Simulates a FIFO post-transform vertex cache
+	 */
+	FVertexCacheStats AnalyzeVertexCache(TArrayView<const uint32> Indices, int32 NumVertices, int32 CacheSize = 16);
+
+	/**
+	 * Reorders the triangles to improve post-transform vertex cache locality
+	 * See Tom Forsyth, Linear-Speed Vertex Cache Optimisation
+	 */
+	void OptimizeVertexCache(TArray<uint32>& Indices, int32 NumVertices);
+
+	/**
+	 * Reorders clusters of triangles so that the ones facing outwards are drawn first, reducing overdraw
+	 * Clusters are delimited by the vertex cache optimizer restarts, so should be called after OptimizeVertexCache
+	 * See Sander et al., Fast Triangle Reordering for Vertex Locality and Reduced Overdraw
+	 *
+	 * @param	Threshold	Max ACMR degradation allowed, eg 1.05 for 5%. If exceeded the indices are left untouched
+	 */
+	void OptimizeOverdraw(TArray<uint32>& Indices, TArrayView<const FVector> Positions, float Threshold);
+
+	/**
+	 * Renumbers the vertices in the order they are first referenced, so that vertex fetches are linear. Unreferenced vertices are removed
+	 *
+	 * @param	OutVertexRemap		For each old vertex, its new index or -1 if it's not referenced. Use RemapVertices to reorder the vertex buffers
+	 * @return	The new number of vertices
+	 */
+	int32 OptimizeVertexFetch(TArray<uint32>& Indices, int32 NumVertices, TArray<int32>& OutVertexRemap);
+
+	template<typename T>
+	void RemapVertices(TArray<T>& Array, const TArray<int32>& VertexRemap, int32 NewNumVertices)
+	{
+		if (Array.Num() == 0)
+		{
+			// eg normals when not rendering
+			return;
+		}
+
+		check(Array.Num() == VertexRemap.Num());
+
+		TArray<T> NewArray;
+		NewArray.Empty(NewNumVertices);
+		NewArray.SetNumUninitialized(NewNumVertices);
+		for (int32 Index = 0; Index < VertexRemap.Num(); Index++)
+		{
+			const int32 NewIndex = VertexRemap[Index];
+			if (NewIndex != -1)
+			{
+				NewArray[NewIndex] = Array[Index];
+			}
+		}
+		Array = MoveTemp(NewArray);
+	}
+}
\ No newline at end of file
@@ -57,6 +57,7 @@ uint32 FVoxelProcMeshBuffers::GetAllocatedSize() const
 {
 	return
 		Guids.GetAllocatedSize() +
+		ChunkRanges.GetAllocatedSize() +
 		VertexBuffers.StaticMeshVertexBuffer.GetResourceSize() +
 		VertexBuffers.PositionVertexBuffer.GetNumVertices() * VertexBuffers.PositionVertexBuffer.GetStride() +
 		VertexBuffers.ColorVertexBuffer.GetNumVertices() * VertexBuffers.ColorVertexBuffer.GetStride() +
@@ -3,6 +3,7 @@
 #include "VoxelRender/VoxelProceduralMeshComponent.h"
 #include "VoxelRender/VoxelProceduralMeshSceneProxy.h"
 #include "VoxelRender/PhysicsCooker/VoxelAsyncPhysicsCooker.h"
+#include "VoxelRender/PhysicsCooker/VoxelCollisionCookingCache.h"
 #include "VoxelRender/VoxelProcMeshBuffers.h"
 #include "VoxelRender/VoxelMaterialInterface.h"
 #include "VoxelRender/VoxelToolRendering.h"
@@ -67,6 +68,11 @@ static FAutoConsoleCommandWithWorld UpdateStaticMeshComponentsCmd(
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+IVoxelProceduralMeshComponent_PhysicsCallbackHandler::IVoxelProceduralMeshComponent_PhysicsCallbackHandler()
+	: CookingCaches(MakeVoxelShared<FVoxelCollisionCookingCaches>())
+{
+}
+
 void IVoxelProceduralMeshComponent_PhysicsCallbackHandler::TickHandler()
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -123,6 +129,7 @@ void UVoxelProceduralMeshComponent::Init(
 	bSimpleCubicCollision = RendererSettings.bSimpleCubicCollision;
 	NumConvexHullsPerAxis = RendererSettings.NumConvexHullsPerAxis;
 	bCleanCollisionMesh = RendererSettings.bCleanCollisionMeshes;
+	CollisionDecimationMaxError = LOD >= RendererSettings.CollisionDecimationMinLOD ? RendererSettings.CollisionDecimationMaxError : 0.f;
 	bClearProcMeshBuffersOnFinishUpdate = RendererSettings.bStaticWorld && !RendererSettings.bRenderWorld; // We still need the buffers if we are rendering!
 	DistanceFieldSelfShadowBias = RendererSettings.DistanceFieldSelfShadowBias;
 	bContributesToStaticLighting = RendererSettings.bContributesToStaticLighting;
@@ -56,9 +56,10 @@ void FVoxelRawStaticIndexBuffer::SetIndices(const TArray<uint32>& InIndices, EIn
 	UpdateCachedNumIndices();
 }
 
-void FVoxelRawStaticIndexBuffer::AllocateData(int32 NumInIndices)
+void FVoxelRawStaticIndexBuffer::AllocateData(int32 NumInIndices, int32 NumVertices)
 {
-	const bool bShouldUse32Bit = NumInIndices > MAX_uint16;
+	// Max index is NumVertices - 1
+	const bool bShouldUse32Bit = NumVertices > MAX_uint16 + 1;
 
 	// Allocate storage for the indices.
 	const int32 IndexStride = bShouldUse32Bit ? sizeof(uint32) : sizeof(uint16);
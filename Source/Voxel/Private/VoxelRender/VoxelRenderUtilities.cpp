@@ -214,9 +214,9 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 
 			if (NumTextureCoordinates == -1)
 			{
-				NumTextureCoordinates = ChunkBuffers.TextureCoordinates.Num();
+				NumTextureCoordinates = ChunkBuffers.GetNumTextureCoordinates();
 			}
-			else if (!ensure(NumTextureCoordinates == ChunkBuffers.TextureCoordinates.Num()))
+			else if (!ensure(NumTextureCoordinates == ChunkBuffers.GetNumTextureCoordinates()))
 			{
 				NumTextureCoordinates = -2;
 			}
@@ -259,9 +259,10 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			ColorBuffer.Init(NumVertices, FVoxelProcMeshBuffers::bNeedsCPUAccess);
 			TextureData.Reserve(NumTextureData);
 		}
-		IndexBuffer.AllocateData(NumIndices);
-		AdjacencyIndexBuffer.AllocateData(NumAdjacencyIndices);
+		IndexBuffer.AllocateData(NumIndices, NumVertices);
+		AdjacencyIndexBuffer.AllocateData(NumAdjacencyIndices, NumVertices);
 		CollisionCubes.Reserve(NumCollisionCubes);
+		ProcMeshBuffers.ChunkRanges.Reserve(ProcMeshBuffers.Guids.Num());
 	}
 
 	CHECK_CANCEL();
@@ -276,7 +277,7 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 		const int32 ChunkNumVertices = Chunk.GetNumVertices();
 		for (int32 Index = 0; Index < ChunkNumVertices; Index++)
 		{
-			PositionBuffer.VertexPosition(VerticesOffset + Index) = FVoxelUtilities::Get(Chunk.Positions, Index) + Offset;
+			PositionBuffer.VertexPosition(VerticesOffset + Index) = Chunk.GetPosition(Index) + Offset;
 		}
 	};
 	const auto CopyColorsAndTextureData = [&](const FVoxelChunkMeshBuffers& Chunk)
@@ -329,15 +330,14 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 		for (int32 Index = 0; Index < ChunkNumVertices; Index++)
 		{
 			{
-				auto& Tangent = FVoxelUtilities::Get(Chunk.Tangents, Index);
-				auto& Normal = FVoxelUtilities::Get(Chunk.Normals, Index);
+				const FVoxelProcMeshTangent Tangent = Chunk.GetTangent(Index);
+				const FVector Normal = Chunk.GetNormal(Index);
 				StaticMeshBuffer.SetVertexTangents(VerticesOffset + Index, Tangent.TangentX, Tangent.GetY(Normal), Normal);
 			}
-			check(Chunk.TextureCoordinates.Num() == NumTextureCoordinates);
+			check(Chunk.GetNumTextureCoordinates() == NumTextureCoordinates);
 			for (int32 Tex = 0; Tex < NumTextureCoordinates; Tex++)
 			{
-				auto& TextureCoordinate = FVoxelUtilities::Get(Chunk.TextureCoordinates[Tex], Index);
-				StaticMeshBuffer.SetVertexUV(VerticesOffset + Index, Tex, TextureCoordinate);
+				StaticMeshBuffer.SetVertexUV(VerticesOffset + Index, Tex, Chunk.GetTextureCoordinate(Tex, Index));
 			}
 		}
 	};
@@ -370,6 +370,13 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			ToNoGrowArray(CollisionCubes).Add(Cube.ShiftBy(Offset));
 		}
 	};
+	const auto AddChunkRange = [&](const FVoxelChunkMeshBuffers& Chunk)
+	{
+		if (Chunk.GetNumVertices() > 0)
+		{
+			ProcMeshBuffers.ChunkRanges.Add({ VerticesOffset, Chunk.GetNumVertices(), IndicesOffset, Chunk.Indices.Num() });
+		}
+	};
 	
 	for (const FVoxelChunkMeshSection& Chunk : Sections)
 	{
@@ -391,8 +398,8 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 				for (int32 Index = 0; Index < MainChunk.GetNumVertices(); Index++)
 				{
 					PositionBuffer.VertexPosition(VerticesOffset + Index) = FVoxelMesherUtilities::GetTranslatedTransvoxel(
-						FVoxelUtilities::Get(MainChunk.Positions, Index),
-						FVoxelUtilities::Get(MainChunk.Normals, Index),
+						MainChunk.GetPosition(Index),
+						MainChunk.GetNormal(Index),
 						Chunk.TransitionsMask,
 						Chunk.LOD) + PositionOffset;
 				}
@@ -406,6 +413,7 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			CopyStaticMesh(MainChunk);
 			CopyIndices(MainChunk);
 			CopyCollisionCubes(MainChunk, PositionOffset);
+			AddChunkRange(MainChunk);
 
 			if (Chunk.bEnableTessellation)
 			{
@@ -429,6 +437,7 @@ TUniquePtr<FVoxelProcMeshBuffers> FVoxelRenderUtilities::MergeSections_AnyThread
 			CopyStaticMesh(TransitionChunk);
 			CopyIndices(TransitionChunk);
 			CopyCollisionCubes(TransitionChunk, PositionOffset);
+			AddChunkRange(TransitionChunk);
 
 			if (Chunk.bEnableTessellation)
 			{
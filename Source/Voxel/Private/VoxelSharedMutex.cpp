@@ -0,0 +1,58 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelSharedMutex.h"
+
+struct FVoxelCompactSharedMutexParkingBucket
+{
+	std::mutex Mutex;
+	std::condition_variable Condition;
+};
+
+// Too many mutexes to give each its own condition variable: mutexes share them based on their address
+static FVoxelCompactSharedMutexParkingBucket& GetParkingBucket(const void* Mutex)
+{
+	constexpr uint32 NumBuckets = 64;
+	// Never destroyed, as mutexes might be unlocked during static destruction
+	static auto* Buckets = new FVoxelCompactSharedMutexParkingBucket[NumBuckets];
+	return Buckets[PointerHash(Mutex) % NumBuckets];
+}
+
+void FVoxelCompactSharedMutex::Park(uint32 BlockingMask)
+{
+	VOXEL_SCOPE_COUNTER("FVoxelCompactSharedMutex::Park");
+
+	auto& Bucket = GetParkingBucket(this);
+	std::unique_lock<std::mutex> Lock(Bucket.Mutex);
+
+	// WaitersBit is set under the bucket lock, and Unpark takes it: the wake up can't be missed
+	uint32 OldState = State.Load();
+	while ((OldState & BlockingMask) && !(OldState & WaitersBit))
+	{
+		if (State.CompareExchange(OldState, OldState | WaitersBit))
+		{
+			OldState |= WaitersBit;
+		}
+	}
+
+	if (OldState & BlockingMask)
+	{
+		Bucket.Condition.wait(Lock);
+	}
+}
+
+void FVoxelCompactSharedMutex::Unpark()
+{
+	VOXEL_SCOPE_COUNTER("FVoxelCompactSharedMutex::Unpark");
+
+	auto& Bucket = GetParkingBucket(this);
+	{
+		std::lock_guard<std::mutex> Lock(Bucket.Mutex);
+
+		uint32 OldState = State.Load();
+		while ((OldState & WaitersBit) && !State.CompareExchange(OldState, OldState & ~WaitersBit))
+		{
+		}
+	}
+	// Other mutexes might share the bucket: wake everyone, the threads still blocked park again
+	Bucket.Condition.notify_all();
+}
\ No newline at end of file
@@ -1,9 +1,72 @@
 // Copyright 2020 Phyronnaz
 
 #include "VoxelTests.h"
+#include "VoxelValue.h"
 #include "VoxelMaterial.h"
+#include "VoxelQueryZone.h"
+#include "VoxelItemStack.h"
+#include "VoxelBoundedMpscQueue.h"
+#include "VoxelLatencyStats.h"
+#include "VoxelData/VoxelDataOctree.h"
+#include "VoxelData/VoxelDataLeafIndex.h"
+#include "VoxelData/VoxelDataOctreeLeafData.h"
+#include "VoxelData/VoxelSaveUtilities.h"
+#include "VoxelRender/VoxelChunkMesh.h"
+#include "VoxelRender/Meshers/VoxelGreedyCubicMesher.h"
+#include "VoxelRender/LODManager/VoxelClipmapLODManager.h"
+#include "VoxelRender/PhysicsCooker/VoxelAsyncPhysicsCooker.h"
+#include "VoxelGenerators/VoxelGenerator.h"
+#include "VoxelGenerators/VoxelGeneratorHelpers.h"
+#include "VoxelGenerators/VoxelTransformableGeneratorHelper.h"
+#include "VoxelPlaceableItems/VoxelPlaceableItem.h"
+#include "VoxelUtilities/VoxelOctreeUtilities.h"
+#include "VoxelUtilities/VoxelIntVectorUtilities.h"
+#include "VoxelUtilities/VoxelDistanceFieldUtilities.h"
 #include "VoxelUtilities/VoxelSerializationUtilities.h"
 #include "VoxelContainers/VoxelStaticArray.h"
+#include "HAL/IConsoleManager.h"
+
+// Values & materials varying with the position, with a value range tight enough to skip some merges
+class FVoxelTestsWaveGeneratorInstance : public TVoxelGeneratorInstanceHelper<FVoxelTestsWaveGeneratorInstance, UVoxelTransformableGenerator>
+{
+public:
+	using Super = TVoxelGeneratorInstanceHelper<FVoxelTestsWaveGeneratorInstance, UVoxelTransformableGenerator>;
+
+	const uint8 Id;
+	const v_flt Offset;
+
+	FVoxelTestsWaveGeneratorInstance(uint8 Id, v_flt Offset)
+		: Super(nullptr)
+		, Id(Id)
+		, Offset(Offset)
+	{
+	}
+
+	//~ Begin FVoxelGeneratorInstance Interface
+	v_flt GetValueImpl(v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const
+	{
+		return FMath::Clamp<v_flt>(Offset + 0.5f * (FMath::Sin(X * 0.3f) + FMath::Cos(Y * 0.2f)) + Z * 0.1f, -1, 1);
+	}
+	FVoxelMaterial GetMaterialImpl(v_flt X, v_flt Y, v_flt Z, int32 LOD, const FVoxelItemStack& Items) const
+	{
+		FVoxelMaterial Material(ForceInit);
+		Material.SetColor(FColor(Id, FMath::FloorToInt(X) & 0xFF, FMath::FloorToInt(Y) & 0xFF, FMath::FloorToInt(Z) & 0xFF));
+		return Material;
+	}
+	TVoxelRange<v_flt> GetValueRangeImpl(const FVoxelIntBox& Bounds, int32 LOD, const FVoxelItemStack& Items) const
+	{
+		return
+		{
+			FMath::Clamp<v_flt>(Offset - 1 + Bounds.Min.Z * 0.1f, -1, 1),
+			FMath::Clamp<v_flt>(Offset + 1 + Bounds.Max.Z * 0.1f, -1, 1)
+		};
+	}
+	FVector GetUpVector(v_flt X, v_flt Y, v_flt Z) const override final
+	{
+		return FVector::UpVector;
+	}
+	//~ End FVoxelGeneratorInstance Interface
+};
 
 struct FVoxelTestsImpl
 {
@@ -65,12 +128,892 @@ struct FVoxelTestsImpl
 		FVoxelSerializationUtilities::TestCompression(128, EVoxelCompressionLevel::BestCompression);
 		//FVoxelSerializationUtilities::TestCompression(1llu << 32, EVoxelCompressionLevel::BestSpeed);
 	}
+
+	static void TestQueryZone()
+	{
+		const auto GetTestValue = [](int32 X, int32 Y, int32 Z)
+		{
+			return X + 1000 * Y + 1000000 * Z;
+		};
+		
+		constexpr int32 LOD = 1;
+		const FVoxelIntBox Bounds(FIntVector(-6, 2, 4), FIntVector(14, 22, 30));
+		const FIntVector Size = Bounds.Size() / (1 << LOD);
+
+		TArray<int32> Data;
+		Data.SetNumZeroed(Size.X * Size.Y * Size.Z);
+		TVoxelQueryZone<int32> QueryZone(Bounds, Size, LOD, Data);
+
+		// Only fill part of the zone, to check that the offsets are correct
+		auto SubQueryZone = QueryZone.ShrinkTo(FVoxelIntBox(FIntVector(-2, 2, 6), FIntVector(14, 20, 28)));
+
+		TVoxelQueryZoneZMajorBuffer<int32> Buffer(SubQueryZone);
+		for (VOXEL_QUERY_ZONE_ITERATE(SubQueryZone, X))
+		{
+			for (VOXEL_QUERY_ZONE_ITERATE(SubQueryZone, Y))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(SubQueryZone, Z))
+				{
+					Buffer.Add(GetTestValue(X, Y, Z));
+				}
+			}
+		}
+		Buffer.Flush();
+		
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+		{
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+				{
+					const int32 Expected = SubQueryZone.Bounds.Contains(X, Y, Z) ? GetTestValue(X, Y, Z) : 0;
+					checkf(QueryZone.Get(X, Y, Z) == Expected, TEXT("%d %d %d"), X, Y, Z);
+				}
+			}
+		}
+	}
+
+	static void TestBoundedMpscQueue()
+	{
+		constexpr uint32 Capacity = 8;
+		const auto Queue = MakeUnique<TVoxelBoundedMpscQueue<int32, Capacity>>();
+
+		int32 Value;
+		check(!Queue->Dequeue(Value));
+
+		// Several laps, to check that the sequence numbers wrap correctly
+		int32 Next = 0;
+		for (int32 Lap = 0; Lap < 4; Lap++)
+		{
+			const int32 First = Next;
+			for (uint32 Index = 0; Index < Capacity; Index++)
+			{
+				check(Queue->Enqueue(Next++));
+			}
+			check(!Queue->Enqueue(-1));
+
+			// Free half the cells and fill them again
+			for (int32 Expected = First; Expected < First + int32(Capacity) / 2; Expected++)
+			{
+				check(Queue->Dequeue(Value) && Value == Expected);
+			}
+			for (uint32 Index = 0; Index < Capacity / 2; Index++)
+			{
+				check(Queue->Enqueue(Next++));
+			}
+			check(!Queue->Enqueue(-1));
+			
+			for (int32 Expected = First + int32(Capacity) / 2; Expected < Next; Expected++)
+			{
+				check(Queue->Dequeue(Value) && Value == Expected);
+			}
+			check(!Queue->Dequeue(Value));
+		}
+	}
+
+	static void TestLeafIndex()
+	{
+		FVoxelDataLeafIndex LeafIndex;
+		{
+			FVoxelDataOctreeParent Octree(2);
+
+			// Creates 64 leaves
+			FVoxelOctreeUtilities::IterateEntireTree(Octree, [&](FVoxelDataOctreeBase& Tree)
+			{
+				if (!Tree.IsLeaf())
+				{
+					Tree.AsParent().CreateChildren(LeafIndex);
+				}
+			});
+			check(LeafIndex.GetNum() == 64);
+
+			FVoxelOctreeUtilities::IterateAllLeaves(Octree, [&](FVoxelDataOctreeLeaf& Leaf)
+			{
+				const FIntVector Min = Leaf.GetMin();
+				check(LeafIndex.Find(Min.X, Min.Y, Min.Z) == &Leaf);
+				check(LeafIndex.Find(Min.X + DATA_CHUNK_SIZE - 1, Min.Y + DATA_CHUNK_SIZE - 1, Min.Z + DATA_CHUNK_SIZE - 1) == &Leaf);
+			});
+
+			// Removing leaves must not break the probe sequences of the others
+			auto& Child = Octree.GetChild(0).AsParent();
+			const FIntVector ChildMin = Child.GetMin();
+			Child.DestroyChildren(LeafIndex);
+			check(LeafIndex.GetNum() == 56);
+			check(!LeafIndex.Find(ChildMin.X, ChildMin.Y, ChildMin.Z));
+
+			FVoxelOctreeUtilities::IterateAllLeaves(Octree, [&](FVoxelDataOctreeLeaf& Leaf)
+			{
+				const FIntVector Min = Leaf.GetMin();
+				check(LeafIndex.Find(Min.X, Min.Y, Min.Z) == &Leaf);
+			});
+
+			// Destroying the whole octree doesn't update the index, it's reset instead
+			LeafIndex.Reset();
+			check(!LeafIndex.Find(0, 0, 0));
+		}
+		check(LeafIndex.GetNum() == 0);
+	}
+
+	static void TestMaterialsPalette()
+	{
+		if (FVoxelMaterial::NumChannels < 2)
+		{
+			// All the materials would be the same
+			return;
+		}
+		
+		// Channel 0 is the same for all the materials, so that the save stores it as a single value
+		const auto MakeMaterial = [](int32 Seed)
+		{
+			FVoxelMaterial Material(ForceInit);
+			for (int32 Channel = 1; Channel < FVoxelMaterial::NumChannels; Channel++)
+			{
+				Material.GetRaw(Channel) = uint8(16 * Seed + Channel);
+			}
+			return Material;
+		};
+		// Runs of 7 voxels, to also go through the identical neighbors fast path
+		const auto GetExpected = [&](int32 Index)
+		{
+			return MakeMaterial(Index == 0 ? 3 : (Index / 7) % 3);
+		};
+		const auto CheckMaterials = [&](const TVoxelDataOctreeLeafData<FVoxelMaterial>& Data, bool bWritten)
+		{
+			TArray<FVoxelMaterial> Copy;
+			Copy.SetNumUninitialized(VOXELS_PER_DATA_CHUNK);
+			Data.CopyTo(Copy.GetData());
+			for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+			{
+				const FVoxelMaterial Expected = bWritten ? GetExpected(Index) : MakeMaterial((Index / 7) % 3);
+				checkf(Data.Get(Index) == Expected, TEXT("%d"), Index);
+				checkf(Copy[Index] == Expected, TEXT("%d"), Index);
+			}
+		};
+
+		const IVoxelDataOctreeMemory Memory;
+		TVoxelDataOctreeLeafData<FVoxelMaterial> Materials;
+		Materials.CreateData(Memory, [&](FVoxelMaterial* RESTRICT DataPtr)
+		{
+			for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+			{
+				DataPtr[Index] = MakeMaterial((Index / 7) % 3);
+			}
+		});
+
+		// Most channels are used: only the palette can compress it
+		Materials.Compress(Memory);
+		check(Materials.IsUsingPalette());
+		CheckMaterials(Materials, false);
+
+		// Writing a material that isn't in the palette expands it
+		Materials.PrepareForWrite(Memory);
+		check(!Materials.IsUsingPalette());
+		CheckMaterials(Materials, false);
+		Materials.GetRef(0) = MakeMaterial(3);
+		CheckMaterials(Materials, true);
+
+		Materials.Compress(Memory);
+		check(Materials.IsUsingPalette());
+		CheckMaterials(Materials, true);
+
+		// Save and load the palettized leaf
+		TVoxelDataOctreeLeafData<FVoxelValue> Values;
+		Values.SetSingleValue(FVoxelValue::Empty());
+		Values.SetIsDirty(true, Memory);
+		Materials.SetIsDirty(true, Memory);
+
+		FVoxelUncompressedWorldSaveImpl Save;
+		{
+			TArray<FVoxelObjectArchiveEntry> Objects;
+			FVoxelSaveBuilder Builder(1);
+			Builder.AddChunk(FIntVector::ZeroValue, Values, Materials);
+			Builder.Save(Save, Objects);
+		}
+
+		TVoxelDataOctreeLeafData<FVoxelValue> LoadedValues;
+		TVoxelDataOctreeLeafData<FVoxelMaterial> LoadedMaterials;
+		{
+			const FVoxelSaveLoader Loader(Save);
+			check(Loader.NumChunks() == 1);
+			Loader.ExtractChunk(0, Memory, LoadedValues, LoadedMaterials);
+		}
+		check(LoadedMaterials.IsDirty());
+		CheckMaterials(LoadedMaterials, true);
+
+		LoadedMaterials.PrepareForWrite(Memory);
+		LoadedMaterials.Compress(Memory);
+		check(LoadedMaterials.IsUsingPalette());
+		CheckMaterials(LoadedMaterials, true);
+
+		Values.ClearData(Memory);
+		Materials.ClearData(Memory);
+		LoadedValues.ClearData(Memory);
+		LoadedMaterials.ClearData(Memory);
+	}
+
+	// Grid of NumCells^2 quads covering a chunk at LOD 0, with Z = Height(X, Y)
+	template<typename T>
+	static void BuildGridMesh(FVoxelChunkMeshBuffers& Buffers, int32 NumCells, T Height)
+	{
+		const float CellSize = float(RENDER_CHUNK_SIZE) / NumCells;
+		for (int32 Y = 0; Y <= NumCells; Y++)
+		{
+			for (int32 X = 0; X <= NumCells; X++)
+			{
+				Buffers.Positions.Add(FVector(X * CellSize, Y * CellSize, Height(X * CellSize, Y * CellSize)));
+			}
+		}
+		for (int32 Y = 0; Y < NumCells; Y++)
+		{
+			for (int32 X = 0; X < NumCells; X++)
+			{
+				const uint32 Index00 = X + Y * (NumCells + 1);
+				const uint32 Index10 = Index00 + 1;
+				const uint32 Index01 = Index00 + NumCells + 1;
+				const uint32 Index11 = Index01 + 1;
+				Buffers.Indices.Append({ Index00, Index11, Index10 });
+				Buffers.Indices.Append({ Index00, Index01, Index11 });
+			}
+		}
+	}
+
+	static void TestDecimation()
+	{
+		// Flat surface: the triangle count must drop, and the vertices in the outer layer of cells must be kept
+		{
+			FVoxelChunkMeshBuffers Buffers;
+			// Half voxel cells, so that some vertices are in the outer layer without being on the mesh open border
+			BuildGridMesh(Buffers, 2 * RENDER_CHUNK_SIZE, [](float X, float Y) { return 8.f; });
+			const TArray<FVector> OldPositions = Buffers.Positions;
+			const int32 OldNumIndices = Buffers.Indices.Num();
+
+			Buffers.Decimate(0, 0.1f);
+
+			check(Buffers.Indices.Num() < OldNumIndices);
+
+			const TSet<FVector> NewPositions(Buffers.Positions);
+			for (const FVector& Position : OldPositions)
+			{
+				if (Position.X < 1 || Position.X > RENDER_CHUNK_SIZE - 1 ||
+					Position.Y < 1 || Position.Y > RENDER_CHUNK_SIZE - 1)
+				{
+					check(NewPositions.Contains(Position));
+				}
+			}
+		}
+
+		// Curved surface: no vertex of the original mesh can be further than MaxError from the decimated one
+		{
+			constexpr float MaxError = 0.25f;
+
+			FVoxelChunkMeshBuffers Buffers;
+			BuildGridMesh(Buffers, RENDER_CHUNK_SIZE, [](float X, float Y) { return 8.f + 2.f * FMath::Sin(X * 0.3f) * FMath::Cos(Y * 0.2f); });
+			const TArray<FVector> OldPositions = Buffers.Positions;
+			const int32 OldNumIndices = Buffers.Indices.Num();
+
+			Buffers.Decimate(0, MaxError);
+
+			check(Buffers.Indices.Num() < OldNumIndices);
+
+			for (const FVector& Position : OldPositions)
+			{
+				float MinDistance = MAX_flt;
+				for (int32 Index = 0; Index < Buffers.Indices.Num(); Index += 3)
+				{
+					const FVector ClosestPoint = FMath::ClosestPointOnTriangleToPoint(
+						Position,
+						Buffers.Positions[Buffers.Indices[Index + 0]],
+						Buffers.Positions[Buffers.Indices[Index + 1]],
+						Buffers.Positions[Buffers.Indices[Index + 2]]);
+					MinDistance = FMath::Min(MinDistance, FVector::Distance(Position, ClosestPoint));
+				}
+				checkf(MinDistance <= MaxError + KINDA_SMALL_NUMBER, TEXT("%s is %f away from the decimated mesh"), *Position.ToString(), MinDistance);
+			}
+		}
+	}
+
+	static void TestConvexHullsGrid()
+	{
+		constexpr int32 ChunkSize = RENDER_CHUNK_SIZE;
+		constexpr int32 CellSize = ChunkSize / 2;
+
+		// Single chunk: the border vertices go in the last cells
+		{
+			const FVoxelConvexHullsGrid Grid(FBox(FVector(0), FVector(ChunkSize)), ChunkSize, 2);
+			check(Grid.Size == FIntVector(2));
+			check(Grid.GetCell(FVector(0)) == FIntVector(0));
+			check(Grid.GetCell(FVector(ChunkSize)) == FIntVector(1));
+		}
+
+		// Merged chunks: the vertices of the other chunks must not be clamped in the first one
+		{
+			const FVoxelConvexHullsGrid Grid(FBox(FVector(0), FVector(3 * ChunkSize, ChunkSize, ChunkSize)), ChunkSize, 2);
+			check(Grid.Size == FIntVector(6, 2, 2));
+			check(Grid.Num() == 24);
+			check(Grid.GetCell(FVector(ChunkSize + 1, 1, 1)) == FIntVector(2, 0, 0));
+			check(Grid.GetCell(FVector(2 * ChunkSize + CellSize + 1, 1, 1)) == FIntVector(5, 0, 0));
+			check(Grid.GetCell(FVector(3 * ChunkSize, ChunkSize, ChunkSize)) == FIntVector(5, 1, 1));
+
+			TSet<int32> Indices;
+			for (int32 Z = 0; Z < Grid.Size.Z; Z++)
+			{
+				for (int32 Y = 0; Y < Grid.Size.Y; Y++)
+				{
+					for (int32 X = 0; X < Grid.Size.X; X++)
+					{
+						const int32 Index = Grid.GetIndex(Grid.GetCell(FVector(X, Y, Z) * CellSize + 1));
+						check(0 <= Index && Index < Grid.Num());
+						Indices.Add(Index);
+					}
+				}
+			}
+			check(Indices.Num() == Grid.Num());
+		}
+
+		// The cells don't depend on the mesh bounds, so that the vertices of unchanged cells end up in the same hulls after an edit
+		{
+			const FVoxelConvexHullsGrid GridA(FBox(FVector(0), FVector(2 * ChunkSize)), ChunkSize, 2);
+			const FVoxelConvexHullsGrid GridB(FBox(FVector(CellSize + 3, 5, -7), FVector(2 * ChunkSize - 1)), ChunkSize, 2);
+			check(GridB.Min == FIntVector(1, 0, -1));
+
+			for (const FVector& Position : { FVector(CellSize + 4, 6, 2), FVector(ChunkSize + 3), FVector(2 * ChunkSize - 2) })
+			{
+				check(GridA.Min + GridA.GetCell(Position) == GridB.Min + GridB.GetCell(Position));
+			}
+		}
+	}
+
+	static void TestLatencyHistogram()
+	{
+		for (uint64 Microseconds = 0; Microseconds < 100000; Microseconds++)
+		{
+			const int32 Bucket = FVoxelLatencyHistogram::GetBucket(Microseconds);
+			check(Microseconds < FVoxelLatencyHistogram::GetBucketUpperBound(Bucket));
+			check(Bucket == 0 || FVoxelLatencyHistogram::GetBucketUpperBound(Bucket - 1) <= Microseconds);
+		}
+
+		FVoxelLatencyHistogram Histogram;
+		for (int32 Index = 1; Index <= 1000; Index++)
+		{
+			Histogram.Add(Index / 1e6);
+		}
+		check(Histogram.GetNum() == 1000);
+		check(Histogram.GetMax() == 1000 / 1e6);
+		// Within one bucket, ie 12.5%
+		check(FMath::IsNearlyEqual(Histogram.GetPercentile(0.5), 500 / 1e6, 500 / 1e6 / 8));
+		check(FMath::IsNearlyEqual(Histogram.GetPercentile(0.99), 990 / 1e6, 990 / 1e6 / 8));
+	}
+
+	// Rolling hills with a few caves, similar to what the cubic mesher sees on a terrain surface chunk
+	// Faces have the same layouts as FVoxelGreedyCubicMesher::CreateGeometryTemplate
+	static void BuildGreedyMeshingChunk(TVoxelStaticArray<FVoxelGreedyCubicMesher::FChunkBitArray, 6>& Faces, FVoxelGreedyCubicMesher::FChunkBitArray& Solid)
+	{
+		constexpr int32 GridSize = RENDER_CHUNK_SIZE;
+		
+		const auto GetIndex = [](int32 X, int32 Y, int32 Z)
+		{
+			return X + Y * GridSize + Z * GridSize * GridSize;
+		};
+
+		FRandomStream Stream(1337);
+		Solid = FVoxelGreedyCubicMesher::FChunkBitArray(ForceInit);
+		for (int32 Z = 0; Z < GridSize; Z++)
+		{
+			for (int32 Y = 0; Y < GridSize; Y++)
+			{
+				for (int32 X = 0; X < GridSize; X++)
+				{
+					const float Height = GridSize / 2 + 6 * FMath::Sin(X * 0.2f) * FMath::Cos(Y * 0.15f) + 3 * FMath::Sin((X + Y) * 0.5f);
+					Solid.Set(GetIndex(X, Y, Z), Z < Height && Stream.FRand() > 0.05f);
+				}
+			}
+		}
+		
+		const auto IsSolid = [&](int32 X, int32 Y, int32 Z)
+		{
+			return
+				0 <= X && X < GridSize &&
+				0 <= Y && Y < GridSize &&
+				0 <= Z && Z < GridSize &&
+				Solid.Test(GetIndex(X, Y, Z));
+		};
+
+		Faces.Memzero();
+		for (int32 Z = 0; Z < GridSize; Z++)
+		{
+			for (int32 Y = 0; Y < GridSize; Y++)
+			{
+				for (int32 X = 0; X < GridSize; X++)
+				{
+					if (!IsSolid(X, Y, Z))
+					{
+						continue;
+					}
+
+					if (!IsSolid(X - 1, Y, Z)) Faces[0].Set(GetIndex(Y, Z, X), true);
+					if (!IsSolid(X + 1, Y, Z)) Faces[1].Set(GetIndex(Y, Z, X), true);
+					if (!IsSolid(X, Y - 1, Z)) Faces[2].Set(GetIndex(Z, X, Y), true);
+					if (!IsSolid(X, Y + 1, Z)) Faces[3].Set(GetIndex(Z, X, Y), true);
+					if (!IsSolid(X, Y, Z - 1)) Faces[4].Set(GetIndex(X, Y, Z), true);
+					if (!IsSolid(X, Y, Z + 1)) Faces[5].Set(GetIndex(X, Y, Z), true);
+				}
+			}
+		}
+	}
+	// Runs the greedy meshing NumIterations times, returns the time per chunk in seconds
+	static double RunGreedyMeshing(bool bGeneric, int32 NumIterations, TArray<FVoxelGreedyCubicMesher::FCubicQuad>& OutQuads, TArray<FVoxelIntBox>& OutCubes)
+	{
+		TVoxelStaticArray<FVoxelGreedyCubicMesher::FChunkBitArray, 6> Faces;
+		FVoxelGreedyCubicMesher::FChunkBitArray Solid;
+		BuildGreedyMeshingChunk(Faces, Solid);
+		
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+		{
+			OutQuads.Reset();
+			OutCubes.Reset();
+
+			// Greedy meshing clears the bits
+			auto FacesCopy = Faces;
+			auto SolidCopy = Solid;
+			FVoxelGreedyCubicMesher::GreedyMeshChunk(bGeneric, FacesCopy, SolidCopy, OutQuads, OutCubes);
+		}
+		const double EndTime = FPlatformTime::Seconds();
+		return (EndTime - StartTime) / NumIterations;
+	}
+	static bool IsSameGreedyMeshing(
+		const TArray<FVoxelGreedyCubicMesher::FCubicQuad>& QuadsA, const TArray<FVoxelIntBox>& CubesA,
+		const TArray<FVoxelGreedyCubicMesher::FCubicQuad>& QuadsB, const TArray<FVoxelIntBox>& CubesB)
+	{
+		return
+			QuadsA.Num() == QuadsB.Num() &&
+			FMemory::Memcmp(QuadsA.GetData(), QuadsB.GetData(), QuadsA.Num() * sizeof(FVoxelGreedyCubicMesher::FCubicQuad)) == 0 &&
+			CubesA == CubesB;
+	}
+	
+	static void TestGreedyMeshing()
+	{
+		TArray<FVoxelGreedyCubicMesher::FCubicQuad> GenericQuads;
+		TArray<FVoxelIntBox> GenericCubes;
+		RunGreedyMeshing(true, 1, GenericQuads, GenericCubes);
+		check(GenericQuads.Num() > 0 && GenericCubes.Num() > 0);
+
+		TArray<FVoxelGreedyCubicMesher::FCubicQuad> Quads;
+		TArray<FVoxelIntBox> Cubes;
+		RunGreedyMeshing(false, 1, Quads, Cubes);
+		check(IsSameGreedyMeshing(Quads, Cubes, GenericQuads, GenericCubes));
+	}
+	
+	static void TestDistanceTransform()
+	{
+		// Not a cube to catch axis mixups
+		const FIntVector Size(7, 6, 5);
+		const int32 Num = Size.X * Size.Y * Size.Z;
+
+		const auto GetPosition = [&](int32 Index)
+		{
+			return FIntVector(Index % Size.X, (Index / Size.X) % Size.Y, Index / (Size.X * Size.Y));
+		};
+
+		// Surface positions store the index of their voxel, to know which one was picked
+		const auto Test = [&](TFunctionRef<bool(const FIntVector&)> IsSurface)
+		{
+			TArray<FVector> SurfacePositions;
+			SurfacePositions.SetNumUninitialized(Num);
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				SurfacePositions[Index] = IsSurface(GetPosition(Index)) ? FVector(Index, 0, 0) : FVoxelDistanceFieldUtilities::MakeInvalidSurfacePosition();
+			}
+			const TArray<FVector> InitialSurfacePositions = SurfacePositions;
+
+			FVoxelDistanceFieldUtilities::ExactDistanceTransform(Size, SurfacePositions);
+
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				const FIntVector Position = GetPosition(Index);
+
+				// Brute force closest surface voxel
+				uint64 BestSquaredDistance = MAX_uint64;
+				for (int32 SurfaceIndex = 0; SurfaceIndex < Num; SurfaceIndex++)
+				{
+					if (FVoxelDistanceFieldUtilities::IsSurfacePositionValid(InitialSurfacePositions[SurfaceIndex]))
+					{
+						BestSquaredDistance = FMath::Min(BestSquaredDistance, FVoxelUtilities::SquaredSize(GetPosition(SurfaceIndex) - Position));
+					}
+				}
+
+				const FVector& SurfacePosition = SurfacePositions[Index];
+				if (BestSquaredDistance == MAX_uint64)
+				{
+					check(!FVoxelDistanceFieldUtilities::IsSurfacePositionValid(SurfacePosition));
+					continue;
+				}
+				
+				check(FVoxelDistanceFieldUtilities::IsSurfacePositionValid(SurfacePosition));
+				const int32 SurfaceIndex = FMath::RoundToInt(SurfacePosition.X);
+				check(0 <= SurfaceIndex && SurfaceIndex < Num);
+				check(FVoxelDistanceFieldUtilities::IsSurfacePositionValid(InitialSurfacePositions[SurfaceIndex]));
+				// Ties can pick any of the closest voxels
+				check(FVoxelUtilities::SquaredSize(GetPosition(SurfaceIndex) - Position) == BestSquaredDistance);
+			}
+		};
+
+		// Empty
+		Test([](const FIntVector&) { return false; });
+		// Full
+		Test([](const FIntVector&) { return true; });
+		// Single corner: distances up to the opposite border
+		Test([](const FIntVector& P) { return P == FIntVector(0); });
+		Test([&](const FIntVector& P) { return P == Size - 1; });
+		// Border faces only
+		Test([&](const FIntVector& P) { return P.X == 0 || P.Y == Size.Y - 1 || P.Z == Size.Z - 1; });
+		// Random sparse surfaces
+		for (int32 Seed = 0; Seed < 8; Seed++)
+		{
+			FRandomStream Stream(Seed);
+			TArray<bool> IsSurface;
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				IsSurface.Add(Stream.FRand() < 0.05f * (Seed + 1));
+			}
+			Test([&](const FIntVector& P) { return IsSurface[P.X + P.Y * Size.X + P.Z * Size.X * Size.Y]; });
+		}
+	}
+	
+	static void TestClipmapRings()
+	{
+		FVoxelClipmapRings::FSettings Settings;
+		// Not aligned on the chunks, to have partial chunks on the world edges
+		Settings.WorldBounds = FVoxelIntBox(FIntVector(-3000, -3000, -700), FIntVector(3000, 3000, 700));
+		Settings.bEnableTransitions = true;
+		Settings.bEnableRender = true;
+		Settings.bEnableCollisions = true;
+		Settings.CollisionsMaxLOD = 1;
+		Settings.bEnableNavmesh = true;
+		Settings.NavmeshMaxLOD = 0;
+
+		constexpr int32 MinLOD = 0;
+		constexpr int32 MaxLOD = 3;
+		
+		FVoxelClipmapRings Rings(FVoxelClipmapRings::MinRingRadius);
+		// The chunks as seen by the renderer, only built from the updates
+		TMap<uint64, FVoxelChunkSettings> RendererChunks;
+
+		FRandomStream Stream(1337);
+		FIntVector Position(0);
+		for (int32 Step = 0; Step < 100; Step++)
+		{
+			if (Step % 25 == 24)
+			{
+				// Teleport
+				Position = FIntVector(Stream.RandRange(-4000, 4000), Stream.RandRange(-4000, 4000), Stream.RandRange(-1000, 1000));
+			}
+			else
+			{
+				const int32 Distance = Stream.RandRange(0, 3) == 0 ? 600 : 64;
+				Position += FIntVector(Stream.RandRange(-Distance, Distance), Stream.RandRange(-Distance, Distance), Stream.RandRange(-Distance, Distance));
+			}
+			
+			if (Step == 50)
+			{
+				// Same as ForceLODsUpdate when the settings change
+				Settings.bInvertTransitions = true;
+				Settings.CollisionsMaxLOD = 2;
+			}
+			
+			TArray<FVoxelChunkUpdate> ChunkUpdates;
+			Rings.Update(Settings, MinLOD, MaxLOD, Position, Step == 0 || Step == 50, ChunkUpdates);
+			for (const FVoxelChunkUpdate& ChunkUpdate : ChunkUpdates)
+			{
+				check(ChunkUpdate.NewSettings != ChunkUpdate.OldSettings);
+				if (ChunkUpdate.OldSettings.HasRenderChunk())
+				{
+					const FVoxelChunkSettings* OldSettings = RendererChunks.Find(ChunkUpdate.Id);
+					check(OldSettings && *OldSettings == ChunkUpdate.OldSettings);
+				}
+				else
+				{
+					check(!RendererChunks.Contains(ChunkUpdate.Id));
+				}
+				
+				if (ChunkUpdate.NewSettings.HasRenderChunk())
+				{
+					RendererChunks.Add(ChunkUpdate.Id, ChunkUpdate.NewSettings);
+				}
+				else
+				{
+					RendererChunks.Remove(ChunkUpdate.Id);
+				}
+			}
+
+			// Recompute from scratch
+			FVoxelClipmapRings FullRings(FVoxelClipmapRings::MinRingRadius);
+			{
+				TArray<FVoxelChunkUpdate> FullChunkUpdates;
+				FullRings.Update(Settings, MinLOD, MaxLOD, Position, true, FullChunkUpdates);
+			}
+
+			int32 NumChunks = 0;
+			for (int32 LOD = 0; LOD < Rings.GetRings().Num(); LOD++)
+			{
+				const FVoxelClipmapRings::FRing& Ring = Rings.GetRings()[LOD];
+				const FVoxelClipmapRings::FRing& FullRing = FullRings.GetRings()[LOD];
+				check(Ring.Bounds == FullRing.Bounds);
+				check(Ring.InnerBounds == FullRing.InnerBounds);
+				check(Ring.Chunks.Num() == FullRing.Chunks.Num());
+				
+				for (auto& It : FullRing.Chunks)
+				{
+					const FVoxelClipmapRings::FRingChunk* Chunk = Ring.Chunks.Find(It.Key);
+					check(Chunk && Chunk->Settings == It.Value.Settings);
+					
+					const FVoxelChunkSettings* RendererSettings = RendererChunks.Find(Chunk->Id);
+					check(RendererSettings && *RendererSettings == Chunk->Settings);
+				}
+				NumChunks += Ring.Chunks.Num();
+			}
+			check(RendererChunks.Num() == NumChunks);
+
+			// No gaps & no overlaps: each position in the world & in the outer cube is in exactly one visible chunk
+			const FVoxelIntBox OuterBounds = Rings.GetRings()[MaxLOD].Bounds;
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				const FIntVector Sample(
+					Stream.RandRange(OuterBounds.Min.X, OuterBounds.Max.X - 1),
+					Stream.RandRange(OuterBounds.Min.Y, OuterBounds.Max.Y - 1),
+					Stream.RandRange(OuterBounds.Min.Z, OuterBounds.Max.Z - 1));
+				if (!Settings.WorldBounds.Contains(Sample))
+				{
+					continue;
+				}
+
+				int32 NumVisibleChunks = 0;
+				for (int32 LOD = MinLOD; LOD <= MaxLOD; LOD++)
+				{
+					const int32 ChunkSize = FVoxelClipmapRings::GetChunkSize(LOD);
+					const FVoxelClipmapRings::FRingChunk* Chunk = Rings.GetRings()[LOD].Chunks.Find(FVoxelUtilities::DivideFloor(Sample, ChunkSize) * ChunkSize);
+					if (Chunk && Chunk->Settings.bVisible)
+					{
+						NumVisibleChunks++;
+					}
+				}
+				check(NumVisibleChunks == 1);
+			}
+		}
+	}
+	
+	template<typename T>
+	static T GetItemStackPerVoxel(const FVoxelPlaceableItemHolder& ItemHolder, const FVoxelGeneratorInstance& Generator, int32 X, int32 Y, int32 Z, int32 LOD)
+	{
+		// Same as the per-voxel query FVoxelDataOctreeBase::GetFromGeneratorAndAssets used to do
+		const auto& Assets = ItemHolder.GetAssetItems();
+		for (int32 Index = Assets.Num() - 1; Index >= 0; Index--)
+		{
+			const FVoxelAssetItem& Asset = *Assets[Index];
+			if (Asset.Bounds.Contains(X, Y, Z))
+			{
+				return Asset.Generator->Get_Transform<T>(Asset.LocalToWorld, X, Y, Z, LOD, FVoxelItemStack(ItemHolder, Generator, Index));
+			}
+		}
+		return Generator.Get<T>(X, Y, Z, LOD, FVoxelItemStack(ItemHolder));
+	}
+	static void TestItemStack()
+	{
+		const FVoxelTestsWaveGeneratorInstance Generator(0, 0.2f);
+
+		const auto MakeAsset = [](uint8 Id, v_flt Offset, bool bSubtractive, const FVoxelIntBox& Bounds, const FTransform& LocalToWorld, int32 Priority)
+		{
+			FVoxelAssetItem Asset;
+			Asset.Generator = MakeVoxelShared<TVoxelTransformableGeneratorHelper<FVoxelTestsWaveGeneratorInstance>>(MakeVoxelShared<FVoxelTestsWaveGeneratorInstance>(Id, Offset), bSubtractive);
+			Asset.Bounds = Bounds;
+			Asset.LocalToWorld = LocalToWorld;
+			Asset.Priority = Priority;
+			return Asset;
+		};
+
+		// The holder keeps pointers to the items
+		const TArray<FVoxelAssetItem> Assets =
+		{
+			MakeAsset(1, -0.3f, false, FVoxelIntBox(FIntVector(-20), FIntVector(12)), FTransform(FVector(5, -3, 2)), 0),
+			MakeAsset(2, 0.4f, true, FVoxelIntBox(FIntVector(-4, -30, -8), FIntVector(28, 6, 24)), FTransform(FRotator(0, 30, 0), FVector(-7, 1, 0), FVector(1.5f)), 1),
+			// Nested in the first one, on top of both
+			MakeAsset(3, -0.5f, false, FVoxelIntBox(FIntVector(-12, -12, -12), FIntVector(-4, 0, 4)), FTransform(FRotator(20, 0, 45), FVector(3, 3, -5)), 2),
+			// Outside all the zones
+			MakeAsset(4, 0.f, false, FVoxelIntBox(FIntVector(100), FIntVector(120)), FTransform::Identity, 3),
+		};
+		
+		FVoxelPlaceableItemHolder ItemHolder;
+		for (const FVoxelAssetItem& Asset : Assets)
+		{
+			ItemHolder.AddItem(Asset);
+		}
+		const FVoxelItemStack Items(ItemHolder, Generator, ItemHolder.GetAssetItems().Num() - 1);
+
+		const auto CheckZone = [&](const FVoxelIntBox& Bounds, int32 LOD)
+		{
+			const FIntVector Size = Bounds.Size() / (1 << LOD);
+
+			TArray<FVoxelValue> Values;
+			Values.SetNumUninitialized(Size.X * Size.Y * Size.Z);
+			TVoxelQueryZone<FVoxelValue> ValuesQueryZone(Bounds, Size, LOD, Values);
+			Items.Get(ValuesQueryZone, LOD);
+			
+			TArray<FVoxelMaterial> Materials;
+			Materials.SetNumUninitialized(Size.X * Size.Y * Size.Z);
+			TVoxelQueryZone<FVoxelMaterial> MaterialsQueryZone(Bounds, Size, LOD, Materials);
+			Items.Get(MaterialsQueryZone, LOD);
+
+			for (VOXEL_QUERY_ZONE_ITERATE(ValuesQueryZone, X))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(ValuesQueryZone, Y))
+				{
+					for (VOXEL_QUERY_ZONE_ITERATE(ValuesQueryZone, Z))
+					{
+						checkf(ValuesQueryZone.Get(X, Y, Z) == GetItemStackPerVoxel<FVoxelValue>(ItemHolder, Generator, X, Y, Z, LOD), TEXT("%d %d %d"), X, Y, Z);
+						checkf(MaterialsQueryZone.Get(X, Y, Z) == GetItemStackPerVoxel<FVoxelMaterial>(ItemHolder, Generator, X, Y, Z, LOD), TEXT("%d %d %d"), X, Y, Z);
+					}
+				}
+			}
+		};
+
+		for (int32 LOD = 0; LOD < 2; LOD++)
+		{
+			// All the items
+			CheckZone(FVoxelIntBox(FIntVector(-32), FIntVector(32)), LOD);
+			// Inside the nested item
+			CheckZone(FVoxelIntBox(FIntVector(-10, -10, -10), FIntVector(-6, -2, 2)), LOD);
+			// No item
+			CheckZone(FVoxelIntBox(FIntVector(40), FIntVector(48)), LOD);
+			// Below & above the generators value ranges, to skip the merges
+			CheckZone(FVoxelIntBox(FIntVector(-16, -16, -32), FIntVector(16, 16, -24)), LOD);
+			CheckZone(FVoxelIntBox(FIntVector(-16, -16, 24), FIntVector(16, 16, 32)), LOD);
+		}
+
+		// Zones partly overlapping the items
+		FRandomStream Stream(1337);
+		for (int32 Index = 0; Index < 50; Index++)
+		{
+			const int32 LOD = Stream.RandRange(0, 2);
+			const int32 Step = 1 << LOD;
+			// Multiple of 4 to be aligned on all the LODs
+			const FIntVector Min = FIntVector(Stream.RandRange(-10, 8), Stream.RandRange(-10, 8), Stream.RandRange(-10, 8)) * 4;
+			const FIntVector Size = FIntVector(Stream.RandRange(1, 8), Stream.RandRange(1, 8), Stream.RandRange(1, 8)) * Step;
+			CheckZone(FVoxelIntBox(Min, Min + Size), LOD);
+		}
+	}
+	
+	static void BenchmarkGreedyMeshing()
+	{
+		constexpr int32 NumIterations = 100;
+		
+		TArray<FVoxelGreedyCubicMesher::FCubicQuad> GenericQuads;
+		TArray<FVoxelIntBox> GenericCubes;
+		const double GenericTime = RunGreedyMeshing(true, NumIterations, GenericQuads, GenericCubes);
+		LOG_VOXEL(Log, TEXT("Bit by bit: %.3fms/chunk, %d quads, %d collision cubes"), GenericTime * 1000, GenericQuads.Num(), GenericCubes.Num());
+
+		TArray<FVoxelGreedyCubicMesher::FCubicQuad> Quads;
+		TArray<FVoxelIntBox> Cubes;
+		const double Time = RunGreedyMeshing(false, NumIterations, Quads, Cubes);
+		LOG_VOXEL(Log, TEXT("Word: %.3fms/chunk, %d quads, %d collision cubes"), Time * 1000, Quads.Num(), Cubes.Num());
+
+		ensure(IsSameGreedyMeshing(Quads, Cubes, GenericQuads, GenericCubes));
+	}
+
+	static void BenchmarkQueryZone()
+	{
+		// Size of a marching cubes query
+		const FVoxelIntBox Bounds(FIntVector(0), FIntVector(35));
+		constexpr int32 NumIterations = 200;
+
+		TArray<FVoxelValue> Data;
+		Data.SetNumUninitialized(int32(Bounds.Count()));
+		TVoxelQueryZone<FVoxelValue> QueryZone(Bounds, Data);
+		
+		const auto GetValue = [](int32 X, int32 Y, int32 Z)
+		{
+			return FVoxelValue(FMath::Sin(X * 0.1f) + FMath::Cos(Y * 0.1f) - Z * 0.05f);
+		};
+
+		const auto Benchmark = [&](const TCHAR* Name, auto&& Lambda)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+			{
+				Lambda();
+			}
+			const double EndTime = FPlatformTime::Seconds();
+			LOG_VOXEL(Log, TEXT("%s: %.3fms/query"), Name, (EndTime - StartTime) * 1000 / NumIterations);
+		};
+
+		Benchmark(TEXT("X, Y, Z order, Set"), [&]()
+		{
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+				{
+					for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+					{
+						QueryZone.Set(X, Y, Z, GetValue(X, Y, Z));
+					}
+				}
+			}
+		});
+		Benchmark(TEXT("X, Y, Z order, Z major buffer"), [&]()
+		{
+			TVoxelQueryZoneZMajorBuffer<FVoxelValue> Buffer(QueryZone);
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+				{
+					for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+					{
+						Buffer.Add(GetValue(X, Y, Z));
+					}
+				}
+			}
+			Buffer.Flush();
+		});
+		Benchmark(TEXT("Z, Y, X order, Set"), [&]()
+		{
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+				{
+					for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+					{
+						QueryZone.Set(X, Y, Z, GetValue(X, Y, Z));
+					}
+				}
+			}
+		});
+	}
 };
 
+static FAutoConsoleCommand CmdBenchmarkQueryZone(
+	TEXT("voxel.tests.BenchmarkQueryZone"),
+	TEXT("Compare the query zone fill orders on a 35^3 marching cubes query"),
+	FConsoleCommandDelegate::CreateStatic(&FVoxelTestsImpl::BenchmarkQueryZone));
+
+static FAutoConsoleCommand CmdBenchmarkGreedyMeshing(
+	TEXT("voxel.tests.BenchmarkGreedyMeshing"),
+	TEXT("Compare the word & the bit by bit greedy meshing of the cubic mesher on a terrain chunk"),
+	FConsoleCommandDelegate::CreateStatic(&FVoxelTestsImpl::BenchmarkGreedyMeshing));
+
 void FVoxelTests::Test()
 {
 	VOXEL_FUNCTION_COUNTER();
 
 	FVoxelTestsImpl::TestMaterials();
 	FVoxelTestsImpl::TestCompression();
+	FVoxelTestsImpl::TestQueryZone();
+	FVoxelTestsImpl::TestBoundedMpscQueue();
+	FVoxelTestsImpl::TestLeafIndex();
+	FVoxelTestsImpl::TestMaterialsPalette();
+	FVoxelTestsImpl::TestDecimation();
+	FVoxelTestsImpl::TestConvexHullsGrid();
+	FVoxelTestsImpl::TestLatencyHistogram();
+	FVoxelTestsImpl::TestGreedyMeshing();
+	FVoxelTestsImpl::TestDistanceTransform();
+	FVoxelTestsImpl::TestClipmapRings();
+	FVoxelTestsImpl::TestItemStack();
 }
\ No newline at end of file
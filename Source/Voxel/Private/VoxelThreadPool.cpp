@@ -3,6 +3,7 @@
 #include "VoxelThreadPool.h"
 #include "VoxelQueuedWork.h"
 #include "VoxelMinimal.h"
+#include "VoxelLatencyStats.h"
 #include "IVoxelPool.h"
 
 #include "HAL/Event.h"
@@ -146,15 +147,25 @@ uint32 FVoxelQueuedThread::Run()
 			while (LocalQueuedWork)
 			{
 				const FName Name = LocalQueuedWork->Name;
+				const EVoxelTaskType TaskType = LocalQueuedWork->TaskType;
+				const uint64 QueuedCycles = LocalQueuedWork->QueuedCycles;
 				
-				const double StartTime = FPlatformTime::Seconds();
+				const uint64 StartCycles = FPlatformTime::Cycles64();
 				
 				LocalQueuedWork->DoThreadedWork();
 				// IMPORTANT: LocalQueuedWork should be considered as deleted after this line
 				
-				const double EndTime = FPlatformTime::Seconds();
+				const uint64 EndCycles = FPlatformTime::Cycles64();
+				const double ExecutionTime = FPlatformTime::ToSeconds64(EndCycles - StartCycles);
 
-				FVoxelQueuedThreadPoolStats::Get().Report(Name, EndTime - StartTime);
+				FVoxelQueuedThreadPoolStats::Get().Report(Name, ExecutionTime);
+				FVoxelLatencyStats::Get().ReportTask(TaskType, FPlatformTime::ToSeconds64(StartCycles - QueuedCycles), ExecutionTime);
+
+				FVoxelTraceCapture& TraceCapture = FVoxelTraceCapture::Get();
+				if (TraceCapture.IsCapturing())
+				{
+					TraceCapture.AddTask(Name, TaskType, QueuedCycles, StartCycles, EndCycles);
+				}
 				
 				LocalQueuedWork = ThreadPool->ReturnToPoolOrGetNextJob(this);
 			}
@@ -266,6 +277,8 @@ void FVoxelQueuedThreadPool::AddQueuedWork(IVoxelQueuedWork* InQueuedWork, uint3
 		return;
 	}
 
+	InQueuedWork->QueuedCycles = FPlatformTime::Cycles64();
+
 	FQueuedWorkInfo WorkInfo;
 	{
 		VOXEL_SCOPE_COUNTER("Compute Priority");
@@ -319,6 +332,12 @@ void FVoxelQueuedThreadPool::AddQueuedWorks(const TArray<IVoxelQueuedWork*>& InQ
 		return;
 	}
 
+	const uint64 QueuedCycles = FPlatformTime::Cycles64();
+	for (auto* InQueuedWork : InQueuedWorks)
+	{
+		InQueuedWork->QueuedCycles = QueuedCycles;
+	}
+
 	{
 		VOXEL_SCOPE_COUNTER("Lock");
 		Section.Lock();
@@ -141,7 +141,7 @@ void UVoxelAssetTools::ImportModifierAssetImpl(
 			if (!Parent.HasChildren())
 			{
 				ensureThreadSafe(Parent.IsLockedForWrite());
-				Parent.CreateChildren();
+				Parent.CreateChildren(Data.GetLeafIndex());
 			}
 		}
 	});
@@ -93,6 +93,28 @@ void UVoxelDataTools::SetMaterialAsync(
 	VOXEL_TOOL_LATENT_HELPER(Write, UpdateRender, VOXEL_DATA_TOOL_PREFIX, Data.SetMaterial(Position, Material));
 }
 
+template<typename T>
+inline void CacheBoundsAsync(UObject* WorldContextObject, FLatentActionInfo LatentInfo, AVoxelWorld* World, FVoxelIntBox Bounds, FName Name, bool bHideLatentWarnings)
+{
+	// Shown by the latent action. Cancelled if it's destroyed before the cache is done, in which case the leaves already generated are kept
+	const TVoxelSharedRef<FVoxelDataProgress> Progress = MakeVoxelShared<FVoxelDataProgress>();
+	
+	FVoxelToolHelpers::StartAsyncLatentAction_WithWorld(
+		WorldContextObject,
+		LatentInfo,
+		World,
+		Name,
+		bHideLatentWarnings,
+		[=](FVoxelData& Data)
+		{
+			TVoxelScopeLock<EVoxelLockType::Write> Lock(Data, Bounds, Name);
+			Data.CacheBounds<T>(Bounds, false, &Progress.Get());
+		},
+		EVoxelUpdateRender::DoNotUpdateRender,
+		Bounds,
+		Progress);
+}
+
 void UVoxelDataTools::CacheValuesAsync(
 	UObject* WorldContextObject,
 	FLatentActionInfo LatentInfo,
@@ -100,7 +122,10 @@ void UVoxelDataTools::CacheValuesAsync(
 	FVoxelIntBox Bounds,
 	bool bHideLatentWarnings)
 {
-	VOXEL_TOOL_LATENT_HELPER(Write, DoNotUpdateRender, NO_PREFIX, Data.CacheBounds<FVoxelValue>(Bounds, false));
+	VOXEL_FUNCTION_COUNTER();
+	CHECK_VOXELWORLD_IS_CREATED_VOID();
+	CHECK_BOUNDS_ARE_VALID_VOID();
+	CacheBoundsAsync<FVoxelValue>(WorldContextObject, LatentInfo, World, Bounds, FUNCTION_FNAME, bHideLatentWarnings);
 }
 
 void UVoxelDataTools::CacheMaterialsAsync(
@@ -110,7 +135,10 @@ void UVoxelDataTools::CacheMaterialsAsync(
 	FVoxelIntBox Bounds,
 	bool bHideLatentWarnings)
 {
-	VOXEL_TOOL_LATENT_HELPER(Write, DoNotUpdateRender, NO_PREFIX, Data.CacheBounds<FVoxelMaterial>(Bounds, false));
+	VOXEL_FUNCTION_COUNTER();
+	CHECK_VOXELWORLD_IS_CREATED_VOID();
+	CHECK_BOUNDS_ARE_VALID_VOID();
+	CacheBoundsAsync<FVoxelMaterial>(WorldContextObject, LatentInfo, World, Bounds, FUNCTION_FNAME, bHideLatentWarnings);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -143,10 +171,10 @@ void UVoxelDataTools::GetSave(AVoxelWorld* World, FVoxelUncompressedWorldSave& O
 	GetSave(World, OutSave.NewMutable(), OutSave.Objects);
 }
 
-void UVoxelDataTools::GetSave(AVoxelWorld* World, FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects)
+bool UVoxelDataTools::GetSave(AVoxelWorld* World, FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects, FVoxelDataProgress* Progress)
 {
-	CHECK_VOXELWORLD_IS_CREATED_VOID();
-	World->GetData().GetSave(OutSave, OutObjects);
+	CHECK_VOXELWORLD_IS_CREATED();
+	return World->GetData().GetSave(OutSave, OutObjects, Progress);
 }
 
 void UVoxelDataTools::GetCompressedSave(AVoxelWorld* World, FVoxelCompressedWorldSave& OutSave)
@@ -154,12 +182,16 @@ void UVoxelDataTools::GetCompressedSave(AVoxelWorld* World, FVoxelCompressedWorl
 	GetCompressedSave(World, OutSave.NewMutable(), OutSave.Objects);
 }
 
-void UVoxelDataTools::GetCompressedSave(AVoxelWorld* World, FVoxelCompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects)
+bool UVoxelDataTools::GetCompressedSave(AVoxelWorld* World, FVoxelCompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects, FVoxelDataProgress* Progress)
 {
-	CHECK_VOXELWORLD_IS_CREATED_VOID();
+	CHECK_VOXELWORLD_IS_CREATED();
 	FVoxelUncompressedWorldSaveImpl Save;
-	World->GetData().GetSave(Save, OutObjects);
+	if (!World->GetData().GetSave(Save, OutObjects, Progress))
+	{
+		return false;
+	}
 	UVoxelSaveUtilities::CompressVoxelSave(Save, OutSave);
+	return true;
 }
 
 void UVoxelDataTools::GetSaveAsync(
@@ -170,6 +202,9 @@ void UVoxelDataTools::GetSaveAsync(
 	bool bHideLatentWarnings)
 {
 	VOXEL_FUNCTION_COUNTER();
+
+	// Cancelled if the latent action is destroyed before the save is done, in which case OutSave isn't modified
+	const TVoxelSharedRef<FVoxelDataProgress> Progress = MakeVoxelShared<FVoxelDataProgress>();
 	
 	FVoxelToolHelpers::StartAsyncLatentAction_WithWorld_WithValue(
 		WorldContextObject,
@@ -178,12 +213,14 @@ void UVoxelDataTools::GetSaveAsync(
 		FUNCTION_FNAME,
 		bHideLatentWarnings,
 		OutSave,
-		[](FVoxelData& Data, FVoxelUncompressedWorldSave& Save)
+		[Progress](FVoxelData& Data, FVoxelUncompressedWorldSave& Save)
 		{
-			Data.GetSave(Save.NewMutable(), Save.Objects);
+			Data.GetSave(Save.NewMutable(), Save.Objects, &Progress.Get());
 		},
 		EVoxelUpdateRender::DoNotUpdateRender,
-		{});
+		{},
+		nullptr,
+		Progress);
 }
 
 void UVoxelDataTools::GetCompressedSaveAsync(
@@ -194,6 +231,9 @@ void UVoxelDataTools::GetCompressedSaveAsync(
 	bool bHideLatentWarnings)
 {
 	VOXEL_FUNCTION_COUNTER();
+
+	// Cancelled if the latent action is destroyed before the save is done, in which case OutSave isn't modified
+	const TVoxelSharedRef<FVoxelDataProgress> Progress = MakeVoxelShared<FVoxelDataProgress>();
 	
 	FVoxelToolHelpers::StartAsyncLatentAction_WithWorld_WithValue(
 		WorldContextObject,
@@ -202,14 +242,20 @@ void UVoxelDataTools::GetCompressedSaveAsync(
 		FUNCTION_FNAME,
 		bHideLatentWarnings,
 		OutSave,
-		[](FVoxelData& Data, FVoxelCompressedWorldSave& CompressedSave)
+		[Progress](FVoxelData& Data, FVoxelCompressedWorldSave& CompressedSave)
 		{
 			FVoxelUncompressedWorldSaveImpl Save;
-			Data.GetSave(Save, CompressedSave.Objects);
+			if (!Data.GetSave(Save, CompressedSave.Objects, &Progress.Get()))
+			{
+				// Cancelled, no need to compress
+				return;
+			}
 			UVoxelSaveUtilities::CompressVoxelSave(Save, CompressedSave.NewMutable());
 		},
 		EVoxelUpdateRender::DoNotUpdateRender,
-		{});
+		{},
+		nullptr,
+		Progress);
 }
 
 bool UVoxelDataTools::LoadFromSave(const AVoxelWorld* World, const FVoxelUncompressedWorldSave& Save)
@@ -606,7 +652,7 @@ void UVoxelDataTools::CompressIntoHeightmapImpl(FVoxelData& Data, TVoxelHeightma
 					if (!Parent.HasChildren())
 					{
 						ensureThreadSafe(Parent.IsLockedForWrite());
-						Parent.CreateChildren();
+						Parent.CreateChildren(Data.GetLeafIndex());
 					}
 				}
 			});
@@ -632,13 +678,8 @@ void UVoxelDataTools::CompressIntoHeightmapImpl(FVoxelData& Data, TVoxelHeightma
 			{
 				if (!DataHolder.HasData())
 				{
-					DataHolder.CreateData(Data, [&](FVoxelValue* RESTRICT DataPtr)
-					{
-						TVoxelQueryZone<FVoxelValue> QueryZone(Leaf.GetBounds(), DataPtr);
-						Leaf.GetFromGeneratorAndAssets(*Data.Generator, QueryZone, 0);
-					});
-					// Reduce memory usage
-					DataHolder.Compress(Data);
+					// Stored as a single value if possible to reduce memory usage
+					Leaf.CreateDataFromGenerator<FVoxelValue>(Data);
 				}
 			}
 			else
@@ -769,7 +810,7 @@ void UVoxelDataTools::CompressIntoHeightmapImpl(FVoxelData& Data, TVoxelHeightma
 										const FIntVector LeafPosition = FIntVector(LeafMinXY.X, LeafMinXY.Y, ItLeafMinZ) + DATA_CHUNK_SIZE / 2;
 										if (!Data.IsInWorld(LeafPosition)) continue;
 										
-										auto* ItLeaf = FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(Data.GetOctree(), LeafPosition);
+										auto* ItLeaf = FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(Data.GetOctree(), LeafPosition, Data.GetLeafIndex());
 										check(ItLeaf);
 										check(!ItLeaf->GetData<FVoxelValue>().HasData());
 
@@ -1061,7 +1102,7 @@ void UVoxelDataTools::SetBoxAsDirtyImpl(FVoxelData& Data, const FVoxelIntBox& Bo
 			if (!Parent.HasChildren())
 			{
 				ensureThreadSafe(Parent.IsLockedForWrite());
-				Parent.CreateChildren();
+				Parent.CreateChildren(Data.GetLeafIndex());
 			}
 		}
 	});
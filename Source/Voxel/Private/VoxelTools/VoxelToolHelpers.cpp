@@ -172,7 +172,8 @@ bool FVoxelToolHelpers::StartAsyncLatentAction_WithWorld(
 	bool bHideLatentWarnings, 
 	TFunction<void(FVoxelData&)> DoWork, 
 	EVoxelUpdateRender UpdateRender, 
-	const FVoxelIntBox& BoundsToUpdate)
+	const FVoxelIntBox& BoundsToUpdate,
+	const TVoxelSharedPtr<FVoxelDataProgress>& Progress)
 {
 	return StartAsyncLatentActionImpl<FVoxelLatentActionAsyncWork_WithWorld>(
 		WorldContextObject,
@@ -180,7 +181,12 @@ bool FVoxelToolHelpers::StartAsyncLatentAction_WithWorld(
 		World,
 		Name,
 		bHideLatentWarnings,
-		[&]() { return new FVoxelLatentActionAsyncWork_WithWorld(Name, World, DoWork); },
+		[&]()
+		{
+			auto* Work = new FVoxelLatentActionAsyncWork_WithWorld(Name, World, DoWork);
+			Work->Progress = Progress;
+			return Work;
+		},
 		[=](FVoxelLatentActionAsyncWork_WithWorld& Work)
 		{
 			if (UpdateRender == EVoxelUpdateRender::UpdateRender && Work.World.IsValid())
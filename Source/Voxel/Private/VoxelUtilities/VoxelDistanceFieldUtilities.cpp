@@ -74,6 +74,44 @@ void FVoxelDistanceFieldUtilities::JumpFlood(const FIntVector& Size, TArray<FVec
 	}
 }
 
+void FVoxelDistanceFieldUtilities::ExactDistanceTransform(const FIntVector& Size, TArray<FVector>& InOutSurfacePositions, bool bMultiThreaded)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+	
+	const int32 Num = Size.X * Size.Y * Size.Z;
+	check(InOutSurfacePositions.Num() == Num);
+
+	// Squared distance to the closest voxel with a surface position, and the index of that voxel
+	TArray<float> SquaredDistances;
+	TArray<int32> ClosestIndices;
+	SquaredDistances.Empty(Num);
+	SquaredDistances.SetNumUninitialized(Num);
+	ClosestIndices.Empty(Num);
+	ClosestIndices.SetNumUninitialized(Num);
+
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		const bool bIsValid = IsSurfacePositionValid(InOutSurfacePositions[Index]);
+		SquaredDistances[Index] = bIsValid ? 0.f : MAX_flt;
+		ClosestIndices[Index] = bIsValid ? Index : -1;
+	}
+
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		ExactDistanceTransformPass(Size, Axis, SquaredDistances, ClosestIndices, bMultiThreaded);
+	}
+
+	TArray<FVector> SurfacePositions;
+	SurfacePositions.Empty(Num);
+	SurfacePositions.SetNumUninitialized(Num);
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		const int32 ClosestIndex = ClosestIndices[Index];
+		SurfacePositions[Index] = ClosestIndex == -1 ? MakeInvalidSurfacePosition() : InOutSurfacePositions[ClosestIndex];
+	}
+	InOutSurfacePositions = MoveTemp(SurfacePositions);
+}
+
 void FVoxelDistanceFieldUtilities::GetDistancesFromSurfacePositions(const FIntVector& Size, TArrayView<const FVector> SurfacePositions, TArrayView<float> InOutDistances)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
@@ -221,6 +259,112 @@ void FVoxelDistanceFieldUtilities::DownSample(
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+void FVoxelDistanceFieldUtilities::ExactDistanceTransformPass(const FIntVector& Size, int32 Axis, TArrayView<float> InOutSquaredDistances, TArrayView<int32> InOutClosestIndices, bool bMultiThreaded)
+{
+	VOXEL_ASYNC_FUNCTION_COUNTER();
+
+	check(InOutSquaredDistances.Num() == Size.X * Size.Y * Size.Z);
+	check(InOutClosestIndices.Num() == Size.X * Size.Y * Size.Z);
+	check(0 <= Axis && Axis < 3);
+
+	const FIntVector Strides(1, Size.X, Size.X * Size.Y);
+	const int32 AxisA = (Axis + 1) % 3;
+	const int32 AxisB = (Axis + 2) % 3;
+
+	const int32 LineSize = Size[Axis];
+	const int32 LineStride = Strides[Axis];
+	const int32 NumLines = Size[AxisA] * Size[AxisB];
+
+	const auto DoWork = [&](int32 LineIndex)
+	{
+		const int32 Start = (LineIndex % Size[AxisA]) * Strides[AxisA] + (LineIndex / Size[AxisA]) * Strides[AxisB];
+
+		// Gather the line so that the strided passes don't thrash the cache while building the envelope
+		TArray<float, TInlineAllocator<128>> Distances;
+		TArray<int32, TInlineAllocator<128>> Indices;
+		Distances.SetNumUninitialized(LineSize);
+		Indices.SetNumUninitialized(LineSize);
+		for (int32 Position = 0; Position < LineSize; Position++)
+		{
+			Distances[Position] = InOutSquaredDistances[Start + Position * LineStride];
+			Indices[Position] = InOutClosestIndices[Start + Position * LineStride];
+		}
+
+		// Lower envelope of the parabolas (X - Position)^2 + Distances[Position]
+		// Parabolas[I] is the position of the I-th parabola of the envelope, which is the lowest one in [Boundaries[I], Boundaries[I + 1]]
+		TArray<int32, TInlineAllocator<128>> Parabolas;
+		TArray<float, TInlineAllocator<129>> Boundaries;
+		Parabolas.SetNumUninitialized(LineSize);
+		Boundaries.SetNumUninitialized(LineSize + 1);
+
+		const auto GetIntersection = [&](int32 P, int32 Q)
+		{
+			return ((Distances[Q] + Q * Q) - (Distances[P] + P * P)) / (2 * Q - 2 * P);
+		};
+		
+		int32 NumParabolas = 0;
+		for (int32 Position = 0; Position < LineSize; Position++)
+		{
+			if (Distances[Position] == MAX_flt)
+			{
+				continue;
+			}
+			if (NumParabolas == 0)
+			{
+				Parabolas[0] = Position;
+				Boundaries[0] = -MAX_flt;
+				Boundaries[1] = MAX_flt;
+				NumParabolas = 1;
+				continue;
+			}
+
+			float Intersection = GetIntersection(Parabolas[NumParabolas - 1], Position);
+			while (Intersection <= Boundaries[NumParabolas - 1])
+			{
+				// The last parabola is entirely above the new one
+				NumParabolas--;
+				checkVoxelSlow(NumParabolas > 0); // Boundaries[0] is -inf
+				Intersection = GetIntersection(Parabolas[NumParabolas - 1], Position);
+			}
+			
+			Parabolas[NumParabolas] = Position;
+			Boundaries[NumParabolas] = Intersection;
+			Boundaries[NumParabolas + 1] = MAX_flt;
+			NumParabolas++;
+		}
+
+		if (NumParabolas == 0)
+		{
+			// Nothing to propagate
+			return;
+		}
+
+		int32 ParabolaIndex = 0;
+		for (int32 Position = 0; Position < LineSize; Position++)
+		{
+			while (Boundaries[ParabolaIndex + 1] < Position)
+			{
+				ParabolaIndex++;
+			}
+			const int32 Parabola = Parabolas[ParabolaIndex];
+			InOutSquaredDistances[Start + Position * LineStride] = FMath::Square(Position - Parabola) + Distances[Parabola];
+			InOutClosestIndices[Start + Position * LineStride] = Indices[Parabola];
+		}
+	};
+
+	if (bMultiThreaded)
+	{
+		ParallelFor(NumLines, DoWork);
+	}
+	else
+	{
+		for (int32 LineIndex = 0; LineIndex < NumLines; LineIndex++)
+		{
+			DoWork(LineIndex);
+		}
+	}
+}
+
 void FVoxelDistanceFieldUtilities::JumpFloodStep_CPU(const FIntVector& Size, TArrayView<const FVector> InData, TArrayView<FVector> OutData, int32 Step, bool bMultiThreaded)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
@@ -12,6 +12,7 @@
 #include "VoxelRender/VoxelToolRendering.h"
 #include "VoxelRender/VoxelTexturePool.h"
 #include "VoxelRender/LODManager/VoxelDefaultLODManager.h"
+#include "VoxelRender/LODManager/VoxelClipmapLODManager.h"
 #include "VoxelRender/VoxelProceduralMeshComponent.h"
 #include "VoxelRender/MaterialCollections/VoxelMaterialCollectionBase.h"
 #include "VoxelRender/MaterialCollections/VoxelInstancedMaterialCollection.h"
@@ -30,6 +31,7 @@
 #include "VoxelDebug/VoxelDebugManager.h"
 #include "VoxelDebug/VoxelLineBatchComponent.h"
 #include "VoxelEvents/VoxelEventManager.h"
+#include "VoxelCooking/VoxelCookedCollisionStreamer.h"
 #include "VoxelMessages.h"
 #include "VoxelFeedbackContext.h"
 #include "VoxelUtilities/VoxelThreadingUtilities.h"
@@ -516,6 +518,7 @@ void AVoxelWorld::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	{
 		DestroyWorld();
 	}
+	CookedCollisionStreamer.Reset();
 }
 
 void AVoxelWorld::Tick(float DeltaTime)
@@ -538,6 +541,10 @@ void AVoxelWorld::Tick(float DeltaTime)
 		}
 #endif
 	}
+	else if (CookedCollisionStreamer)
+	{
+		CookedCollisionStreamer->Tick(*this);
+	}
 }
 
 void AVoxelWorld::ApplyWorldOffset(const FVector& InOffset, bool bWorldShift)
@@ -936,6 +943,16 @@ TVoxelSharedRef<IVoxelRenderer> AVoxelWorld::CreateRenderer() const
 TVoxelSharedRef<IVoxelLODManager> AVoxelWorld::CreateLODManager() const
 {
 	VOXEL_FUNCTION_COUNTER();
+	if (bUseClipmapLODs)
+	{
+		return FVoxelClipmapLODManager::Create(
+			FVoxelLODSettings(this,
+				PlayType,
+				Renderer.ToSharedRef(),
+				Pool.ToSharedRef()),
+			LODDynamicSettings,
+			ClipmapRingRadius);
+	}
 	return FVoxelDefaultLODManager::Create(
 		FVoxelLODSettings(this,
 			PlayType,
@@ -965,6 +982,9 @@ void AVoxelWorld::CreateWorldInternal(const FVoxelWorldCreateInfo& Info)
 
 	LOG_VOXEL(Log, TEXT("Loading world"));
 
+	// The world collision replaces the cooked one
+	CookedCollisionStreamer.Reset();
+
 	bIsCreated = true;
 	bIsLoaded = false;
 	TimeOfCreation = FPlatformTime::Seconds();
@@ -6,6 +6,8 @@
 
 #include "PhysXIncludes.h"
 #include "PrimitiveSceneProxy.h"
+#include "AI/NavigationSystemHelpers.h"
+#include "AI/NavigationSystemBase.h"
 #include "Engine/Engine.h"
 #include "Materials/Material.h"
 
@@ -46,6 +48,9 @@ UVoxelWorldRootComponent::UVoxelWorldRootComponent()
 	// Else it's laggy as hell when editing voxel world properties (too many components)
 	// And only registering this one & not the proc meshes messes up the physics
 	bAllowReregistration = false;
+
+	// Cooked chunks have their own body setups, see DoCustomNavigableGeometryExport
+	bHasCustomNavigableGeometry = EHasCustomNavigableGeometry::Yes;
 }
 
 UVoxelWorldRootComponent::~UVoxelWorldRootComponent()
@@ -80,6 +85,66 @@ TArray<URuntimeVirtualTexture*> const& UVoxelWorldRootComponent::GetRuntimeVirtu
 	return Textures;
 }
 
+bool UVoxelWorldRootComponent::DoCustomNavigableGeometryExport(FNavigableGeometryExport& GeomExport) const
+{
+	VOXEL_FUNCTION_COUNTER();
+	
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	for (auto& It : CookedChunksBodySetups)
+	{
+		GeomExport.ExportRigidBodySetup(*It.Value, GetComponentTransform());
+	}
+#endif
+
+	// Also export the root body setup
+	return true;
+}
+
+void UVoxelWorldRootComponent::OnCreatePhysicsState()
+{
+	Super::OnCreatePhysicsState();
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	for (auto& It : CookedChunksBodySetups)
+	{
+		CreateCookedChunkBody(It.Key);
+	}
+#endif
+}
+
+void UVoxelWorldRootComponent::OnDestroyPhysicsState()
+{
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	for (auto& It : CookedChunksBodyInstances)
+	{
+		It.Value->TermBody();
+	}
+	CookedChunksBodyInstances.Empty();
+#endif
+
+	Super::OnDestroyPhysicsState();
+}
+
+void UVoxelWorldRootComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	// Moves the root body
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	if (!EnumHasAnyFlags(UpdateTransformFlags, EUpdateTransformFlags::SkipPhysicsUpdate))
+	{
+		VOXEL_FUNCTION_COUNTER();
+		
+		const FTransform& Transform = GetComponentTransform();
+		for (auto& It : CookedChunksBodyInstances)
+		{
+			It.Value->UpdateBodyScale(Transform.GetScale3D());
+			It.Value->SetBodyTransform(Transform, Teleport);
+		}
+	}
+#endif
+}
+
 void UVoxelWorldRootComponent::TickWorldRoot()
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -90,6 +155,12 @@ void UVoxelWorldRootComponent::TickWorldRoot()
 		bRebuildQueued = false;
 		RebuildConvexCollision();
 	}
+	if (bNavigationUpdateQueued)
+	{
+		// Batched: the streamer can add many chunks per tick, and each update exports all of them
+		bNavigationUpdateQueued = false;
+		UpdateNavigation();
+	}
 #endif
 }
 
@@ -155,16 +226,7 @@ void UVoxelWorldRootComponent::RebuildConvexCollision()
 	VOXEL_FUNCTION_COUNTER();
 	ensure(CollisionTraceFlag != CTF_UseComplexAsSimple);
 
-	{
-		VOXEL_SCOPE_COUNTER("Update bounds");
-		FBox LocalBox(ForceInit);
-		for (auto& It : ProcMeshesSimpleCollision)
-		{
-			LocalBox += It.Value->Data.Bounds;
-		}
-		LocalBounds = LocalBox.IsValid ? FBoxSphereBounds(LocalBox) : FBoxSphereBounds(ForceInit); // fallback to reset box sphere bounds
-		UpdateBounds();
-	}
+	UpdateLocalBounds();
 	
 	// Create body setup
 	GetBodySetup();
@@ -260,6 +322,34 @@ void UVoxelWorldRootComponent::RebuildConvexCollision()
 	}
 }
 
+void UVoxelWorldRootComponent::UpdateLocalBounds()
+{
+	VOXEL_FUNCTION_COUNTER();
+	
+	FBox LocalBox(ForceInit);
+	for (auto& It : ProcMeshesSimpleCollision)
+	{
+		LocalBox += It.Value->Data.Bounds;
+	}
+	for (auto& It : CookedChunksBounds)
+	{
+		LocalBox += It.Value;
+	}
+	LocalBounds = LocalBox.IsValid ? FBoxSphereBounds(LocalBox) : FBoxSphereBounds(ForceInit); // fallback to reset box sphere bounds
+	UpdateBounds();
+}
+
+void UVoxelWorldRootComponent::UpdateNavigation()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (CanEverAffectNavigation() && IsRegistered() && GetWorld() && GetWorld()->GetNavigationSystem() && FNavigationSystem::WantsComponentChangeNotifies())
+	{
+		bNavigationRelevant = IsNavigationRelevant();
+		FNavigationSystem::UpdateComponentData(*this);
+	}
+}
+
 #if ENGINE_MINOR_VERSION >= 24
 class UMRMeshComponent
 {
@@ -271,6 +361,16 @@ public:
 };
 #endif
 
+// Takes ownership of the meshes
+inline void SetBodySetupTriMeshes(UBodySetup& Body, const TArray<physx::PxTriangleMesh*>& TriMeshes)
+{
+#if ENGINE_MINOR_VERSION < 24
+	Body.FinishCreatingPhysicsMeshes({}, {}, TriMeshes);
+#else
+	UMRMeshComponent::FinishCreatingPhysicsMeshes(&Body, {}, {}, TriMeshes);
+#endif
+}
+
 void UVoxelWorldRootComponent::SetCookedTriMeshes(const TArray<physx::PxTriangleMesh*>& TriMeshes)
 {
 	VOXEL_FUNCTION_COUNTER();
@@ -278,11 +378,83 @@ void UVoxelWorldRootComponent::SetCookedTriMeshes(const TArray<physx::PxTriangle
 	// Create body setup
 	GetBodySetup();
 
-#if ENGINE_MINOR_VERSION < 24
-	BodySetup->FinishCreatingPhysicsMeshes({}, {}, TriMeshes);
-#else
-	UMRMeshComponent::FinishCreatingPhysicsMeshes(BodySetup, {}, {}, TriMeshes);
-#endif
+	SetBodySetupTriMeshes(*BodySetup, TriMeshes);
+}
+
+void UVoxelWorldRootComponent::AddCookedChunk(int32 Id, physx::PxTriangleMesh* TriMesh)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(TriMesh);
+
+	if (!ensure(!CookedChunksBodySetups.Contains(Id)))
+	{
+		TriMesh->release();
+		return;
+	}
+
+	UBodySetup* ChunkBodySetup = NewObject<UBodySetup>(this);
+	ChunkBodySetup->bGenerateMirroredCollision = false;
+	ChunkBodySetup->CollisionTraceFlag = CollisionTraceFlag;
+	SetBodySetupTriMeshes(*ChunkBodySetup, { TriMesh });
+
+	CookedChunksBodySetups.Add(Id, ChunkBodySetup);
+
+	const physx::PxBounds3 TriMeshBounds = TriMesh->getLocalBounds();
+	CookedChunksBounds.Add(Id, FBox(
+		FVector(TriMeshBounds.minimum.x, TriMeshBounds.minimum.y, TriMeshBounds.minimum.z),
+		FVector(TriMeshBounds.maximum.x, TriMeshBounds.maximum.y, TriMeshBounds.maximum.z)));
+	UpdateLocalBounds();
+	bNavigationUpdateQueued = true;
+
+	if (IsPhysicsStateCreated())
+	{
+		CreateCookedChunkBody(Id);
+	}
+}
+
+void UVoxelWorldRootComponent::RemoveCookedChunk(int32 Id)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	UBodySetup* ChunkBodySetup = nullptr;
+	if (!ensure(CookedChunksBodySetups.RemoveAndCopyValue(Id, ChunkBodySetup)))
+	{
+		return;
+	}
+
+	TUniquePtr<FBodyInstance> ChunkBodyInstance;
+	if (CookedChunksBodyInstances.RemoveAndCopyValue(Id, ChunkBodyInstance))
+	{
+		ChunkBodyInstance->TermBody();
+	}
+
+	// Release the mesh now instead of when the body setup is garbage collected
+	ChunkBodySetup->ClearPhysicsMeshes();
+
+	CookedChunksBounds.Remove(Id);
+	UpdateLocalBounds();
+	bNavigationUpdateQueued = true;
+}
+
+void UVoxelWorldRootComponent::CreateCookedChunkBody(int32 Id)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(!CookedChunksBodyInstances.Contains(Id));
+
+	UWorld* World = GetWorld();
+	if (!World || !World->GetPhysicsScene())
+	{
+		return;
+	}
+
+	TUniquePtr<FBodyInstance> ChunkBodyInstance = MakeUnique<FBodyInstance>();
+	// Same collision settings as the root
+	ChunkBodyInstance->CopyBodyInstancePropertiesFrom(&BodyInstance);
+	// Triangle meshes can't be simulated
+	ChunkBodyInstance->bSimulatePhysics = false;
+	ChunkBodyInstance->InitBody(CookedChunksBodySetups[Id], GetComponentTransform(), this, World->GetPhysicsScene());
+
+	CookedChunksBodyInstances.Add(Id, MoveTemp(ChunkBodyInstance));
 }
 #endif
 
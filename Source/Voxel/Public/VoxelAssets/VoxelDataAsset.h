@@ -92,6 +92,8 @@ public:
 	//~ Begin UVoxelGenerator Interface
 	virtual TVoxelSharedRef<FVoxelGeneratorInstance> GetInstance() override;
 	virtual TVoxelSharedRef<FVoxelTransformableGeneratorInstance> GetTransformableInstance() override final;
+	// Also hashes the voxel data, as it isn't a property
+	virtual uint64 GetGeneratorHash(const TMap<FName, FString>& Parameters) const override;
 	//~ End UVoxelGenerator Interface
 
 public:
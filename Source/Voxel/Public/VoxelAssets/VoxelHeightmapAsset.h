@@ -71,6 +71,12 @@ public:
 		return Height;
 	}
 
+public:
+	//~ Begin UVoxelGenerator Interface
+	// Also hashes the heightmap data, as it isn't a property
+	virtual uint64 GetGeneratorHash(const TMap<FName, FString>& Parameters) const override;
+	//~ End UVoxelGenerator Interface
+
 protected:
 	template<typename T>
 	void TryLoad(TVoxelHeightmapAssetData<T>& Data);
@@ -102,7 +108,8 @@ private:
 	UPROPERTY()
 	uint32 MaterialConfigFlag;
 
-	TArray<uint8> CompressedData;
+	// Shared with the heightmap data when it's paged: never modified in place, a new array is created instead
+	TVoxelSharedRef<TArray<uint8>> CompressedData = MakeVoxelShared<TArray<uint8>>();
 
 private:
 #if WITH_EDITORONLY_DATA
@@ -5,8 +5,7 @@
 #include "CoreMinimal.h"
 #include "VoxelMaterial.h"
 #include "VoxelRange.h"
-
-DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Heightmap Assets Memory"), STAT_VoxelHeightmapAssetMemory, STATGROUP_VoxelMemory, VOXEL_API);
+#include "VoxelAssets/VoxelHeightmapAssetTiles.h"
 
 namespace FVoxelHeightmapAssetDataVersion
 {
@@ -29,6 +28,7 @@ namespace FVoxelHeightmapAssetDataVersion
 		SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage,
 		UseTArray64,
 		SerializeHeightRangeMips,
+		TiledStorage,
 		
 		// -----<new versions can be added above this line>-------------------------------------------------
 		VersionPlusOne,
@@ -81,12 +81,19 @@ public:
 public:
 	bool HasMaterials() const
 	{
-		return Materials.Num() > 0;
+		return Materials.Num() > 0 || (Tiles.IsValid() && Tiles->MaterialSize > 0);
 	}
 	bool IsEmpty() const
 	{
-		return Heights.Num() <= 4 && Materials.Num() == 0;
+		return !Tiles.IsValid() && Heights.Num() <= 4 && Materials.Num() == 0;
+	}
+	// If true, the heights and materials are decompressed by tiles on demand
+	bool IsPaged() const
+	{
+		return Tiles.IsValid();
 	}
+	// Decompress all the tiles of a paged heightmap. Called before any edit
+	void MakeResident();
 	int64 GetAllocatedSize() const
 	{
 		return AllocatedSize;
@@ -137,17 +144,13 @@ public:
 
 	FORCEINLINE T GetHeightUnsafe(int64 X, int64 Y) const
 	{
-		return GetHeightUnsafe(GetIndex(X, Y));
-	}
-	FORCEINLINE FVoxelMaterial GetMaterialUnsafe(int64 X, int64 Y) const
-	{
-		return GetMaterialUnsafe(GetIndex(X, Y));
-	}
-	FORCEINLINE T GetHeightUnsafe(int64 Index) const
-	{
-		return Heights[Index];
+		if (Tiles.IsValid())
+		{
+			return Tiles->GetHeight(X, Y);
+		}
+		return Heights[GetIndex(X, Y)];
 	}
-	FVoxelMaterial GetMaterialUnsafe(int64 Index) const;
+	FVoxelMaterial GetMaterialUnsafe(int64 X, int64 Y) const;
 
 public:
 	void TileCoordinates(int64& X, int64& Y) const;
@@ -169,18 +172,30 @@ public:
 	FVoxelMaterial GetMaterial(float X, float Y, EVoxelSamplerMode Mode) const;
 
 public:
+	// Empty if the heightmap is paged
 	const auto& GetRawHeights() const
 	{
+		ensure(!Tiles.IsValid());
 		return Heights;
 	}
 
 public:
+	// Legacy format, used before TiledStorage
 	void Serialize(FArchive& Ar, uint32 MaterialConfigFlag, FVoxelHeightmapAssetDataVersion::Type Version, bool& bNeedToSave);
+
+	// Header with the height range mips, followed by the compressed tiles. See TVoxelHeightmapAssetTiles
+	void SaveTiled(TArray<uint8>& OutData) const;
+	// Returns false if the data is corrupted
+	// If the heightmap is too big, it will be paged and Data will be kept alive by the tiles
+	bool LoadTiled(const TVoxelSharedRef<const TArray<uint8>>& Data);
 	
 private:
 	TNoGrowArray64<T> Heights;
 	TNoGrowArray64<uint8> Materials;
 
+	// Only set if paged, in which case Heights and Materials are empty
+	TVoxelSharedPtr<const TVoxelHeightmapAssetTiles<T>> Tiles;
+
 	// In theory these fit in int32, but it's safer to use 64 bit math everywhere
 	int64 Width = -1;
 	int64 Height = -1;
@@ -221,5 +236,9 @@ private:
 private:
 	int64 AllocatedSize = 0;
 
+	int32 GetMaterialSize() const;
+	FVoxelMaterial GetMaterialFromBytes(const uint8* Bytes) const;
+	bool DecompressTiles(const TVoxelHeightmapAssetTiles<T>& InTiles);
+
 	void UpdateStats();
 };
\ No newline at end of file
@@ -7,6 +7,12 @@
 #include "VoxelFeedbackContext.h"
 #include "VoxelAssets/VoxelHeightmapAssetData.h"
 #include "VoxelUtilities/VoxelSerializationUtilities.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/LargeMemoryReader.h"
+#include "Serialization/LargeMemoryWriter.h"
 
 template<typename T>
 void TVoxelHeightmapAssetData<T>::SetSize(int64 NewWidth, int64 NewHeight, bool bCreateMaterials, EVoxelMaterialConfig InMaterialConfig)
@@ -15,6 +21,8 @@ void TVoxelHeightmapAssetData<T>::SetSize(int64 NewWidth, int64 NewHeight, bool
 
 	check(NewWidth > 0 && NewHeight > 0);
 
+	Tiles.Reset();
+
 	const int64 NumHeights = NewWidth * NewHeight;
 	Heights.Empty(NumHeights);
 	Heights.SetNumUninitialized(NumHeights);
@@ -257,6 +265,11 @@ void TVoxelHeightmapAssetData<T>::InitializeHeightRangeMips()
 template<typename T>
 void TVoxelHeightmapAssetData<T>::SetHeight(int64 X, int64 Y, T NewHeight)
 {
+	if (Tiles.IsValid())
+	{
+		MakeResident();
+	}
+
 	Heights[GetIndex(X, Y)] = NewHeight;
 
 	MaxHeight = FMath::Max(MaxHeight, NewHeight);
@@ -282,6 +295,11 @@ template<typename T>
 void TVoxelHeightmapAssetData<T>::SetMaterial_RGB(int64 X, int64 Y, FColor Color)
 {
 	checkVoxelSlow(MaterialConfig == EVoxelMaterialConfig::RGB);
+	if (Tiles.IsValid())
+	{
+		MakeResident();
+	}
+
 	const int64 Index = GetIndex(X, Y);
 
 	Materials[4 * Index + 0] = Color.R;
@@ -294,6 +312,11 @@ template<typename T>
 void TVoxelHeightmapAssetData<T>::SetMaterial_SingleIndex(int64 X, int64 Y, uint8 SingleIndex)
 {
 	checkVoxelSlow(MaterialConfig == EVoxelMaterialConfig::SingleIndex);
+	if (Tiles.IsValid())
+	{
+		MakeResident();
+	}
+
 	Materials[GetIndex(X, Y)] = SingleIndex;
 }
 
@@ -301,6 +324,11 @@ template<typename T>
 void TVoxelHeightmapAssetData<T>::SetMaterial_MultiIndex(int64 X, int64 Y, const FVoxelMaterial& Material)
 {
 	checkVoxelSlow(MaterialConfig == EVoxelMaterialConfig::MultiIndex);
+	if (Tiles.IsValid())
+	{
+		MakeResident();
+	}
+
 	const int64 Index = GetIndex(X, Y);
 
 	Materials[7 * Index + 0] = Material.GetMultiIndex_Blend0();
@@ -317,34 +345,61 @@ void TVoxelHeightmapAssetData<T>::SetMaterial_MultiIndex(int64 X, int64 Y, const
 ///////////////////////////////////////////////////////////////////////////////
 
 template<typename T>
-FORCEINLINE FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterialUnsafe(int64 Index) const
+FORCEINLINE FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterialUnsafe(int64 X, int64 Y) const
+{
+	if (Tiles.IsValid())
+	{
+		FVoxelMaterial Material;
+		Tiles->AccessMaterial(X, Y, [&](const uint8* Bytes)
+		{
+			Material = GetMaterialFromBytes(Bytes);
+		});
+		return Material;
+	}
+	return GetMaterialFromBytes(&Materials[GetMaterialSize() * GetIndex(X, Y)]);
+}
+
+template<typename T>
+FORCEINLINE FVoxelMaterial TVoxelHeightmapAssetData<T>::GetMaterialFromBytes(const uint8* Bytes) const
 {
 	FVoxelMaterial Material(ForceInit);
 	switch (MaterialConfig)
 	{
 	case EVoxelMaterialConfig::RGB:
-		Material.SetR(Materials[4 * Index + 0]);
-		Material.SetG(Materials[4 * Index + 1]);
-		Material.SetB(Materials[4 * Index + 2]);
-		Material.SetA(Materials[4 * Index + 3]);
+		Material.SetR(Bytes[0]);
+		Material.SetG(Bytes[1]);
+		Material.SetB(Bytes[2]);
+		Material.SetA(Bytes[3]);
 		break;
 	case EVoxelMaterialConfig::SingleIndex:
-		Material.SetSingleIndex(Materials[Index]);
+		Material.SetSingleIndex(Bytes[0]);
 		break;
 	case EVoxelMaterialConfig::MultiIndex:
 	default:
-		Material.SetMultiIndex_Blend0(Materials[7 * Index + 0]);
-		Material.SetMultiIndex_Blend1(Materials[7 * Index + 1]);
-		Material.SetMultiIndex_Blend2(Materials[7 * Index + 2]);
-		Material.SetMultiIndex_Index0(Materials[7 * Index + 3]);
-		Material.SetMultiIndex_Index1(Materials[7 * Index + 4]);
-		Material.SetMultiIndex_Index2(Materials[7 * Index + 5]);
-		Material.SetMultiIndex_Index3(Materials[7 * Index + 6]);
+		Material.SetMultiIndex_Blend0(Bytes[0]);
+		Material.SetMultiIndex_Blend1(Bytes[1]);
+		Material.SetMultiIndex_Blend2(Bytes[2]);
+		Material.SetMultiIndex_Index0(Bytes[3]);
+		Material.SetMultiIndex_Index1(Bytes[4]);
+		Material.SetMultiIndex_Index2(Bytes[5]);
+		Material.SetMultiIndex_Index3(Bytes[6]);
 		break;
 	}
 	return Material;
 }
 
+template<typename T>
+FORCEINLINE int32 TVoxelHeightmapAssetData<T>::GetMaterialSize() const
+{
+	switch (MaterialConfig)
+	{
+	case EVoxelMaterialConfig::RGB: return 4;
+	case EVoxelMaterialConfig::SingleIndex: return 1;
+	case EVoxelMaterialConfig::MultiIndex: return 7;
+	default: return 0;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -603,6 +658,257 @@ void TVoxelHeightmapAssetData<T>::Serialize(FArchive& Ar, uint32 MaterialConfigF
 	UpdateStats();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+void TVoxelHeightmapAssetData<T>::SaveTiled(TArray<uint8>& OutData) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	using FTiles = TVoxelHeightmapAssetTiles<T>;
+	check(!Tiles.IsValid());
+
+	FVoxelScopedSlowTask Saving(2.f);
+
+	const int64 NumTilesX = FTiles::GetNumTiles(Width);
+	const int64 NumTilesY = FTiles::GetNumTiles(Height);
+	const int32 MaterialSize = Materials.Num() > 0 ? GetMaterialSize() : 0;
+
+	Saving.EnterProgressFrame(1.f, VOXEL_LOCTEXT("Compressing tiles"));
+
+	TArray<TArray<uint8>> CompressedTiles;
+	CompressedTiles.SetNum(NumTilesX * NumTilesY);
+
+	ParallelFor(CompressedTiles.Num(), [&](int32 TileIndex)
+	{
+		const int64 TileX = TileIndex % NumTilesX;
+		const int64 TileY = TileIndex / NumTilesX;
+		const int64 SizeX = FTiles::GetTileSize(Width, TileX);
+		const int64 SizeY = FTiles::GetTileSize(Height, TileY);
+
+		TArray<uint8> Tile;
+		Tile.SetNumUninitialized(SizeX * SizeY * (sizeof(T) + MaterialSize));
+
+		uint8* const TileHeights = Tile.GetData();
+		uint8* const TileMaterials = Tile.GetData() + SizeX * SizeY * sizeof(T);
+		for (int64 Y = 0; Y < SizeY; Y++)
+		{
+			const int64 Index = GetIndex(TileX * FTiles::TileSize, TileY * FTiles::TileSize + Y);
+			FMemory::Memcpy(TileHeights + Y * SizeX * sizeof(T), &Heights[Index], SizeX * sizeof(T));
+			if (MaterialSize > 0)
+			{
+				FMemory::Memcpy(TileMaterials + Y * SizeX * MaterialSize, &Materials[Index * MaterialSize], SizeX * MaterialSize);
+			}
+		}
+
+		verify(FTiles::CompressTile(Tile, CompressedTiles[TileIndex]));
+	});
+
+	Saving.EnterProgressFrame(1.f, VOXEL_LOCTEXT("Writing tiles"));
+
+	TArray<typename FTiles::FTileEntry> Entries;
+	Entries.SetNum(CompressedTiles.Num());
+
+	int64 TilesSize = 0;
+	for (int32 TileIndex = 0; TileIndex < CompressedTiles.Num(); TileIndex++)
+	{
+		Entries[TileIndex].Offset = TilesSize;
+		Entries[TileIndex].CompressedSize = CompressedTiles[TileIndex].Num();
+		TilesSize += CompressedTiles[TileIndex].Num();
+	}
+
+	TArray<uint8> CompressedHeader;
+	{
+		FLargeMemoryWriter HeaderWriter;
+
+		int32 TileSize = FTiles::TileSize;
+		int64 LocalWidth = Width;
+		int64 LocalHeight = Height;
+		T LocalMinHeight = MinHeight;
+		T LocalMaxHeight = MaxHeight;
+		EVoxelMaterialConfig LocalMaterialConfig = MaterialConfig;
+		int32 LocalMaterialSize = MaterialSize;
+
+		HeaderWriter << TileSize;
+		HeaderWriter << LocalWidth;
+		HeaderWriter << LocalHeight;
+		HeaderWriter << LocalMinHeight;
+		HeaderWriter << LocalMaxHeight;
+		HeaderWriter << LocalMaterialConfig;
+		HeaderWriter << LocalMaterialSize;
+		HeaderWriter << const_cast<TArray<FHeightRangeMip, TInlineAllocator<16>>&>(HeightRangeMips);
+		HeaderWriter << Entries;
+
+		FVoxelSerializationUtilities::CompressData(HeaderWriter, CompressedHeader);
+	}
+
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+	Writer << CompressedHeader;
+
+	OutData.Reserve(OutData.Num() + TilesSize);
+	for (const TArray<uint8>& CompressedTile : CompressedTiles)
+	{
+		OutData.Append(CompressedTile);
+	}
+}
+
+template<typename T>
+bool TVoxelHeightmapAssetData<T>::LoadTiled(const TVoxelSharedRef<const TArray<uint8>>& Data)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	using FTiles = TVoxelHeightmapAssetTiles<T>;
+
+	// The header is small: the tiles are only read through their offsets
+	FMemoryReader Reader(*Data);
+	TArray<uint8> CompressedHeader;
+	Reader << CompressedHeader;
+	if (Reader.IsError())
+	{
+		return false;
+	}
+	const int64 TilesOffset = Reader.Tell();
+
+	TArray64<uint8> UncompressedHeader;
+	if (!FVoxelSerializationUtilities::DecompressData(CompressedHeader, UncompressedHeader))
+	{
+		return false;
+	}
+
+	int32 TileSize = 0;
+	int64 NewWidth = -1;
+	int64 NewHeight = -1;
+	T NewMinHeight = 0;
+	T NewMaxHeight = 0;
+	EVoxelMaterialConfig NewMaterialConfig{};
+	int32 NewMaterialSize = 0;
+	TArray<FHeightRangeMip, TInlineAllocator<16>> NewHeightRangeMips;
+	TArray<typename FTiles::FTileEntry> Entries;
+	{
+		FLargeMemoryReader HeaderReader(UncompressedHeader.GetData(), UncompressedHeader.Num());
+		HeaderReader << TileSize;
+		HeaderReader << NewWidth;
+		HeaderReader << NewHeight;
+		HeaderReader << NewMinHeight;
+		HeaderReader << NewMaxHeight;
+		HeaderReader << NewMaterialConfig;
+		HeaderReader << NewMaterialSize;
+		HeaderReader << NewHeightRangeMips;
+		HeaderReader << Entries;
+
+		if (HeaderReader.IsError() || !HeaderReader.AtEnd())
+		{
+			return false;
+		}
+	}
+
+	if (TileSize != FTiles::TileSize ||
+		NewWidth <= 0 ||
+		NewHeight <= 0 ||
+		Entries.Num() != FTiles::GetNumTiles(NewWidth) * FTiles::GetNumTiles(NewHeight))
+	{
+		return false;
+	}
+
+	Tiles.Reset();
+	Heights.Empty();
+	Materials.Empty();
+
+	Width = NewWidth;
+	Height = NewHeight;
+	MinHeight = NewMinHeight;
+	MaxHeight = NewMaxHeight;
+	MaterialConfig = NewMaterialConfig;
+	HeightRangeMips = MoveTemp(NewHeightRangeMips);
+
+	if (NewMaterialSize != 0 && NewMaterialSize != GetMaterialSize())
+	{
+		return false;
+	}
+
+	const auto NewTiles = MakeVoxelShared<FTiles>(Width, Height, NewMaterialSize, Entries, Data, TilesOffset);
+
+	const int64 ResidentSize = Width * Height * (sizeof(T) + NewMaterialSize);
+	if (ResidentSize > FVoxelHeightmapAssetTilesParameters::GetMaxResidentSize())
+	{
+		LOG_VOXEL(Log, TEXT("Paging heightmap of %lldx%lld (%fMB decompressed)"), Width, Height, ResidentSize / double(1 << 20));
+		Tiles = NewTiles;
+	}
+	else if (!DecompressTiles(*NewTiles))
+	{
+		return false;
+	}
+
+	UpdateStats();
+	return true;
+}
+
+template<typename T>
+void TVoxelHeightmapAssetData<T>::MakeResident()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!Tiles.IsValid())
+	{
+		return;
+	}
+
+	const auto LocalTiles = Tiles;
+	Tiles.Reset();
+
+	ensureMsgf(DecompressTiles(*LocalTiles), TEXT("Corrupted heightmap tiles"));
+
+	UpdateStats();
+}
+
+template<typename T>
+bool TVoxelHeightmapAssetData<T>::DecompressTiles(const TVoxelHeightmapAssetTiles<T>& InTiles)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	using FTiles = TVoxelHeightmapAssetTiles<T>;
+	checkVoxelSlow(InTiles.Width == Width && InTiles.Height == Height);
+
+	const int32 MaterialSize = InTiles.MaterialSize;
+
+	Heights.Empty(Width * Height);
+	Heights.SetNumUninitialized(Width * Height);
+	Materials.Empty(Width * Height * MaterialSize);
+	Materials.SetNumUninitialized(Width * Height * MaterialSize);
+
+	FThreadSafeBool bSuccess = true;
+	ParallelFor(InTiles.NumTilesX * InTiles.NumTilesY, [&](int32 TileIndex)
+	{
+		const int64 TileX = TileIndex % InTiles.NumTilesX;
+		const int64 TileY = TileIndex / InTiles.NumTilesX;
+		const int64 SizeX = FTiles::GetTileSize(Width, TileX);
+		const int64 SizeY = FTiles::GetTileSize(Height, TileY);
+
+		TArray<T> TileHeights;
+		TArray<uint8> TileMaterials;
+		if (!InTiles.DecompressTile(TileIndex, TileHeights, TileMaterials))
+		{
+			bSuccess = false;
+			return;
+		}
+
+		for (int64 Y = 0; Y < SizeY; Y++)
+		{
+			const int64 Index = GetIndex(TileX * FTiles::TileSize, TileY * FTiles::TileSize + Y);
+			FMemory::Memcpy(&Heights[Index], &TileHeights[Y * SizeX], SizeX * sizeof(T));
+			if (MaterialSize > 0)
+			{
+				FMemory::Memcpy(&Materials[Index * MaterialSize], &TileMaterials[Y * SizeX * MaterialSize], SizeX * MaterialSize);
+			}
+		}
+	});
+
+	return bSuccess;
+}
+
 template<typename T>
 void TVoxelHeightmapAssetData<T>::UpdateStats()
 {
@@ -94,6 +94,9 @@ public:
 	}
 	virtual void GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override final
 	{
+		// Z is the inner loop so that the height is only sampled once per column
+		TVoxelQueryZoneZMajorBuffer<FVoxelValue> Buffer(QueryZone);
+		
 		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 		{
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
@@ -112,10 +115,12 @@ public:
 						// Outside asset bounds
 						Value = FVoxelValue::Empty();
 					}
-					QueryZone.Set(X, Y, Z, Value);
+					Buffer.Add(Value);
 				}
 			}
 		}
+
+		Buffer.Flush();
 	}
 	virtual FVector GetUpVector(v_flt X, v_flt Y, v_flt Z) const override final
 	{
@@ -0,0 +1,367 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "Templates/Atomic.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeLock.h"
+
+DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Heightmap Assets Memory"), STAT_VoxelHeightmapAssetMemory, STATGROUP_VoxelMemory, VOXEL_API);
+
+namespace FVoxelHeightmapAssetTilesParameters
+{
+	// Heightmaps bigger than this once decompressed are paged by tiles
+	VOXEL_API int64 GetMaxResidentSize();
+	// Max memory used by the decompressed tiles of a paged heightmap
+	VOXEL_API int64 GetTileCacheSize();
+}
+
+/**
+ * Tiled layout of the heightmap assets data: each tile of TileSize x TileSize pixels is compressed separately,
+ * so that a tile can be decompressed without touching the rest of the heightmap
+ * A tile stores its heights, then its materials. Tiles on the right/bottom border are smaller
+ *
+ * When the heightmap is too big to be decompressed at once, the tiles are decompressed on demand
+ * and kept in a LRU cache, the compressed tiles staying in memory
+ *
+ * Sampling is lock free: the loaded tiles are published in atomic slots. Tiles are decompressed without any lock,
+ * the first thread to publish a tile winning. Evicted tiles are only freed once no sampling started before
+ * their eviction is still running, see WaitForReaders
+ */
+template<typename T>
+class TVoxelHeightmapAssetTiles
+{
+public:
+	static constexpr int64 TileSize = 256;
+
+	struct FTileEntry
+	{
+		// Offset in the tiles data
+		int64 Offset = 0;
+		int32 CompressedSize = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FTileEntry& Entry)
+		{
+			Ar << Entry.Offset;
+			Ar << Entry.CompressedSize;
+			return Ar;
+		}
+	};
+
+	const int64 Width;
+	const int64 Height;
+	const int32 MaterialSize;
+	const int64 NumTilesX;
+	const int64 NumTilesY;
+
+	TVoxelHeightmapAssetTiles(
+		int64 Width,
+		int64 Height,
+		int32 MaterialSize,
+		const TArray<FTileEntry>& Entries,
+		const TVoxelSharedRef<const TArray<uint8>>& Data,
+		int64 DataOffset)
+		: Width(Width)
+		, Height(Height)
+		, MaterialSize(MaterialSize)
+		, NumTilesX(GetNumTiles(Width))
+		, NumTilesY(GetNumTiles(Height))
+		, Entries(Entries)
+		, Data(Data)
+		, DataOffset(DataOffset)
+	{
+		check(Entries.Num() == NumTilesX * NumTilesY);
+		Tiles = MakeUnique<TAtomic<FTile*>[]>(Entries.Num());
+		for (int32 Index = 0; Index < Entries.Num(); Index++)
+		{
+			Tiles[Index].Store(nullptr);
+		}
+		INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetMemory, Entries.GetAllocatedSize() + Entries.Num() * sizeof(TAtomic<FTile*>));
+	}
+	~TVoxelHeightmapAssetTiles()
+	{
+		for (int32 Index = 0; Index < Entries.Num(); Index++)
+		{
+			delete Tiles[Index].Load();
+		}
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetMemory, Entries.GetAllocatedSize() + Entries.Num() * sizeof(TAtomic<FTile*>) + LoadedSize);
+	}
+
+	UE_NONCOPYABLE(TVoxelHeightmapAssetTiles);
+
+public:
+	static int64 GetNumTiles(int64 Size)
+	{
+		return FVoxelUtilities::DivideCeil64(Size, TileSize);
+	}
+	// Size of the tile along an axis
+	static int64 GetTileSize(int64 Size, int64 Tile)
+	{
+		return FMath::Min(TileSize, Size - Tile * TileSize);
+	}
+
+	// Used when saving
+	static bool CompressTile(const TArray<uint8>& UncompressedTile, TArray<uint8>& OutCompressedTile)
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedTile.Num());
+		OutCompressedTile.SetNumUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(NAME_Zlib, OutCompressedTile.GetData(), CompressedSize, UncompressedTile.GetData(), UncompressedTile.Num()))
+		{
+			return false;
+		}
+		OutCompressedTile.SetNum(CompressedSize);
+		return true;
+	}
+
+	// Returns false if the data is corrupted
+	bool DecompressTile(int64 TileIndex, TArray<T>& OutHeights, TArray<uint8>& OutMaterials) const
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		const int64 NumPixels = GetTileSize(Width, TileIndex % NumTilesX) * GetTileSize(Height, TileIndex / NumTilesX);
+		const int64 HeightsSize = NumPixels * sizeof(T);
+		const int64 MaterialsSize = NumPixels * MaterialSize;
+
+		const FTileEntry& Entry = Entries[TileIndex];
+		if (Entry.Offset < 0 || DataOffset + Entry.Offset + Entry.CompressedSize > Data->Num())
+		{
+			return false;
+		}
+
+		TArray<uint8> UncompressedTile;
+		UncompressedTile.SetNumUninitialized(HeightsSize + MaterialsSize);
+		if (!FCompression::UncompressMemory(NAME_Zlib, UncompressedTile.GetData(), UncompressedTile.Num(), Data->GetData() + DataOffset + Entry.Offset, Entry.CompressedSize))
+		{
+			return false;
+		}
+
+		OutHeights.SetNumUninitialized(NumPixels);
+		FMemory::Memcpy(OutHeights.GetData(), UncompressedTile.GetData(), HeightsSize);
+
+		OutMaterials.SetNumUninitialized(MaterialsSize);
+		FMemory::Memcpy(OutMaterials.GetData(), UncompressedTile.GetData() + HeightsSize, MaterialsSize);
+
+		return true;
+	}
+
+public:
+	FORCEINLINE T GetHeight(int64 X, int64 Y) const
+	{
+		T Result;
+		AccessTile(X, Y, [&](const FTile& Tile, int64 LocalIndex)
+		{
+			Result = Tile.Heights[LocalIndex];
+		});
+		return Result;
+	}
+	// Lambda gets a pointer to the MaterialSize bytes of the material
+	template<typename TLambda>
+	FORCEINLINE void AccessMaterial(int64 X, int64 Y, TLambda Lambda) const
+	{
+		AccessTile(X, Y, [&](const FTile& Tile, int64 LocalIndex)
+		{
+			Lambda(Tile.Materials.GetData() + LocalIndex * MaterialSize);
+		});
+	}
+
+private:
+	struct FTile
+	{
+		TArray<T> Heights;
+		TArray<uint8> Materials;
+		TAtomic<uint64> LastUse{ 0 };
+
+		int64 GetAllocatedSize() const
+		{
+			return sizeof(FTile) + Heights.GetAllocatedSize() + Materials.GetAllocatedSize();
+		}
+	};
+
+	const TArray<FTileEntry> Entries;
+	// The compressed tiles. Shared with the asset
+	const TVoxelSharedRef<const TArray<uint8>> Data;
+	const int64 DataOffset;
+
+	// Null if not loaded
+	TUniquePtr<TAtomic<FTile*>[]> Tiles;
+	// Not exact, only used to find the least recently used tiles
+	mutable TAtomic<uint64> UseCounter{ 0 };
+
+	// Serializes the loaded tiles bookkeeping & the evictions
+	mutable FCriticalSection LoadSection;
+	mutable TArray<int64> LoadedTiles;
+	mutable int64 LoadedSize = 0;
+
+	// Number of samplings running, for each reader epoch. Sharded by thread to avoid contention
+	static constexpr int32 NumReaderShards = 16;
+	struct FReaderCounter
+	{
+		TAtomic<int32> Num{ 0 };
+		uint8 PadToAvoidContention[PLATFORM_CACHE_LINE_SIZE - sizeof(TAtomic<int32>)];
+	};
+	mutable FReaderCounter ReaderCounters[2][NumReaderShards];
+	mutable TAtomic<uint32> ReaderEpoch{ 0 };
+
+	// A sampling. Tiles loaded from the slots stay valid until the end of the scope
+	struct FScopedReader
+	{
+		FReaderCounter& Counter;
+
+		FORCEINLINE explicit FScopedReader(const TVoxelHeightmapAssetTiles& Tiles)
+			: Counter(Tiles.ReaderCounters[Tiles.ReaderEpoch.Load() & 1][FPlatformTLS::GetCurrentThreadId() % NumReaderShards])
+		{
+			++Counter.Num;
+		}
+		FORCEINLINE ~FScopedReader()
+		{
+			--Counter.Num;
+		}
+	};
+
+	template<typename TLambda>
+	FORCEINLINE void AccessTile(int64 X, int64 Y, TLambda Lambda) const
+	{
+		checkVoxelSlow(0 <= X && X < Width && 0 <= Y && Y < Height);
+
+		const int64 TileX = X / TileSize;
+		const int64 TileY = Y / TileSize;
+		const int64 TileIndex = TileX + NumTilesX * TileY;
+		const int64 LocalIndex = (X - TileX * TileSize) + GetTileSize(Width, TileX) * (Y - TileY * TileSize);
+
+		{
+			FScopedReader Reader(*this);
+			if (FTile* Tile = Tiles[TileIndex].Load())
+			{
+				MarkUsed(*Tile);
+				Lambda(*Tile, LocalIndex);
+				return;
+			}
+		}
+
+		// Decompress without holding anything, other threads can keep sampling/decompressing other tiles
+		FTile* NewTile = CreateTile(TileIndex);
+
+		bool bPublished;
+		{
+			FScopedReader Reader(*this);
+
+			FTile* Tile = nullptr;
+			bPublished = Tiles[TileIndex].CompareExchange(Tile, NewTile);
+			if (bPublished)
+			{
+				Tile = NewTile;
+			}
+			else
+			{
+				// Loaded by another thread at the same time
+				delete NewTile;
+			}
+
+			MarkUsed(*Tile);
+			Lambda(*Tile, LocalIndex);
+		}
+
+		if (bPublished)
+		{
+			// Can't be evicted before that, as it's not in LoadedTiles yet
+			OnTileLoaded(TileIndex, *NewTile);
+		}
+	}
+
+	FORCEINLINE void MarkUsed(FTile& Tile) const
+	{
+		// Relaxed & racy: some uses might be lost, which is fine for the LRU
+		// Don't write anything when sampling the most recently used tile again
+		const uint64 Use = UseCounter.Load(EMemoryOrder::Relaxed);
+		if (Tile.LastUse.Load(EMemoryOrder::Relaxed) != Use)
+		{
+			UseCounter.Store(Use + 1, EMemoryOrder::Relaxed);
+			Tile.LastUse.Store(Use + 1, EMemoryOrder::Relaxed);
+		}
+	}
+
+	FTile* CreateTile(int64 TileIndex) const
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		FTile* NewTile = new FTile();
+		if (!DecompressTile(TileIndex, NewTile->Heights, NewTile->Materials))
+		{
+			ensureMsgf(false, TEXT("Corrupted heightmap tile %lld"), TileIndex);
+			const int64 NumPixels = GetTileSize(Width, TileIndex % NumTilesX) * GetTileSize(Height, TileIndex / NumTilesX);
+			NewTile->Heights.SetNumZeroed(NumPixels);
+			NewTile->Materials.SetNumZeroed(NumPixels * MaterialSize);
+		}
+		return NewTile;
+	}
+
+	void OnTileLoaded(int64 TileIndex, const FTile& Tile) const
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		FScopeLock Lock(&LoadSection);
+
+		const int64 TileAllocatedSize = Tile.GetAllocatedSize();
+		LoadedSize += TileAllocatedSize;
+		INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetMemory, TileAllocatedSize);
+
+		const int64 MaxLoadedSize = FVoxelHeightmapAssetTilesParameters::GetTileCacheSize();
+
+		// Remove the least recently used tiles, never the one we just loaded
+		TArray<FTile*, TInlineAllocator<8>> EvictedTiles;
+		while (LoadedTiles.Num() > 0 && LoadedSize > MaxLoadedSize)
+		{
+			int32 OldestIndex = 0;
+			for (int32 Index = 1; Index < LoadedTiles.Num(); Index++)
+			{
+				if (Tiles[LoadedTiles[Index]].Load()->LastUse.Load(EMemoryOrder::Relaxed) < Tiles[LoadedTiles[OldestIndex]].Load()->LastUse.Load(EMemoryOrder::Relaxed))
+				{
+					OldestIndex = Index;
+				}
+			}
+
+			FTile* OldestTile = Tiles[LoadedTiles[OldestIndex]].Exchange(nullptr);
+			LoadedSize -= OldestTile->GetAllocatedSize();
+			EvictedTiles.Add(OldestTile);
+			LoadedTiles.RemoveAtSwap(OldestIndex);
+		}
+
+		LoadedTiles.Add(TileIndex);
+
+		if (EvictedTiles.Num() > 0)
+		{
+			// Samplings that started before the eviction might still be reading them
+			WaitForReaders();
+
+			for (FTile* EvictedTile : EvictedTiles)
+			{
+				DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelHeightmapAssetMemory, EvictedTile->GetAllocatedSize());
+				delete EvictedTile;
+			}
+		}
+	}
+
+	// Waits for all the samplings running when called to be done. Samplings started after that can't see the tiles removed from the slots before the call
+	// Flips the epoch twice, as samplings might have read the old epoch but not incremented its counter yet when flipping the first time
+	void WaitForReaders() const
+	{
+		VOXEL_ASYNC_FUNCTION_COUNTER();
+
+		for (int32 Pass = 0; Pass < 2; Pass++)
+		{
+			const uint32 OldEpoch = ReaderEpoch.Load();
+			ReaderEpoch.Store(OldEpoch + 1);
+
+			for (auto& Counter : ReaderCounters[OldEpoch & 1])
+			{
+				// Samplings are short, no need to sleep
+				while (Counter.Num.Load() != 0)
+				{
+					FPlatformProcess::Yield();
+				}
+			}
+		}
+	}
+};
\ No newline at end of file
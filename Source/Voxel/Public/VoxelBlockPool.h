@@ -0,0 +1,71 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+/**
+ * Thread safe pool of fixed size blocks, allocated by slabs of BlocksPerSlab blocks
+ * Avoids millions of small mallocs when creating octrees. Freed blocks are reused, and the slabs are only returned to the system by Trim
+ * The free blocks are split between NumShards free lists with their own lock, and each thread uses one of them: concurrent edits don't all contend on a single lock
+ */
+class VOXEL_API FVoxelBlockPool
+{
+public:
+	static constexpr uint32 Alignment = 16;
+	static constexpr uint32 BlocksPerSlab = 64;
+	static constexpr int32 NumShards = 16;
+
+	// One pool per block size for the whole process, owned by the voxel module
+	// Never destroyed, as blocks might be freed during static destruction
+	static FVoxelBlockPool& Get(uint32 BlockSize);
+
+	const uint32 BlockSize;
+
+	void* Allocate();
+	// Can be called from any thread, not only the one that allocated the block
+	void Free(void* Ptr);
+
+	// Returns the slabs whose blocks are all free to the system
+	// Locks all the shards & goes through all the free blocks: should only be called after a lot of blocks were freed, eg when an octree is destroyed
+	void Trim();
+
+private:
+	struct FFreeBlock
+	{
+		FFreeBlock* Next;
+	};
+
+	struct FShard
+	{
+		FCriticalSection Section;
+		FFreeBlock* FreeList = nullptr;
+		uint8 PadToAvoidContention[PLATFORM_CACHE_LINE_SIZE];
+	};
+	FShard Shards[NumShards];
+
+	// Taken after a shard lock
+	FCriticalSection SlabsSection;
+	TArray<uint8*> Slabs;
+
+	explicit FVoxelBlockPool(uint32 BlockSize);
+	UE_NONCOPYABLE(FVoxelBlockPool);
+
+	FShard& GetShard();
+	void AllocateSlab(FShard& Shard);
+};
+
+// Caches the pool of a block size: the cache is per module, the pool isn't
+template<uint32 InBlockSize>
+class TVoxelBlockPool
+{
+public:
+	static constexpr uint32 BlockSize = Align(InBlockSize, FVoxelBlockPool::Alignment);
+
+	FORCEINLINE static FVoxelBlockPool& Get()
+	{
+		static FVoxelBlockPool& Pool = FVoxelBlockPool::Get(BlockSize);
+		return Pool;
+	}
+};
@@ -0,0 +1,89 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+
+/**
+ * Lock-free bounded multi-producer single-consumer ring. Unlike TQueue, doesn't allocate on Enqueue
+ * Each cell has a sequence number telling whether it's ready to be written or read, see Dmitry Vyukov's bounded MPMC queue
+ */
+template<typename ItemType, uint32 Capacity>
+class TVoxelBoundedMpscQueue
+{
+public:
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+	TVoxelBoundedMpscQueue()
+	{
+		for (uint32 Index = 0; Index < Capacity; Index++)
+		{
+			Cells[Index].Sequence.Store(Index);
+		}
+	}
+	UE_NONCOPYABLE(TVoxelBoundedMpscQueue);
+
+public:
+	// Any thread. Returns false if the queue is full
+	bool Enqueue(const ItemType& Item)
+	{
+		uint32 Position = EnqueuePosition.Load();
+		for (;;)
+		{
+			FCell& Cell = Cells[Position & (Capacity - 1)];
+			const int32 Difference = int32(Cell.Sequence.Load() - Position);
+			if (Difference == 0)
+			{
+				// The cell is free: try to claim it. On failure, Position is updated to the new value
+				if (EnqueuePosition.CompareExchange(Position, Position + 1))
+				{
+					Cell.Item = Item;
+					// Publish the item
+					Cell.Sequence.Store(Position + 1);
+					return true;
+				}
+			}
+			else if (Difference < 0)
+			{
+				// The consumer hasn't read this cell yet
+				return false;
+			}
+			else
+			{
+				// Another producer claimed this cell
+				Position = EnqueuePosition.Load();
+			}
+		}
+	}
+	// Consumer thread only
+	bool Dequeue(ItemType& OutItem)
+	{
+		FCell& Cell = Cells[DequeuePosition & (Capacity - 1)];
+		if (int32(Cell.Sequence.Load() - (DequeuePosition + 1)) < 0)
+		{
+			// Empty, or the producer is still writing the item
+			return false;
+		}
+
+		OutItem = MoveTemp(Cell.Item);
+		// Free the cell for the next lap
+		Cell.Sequence.Store(DequeuePosition + Capacity);
+		DequeuePosition++;
+		return true;
+	}
+
+private:
+	struct FCell
+	{
+		TAtomic<uint32> Sequence;
+		ItemType Item;
+	};
+
+	FCell Cells[Capacity];
+
+	uint8 PadToAvoidContention0[PLATFORM_CACHE_LINE_SIZE];
+	TAtomic<uint32> EnqueuePosition{ 0 };
+	uint8 PadToAvoidContention1[PLATFORM_CACHE_LINE_SIZE];
+	uint32 DequeuePosition = 0;
+};
\ No newline at end of file
@@ -127,12 +127,27 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel Invoker|Navmesh", meta = (EditCondition = bUseForNavmesh, ClampMin = 0))
 	float NavmeshRange = 1000;
 
+	// Will use the invoker velocity to prefetch the chunks along its predicted path:
+	// the LOD range will also be applied around the predicted position, and the tasks along the path will have a higher priority
+	// Unlike the invoker with prediction, the chunks around the current position are still computed first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel Invoker|Prefetch")
+	bool bEnablePrefetch = false;
+
+	// In seconds. Chunks will be prefetched up to Velocity * PrefetchTime ahead of the invoker
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel Invoker|Prefetch", meta = (EditCondition = bEnablePrefetch, ClampMin = 0))
+	float PrefetchTime = 2;
+
 public:
 	// VoxelSimpleInvokerComponent's GetInvokerVoxelPosition and GetInvokerSettings functions are calling GetInvokerGlobalPosition to find the global position of the invoker
 	// Defaults to GetComponentPosition
 	UFUNCTION(BlueprintNativeEvent, Category = "Voxel|Invoker")
 	FVector GetInvokerGlobalPosition() const;
 
+	// Used to prefetch the chunks if bEnablePrefetch is true. In cm/s
+	// Defaults to GetOwner()->GetVelocity()
+	UFUNCTION(BlueprintNativeEvent, Category = "Voxel|Invoker")
+	FVector GetInvokerGlobalVelocity() const;
+
 public:
 	//~ Begin UVoxelInvokerComponentBase Interface
 	virtual FIntVector GetInvokerVoxelPosition_Implementation(AVoxelWorldInterface* VoxelWorld) const override;
@@ -142,11 +157,13 @@ public:
 protected:
 	//~ Begin UVoxelSimpleInvokerComponent Interface
 	virtual FVector GetInvokerGlobalPosition_Implementation() const;
+	virtual FVector GetInvokerGlobalVelocity_Implementation() const;
 	//~ End UVoxelSimpleInvokerComponent Interface
 };
 
 // Voxel Invokers are used to configure the voxel world LOD, collisions and navmesh
 // Same as simple invoker, but optionally use the velocity to predict the position
+// Note: bEnablePrefetch is usually a better option, as it doesn't move the collisions & navmesh away from the invoker
 UCLASS(ClassGroup = Voxel, meta = (BlueprintSpawnableComponent))
 class VOXEL_API UVoxelInvokerWithPredictionComponent : public UVoxelSimpleInvokerComponent
 {
@@ -28,6 +28,7 @@ namespace FVoxelCookedDataVersion
 		SHARED_AddUserFlagsToSaves,
 		SHARED_StoreSpawnerMatricesRelativeToComponent,
 		SHARED_StoreMaterialChannelsIndividuallyAndRemoveFoliage,
+		AddChunkPositions,
 		
 		// -----<new versions can be added above this line>-------------------------------------------------
 		VersionPlusOne,
@@ -51,6 +52,8 @@ struct VOXEL_API FVoxelCookedDataImpl
 public:
 	struct FChunk
 	{
+		// Unknown (zero) for data cooked before AddChunkPositions
+		FIntVector Position = FIntVector::ZeroValue;
 		TArray<uint8> Data;
 
 		friend FArchive& operator<<(FArchive& Ar, FChunk& Chunk)
@@ -78,9 +81,13 @@ public:
 	{
 		return Chunks.Num() == 0;
 	}
+	bool HasChunkPositions() const
+	{
+		return Version >= FVoxelCookedDataVersion::AddChunkPositions;
+	}
 	
 private:
-	int32 Version;
+	int32 Version = FVoxelCookedDataVersion::LatestVersion;
 	FGuid Guid;
 
 	TArray<FChunk> Chunks;
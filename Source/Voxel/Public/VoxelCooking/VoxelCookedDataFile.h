@@ -0,0 +1,124 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Cooked collision stored in a seekable file, so that chunks can be read individually:
+ * a header, the PhysX data of each chunk, and an index of the chunks at the end
+ *
+ * Cook with UVoxelCookingLibrary::CookVoxelDataToFile, load with UVoxelCookingLibrary::LoadCookedVoxelDataFromFile
+ */
+namespace FVoxelCookedDataFileFormat
+{
+	static constexpr uint32 Magic = 0x44435856; // VXCD
+	// Bump when the layout changes
+	static constexpr uint32 Version = 1;
+
+	struct FChunkEntry
+	{
+		FIntVector Position = FIntVector::ZeroValue;
+		// Offset in the file
+		int64 Offset = 0;
+		int32 Size = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FChunkEntry& Entry)
+		{
+			Ar << Entry.Position;
+			Ar << Entry.Offset;
+			Ar << Entry.Size;
+			return Ar;
+		}
+	};
+}
+
+/**
+ * Writes the chunks directly to the file as they are cooked, so that the whole cooked data never needs to be in memory
+ * AddChunk is thread safe
+ */
+class VOXEL_API FVoxelCookedDataFileWriter
+{
+public:
+	// Null if the file can't be created
+	static TVoxelSharedPtr<FVoxelCookedDataFileWriter> Create(const FString& Path);
+	~FVoxelCookedDataFileWriter();
+
+	UE_NONCOPYABLE(FVoxelCookedDataFileWriter);
+
+	// Empty chunks are skipped
+	void AddChunk(const FIntVector& Position, const TArray<uint8>& Data);
+	// Writes the index and moves the file to its final path. Returns false on error
+	bool Finish();
+
+	int32 GetNumChunks() const
+	{
+		return Entries.Num();
+	}
+
+private:
+	const FString Path;
+	const FString TempPath;
+
+	FCriticalSection Section;
+	TUniquePtr<FArchive> Archive;
+	TArray<FVoxelCookedDataFileFormat::FChunkEntry> Entries;
+
+	FVoxelCookedDataFileWriter(const FString& Path, const FString& TempPath, TUniquePtr<FArchive> Archive);
+
+	void WriteHeader(int64 IndexOffset);
+};
+
+/**
+ * Only the index is read when opening the file: chunks are read on demand
+ * The file is memory mapped when the platform supports it, else chunks are read with regular file reads
+ * Thread safe
+ */
+class VOXEL_API FVoxelCookedDataFile
+{
+public:
+	// Null if the file doesn't exist or is corrupted
+	static TVoxelSharedPtr<FVoxelCookedDataFile> Open(const FString& Path);
+	~FVoxelCookedDataFile();
+
+	UE_NONCOPYABLE(FVoxelCookedDataFile);
+
+	const FString Path;
+
+	int32 Num() const
+	{
+		return Entries.Num();
+	}
+	const FIntVector& GetChunkPosition(int32 Index) const
+	{
+		return Entries[Index].Position;
+	}
+	bool IsMapped() const
+	{
+		return MappedRegion.IsValid();
+	}
+
+	// Lambda is called with the PhysX data of the chunk. Returns false if it couldn't be read
+	bool ReadChunk(int32 Index, TFunctionRef<void(TArrayView<const uint8> Data)> Lambda) const;
+
+private:
+	TArray<FVoxelCookedDataFileFormat::FChunkEntry> Entries;
+
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Fallback when mapping isn't supported
+	mutable FCriticalSection FileHandleSection;
+	TUniquePtr<IFileHandle> FileHandle;
+
+	explicit FVoxelCookedDataFile(const FString& Path);
+
+	// Reads Size bytes at Offset, from the mapped region or from the file
+	bool Read(int64 Offset, int64 Size, TFunctionRef<void(TArrayView<const uint8> Data)> Lambda) const;
+	int64 GetFileSize() const;
+};
\ No newline at end of file
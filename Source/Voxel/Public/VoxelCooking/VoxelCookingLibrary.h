@@ -48,6 +48,7 @@ class VOXEL_API UVoxelCookingLibrary : public UBlueprintFunctionLibrary
 
 public:
 	static FVoxelCookedData CookVoxelDataImpl(const FVoxelCookingSettings& Settings, const FVoxelUncompressedWorldSaveImpl* Save = nullptr);
+	static bool CookVoxelDataToFileImpl(const FVoxelCookingSettings& Settings, const FString& Path, const FVoxelUncompressedWorldSaveImpl* Save = nullptr);
 
 	// Cook collision meshes and save the result to VoxelCookedData
 	// Can then be loaded using LoadCookedVoxelData
@@ -66,6 +67,27 @@ public:
 		return CookVoxelDataImpl(Settings, &Save.Const());
 	}
 	
+	// Cook collision meshes and write them to Path as they are cooked, so that the whole cooked data is never in memory
+	// Can then be loaded using LoadCookedVoxelDataFromFile
+	// Useful for servers with big worlds
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Cooking")
+	static bool CookVoxelDataToFile(FVoxelCookingSettings Settings, const FString& Path)
+	{
+		return CookVoxelDataToFileImpl(Settings, Path, nullptr);
+	}
+	// Cook collision meshes and write them to Path as they are cooked, so that the whole cooked data is never in memory
+	// Can then be loaded using LoadCookedVoxelDataFromFile
+	// Useful for servers with big worlds
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Cooking")
+	static bool CookVoxelDataWithSaveToFile(FVoxelCookingSettings Settings, FVoxelUncompressedWorldSave Save, const FString& Path)
+	{
+		return CookVoxelDataToFileImpl(Settings, Path, &Save.Const());
+	}
+	// Write data cooked with CookVoxelData to a file that can be loaded using LoadCookedVoxelDataFromFile
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Cooking")
+	static bool SaveCookedVoxelDataToFile(FVoxelCookedData CookedData, const FString& Path);
+	
+
 	UFUNCTION(BlueprintPure, Category = "Voxel|Cooking", meta = (DefaultToSelf = "World"))
 	static FVoxelCookingSettings MakeVoxelCookingSettingsFromVoxelWorld(AVoxelWorld* World, int32 ThreadCount = 2);
 
@@ -76,4 +98,13 @@ public:
 	// Useful for servers
 	UFUNCTION(BlueprintCallable, Category = "Voxel|Cooking", meta = (DefaultToSelf = "World"))
 	static void LoadCookedVoxelData(FVoxelCookedData CookedData, AVoxelWorld* World);
+	
+	// Loads collision cooked with CookVoxelDataToFile
+	// Only the index of the file is read: the collision of a chunk is read from the file and created once it's in the collision bounds of an invoker,
+	// and is released once it isn't anymore. The file is memory mapped if the platform supports it
+	// The voxel world must not be created: it won't ever be created, collision meshes will be loaded directly
+	// Note: Only the voxel world collision settings will be applied
+	// Useful for servers
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Cooking", meta = (DefaultToSelf = "World"))
+	static bool LoadCookedVoxelDataFromFile(const FString& Path, AVoxelWorld* World);
 };
@@ -9,7 +9,9 @@
 #include "VoxelMaterial.h"
 #include "VoxelSharedMutex.h"
 #include "VoxelData/IVoxelData.h"
+#include "VoxelData/VoxelDataLeafIndex.h"
 #include "HAL/ConsoleManager.h"
+#include "HAL/ThreadSafeBool.h"
 
 class AVoxelWorld;
 class FVoxelData;
@@ -38,8 +40,34 @@ DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Num Voxel Asset Items"), STAT_NumVox
 DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Num Voxel Disable Edits Items"), STAT_NumVoxelDisableEditsItems, STATGROUP_VoxelCounters, VOXEL_API);
 DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Num Voxel Data Items"), STAT_NumVoxelDataItems, STATGROUP_VoxelCounters, VOXEL_API);
 
+enum class EVoxelEmptyState : uint8
+{
+	// Might have both empty and full values
+	Unknown,
+	// All values are empty
+	Empty,
+	// All values are full
+	Full
+};
+
 extern VOXEL_API TAutoConsoleVariable<int32> CVarMaxPlaceableItemsPerOctree;
 extern VOXEL_API TAutoConsoleVariable<int32> CVarStoreSpecialValueForGeneratorValuesInSaves;
+extern VOXEL_API TAutoConsoleVariable<int32> CVarCacheBoundsBatchSize;
+
+// Optional progress of the long FVoxelData operations (CacheBounds, GetSave), can be read & cancelled from any thread
+struct FVoxelDataProgress
+{
+	// Set once the leaves to process are known
+	FThreadSafeCounter NumLeaves;
+	FThreadSafeCounter NumLeavesDone;
+	FThreadSafeBool bCancel;
+
+	float GetProgress() const
+	{
+		const int32 Num = NumLeaves.GetValue();
+		return Num > 0 ? float(NumLeavesDone.GetValue()) / Num : 0.f;
+	}
+};
 
 // Turns off some expensive compression settings that aren't needed if you just want to save, recreate world, load
 // TODO REMOVE AND MAKE Save/Load param
@@ -78,6 +106,8 @@ struct VOXEL_API FVoxelDataSettings
 	const TVoxelSharedRef<FVoxelGeneratorInstance> Generator;
 	const bool bEnableMultiplayer;
 	const bool bEnableUndoRedo;
+	// See FVoxelData::GeneratorHash. Only known when created from a world
+	const uint64 GeneratorHash;
 
 	FVoxelDataSettings(const AVoxelWorld* World, EVoxelPlayType PlayType);
 	FVoxelDataSettings(
@@ -101,12 +131,18 @@ private:
 	explicit FVoxelData(const FVoxelDataSettings& Settings);
 
 public:
+	// Hash of the generator, its parameters & its init, 0 if unknown. Used to key the chunk meshes saved on disk
+	const uint64 GeneratorHash;
+
 	static TVoxelSharedRef<FVoxelData> Create(const FVoxelDataSettings& Settings, int32 DataOctreeInitialSubdivisionDepth = 0);
 	// Clone without keeping the voxel data
 	TVoxelSharedRef<FVoxelData> Clone() const;
 	~FVoxelData();
 	
 private:
+	// Must be declared before Octree, so that it doesn't point to destroyed leaves. Reset when the octree is destroyed
+	// Mutable as the octree is: leaves are added to it when created by const functions
+	mutable FVoxelDataLeafIndex LeafIndex;
 	TUniquePtr<FVoxelDataOctreeParent> Octree;
 	// Is locked as read when a lock is done
 	// Lock as write to clear the octree, making sure no octrees are locked
@@ -119,6 +155,18 @@ public:
 	}
 	FVoxelDataOctreeBase& GetOctree() const;
 
+	// Bottom node containing X Y Z: the leaf if there's one, else the deepest parent
+	// Uses the leaf index when possible to avoid walking down the octree
+	FVoxelDataOctreeBase& GetBottomNode(int32 X, int32 Y, int32 Z) const;
+	// Creates the leaf if needed. Requires write lock
+	FVoxelDataOctreeLeaf& GetOrCreateLeaf(int32 X, int32 Y, int32 Z);
+
+	// Pass to FVoxelDataOctreeParent::CreateChildren
+	FORCEINLINE FVoxelDataLeafIndex& GetLeafIndex() const
+	{
+		return LeafIndex;
+	}
+
 	// NOTE: what if we query between WorldBounds.Max - 1 and WorldBounds.Max?
 	template<typename T>
 	FORCEINLINE bool IsInWorld(T X, T Y, T Z) const
@@ -167,8 +215,11 @@ public:
 	void ClearOctreeData(TArray<FVoxelIntBox>& OutBoundsToUpdate);
 
 	// Requires write lock
+	// Leaves without items are generated by batches of voxel.data.CacheBoundsBatchSize^3 leaves, in a single generator query
+	// Leaves the generator range analysis proves single valued are not generated
+	// If cancelled through Progress, the leaves already generated are kept
 	template<typename T>
-	void CacheBounds(const FVoxelIntBox& Bounds, bool bMultiThreaded);
+	void CacheBounds(const FVoxelIntBox& Bounds, bool bMultiThreaded, FVoxelDataProgress* Progress = nullptr);
 	
 	// Requires write lock
 	template<typename T>
@@ -202,6 +253,10 @@ public:
 	TVoxelRange<FVoxelValue> GetValueRange(const FVoxelIntBox& Bounds, int32 LOD) const;
 
 	bool IsEmpty(const FVoxelIntBox& Bounds, int32 LOD) const;
+	// Requires read lock
+	// If the range of Bounds is inconclusive, recursively tries again on its octants until they are smaller than MinSize voxels at LOD
+	// Range analysis is a lot more precise on small bounds, so this can prove chunks empty when IsEmpty can't
+	EVoxelEmptyState GetEmptyState(const FVoxelIntBox& Bounds, int32 LOD, int32 MinSize) const;
 
 	template<typename T>
 	T GetCustomOutput(T DefaultValue, FName Name, v_flt X, v_flt Y, v_flt Z, int32 LOD) const;
@@ -264,7 +319,11 @@ public:
 	 */
 
 	// Get a save of this world. No lock required
-	void GetSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects);
+	// The dirty data is copied under a read lock, the save is then built from the copy without locking: edits are only blocked during the copy
+	// Trade-off: this is a memcpy of every dirty leaf buffer (8KB of values per leaf, plus its materials) under a read lock on the whole world,
+	// not a copy-on-write: writers would need to check for a shared buffer in every GetRef. On worlds with a lot of edited leaves, expect edits to stall for the duration of the copy
+	// Returns false if cancelled through Progress, in which case OutSave is left untouched
+	bool GetSave(FVoxelUncompressedWorldSaveImpl& OutSave, TArray<FVoxelObjectArchiveEntry>& OutObjects, FVoxelDataProgress* Progress = nullptr);
 
 	/**
 	 * Load this world from save. No lock required
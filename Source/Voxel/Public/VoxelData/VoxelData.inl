@@ -15,12 +15,39 @@ FORCEINLINE FVoxelDataOctreeBase& FVoxelData::GetOctree() const
 	return *Octree;
 }
 
+FORCEINLINE FVoxelDataOctreeBase& FVoxelData::GetBottomNode(int32 X, int32 Y, int32 Z) const
+{
+	if (FVoxelDataOctreeLeaf* Leaf = LeafIndex.Find(X, Y, Z))
+	{
+		checkVoxelSlow(Leaf->IsInOctree(X, Y, Z));
+		return *Leaf;
+	}
+	// Need to get the node for ItemHolders, even if there is no leaf
+	return FVoxelOctreeUtilities::GetBottomNode(GetOctree(), X, Y, Z);
+}
+
+FORCEINLINE FVoxelDataOctreeLeaf& FVoxelData::GetOrCreateLeaf(int32 X, int32 Y, int32 Z)
+{
+	if (FVoxelDataOctreeLeaf* Leaf = LeafIndex.Find(X, Y, Z))
+	{
+		checkVoxelSlow(Leaf->IsInOctree(X, Y, Z));
+		return *Leaf;
+	}
+	return *FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(GetOctree(), X, Y, Z, LeafIndex);
+}
+
 template<typename T>
-void FVoxelData::CacheBounds(const FVoxelIntBox& Bounds, bool bMultiThreaded)
+void FVoxelData::CacheBounds(const FVoxelIntBox& Bounds, bool bMultiThreaded, FVoxelDataProgress* Progress)
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
+	const int32 BatchSize = FMath::Max(1, CVarCacheBoundsBatchSize.GetValueOnAnyThread());
+
+	// Leaves with items, generated one by one
 	TArray<FVoxelDataOctreeLeaf*> Leaves;
+	// Leaves without items only depend on the generator: they can be queried together
+	TMap<FIntVector, TArray<FVoxelDataOctreeLeaf*>> LeavesToBatch;
+	int32 NumLeaves = 0;
 	FVoxelOctreeUtilities::IterateTreeInBounds(GetOctree(), Bounds, [&](FVoxelDataOctreeBase& Chunk)
 	{
 		if (Chunk.IsLeaf())
@@ -31,7 +58,15 @@ void FVoxelData::CacheBounds(const FVoxelIntBox& Bounds, bool bMultiThreaded)
 			auto& DataHolder = Leaf.GetData<T>();
 			if (!DataHolder.HasData())
 			{
-				Leaves.Add(&Leaf);
+				NumLeaves++;
+				if (BatchSize > 1 && Leaf.GetItemHolder().NumItems() == 0)
+				{
+					LeavesToBatch.FindOrAdd(FVoxelUtilities::DivideFloor(Leaf.GetMin(), DATA_CHUNK_SIZE * BatchSize)).Add(&Leaf);
+				}
+				else
+				{
+					Leaves.Add(&Leaf);
+				}
 			}
 		}
 		else
@@ -40,22 +75,111 @@ void FVoxelData::CacheBounds(const FVoxelIntBox& Bounds, bool bMultiThreaded)
 			if (!Parent.HasChildren())
 			{
 				ensureThreadSafe(Chunk.IsLockedForWrite());
-				Parent.CreateChildren();
+				Parent.CreateChildren(LeafIndex);
 			}
 		}
 	});
 
-	ParallelFor(Leaves.Num(), [&](int32 Index)
+	struct FBatch
 	{
-		FVoxelDataOctreeLeaf& Leaf = *Leaves[Index];
-		
-		auto& DataHolder = Leaf.GetData<T>();
-		DataHolder.CreateData(*this, [&](T* RESTRICT DataPtr)
+		FVoxelIntBox Bounds;
+		TArray<FVoxelDataOctreeLeaf*> Leaves;
+	};
+	TArray<FBatch> Batches;
+	for (auto& It : LeavesToBatch)
+	{
+		FVoxelIntBox BatchBounds = It.Value[0]->GetBounds();
+		for (FVoxelDataOctreeLeaf* Leaf : It.Value)
 		{
-			TVoxelQueryZone<T> QueryZone(Leaf.GetBounds(), DataPtr);
-			Leaf.GetFromGeneratorAndAssets(*Generator, QueryZone, 0);
-		});
+			BatchBounds = BatchBounds + Leaf->GetBounds();
+		}
+
+		// Don't query the generator for a mostly empty box
+		if (It.Value.Num() > 1 && uint64(2 * It.Value.Num() * VOXELS_PER_DATA_CHUNK) >= BatchBounds.Count())
+		{
+			Batches.Add({ BatchBounds, MoveTemp(It.Value) });
+		}
+		else
+		{
+			Leaves.Append(It.Value);
+		}
+	}
+	LeavesToBatch.Empty();
+
+	if (Progress)
+	{
+		Progress->NumLeaves.Set(NumLeaves);
+	}
+
+	const auto ReportProgress = [&](int32 NumDone)
+	{
+		if (Progress)
+		{
+			Progress->NumLeavesDone.Add(NumDone);
+		}
+	};
+	const auto IsCancelled = [&]()
+	{
+		return Progress && Progress->bCancel;
+	};
+
+	ParallelFor(Batches.Num() + Leaves.Num(), [&](int32 Index)
+	{
+		if (IsCancelled())
+		{
+			return;
+		}
+
+		if (Index >= Batches.Num())
+		{
+			Leaves[Index - Batches.Num()]->CreateDataFromGenerator<T>(*this);
+			ReportProgress(1);
+			return;
+		}
 
+		const FBatch& Batch = Batches[Index];
+
+		T SingleValue;
+		if (FVoxelDataOctreeUtilities::GetSingleValueFromRange(*Generator, Batch.Bounds, FVoxelItemStack::Empty, SingleValue))
+		{
+			for (FVoxelDataOctreeLeaf* Leaf : Batch.Leaves)
+			{
+				Leaf->GetData<T>().SetSingleValue(SingleValue);
+			}
+			INC_DWORD_STAT_BY(STAT_VoxelDataLeafAllocationsAvoided, Batch.Leaves.Num());
+			ReportProgress(Batch.Leaves.Num());
+			return;
+		}
+
+		TArray<T> BatchData;
+		BatchData.SetNumUninitialized(int32(Batch.Bounds.Count()));
+		{
+			VOXEL_ASYNC_SCOPE_COUNTER("Query Batch");
+			TVoxelQueryZone<T> QueryZone(Batch.Bounds, BatchData);
+			Generator->Get(QueryZone, 0, FVoxelItemStack::Empty);
+		}
+
+		const FIntVector Size = Batch.Bounds.Size();
+		for (FVoxelDataOctreeLeaf* Leaf : Batch.Leaves)
+		{
+			const FIntVector Offset = Leaf->GetMin() - Batch.Bounds.Min;
+			auto& DataHolder = Leaf->GetData<T>();
+			DataHolder.CreateData(*this, [&](T* RESTRICT DataPtr)
+			{
+				for (int32 Z = 0; Z < DATA_CHUNK_SIZE; Z++)
+				{
+					for (int32 Y = 0; Y < DATA_CHUNK_SIZE; Y++)
+					{
+						FMemory::Memcpy(
+							&DataPtr[FVoxelDataOctreeUtilities::IndexFromCoordinates(0, Y, Z)],
+							&BatchData[Offset.X + Size.X * (Offset.Y + Y) + Size.X * Size.Y * (Offset.Z + Z)],
+							DATA_CHUNK_SIZE * sizeof(T));
+					}
+				}
+			});
+			DataHolder.TryCompressToSingleValue(*this);
+		}
+		ReportProgress(Batch.Leaves.Num());
 	}, !bMultiThreaded);
 }
 
@@ -119,7 +243,7 @@ FORCEINLINE T FVoxelData::GetCustomOutput(T DefaultValue, FName Name, v_flt X, v
 	// Clamp to world, to avoid un-editable border
 	ClampToWorld(X, Y, Z);
 
-	auto& Node = FVoxelOctreeUtilities::GetBottomNode(GetOctree(), int32(X), int32(Y), int32(Z));
+	auto& Node = GetBottomNode(int32(X), int32(Y), int32(Z));
 	return Node.GetCustomOutput<T>(*Generator, DefaultValue, Name, X, Y, Z, LOD);
 }
 
@@ -144,7 +268,7 @@ void FVoxelData::Set(const FVoxelIntBox& Bounds, F Apply)
 			if (!Parent.HasChildren())
 			{
 				ensureThreadSafe(Parent.IsLockedForWrite());
-				Parent.CreateChildren();
+				Parent.CreateChildren(LeafIndex);
 			}
 		}
 	});
@@ -170,7 +294,7 @@ void FVoxelData::ParallelSet(const FVoxelIntBox& Bounds, F Apply, bool bForceSin
 			if (!Parent.HasChildren())
 			{
 				ensureThreadSafe(Parent.IsLockedForWrite());
-				Parent.CreateChildren();
+				Parent.CreateChildren(LeafIndex);
 			}
 		}
 	});
@@ -192,7 +316,7 @@ FORCEINLINE void FVoxelData::Set(int32 X, int32 Y, int32 Z, const T& Value)
 	{
 		auto Iterate = [&](auto Lambda) { Lambda(X, Y, Z); };
 		auto Apply = [&](int32, int32, int32, T& InValue) { InValue = Value; };
-		auto& Leaf = *FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(GetOctree(), X, Y, Z);
+		auto& Leaf = GetOrCreateLeaf(X, Y, Z);
 		FVoxelDataOctreeSetter::Set<T>(*this, Leaf, Iterate, Apply);
 	}
 }
@@ -203,7 +327,7 @@ FORCEINLINE T FVoxelData::Get(int32 X, int32 Y, int32 Z, int32 LOD) const
 	// Clamp to world, to avoid un-editable border
 	ClampToWorld(X, Y, Z);
 
-	auto& Node = FVoxelOctreeUtilities::GetBottomNode(GetOctree(), int32(X), int32(Y), int32(Z));
+	auto& Node = GetBottomNode(X, Y, Z);
 	return Node.Get<T>(*Generator, X, Y, Z, LOD);
 }
 
@@ -325,7 +449,7 @@ TVoxelWeakPtr<const TVoxelDataItemWrapper<T>> FVoxelData::AddItem(TArgs&&... Arg
 		{
 			ensureThreadSafe(Tree.IsLockedForWrite());
 			
-			Tree.GetItemHolder().AddItem(ItemWrapper->Item);
+			Tree.GetOrCreateItemHolder().AddItem(ItemWrapper->Item);
 
 			if (!bDoNotModifyExistingDataChunks)
 			{
@@ -341,11 +465,11 @@ TVoxelWeakPtr<const TVoxelDataItemWrapper<T>> FVoxelData::AddItem(TArgs&&... Arg
 				// -1: since we're adding a new one
 				if (Tree.GetItemHolder().NeedToSubdivide(MaxPlaceableItemsPerOctree - 1))
 				{
-					Parent.CreateChildren();
+					Parent.CreateChildren(LeafIndex);
 				}
 				else
 				{
-					Tree.GetItemHolder().AddItem(ItemWrapper->Item);
+					Tree.GetOrCreateItemHolder().AddItem(ItemWrapper->Item);
 				}
 			}
 		}
@@ -399,7 +523,7 @@ bool FVoxelData::RemoveItem(TVoxelWeakPtr<const TVoxelDataItemWrapper<T>>& InIte
 		{
 			ensureThreadSafe(Tree.IsLockedForWrite());
 
-			Tree.GetItemHolder().RemoveItem(Item->Item);
+			Tree.RemoveItem(Item->Item);
 
 			if (Tree.IsLeaf())
 			{
@@ -512,8 +636,8 @@ void FVoxelDataUtilities::AddItemToLeafData(
 		Data,
 		Leaf,
 		Item.Bounds,
-		[&]() { ensure(Leaf.GetItemHolder().RemoveItem(Item)); },
-		[&]() { Leaf.GetItemHolder().AddItem(Item); });
+		[&]() { ensure(Leaf.RemoveItem(Item)); },
+		[&]() { Leaf.GetOrCreateItemHolder().AddItem(Item); });
 }
 
 template<typename T, typename TItem>
@@ -522,11 +646,11 @@ void FVoxelDataUtilities::RemoveItemFromLeafData(
 	FVoxelDataOctreeLeaf& Leaf,
 	const TItem& Item)
 {
-	ensureVoxelSlowNoSideEffects(!Leaf.GetItemHolder().RemoveItem(Item));
+	ensureVoxelSlowNoSideEffects(!Leaf.RemoveItem(Item));
 	MigrateLeafDataToNewGenerator<T>(
 		Data,
 		Leaf,
 		Item.Bounds,
-		[&]() { Leaf.GetItemHolder().AddItem(Item); },
-		[&]() { ensure(Leaf.GetItemHolder().RemoveItem(Item)); });
+		[&]() { Leaf.GetOrCreateItemHolder().AddItem(Item); },
+		[&]() { ensure(Leaf.RemoveItem(Item)); });
 }
\ No newline at end of file
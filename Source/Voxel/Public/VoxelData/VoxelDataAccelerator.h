@@ -15,7 +15,7 @@ class FVoxelDataOctreeBase;
 namespace FVoxelDataAcceleratorParameters
 {
 	VOXEL_API int32 GetDefaultCacheSize();
-	VOXEL_API bool GetUseAcceleratorMap();
+	VOXEL_API bool GetUseLeafIndex();
 	VOXEL_API bool GetShowStats();
 }
 	
@@ -26,15 +26,14 @@ public:
 	TData& Data;
 	const FVoxelIntBox Bounds;
 	const int32 CacheSize;
-	const bool bUseAcceleratorMap;
+	const bool bUseLeafIndex;
 
 	static constexpr bool bIsConst = TIsConst<TData>::Value;
 
-	// Will not build an accelerator map. Access can be done anywhere
+	// Access can be done anywhere
 	explicit TVoxelDataAccelerator(TData& Data, int32 CacheSize = FVoxelDataAcceleratorParameters::GetDefaultCacheSize());
-	// Will build an accelerator map. Access can only be done in Bounds
-	// Map source can't be used when TData is not const
-	TVoxelDataAccelerator(TData& Data, const FVoxelIntBox& Bounds, const TVoxelDataAccelerator<TData>* MapSource = nullptr, int32 CacheSize = FVoxelDataAcceleratorParameters::GetDefaultCacheSize());
+	// Access can only be done in Bounds
+	TVoxelDataAccelerator(TData& Data, const FVoxelIntBox& Bounds, int32 CacheSize = FVoxelDataAcceleratorParameters::GetDefaultCacheSize());
 	~TVoxelDataAccelerator();
 
 	// Copying can mess up the cache
@@ -139,18 +138,12 @@ private:
 	mutable uint32 NumCacheAllAccess = 0;
 	mutable uint32 NumCacheAllMiss = 0;
 
-	mutable uint32 NumMapAccess = 0;
-	mutable uint32 NumMapMiss = 0;
+	mutable uint32 NumLeafIndexAccess = 0;
+	mutable uint32 NumLeafIndexMiss = 0;
 	
 	mutable uint32 NumOutOfWorld = 0;
 #endif
 
-	using FAcceleratorMap = TMap<FIntVector, FVoxelDataOctreeLeaf*>;
-	using FConstAcceleratorMap = typename TChooseClass<bIsConst, const FAcceleratorMap, FAcceleratorMap>::Result;
-	
-	// Map from Leaf.GetMin() to &Leaf
-	const TVoxelSharedPtr<FConstAcceleratorMap> AcceleratorMap;
-
 	template<typename T>
 	auto GetImpl(int32 X, int32 Y, int32 Z, T UseOctree) const;
 
@@ -159,11 +152,9 @@ private:
 
 	FVoxelDataOctreeBase* GetOctreeFromCache_CheckTopOnly(int32 X, int32 Y, int32 Z) const;
 	FVoxelDataOctreeBase* GetOctreeFromCache_CheckAll(int32 X, int32 Y, int32 Z) const;
-	FVoxelDataOctreeBase* GetOctreeFromMap(int32 X, int32 Y, int32 Z) const;
+	FVoxelDataOctreeBase* GetOctreeFromLeafIndex(int32 X, int32 Y, int32 Z) const;
 
 	void StoreOctreeInCache(FVoxelDataOctreeBase& Octree) const;
-
-	static TVoxelSharedRef<FAcceleratorMap> GetAcceleratorMap(const FVoxelData& Data, const FVoxelIntBox& Bounds);
 };
 
 class FVoxelMutableDataAccelerator : public TVoxelDataAccelerator<FVoxelData>
@@ -19,21 +19,18 @@ TVoxelDataAccelerator<TData>::TVoxelDataAccelerator(TData& Data, int32 CacheSize
 	: Data(Data)
 	, Bounds(FVoxelIntBox::Infinite)
 	, CacheSize(CacheSize)
-	, bUseAcceleratorMap(false)
+	, bUseLeafIndex(FVoxelDataAcceleratorParameters::GetUseLeafIndex())
 {
 	CacheEntries.Reserve(CacheSize);
 }
 
 template<typename TData>
-TVoxelDataAccelerator<TData>::TVoxelDataAccelerator(TData& Data, const FVoxelIntBox& Bounds, const TVoxelDataAccelerator<TData>* MapSource, int32 CacheSize)
+TVoxelDataAccelerator<TData>::TVoxelDataAccelerator(TData& Data, const FVoxelIntBox& Bounds, int32 CacheSize)
 	: Data(Data)
 	, Bounds(Bounds)
 	, CacheSize(CacheSize)
-	, bUseAcceleratorMap(FVoxelDataAcceleratorParameters::GetUseAcceleratorMap())
-	, AcceleratorMap(MapSource ? MapSource->AcceleratorMap : GetAcceleratorMap(Data, Bounds))
+	, bUseLeafIndex(FVoxelDataAcceleratorParameters::GetUseLeafIndex())
 {
-	check(!MapSource || bIsConst);
-	ensure(!MapSource || bUseAcceleratorMap == MapSource->bUseAcceleratorMap);
 	CacheEntries.Reserve(CacheSize);
 }
 
@@ -45,7 +42,7 @@ TVoxelDataAccelerator<TData>::~TVoxelDataAccelerator()
 	{
 		LOG_VOXEL(
 			Log,
-			TEXT("DataAccelerator: %6u reads; %6u writes; %6u/%6u top cache miss (%3.2f%% hits); %6u/%6u other cache miss (%3.2f%% hits); %6u/%6u map miss (%3.2f%% hits); %6u out of world"),
+			TEXT("DataAccelerator: %6u reads; %6u writes; %6u/%6u top cache miss (%3.2f%% hits); %6u/%6u other cache miss (%3.2f%% hits); %6u/%6u leaf index miss (%3.2f%% hits); %6u out of world"),
 			NumGet,
 			NumSet,
 			NumCacheTopMiss,
@@ -54,9 +51,9 @@ TVoxelDataAccelerator<TData>::~TVoxelDataAccelerator()
 			NumCacheAllMiss,
 			NumCacheAllAccess,
 			NumCacheAllAccess > 0 ? 100 * double(NumCacheAllAccess - NumCacheAllMiss) / NumCacheAllAccess : 0,
-			NumMapMiss,
-			NumMapAccess,
-			NumMapAccess > 0 ? 100 * double(NumMapAccess - NumMapMiss) / NumMapAccess : 0,
+			NumLeafIndexMiss,
+			NumLeafIndexAccess,
+			NumLeafIndexAccess > 0 ? 100 * double(NumLeafIndexAccess - NumLeafIndexMiss) / NumLeafIndexAccess : 0,
 			NumOutOfWorld);
 	}
 #endif
@@ -129,7 +126,7 @@ auto TVoxelDataAccelerator<TData>::GetImpl(int32 X, int32 Y, int32 Z, T UseOctre
 	// Each caller should clamp the coordinates
 	ensureVoxelSlow(Data.IsInWorld(X, Y, Z));
 
-	ensureMsgfVoxelSlowNoSideEffects(!bUseAcceleratorMap || Bounds.Contains(X, Y, Z), TEXT("(%d, %d, %d) is not in %s!"), X, Y, Z, *Bounds.ToString());
+	ensureMsgfVoxelSlowNoSideEffects(Bounds.Contains(X, Y, Z), TEXT("(%d, %d, %d) is not in %s!"), X, Y, Z, *Bounds.ToString());
 
 	FVoxelDataOctreeBase* Octree = GetOctreeFromCache_CheckTopOnly(X, Y, Z);
 
@@ -148,9 +145,9 @@ auto TVoxelDataAccelerator<TData>::GetImpl(int32 X, int32 Y, int32 Z, T UseOctre
 		return UseOctree(*Octree);
 	}
 
-	if (bUseAcceleratorMap)
+	if (bUseLeafIndex)
 	{
-		Octree = GetOctreeFromMap(X, Y, Z);
+		Octree = GetOctreeFromLeafIndex(X, Y, Z);
 	}
 	
 	if (!Octree)
@@ -173,7 +170,7 @@ bool TVoxelDataAccelerator<TData>::SetImpl(int32 X, int32 Y, int32 Z, TLambda Ed
 
 	ACCELERATOR_STAT(NumSet++);
 
-	ensureVoxelSlowNoSideEffects(!bUseAcceleratorMap || Bounds.Contains(X, Y, Z));
+	ensureVoxelSlowNoSideEffects(Bounds.Contains(X, Y, Z));
 
 	FVoxelDataOctreeBase* Octree;
 
@@ -209,23 +206,15 @@ bool TVoxelDataAccelerator<TData>::SetImpl(int32 X, int32 Y, int32 Z, TLambda Ed
 			return false;
 		}
 		
-		if (bUseAcceleratorMap)
+		if (bUseLeafIndex)
 		{
-			Octree = GetOctreeFromMap(X, Y, Z);
+			Octree = GetOctreeFromLeafIndex(X, Y, Z);
 		}
 
 		if (!Octree)
 		{
-			auto& Node = FVoxelOctreeUtilities::GetBottomNode(Data.GetOctree(), X, Y, Z);
-			// Not true if it was edited outside of this accelerator // ensureVoxelSlowNoSideEffects(!bUseAcceleratorMap || !Node.IsLeaf());
-			Octree = FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(Node, X, Y, Z);
-
-			if (bUseAcceleratorMap)
-			{
-				const FIntVector HashPosition = FVoxelUtilities::DivideFloor(FIntVector(X, Y, Z), DATA_CHUNK_SIZE);
-				ensureVoxelSlowNoSideEffects(AcceleratorMap.IsUnique());
-				AcceleratorMap->Add(HashPosition, &Octree->AsLeaf());
-			}
+			// The new leaf is added to the leaf index when created
+			Octree = FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(Data.GetOctree(), X, Y, Z, Data.GetLeafIndex());
 		}
 
 		StoreOctreeInCache(*Octree);
@@ -302,15 +291,16 @@ FVoxelDataOctreeBase* TVoxelDataAccelerator<TData>::GetOctreeFromCache_CheckAll(
 //////////////////////////////////////////////////////////////////////////////
 
 template<typename TData>
-FVoxelDataOctreeBase* TVoxelDataAccelerator<TData>::GetOctreeFromMap(int32 X, int32 Y, int32 Z) const
+FVoxelDataOctreeBase* TVoxelDataAccelerator<TData>::GetOctreeFromLeafIndex(int32 X, int32 Y, int32 Z) const
 {
-	checkVoxelSlow(bUseAcceleratorMap);
-
-	ACCELERATOR_STAT(NumMapAccess++);
-	const FIntVector HashPosition = FVoxelUtilities::DivideFloor(FIntVector(X, Y, Z), DATA_CHUNK_SIZE);
-	auto* Result = AcceleratorMap->FindRef(HashPosition);
-	ACCELERATOR_STAT(if (!Result) NumMapMiss++);
-	return Result;
+	checkVoxelSlow(bUseLeafIndex);
+
+	ACCELERATOR_STAT(NumLeafIndexAccess++);
+	FVoxelDataOctreeLeaf* Leaf = Data.GetLeafIndex().Find(X, Y, Z);
+	ACCELERATOR_STAT(if (!Leaf) NumLeafIndexMiss++);
+	checkVoxelSlow(!Leaf || Leaf->IsInOctree(X, Y, Z));
+	ensureThreadSafe(!Leaf || Leaf->IsLockedForRead());
+	return Leaf;
 }
 
 template<typename TData>
@@ -328,19 +318,4 @@ void TVoxelDataAccelerator<TData>::StoreOctreeInCache(FVoxelDataOctreeBase& Octr
 	CacheEntries.Insert(CacheEntry, 0);
 }
 
-template<typename TData>
-TVoxelSharedRef<TMap<FIntVector, FVoxelDataOctreeLeaf*>> TVoxelDataAccelerator<TData>::GetAcceleratorMap(const FVoxelData& Data, const FVoxelIntBox& Bounds)
-{
-	VOXEL_ASYNC_FUNCTION_COUNTER();
-
-	const auto AcceleratorMap = MakeVoxelShared<FAcceleratorMap>();
-	FVoxelOctreeUtilities::IterateLeavesInBounds(Data.GetOctree(), Bounds, [&](auto& Leaf)
-	{
-		ensureThreadSafe(Leaf.IsLockedForRead());
-		AcceleratorMap->Add(Leaf.GetMin() / DATA_CHUNK_SIZE, &Leaf);
-	});
-	AcceleratorMap->Compact();
-	return AcceleratorMap;
-}
-
 #undef ACCELERATOR_STAT
\ No newline at end of file
@@ -0,0 +1,138 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+#include "VoxelUtilities/VoxelBaseUtilities.h"
+#include "Templates/Atomic.h"
+
+class FVoxelDataOctreeLeaf;
+
+/**
+ * Map from leaf position to leaf, for all the leaves of a data octree
+ * Kept up to date when leaves are created/destroyed, so that finding the leaf of a voxel is a single probe instead of a walk down the octree
+ *
+ * Open addressing with linear probing, keyed by Leaf.GetMin() / DATA_CHUNK_SIZE
+ *
+ * Lookups are lock free: writers increment Version before and after modifying the table, and a lookup that overlaps a write
+ * returns null instead of a possibly torn slot, the caller then walking down the octree. Writes only happen when leaves are created,
+ * which is rare compared to lookups
+ * Writers are serialized by a critical section, as leaves can be created in different parts of the octree at the same time
+ * Tables replaced when growing are only freed in Reset/the destructor, as lookups might still be reading them
+ *
+ * The leaves returned are only valid as long as the caller has a lock on them
+ */
+class VOXEL_API FVoxelDataLeafIndex
+{
+public:
+	FVoxelDataLeafIndex() = default;
+	~FVoxelDataLeafIndex();
+
+	UE_NONCOPYABLE(FVoxelDataLeafIndex);
+
+	// Leaf containing X Y Z, or null if none or if the index was being modified
+	FORCEINLINE FVoxelDataOctreeLeaf* Find(int32 X, int32 Y, int32 Z) const
+	{
+		const FIntVector Key(
+			FVoxelUtilities::DivideFloor(X, DATA_CHUNK_SIZE),
+			FVoxelUtilities::DivideFloor(Y, DATA_CHUNK_SIZE),
+			FVoxelUtilities::DivideFloor(Z, DATA_CHUNK_SIZE));
+
+		const uint32 StartVersion = Version.Load();
+		if (StartVersion & 1)
+		{
+			// Being written to
+			return nullptr;
+		}
+
+		const FTable* LocalTable = Table.Load();
+		if (!LocalTable)
+		{
+			return nullptr;
+		}
+
+		FVoxelDataOctreeLeaf* Result = nullptr;
+		const uint32 Mask = LocalTable->Capacity - 1;
+		// Bounded, as the table can be modified while we're probing it
+		for (uint32 Probe = 0, Index = GetHash(Key) & Mask; Probe < LocalTable->Capacity; Probe++, Index = (Index + 1) & Mask)
+		{
+			const FSlot& Slot = LocalTable->Slots[Index];
+			FVoxelDataOctreeLeaf* const SlotLeaf = Slot.Leaf;
+			if (!SlotLeaf)
+			{
+				break;
+			}
+			if (Slot.Key == Key)
+			{
+				Result = SlotLeaf;
+				break;
+			}
+		}
+
+		// Make sure the slot reads are done before checking the version again
+		FPlatformMisc::MemoryBarrier();
+		if (Version.Load() != StartVersion)
+		{
+			return nullptr;
+		}
+		return Result;
+	}
+
+	// Called by the octree when leaves are created/destroyed. Thread safe
+	void Add(FVoxelDataOctreeLeaf& Leaf);
+	void Remove(FVoxelDataOctreeLeaf& Leaf);
+	// Removes all the leaves, when the entire octree is destroyed. No lookup must be running
+	void Reset();
+
+	int32 GetNum() const
+	{
+		FScopeLock Lock(&WriteSection);
+		return Num;
+	}
+
+private:
+	struct FSlot
+	{
+		FIntVector Key;
+		// Null if the slot is empty
+		FVoxelDataOctreeLeaf* Leaf;
+	};
+	struct FTable
+	{
+		uint32 Capacity; // Always a power of 2
+		FSlot Slots[1];
+	};
+
+	TAtomic<uint32> Version{ 0 };
+	TAtomic<FTable*> Table{ nullptr };
+
+	mutable FCriticalSection WriteSection;
+	uint32 Num = 0;
+	// Tables that lookups might still be reading
+	TArray<FTable*> RetiredTables;
+
+	static FTable* AllocateTable(uint32 Capacity);
+	static void FreeTable(FTable* Table);
+
+	FORCEINLINE static uint32 GetHash(const FIntVector& Key)
+	{
+		return FVoxelUtilities::MurmurHash32(uint32(Key.X) * 73856093u ^ uint32(Key.Y) * 19349663u ^ uint32(Key.Z) * 83492791u);
+	}
+
+	static void Insert(FTable& Table, const FIntVector& Key, FVoxelDataOctreeLeaf* Leaf);
+	void Grow();
+
+	// Makes lookups running concurrently to a write return null
+	FORCEINLINE void BeginWrite()
+	{
+		checkVoxelSlow(!(Version.Load() & 1));
+		++Version;
+		FPlatformMisc::MemoryBarrier();
+	}
+	FORCEINLINE void EndWrite()
+	{
+		FPlatformMisc::MemoryBarrier();
+		++Version;
+	}
+};
\ No newline at end of file
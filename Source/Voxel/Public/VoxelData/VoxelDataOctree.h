@@ -14,10 +14,14 @@
 #include "VoxelData/VoxelDataOctreeLeafCustomChannels.h"
 #include "VoxelData/VoxelDataOctreeLeafUndoRedo.h"
 #include "VoxelData/VoxelDataOctreeLeafMultiplayer.h"
+#include "VoxelData/VoxelDataLeafIndex.h"
 #include "VoxelPlaceableItems/VoxelPlaceableItem.h"
 
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Data Octrees Memory"), STAT_VoxelDataOctreesMemory, STATGROUP_VoxelMemory, VOXEL_API);
 DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Voxel Data Octrees Count"), STAT_VoxelDataOctreesCount, STATGROUP_VoxelCounters, VOXEL_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Voxel Data Leaf Allocations Avoided"), STAT_VoxelDataLeafAllocationsAvoided, STATGROUP_VoxelCounters, VOXEL_API);
+
+struct FVoxelItemStack;
 
 namespace FVoxelDataOctreeUtilities
 {
@@ -42,6 +46,14 @@ namespace FVoxelDataOctreeUtilities
 		Z -= Min.Z;
 		return IndexFromCoordinates(X, Y, Z);
 	}
+
+	// True if the generator range analysis proves that Bounds only has one value
+	VOXEL_API bool GetSingleValueFromRange(const FVoxelGeneratorInstance& Generator, const FVoxelIntBox& Bounds, const FVoxelItemStack& Items, FVoxelValue& OutValue);
+	// Materials have no range analysis
+	FORCEINLINE bool GetSingleValueFromRange(const FVoxelGeneratorInstance& Generator, const FVoxelIntBox& Bounds, const FVoxelItemStack& Items, FVoxelMaterial& OutMaterial)
+	{
+		return false;
+	}
 }
 
 class VOXEL_API FVoxelDataOctreeBase : public TVoxelOctreeBase<DATA_CHUNK_SIZE>
@@ -55,6 +67,7 @@ public:
 	~FVoxelDataOctreeBase()
 	{
 		DEC_DWORD_STAT_BY(STAT_VoxelDataOctreesCount, 1);
+		ResetItemHolder();
 	}
 
 public:
@@ -83,17 +96,54 @@ public:
 #endif
 
 public:
-	FVoxelPlaceableItemHolder& GetItemHolder() { return *ItemHolder; }
-	const FVoxelPlaceableItemHolder& GetItemHolder() const { return *ItemHolder; }
+	// Empty if no items were added to this node
+	const FVoxelPlaceableItemHolder& GetItemHolder() const { return ItemHolder.IsValid() ? *ItemHolder : EmptyItemHolder; }
+	// Must be locked for write. Should not be called on a node with children
+	FVoxelPlaceableItemHolder& GetOrCreateItemHolder()
+	{
+		if (!ItemHolder.IsValid())
+		{
+			INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataOctreesMemory, sizeof(FVoxelPlaceableItemHolder));
+			ItemHolder = MakeUnique<FVoxelPlaceableItemHolder>();
+		}
+		return *ItemHolder;
+	}
+	// Must be locked for write. Doesn't allocate the holder: returns false if this node has none
+	// The holder is freed once its last item is removed
+	template<typename T>
+	bool RemoveItem(const T& Item)
+	{
+		if (!ItemHolder.IsValid())
+		{
+			return false;
+		}
+		const bool bRemoved = ItemHolder->RemoveItem(Item);
+		if (ItemHolder->NumItems() == 0)
+		{
+			ResetItemHolder();
+		}
+		return bRemoved;
+	}
 
 private:
-	// Always valid on a node with no children
-	TUniquePtr<FVoxelPlaceableItemHolder> ItemHolder = MakeUnique<FVoxelPlaceableItemHolder>();
-	FVoxelSharedMutex Mutex;
+	// Only allocated once an item is added, as most nodes don't have any
+	TUniquePtr<FVoxelPlaceableItemHolder> ItemHolder;
+	FVoxelCompactSharedMutex Mutex;
 #if DO_THREADSAFE_CHECKS
 	FVoxelDataOctreeBase* Parent = nullptr;
 #endif
 	
+	static const FVoxelPlaceableItemHolder EmptyItemHolder;
+
+	void ResetItemHolder()
+	{
+		if (ItemHolder.IsValid())
+		{
+			DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataOctreesMemory, sizeof(FVoxelPlaceableItemHolder));
+			ItemHolder.Reset();
+		}
+	}
+	
 	friend class FVoxelDataOctreeLocker;
 	friend class FVoxelDataOctreeUnlocker;
 	friend class FVoxelDataOctreeParent;
@@ -133,11 +183,7 @@ public:
 		TVoxelDataOctreeLeafData<T>& DataHolder = GetData<T>();
 		if (!DataHolder.HasData())
 		{
-			DataHolder.CreateData(Data, [&](T* RESTRICT DataPtr)
-			{
-				TVoxelQueryZone<T> QueryZone(GetBounds(), DataPtr);
-				GetFromGeneratorAndAssets(*Data.Generator, QueryZone, 0);
-			});
+			CreateDataFromGeneratorForWrite<T>(Data);
 		}
 		DataHolder.PrepareForWrite(Data);
 		
@@ -154,6 +200,25 @@ public:
 		}
 	}
 
+	// Creates the data from the generator & assets, to be read. Must not have data already
+	// The data is stored as a single value if the generator range is a single value or if its output is uniform, eg deep underground or in the air
+	template<typename T>
+	void CreateDataFromGenerator(const IVoxelData& Data);
+	// Creates the data from the generator & assets, to be written to. Must not have data already
+	// Always allocated, as a single value would be expanded by the first write anyways
+	template<typename T>
+	void CreateDataFromGeneratorForWrite(const IVoxelData& Data)
+	{
+		auto& DataHolder = GetData<T>();
+		check(!DataHolder.HasData());
+		
+		DataHolder.CreateData(Data, [&](T* RESTRICT DataPtr)
+		{
+			TVoxelQueryZone<T> QueryZone(GetBounds(), DataPtr);
+			GetFromGeneratorAndAssets(*Data.Generator, QueryZone, 0);
+		});
+	}
+
 public:
 	template<typename T> FORCEINLINE       TVoxelDataOctreeLeafData<typename TRemoveConst<T>::Type>& GetData()       { return FVoxelUtilities::TValuesMaterialsSelector<T>::Get(*this); }
 	template<typename T> FORCEINLINE const TVoxelDataOctreeLeafData<typename TRemoveConst<T>::Type>& GetData() const { return FVoxelUtilities::TValuesMaterialsSelector<T>::Get(*this); }
@@ -181,8 +246,10 @@ public:
 		INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelDataOctreesMemory, sizeof(FVoxelDataOctreeParent));
 	}
 
-	void CreateChildren();
-	void DestroyChildren();
+	// Leaves are added to/removed from LeafIndex, which is the one of the data owning the octree (see FVoxelData::GetLeafIndex)
+	// The index isn't updated when the entire octree is destroyed: it's reset instead
+	void CreateChildren(FVoxelDataLeafIndex& LeafIndex);
+	void DestroyChildren(FVoxelDataLeafIndex& LeafIndex);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -272,20 +272,21 @@ public:
 		}
 		CheckState();
 	}
-	void TryCompressToSingleValue(const IVoxelDataOctreeMemory& Memory)
+	// Returns true if compressed
+	bool TryCompressToSingleValue(const IVoxelDataOctreeMemory& Memory)
 	{
 		CheckState();
 		check(!bIsSingleValue);
 		
 		if (!DataPtr)
 		{
-			return;
+			return false;
 		}
 
 		const FVoxelValue NewSingleValue = DataPtr[0];
 		for (int32 Index = 1; Index < VOXELS_PER_DATA_CHUNK; Index++)
 		{
-			if (DataPtr[Index] != NewSingleValue) return;
+			if (DataPtr[Index] != NewSingleValue) return false;
 		}
 
 		Deallocate(Memory);
@@ -293,6 +294,7 @@ public:
 		bIsSingleValue = true;
 		
 		CheckState();
+		return true;
 	}
 	
 private:
@@ -347,6 +349,13 @@ class TVoxelDataOctreeLeafData<FVoxelMaterial>
 	bool bUseChannels = false;
 	bool bDirty = false;
 
+	// Palette of unique materials, followed by the packed per-voxel indices into it
+	// Like channels, palettes are only created by Compress and are expanded back to main on write
+	uint8* RESTRICT Palette_DataPtr = nullptr;
+	uint16 Palette_Num = 0;
+	// 1, 2, 4 or 8, so that an index never straddles two bytes
+	uint8 Palette_BitsPerIndex = 0;
+
 	friend class FVoxelSaveBuilder;
 	friend class FVoxelSaveLoader;
 
@@ -355,6 +364,7 @@ public:
 	~TVoxelDataOctreeLeafData()
 	{
 		bool bClear = !ensureVoxelSlow(!Main_DataPtr);
+		bClear |= !ensureVoxelSlow(!Palette_DataPtr);
 		for (auto& DataPtr : Channels_DataPtr)
 		{
 			bClear |= !ensureVoxelSlow(!DataPtr);
@@ -398,6 +408,12 @@ public:
 				}
 			}
 		}
+		else if (Palette_DataPtr)
+		{
+			const int32 MemorySize = Palette_GetMemorySize(Palette_Num, Palette_BitsPerIndex);
+			TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Decrease(MemorySize, bOldDirty, Memory);
+			TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Increase(MemorySize, bNewDirty, Memory);
+		}
 		else
 		{
 			if (Main_DataPtr)
@@ -442,6 +458,11 @@ public:
 				}
 			}
 		}
+		else if (Source.Palette_DataPtr)
+		{
+			Palette_Allocate(Source.Palette_Num, Source.Palette_BitsPerIndex, Memory);
+			FMemory::Memcpy(Palette_DataPtr, Source.Palette_DataPtr, Palette_GetMemorySize(Palette_Num, Palette_BitsPerIndex));
+		}
 		else
 		{
 			if (Source.Main_DataPtr)
@@ -473,6 +494,10 @@ public:
 			{
 				Main_Deallocate(Memory);
 			}
+			if (Palette_DataPtr)
+			{
+				Palette_Deallocate(Memory);
+			}
 		}
 		bUseChannels = false;
 		checkVoxelSlow(!HasData());
@@ -496,12 +521,16 @@ public:
 		}
 		else
 		{
-			return Main_DataPtr != nullptr;
+			return Main_DataPtr != nullptr || Palette_DataPtr != nullptr;
 		}
 	}
 	FORCEINLINE bool HasData() const
 	{
-		return bUseChannels || Main_DataPtr;
+		return bUseChannels || Main_DataPtr || Palette_DataPtr;
+	}
+	FORCEINLINE bool IsUsingPalette() const
+	{
+		return Palette_DataPtr != nullptr;
 	}
 	
 public:
@@ -533,10 +562,25 @@ public:
 			if (DoNotCompressChannel == DoNotCompressAnyChannel)
 			{
 				// Fast path if all channels are different
-				return;
+				break;
 			}
 		}
-		checkVoxelSlow(DoNotCompressChannel != DoNotCompressAnyChannel);
+
+		const int32 ChannelsMemorySize =
+			DoNotCompressChannel == DoNotCompressAnyChannel
+			? MAX_int32
+			: FVoxelUtilities::Popc(DoNotCompressChannel) * Channels_MemorySize;
+
+		// Painted data usually only has a few unique materials, even when all the channels are used
+		if (ChannelsMemorySize > Palette_GetMemorySize(2, 1) && TryCompressToPalette(FMath::Min(ChannelsMemorySize, Main_MemorySize), Memory))
+		{
+			return;
+		}
+		
+		if (DoNotCompressChannel == DoNotCompressAnyChannel)
+		{
+			return;
+		}
 
 		// Create channels
 		for (int32 Channel = 0; Channel < NumChannels; Channel++)
@@ -576,6 +620,10 @@ public:
 		{
 			return GetFromChannels(Index);
 		}
+		else if (Palette_DataPtr)
+		{
+			return GetFromPalette(Index);
+		}
 		else
 		{
 			checkVoxelSlow(Main_DataPtr);
@@ -610,7 +658,20 @@ public:
 			}
 			bUseChannels = false;
 		}
+		else if (Palette_DataPtr)
+		{
+			Main_Allocate(Memory);
+			checkVoxelSlow(Main_DataPtr);
+
+			for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+			{
+				Main_DataPtr[Index] = GetFromPalette(Index);
+			}
+
+			Palette_Deallocate(Memory);
+		}
 		checkVoxelSlow(!bUseChannels);
+		checkVoxelSlow(!Palette_DataPtr);
 		checkVoxelSlow(HasData());
 		CheckState();
 	}
@@ -631,6 +692,28 @@ public:
 		}
 		CheckState();
 	}
+	// Cheaper than Compress when only a single material is worth checking for, eg right after generating the data
+	// Returns true if compressed
+	bool TryCompressToSingleValue(const IVoxelDataOctreeMemory& Memory)
+	{
+		CheckState();
+
+		if (bUseChannels || !Main_DataPtr)
+		{
+			return false;
+		}
+
+		const FVoxelMaterial SingleMaterial = Main_DataPtr[0];
+		for (int32 Index = 1; Index < VOXELS_PER_DATA_CHUNK; Index++)
+		{
+			if (Main_DataPtr[Index] != SingleMaterial) return false;
+		}
+
+		Main_Deallocate(Memory);
+		SetSingleValue(SingleMaterial);
+
+		return true;
+	}
 
 public:
 	FORCEINLINE void CopyTo(FVoxelMaterial* RESTRICT DestPtr) const
@@ -644,6 +727,13 @@ public:
 				DestPtr[Index] = GetFromChannels(Index);
 			}
 		}
+		else if (Palette_DataPtr)
+		{
+			for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+			{
+				DestPtr[Index] = GetFromPalette(Index);
+			}
+		}
 		else
 		{
 			checkVoxelSlow(Main_DataPtr);
@@ -655,6 +745,7 @@ private:
 	FORCEINLINE void CheckState() const
 	{
 		checkVoxelSlow(!(Main_DataPtr && bUseChannels));
+		checkVoxelSlow(!(Palette_DataPtr && (Main_DataPtr || bUseChannels)));
 		checkVoxelSlow(!bDirty || HasData());
 	}
 	FORCEINLINE static void CheckBounds(int32 Index)
@@ -662,6 +753,85 @@ private:
 		checkVoxelSlow(0 <= Index && Index < VOXELS_PER_DATA_CHUNK);
 	}
 
+	FORCEINLINE const FVoxelMaterial* Palette_GetMaterials() const
+	{
+		checkVoxelSlow(Palette_DataPtr);
+		return reinterpret_cast<const FVoxelMaterial*>(Palette_DataPtr);
+	}
+	FORCEINLINE uint8* Palette_GetIndices() const
+	{
+		checkVoxelSlow(Palette_DataPtr);
+		return Palette_DataPtr + Palette_Num * sizeof(FVoxelMaterial);
+	}
+	FORCEINLINE FVoxelMaterial GetFromPalette(int32 Index) const
+	{
+		CheckBounds(Index);
+		checkVoxelSlow(Palette_DataPtr);
+
+		const uint32 BitIndex = Index * Palette_BitsPerIndex;
+		const uint32 Mask = (1u << Palette_BitsPerIndex) - 1;
+		const uint32 PaletteIndex = (Palette_GetIndices()[BitIndex / 8] >> (BitIndex % 8)) & Mask;
+		checkVoxelSlow(PaletteIndex < Palette_Num);
+
+		return Palette_GetMaterials()[PaletteIndex];
+	}
+
+	bool TryCompressToPalette(int32 MaxMemorySize, const IVoxelDataOctreeMemory& Memory)
+	{
+		VOXEL_SLOW_FUNCTION_COUNTER();
+		checkVoxelSlow(Main_DataPtr);
+
+		TArray<FVoxelMaterial, TInlineAllocator<256>> Palette;
+		TVoxelStaticArray<uint8, VOXELS_PER_DATA_CHUNK> Indices;
+
+		int32 LastPaletteIndex = -1;
+		for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+		{
+			const FVoxelMaterial& Material = Main_DataPtr[Index];
+
+			// Neighbors are usually identical
+			if (LastPaletteIndex != -1 && Palette[LastPaletteIndex] == Material)
+			{
+				Indices[Index] = LastPaletteIndex;
+				continue;
+			}
+
+			LastPaletteIndex = Palette.Find(Material);
+			if (LastPaletteIndex == INDEX_NONE)
+			{
+				if (Palette.Num() == 256 || Palette_GetMemorySize(Palette.Num() + 1, GetBitsPerIndex(Palette.Num() + 1)) >= MaxMemorySize)
+				{
+					// Too many unique materials, not worth it
+					return false;
+				}
+				LastPaletteIndex = Palette.Add(Material);
+			}
+			Indices[Index] = LastPaletteIndex;
+		}
+
+		const int32 BitsPerIndex = GetBitsPerIndex(Palette.Num());
+		if (Palette_GetMemorySize(Palette.Num(), BitsPerIndex) >= MaxMemorySize)
+		{
+			return false;
+		}
+
+		Main_Deallocate(Memory);
+		Palette_Allocate(Palette.Num(), BitsPerIndex, Memory);
+
+		FMemory::Memcpy(Palette_DataPtr, Palette.GetData(), Palette.Num() * sizeof(FVoxelMaterial));
+
+		uint8* RESTRICT PackedIndices = Palette_GetIndices();
+		FMemory::Memzero(PackedIndices, Palette_GetIndicesMemorySize(BitsPerIndex));
+		for (int32 Index = 0; Index < VOXELS_PER_DATA_CHUNK; Index++)
+		{
+			const uint32 BitIndex = Index * BitsPerIndex;
+			PackedIndices[BitIndex / 8] |= Indices[Index] << (BitIndex % 8);
+		}
+
+		CheckState();
+		return true;
+	}
+
 	FORCEINLINE FVoxelMaterial GetFromChannels(int32 Index) const
 	{
 		CheckBounds(Index);
@@ -706,6 +876,48 @@ private:
 		TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Decrease(Main_MemorySize, bDirty, Memory);
 	}
 	
+	static int32 GetBitsPerIndex(int32 PaletteNum)
+	{
+		checkVoxelSlow(PaletteNum <= 256);
+		return PaletteNum <= 2 ? 1 : PaletteNum <= 4 ? 2 : PaletteNum <= 16 ? 4 : 8;
+	}
+	static constexpr int32 Palette_GetIndicesMemorySize(int32 BitsPerIndex)
+	{
+		return VOXELS_PER_DATA_CHUNK * BitsPerIndex / 8;
+	}
+	static constexpr int32 Palette_GetMemorySize(int32 PaletteNum, int32 BitsPerIndex)
+	{
+		return PaletteNum * sizeof(FVoxelMaterial) + Palette_GetIndicesMemorySize(BitsPerIndex);
+	}
+	
+	void Palette_Allocate(int32 PaletteNum, int32 BitsPerIndex, const IVoxelDataOctreeMemory& Memory)
+	{
+		VOXEL_SLOW_FUNCTION_COUNTER();
+
+		check(!Palette_DataPtr);
+		check(0 < PaletteNum && PaletteNum <= 256);
+		Palette_Num = PaletteNum;
+		Palette_BitsPerIndex = BitsPerIndex;
+
+		const int32 MemorySize = Palette_GetMemorySize(Palette_Num, Palette_BitsPerIndex);
+		Palette_DataPtr = static_cast<uint8*>(FMemory::Malloc(MemorySize));
+
+		TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Increase(MemorySize, bDirty, Memory);
+	}
+	void Palette_Deallocate(const IVoxelDataOctreeMemory& Memory)
+	{
+		VOXEL_SLOW_FUNCTION_COUNTER();
+
+		check(Palette_DataPtr);
+		FMemory::Free(Palette_DataPtr);
+		Palette_DataPtr = nullptr;
+
+		TVoxelDataOctreeLeafMemoryUsage<FVoxelMaterial>::Decrease(Palette_GetMemorySize(Palette_Num, Palette_BitsPerIndex), bDirty, Memory);
+
+		Palette_Num = 0;
+		Palette_BitsPerIndex = 0;
+	}
+	
 	void Channels_Allocate(uint8* RESTRICT& DataPtr, const IVoxelDataOctreeMemory& Memory) const
 	{
 		VOXEL_SLOW_FUNCTION_COUNTER();
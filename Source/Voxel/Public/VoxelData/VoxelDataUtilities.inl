@@ -164,7 +164,7 @@ void FVoxelDataUtilities::SetEntireDataAsDirtyAndCopyFrom(const FVoxelData& Sour
 			auto& Parent = Tree.AsParent();
 			if (!Parent.HasChildren())
 			{
-				Parent.CreateChildren();
+				Parent.CreateChildren(DestData.GetLeafIndex());
 			}
 		}
 	});
@@ -182,7 +182,7 @@ void FVoxelDataUtilities::CopyDirtyChunksFrom(const FVoxelData& SourceData, FVox
 			return;
 		}
 
-		FVoxelDataOctreeLeaf& DestLeaf = *FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(DestData.GetOctree(), SourceLeaf.Position.X, SourceLeaf.Position.Y, SourceLeaf.Position.Z);
+		FVoxelDataOctreeLeaf& DestLeaf = *FVoxelOctreeUtilities::GetLeaf<EVoxelOctreeLeafQuery::CreateIfNull>(DestData.GetOctree(), SourceLeaf.Position.X, SourceLeaf.Position.Y, SourceLeaf.Position.Z, DestData.GetLeafIndex());
 		TVoxelDataOctreeLeafData<T>& DestDataHolder = DestLeaf.GetData<T>();
 
 		if (SourceDataHolder.IsSingleValue())
@@ -223,7 +223,7 @@ void FVoxelDataUtilities::OverrideGeneratorValue(FVoxelData& Data, T Value)
 			auto& Parent = Tree.AsParent();
 			if (!Parent.HasChildren())
 			{
-				Parent.CreateChildren();
+				Parent.CreateChildren(Data.GetLeafIndex());
 			}
 		}
 	});
@@ -90,12 +90,6 @@
 #define VOXEL_DATA_ACCELERATOR_STATS VOXEL_DEBUG
 #endif
 
-// No support for indices optimizations on some platforms
-// Note: I have yet to find any performance improvements due to this
-#ifndef ENABLE_OPTIMIZE_INDICES
-#define ENABLE_OPTIMIZE_INDICES PLATFORM_WINDOWS
-#endif
-
 #ifndef EIGHT_BITS_VOXEL_VALUE
 #define EIGHT_BITS_VOXEL_VALUE 0
 #endif
@@ -26,8 +26,17 @@ public:
 	
 	virtual TVoxelSharedRef<FVoxelGeneratorInstance> GetInstance(const TMap<FName, FString>& Parameters);
 	virtual TVoxelSharedRef<FVoxelGeneratorInstance> GetInstance();
+	// Hash of everything the generator output depends on, used to key the chunk meshes saved on disk
+	// Default: the class & the version of its native code, the properties of this object & of its subobjects (eg graph nodes),
+	// the objects they reference (eg curves; referenced generators are hashed with their own GetGeneratorHash) and the parameters
+	// Not covered: data that isn't in properties (override this, see UVoxelHeightmapAsset), soft references and anything read at runtime
+	// Return 0 if the output can't be hashed (eg it depends on runtime state) to disable the mesh disk cache
+	virtual uint64 GetGeneratorHash(const TMap<FName, FString>& Parameters) const;
 	//~ End UVoxelGenerator Interface
 
+	// Timestamp of the binary with the native code of Class, so that hashes change when the code is recompiled
+	static FString GetNativeCodeVersion(const UClass* Class);
+
 protected:
 	TMap<FName, FString> ApplyParametersInternal(const TMap<FName, FString>& Parameters);
 };
@@ -60,11 +60,11 @@ public:
 
 	virtual void GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override
 	{
-		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 		{
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 			{
-				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 				{
 					QueryZone.Set(X, Y, Z, FVoxelValue(This().GetValueImpl(X, Y, Z, LOD, Items)));
 				}
@@ -73,11 +73,11 @@ public:
 	}
 	virtual void GetMaterials(TVoxelQueryZone<FVoxelMaterial>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override
 	{
-		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 		{
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 			{
-				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 				{
 					QueryZone.Set(X, Y, Z, This().GetMaterialImpl(X, Y, Z, LOD, Items));
 				}
@@ -160,11 +160,11 @@ public:
 
 	virtual void GetValues(TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override
 	{
-		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 		{
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 			{
-				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 				{
 					QueryZone.Set(X, Y, Z, FVoxelValue(This().GetValueNoTransformImpl(X, Y, Z, LOD, Items)));
 				}
@@ -173,11 +173,11 @@ public:
 	}
 	virtual void GetMaterials(TVoxelQueryZone<FVoxelMaterial>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override
 	{
-		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 		{
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 			{
-				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 				{
 					QueryZone.Set(X, Y, Z, This().GetMaterialNoTransformImpl(X, Y, Z, LOD, Items));
 				}
@@ -187,11 +187,11 @@ public:
 	
 	virtual void GetValues_Transform(const FTransform& LocalToWorld, TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override
 	{
-		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 		{
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 			{
-				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 				{
 					QueryZone.Set(X, Y, Z, FVoxelValue(This().GetValueWithTransformImpl(LocalToWorld, X, Y, Z, LOD, Items)));
 				}
@@ -200,11 +200,11 @@ public:
 	}
 	virtual void GetMaterials_Transform(const FTransform& LocalToWorld, TVoxelQueryZone<FVoxelMaterial>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override
 	{
-		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 		{
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 			{
-				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 				{
 					QueryZone.Set(X, Y, Z, This().GetMaterialWithTransformImpl(LocalToWorld, X, Y, Z, LOD, Items));
 				}
@@ -273,6 +273,41 @@ FORCEINLINE T FVoxelItemStack::Get(v_flt X, v_flt Y, v_flt Z, int32 LOD) const
 	}
 }
 
+template<typename T>
+void FVoxelItemStack::Get(TVoxelQueryZone<T>& QueryZone, int32 LOD) const
+{
+	check(IsValid());
+	if (Depth == -1)
+	{
+		Generator->Get<T>(QueryZone, LOD, *this);
+		return;
+	}
+	
+	auto& Asset = *ItemHolder.GetAssetItems()[Depth];
+	const auto NextStack = FVoxelItemStack(ItemHolder, *Generator, Depth - 1, CustomData);
+	
+	if (!Asset.Bounds.Intersect(QueryZone.Bounds))
+	{
+		NextStack.Get(QueryZone, LOD);
+		return;
+	}
+
+	auto AssetQueryZone = QueryZone.ShrinkTo(Asset.Bounds);
+	if (AssetQueryZone.Bounds.IsValid())
+	{
+		Asset.Generator->Get_Transform<T>(Asset.LocalToWorld, AssetQueryZone, LOD, *this);
+	}
+
+	for (auto& SubBounds : QueryZone.Bounds.Difference(Asset.Bounds))
+	{
+		auto SubQueryZone = QueryZone.ShrinkTo(SubBounds);
+		if (SubQueryZone.Bounds.IsValid())
+		{
+			NextStack.Get(SubQueryZone, LOD);
+		}
+	}
+}
+
 FORCEINLINE TVoxelRange<v_flt> FVoxelItemStack::GetValueRange(const FVoxelIntBox& Bounds, int32 LOD) const
 {
 	check(IsValid());
@@ -122,7 +122,85 @@ public:
 	}
 	//~ End FVoxelGeneratorInstance Interface
 
+	//~ Begin FVoxelTransformableGeneratorInstance Interface
+	virtual void GetValues_Transform(const FTransform& LocalToWorld, TVoxelQueryZone<FVoxelValue>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override final
+	{
+		if (Items.IsEmpty() || IsBestValueInBounds(LocalToWorld, QueryZone.Bounds, LOD, Items))
+		{
+			// No need to query the items below
+			Super::GetValues_Transform(LocalToWorld, QueryZone, LOD, Items);
+			return;
+		}
+
+		// Query the items below once for the whole zone, then merge
+		GetNextStack(Items).Get(QueryZone, LOD);
+		
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+		{
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+				{
+					const FVector P = GetLocalPosition<true>(LocalToWorld, X, Y, Z);
+					const FVoxelValue Value = FVoxelValue(Generator->GetValueImpl(P.X, P.Y, P.Z, LOD, Items));
+					const FVoxelValue NextValue = QueryZone.Get(X, Y, Z);
+					// FVoxelValue quantization is monotonic, so merging quantized values is the same as merging floats
+					QueryZone.Set(X, Y, Z, FVoxelUtilities::MergeAsset(Value, NextValue, bSubtractiveAsset));
+				}
+			}
+		}
+	}
+	virtual void GetMaterials_Transform(const FTransform& LocalToWorld, TVoxelQueryZone<FVoxelMaterial>& QueryZone, int32 LOD, const FVoxelItemStack& Items) const override final
+	{
+		if (Items.IsEmpty() || IsBestValueInBounds(LocalToWorld, QueryZone.Bounds, LOD, Items))
+		{
+			// No need to query the items below
+			Super::GetMaterials_Transform(LocalToWorld, QueryZone, LOD, Items);
+			return;
+		}
+
+		const FVoxelItemStack NextStack = GetNextStack(Items);
+
+		TArray<FVoxelValue> NextValues;
+		auto NextValuesQueryZone = QueryZone.MakeDenseZone(NextValues);
+		NextStack.Get(NextValuesQueryZone, LOD);
+		NextStack.Get(QueryZone, LOD);
+		
+		for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+		{
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
+			{
+				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+				{
+					const FVector P = GetLocalPosition<true>(LocalToWorld, X, Y, Z);
+					const FVoxelValue Value = FVoxelValue(Generator->GetValueImpl(P.X, P.Y, P.Z, LOD, Items));
+					const FVoxelValue NextValue = NextValuesQueryZone.Get(X, Y, Z);
+					if (bSubtractiveAsset ? Value >= NextValue : Value <= NextValue)
+					{
+						// We have a better value
+						QueryZone.Set(X, Y, Z, Generator->GetMaterialImpl(P.X, P.Y, P.Z, LOD, Items));
+					}
+				}
+			}
+		}
+	}
+	//~ End FVoxelTransformableGeneratorInstance Interface
+
 private:
+	FORCEINLINE static FVoxelItemStack GetNextStack(const FVoxelItemStack& Items)
+	{
+		// Unlike Items.GetNextStack, this doesn't require the next item to be the same everywhere: FVoxelItemStack::Get will split the query zone
+		return FVoxelItemStack(Items.ItemHolder, *Items.Generator, Items.Depth - 1, Items.CustomData);
+	}
+	bool IsBestValueInBounds(const FTransform& LocalToWorld, const FVoxelIntBox& WorldBounds, int32 LOD, const FVoxelItemStack& Items) const
+	{
+		const FVoxelIntBox LocalBounds = WorldBounds.ApplyTransform<EInverseTransform::True>(LocalToWorld);
+		const TVoxelRange<v_flt> Range = Generator->GetValueRangeImpl(LocalBounds, LOD, Items);
+		return bSubtractiveAsset
+			? FVoxelValue(Range.Min) == FVoxelValue::Empty()
+			: FVoxelValue(Range.Max) == FVoxelValue::Full();
+	}
+	
 	template<bool bCustomTransform>
 	FORCEINLINE FVector GetLocalPosition(const FTransform& LocalToWorld, v_flt X, v_flt Y, v_flt Z) const
 	{
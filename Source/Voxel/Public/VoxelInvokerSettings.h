@@ -27,4 +27,10 @@ struct FVoxelInvokerSettings
 	bool bUseForNavmesh = false;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Voxel")
 	FVoxelIntBox NavmeshBounds;
+
+	// In voxels. Where the invoker is predicted to be once the prefetched chunks are needed, relative to its position
+	// Tasks along this path will have a higher priority. Zero if the invoker doesn't report its velocity
+	// Note: LODBounds should already include the predicted position
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Voxel")
+	FIntVector PrefetchOffset = FIntVector::ZeroValue;
 };
\ No newline at end of file
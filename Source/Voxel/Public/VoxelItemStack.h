@@ -7,6 +7,8 @@
 
 class FVoxelPlaceableItemHolder;
 class FVoxelGeneratorInstance;
+template<typename T>
+class TVoxelQueryZone;
 
 struct VOXEL_API FVoxelItemStack
 {
@@ -35,6 +37,9 @@ public:
 
 	template<typename T>
 	T Get(v_flt X, v_flt Y, v_flt Z, int32 LOD) const;
+	// Batched version: each item is queried once on the part of the zone it covers, instead of once per voxel
+	template<typename T>
+	void Get(TVoxelQueryZone<T>& QueryZone, int32 LOD) const;
 	TVoxelRange<v_flt> GetValueRange(const FVoxelIntBox& Bounds, int32 LOD) const;
 	
 	template<typename T>
@@ -0,0 +1,150 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelMinimal.h"
+
+enum class EVoxelTaskType : uint8;
+
+/**
+ * Lock free histogram of durations, safe to add to from any thread
+ * Buckets are log-linear in microseconds: exact below 8us, then 8 buckets per power of 2, so percentiles are within 12.5%
+ */
+class VOXEL_API FVoxelLatencyHistogram
+{
+public:
+	static constexpr int32 NumSubBuckets = 8;
+	// Last bucket is everything above 2^34us (~4h45)
+	static constexpr int32 NumBuckets = 256;
+
+	FVoxelLatencyHistogram() = default;
+	UE_NONCOPYABLE(FVoxelLatencyHistogram);
+
+	void Add(double Seconds);
+	void Reset();
+
+	int64 GetNum() const;
+	// In seconds. Upper bound of the bucket containing the percentile. Percentile is between 0 and 1
+	double GetPercentile(double Percentile) const;
+	double GetMax() const;
+	double GetAverage() const;
+
+	// eg "1234 samples, average 1.2ms, p50 1.0ms, p95 2.5ms, p99 4.0ms, max 10.3ms"
+	FString ToString() const;
+
+public:
+	FORCEINLINE static int32 GetBucket(uint64 Microseconds)
+	{
+		if (Microseconds < NumSubBuckets)
+		{
+			return Microseconds;
+		}
+		const int32 Log2 = FMath::FloorLog2_64(Microseconds);
+		const int32 SubBucket = (Microseconds >> (Log2 - 3)) & (NumSubBuckets - 1);
+		return FMath::Min(NumSubBuckets * (Log2 - 2) + SubBucket, NumBuckets - 1);
+	}
+	// Excluded
+	static uint64 GetBucketUpperBound(int32 Bucket)
+	{
+		if (Bucket < NumSubBuckets)
+		{
+			return Bucket + 1;
+		}
+		const int32 Log2 = Bucket / NumSubBuckets + 2;
+		const int32 SubBucket = Bucket % NumSubBuckets;
+		return uint64(NumSubBuckets + SubBucket + 1) << (Log2 - 3);
+	}
+
+private:
+	int64 Buckets[NumBuckets] = {};
+	int64 TotalMicroseconds = 0;
+	int64 MaxMicroseconds = 0;
+};
+
+/**
+ * Latency of the voxel tasks and chunks, always recorded as it's only a few atomic increments per task
+ * Use voxel.threading.LogLatencyStats to see them
+ */
+class VOXEL_API FVoxelLatencyStats
+{
+public:
+	// Number of values of EVoxelTaskType, RenderOctree being the last one
+	static constexpr int32 NumTaskTypes = 10;
+
+	static FVoxelLatencyStats& Get();
+
+	// Thread safe
+	void ReportTask(EVoxelTaskType Type, double QueueWaitTime, double ExecutionTime);
+	// Time from a chunk being requested visible to its first mesh being applied
+	void ReportChunkLatency(double Time);
+
+	void LogStats() const;
+	void Reset();
+
+public:
+	const FVoxelLatencyHistogram& GetQueueWait(EVoxelTaskType Type) const
+	{
+		return QueueWait[FMath::Min<int32>(int32(Type), NumTaskTypes - 1)];
+	}
+	const FVoxelLatencyHistogram& GetExecution(EVoxelTaskType Type) const
+	{
+		return Execution[FMath::Min<int32>(int32(Type), NumTaskTypes - 1)];
+	}
+	const FVoxelLatencyHistogram& GetChunkLatency() const
+	{
+		return ChunkLatency;
+	}
+
+private:
+	FVoxelLatencyStats() = default;
+
+	FVoxelLatencyHistogram QueueWait[NumTaskTypes];
+	FVoxelLatencyHistogram Execution[NumTaskTypes];
+	FVoxelLatencyHistogram ChunkLatency;
+};
+
+/**
+ * Records the voxel tasks while capturing, to export them as a Chrome trace JSON (chrome://tracing or ui.perfetto.dev)
+ * Events are written to a preallocated buffer with an atomic increment: events past its capacity are dropped
+ * Use voxel.threading.StartTrace/StopTrace
+ */
+class VOXEL_API FVoxelTraceCapture
+{
+public:
+	static FVoxelTraceCapture& Get();
+
+	FORCEINLINE bool IsCapturing() const
+	{
+		return FPlatformAtomics::AtomicRead(&bCapturing) != 0;
+	}
+
+	// Thread safe
+	void AddTask(FName Name, EVoxelTaskType Type, uint64 QueuedCycles, uint64 StartCycles, uint64 EndCycles);
+
+	// Game thread
+	void Start(int32 MaxEvents);
+	// Returns false if not capturing or if the file couldn't be written
+	bool StopAndSave(const FString& Path);
+
+private:
+	FVoxelTraceCapture() = default;
+
+	struct FEvent
+	{
+		FName Name;
+		EVoxelTaskType Type;
+		uint32 ThreadId;
+		uint64 QueuedCycles;
+		uint64 StartCycles;
+		uint64 EndCycles;
+	};
+	TArray<FEvent> Events;
+	uint64 CaptureStartCycles = 0;
+
+	int32 bCapturing = 0;
+	int32 NumWriters = 0;
+	// Never more than the capacity + the number of writers, see AddTask
+	int32 NumEvents = 0;
+	int64 NumDropped = 0;
+};
\ No newline at end of file
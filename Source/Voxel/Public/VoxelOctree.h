@@ -6,6 +6,7 @@
 #include "VoxelMinimal.h"
 #include "VoxelIntBox.h"
 #include "VoxelOctreeId.h"
+#include "VoxelBlockPool.h"
 
 template<uint32 ChunkSize>
 class TVoxelOctreeBase
@@ -211,6 +212,13 @@ public:
 		}
 	}
 
+	// Returns the memory of the destroyed children to the system
+	static void TrimChildrenPools()
+	{
+		TVoxelBlockPool<8 * sizeof(LeafType)>::Get().Trim();
+		TVoxelBlockPool<8 * sizeof(ParentType)>::Get().Trim();
+	}
+
 	inline FChildrenIterator<const BaseType> GetChildren() const
 	{
 		check(Children);
@@ -234,8 +242,14 @@ protected:
 	{		
 		check(!HasChildren() && this->Height > 0);
 
-		// TODO PERF: Specialized malloc call
-		Children = FMemory::Malloc(8 * (this->Height == 1 ? sizeof(LeafType) : sizeof(ParentType)));
+		if (this->Height == 1)
+		{
+			Children = TVoxelBlockPool<8 * sizeof(LeafType)>::Get().Allocate();
+		}
+		else
+		{
+			Children = TVoxelBlockPool<8 * sizeof(ParentType)>::Get().Allocate();
+		}
 
 		for (int32 Index = 0; Index < 8 ; Index++)
 		{
@@ -267,7 +281,14 @@ protected:
 			}
 		}
 
-		FMemory::Free(Children);
+		if (this->Height == 1)
+		{
+			TVoxelBlockPool<8 * sizeof(LeafType)>::Get().Free(Children);
+		}
+		else
+		{
+			TVoxelBlockPool<8 * sizeof(ParentType)>::Get().Free(Children);
+		}
 		Children = nullptr;
 	}
 
@@ -12,7 +12,7 @@ public:
 	FInvokerPositionsArray() = default;
 	explicit FInvokerPositionsArray(int32 NewMax)
 		: Max(NewMax)
-		, Data(reinterpret_cast<FIntVector*>(FMemory::Malloc(sizeof(FIntVector) * NewMax, alignof(FIntVector))))
+		, Data(reinterpret_cast<FInvokerPosition*>(FMemory::Malloc(sizeof(FInvokerPosition) * NewMax, alignof(FInvokerPosition))))
 	{
 	}
 	~FInvokerPositionsArray()
@@ -20,12 +20,15 @@ public:
 		FMemory::Free(Data);
 	}
 
-	void Set(const TArray<FIntVector>& Array)
+	// PrefetchOffsets: see FVoxelInvokerSettings::PrefetchOffset. Can be empty
+	void Set(const TArray<FIntVector>& Array, const TArray<FIntVector>& PrefetchOffsets)
 	{
 		check(Array.Num() <= Max);
+		check(PrefetchOffsets.Num() == 0 || PrefetchOffsets.Num() == Array.Num());
 		for (int32 Index = 0; Index < Array.Num(); Index++)
 		{
-			Data[Index] = Array[Index];
+			Data[Index].Position = Array[Index];
+			Data[Index].PrefetchOffset = PrefetchOffsets.Num() > 0 ? PrefetchOffsets[Index] : FIntVector::ZeroValue;
 		}
 		// Make sure all the data is written before updating Num
 		FPlatformMisc::MemoryBarrier();
@@ -44,17 +47,31 @@ public:
 	FORCEINLINE FIntVector Get(int32 Index) const
 	{
 		checkVoxelSlow(Index < Num);
-		return Data[Index];
+		return Data[Index].Position;
+	}
+	FORCEINLINE FIntVector GetPrefetchOffset(int32 Index) const
+	{
+		checkVoxelSlow(Index < Num);
+		return Data[Index].PrefetchOffset;
 	}
 
 private:
+	struct FInvokerPosition
+	{
+		FIntVector Position;
+		FIntVector PrefetchOffset;
+	};
+	
 	int32 Num = 0;
 	const int32 Max = 0;
-	FIntVector* RESTRICT const Data = nullptr;
+	FInvokerPosition* RESTRICT const Data = nullptr;
 };
 
 struct FVoxelPriorityHandler
 {
+	// Number of points sampled on the invokers predicted paths
+	static constexpr int32 NumPrefetchSteps = 4;
+	
 	FVoxelIntBox Bounds;
 	TVoxelSharedPtr<FInvokerPositionsArray> InvokersPositions;
 
@@ -72,6 +89,20 @@ struct FVoxelPriorityHandler
 		{
 			const FIntVector Position = InvokersPositions->Get(Index);
 			Distance = FMath::Min(Distance, Bounds.ComputeSquaredDistanceFromBoxToPoint(Position));
+
+			const FIntVector PrefetchOffset = InvokersPositions->GetPrefetchOffset(Index);
+			if (PrefetchOffset != FIntVector::ZeroValue)
+			{
+				// Chunks along the path are needed once the invoker gets there: use the distance to the predicted positions,
+				// plus half the distance traveled so that the chunks ahead come before the ones behind but after the ones around the invoker
+				const float PathLength = FVector(PrefetchOffset).Size();
+				for (int32 Step = 1; Step <= NumPrefetchSteps; Step++)
+				{
+					const FIntVector PredictedPosition = Position + PrefetchOffset * Step / NumPrefetchSteps;
+					const float PathDistance = FMath::Sqrt(float(Bounds.ComputeSquaredDistanceFromBoxToPoint(PredictedPosition))) + PathLength * Step / NumPrefetchSteps / 2;
+					Distance = FMath::Min(Distance, uint64(FMath::Square(PathDistance)));
+				}
+			}
 		}
 		return MAX_uint32 - uint32(FMath::Sqrt(Distance));
 	}
@@ -54,26 +54,11 @@ public:
 
 	FORCEINLINE void Set(int32 X, int32 Y, int32 Z, T Value)
 	{
-		checkVoxelSlow(Bounds.Contains(X, Y, Z));
-		
-		checkVoxelSlow(X % Step == 0);
-		checkVoxelSlow(Y % Step == 0);
-		checkVoxelSlow(Z % Step == 0);
-		
-		checkVoxelSlow(Offset.X <= X);
-		checkVoxelSlow(Offset.Y <= Y);
-		checkVoxelSlow(Offset.Z <= Z);
-
-		const int32 LocalX = uint32(X - Offset.X) >> LOD;
-		const int32 LocalY = uint32(Y - Offset.Y) >> LOD;
-		const int32 LocalZ = uint32(Z - Offset.Z) >> LOD;
-
-		checkVoxelSlow(0 <= LocalX && LocalX < ArraySize.X);
-		checkVoxelSlow(0 <= LocalY && LocalY < ArraySize.Y);
-		checkVoxelSlow(0 <= LocalZ && LocalZ < ArraySize.Z);
-
-		const int32 Index = LocalX + ArraySize.X * LocalY + ArraySize.X * ArraySize.Y * LocalZ;
-		Data[Index] = Value;
+		Data[GetIndex(X, Y, Z)] = Value;
+	}
+	FORCEINLINE T Get(int32 X, int32 Y, int32 Z) const
+	{
+		return Data[GetIndex(X, Y, Z)];
 	}
 	
 	TVoxelQueryZone<T> ShrinkTo(const FVoxelIntBox& InBounds) const
@@ -83,6 +68,58 @@ public:
 		return TVoxelQueryZone<T>(LocalBounds, Offset, ArraySize, LOD, Data);
 	}
 
+	FORCEINLINE FIntVector GetSize() const
+	{
+		return Bounds.Size() / Step;
+	}
+
+	/**
+	 * Copies Source, laid out with Z fastest (ie in the X, Y, Z nested VOXEL_QUERY_ZONE_ITERATE order), to the zone which is laid out with X fastest
+	 * Done in tiles so that both the reads and the writes stay in cache
+	 */
+	void SetFromZMajor(const T* RESTRICT Source)
+	{
+		if (!Bounds.IsValid())
+		{
+			return;
+		}
+		
+		const FIntVector Size = GetSize();
+		const int32 BaseIndex = GetIndex(Bounds.Min.X, Bounds.Min.Y, Bounds.Min.Z);
+		const int32 StrideY = ArraySize.X;
+		const int32 StrideZ = ArraySize.X * ArraySize.Y;
+
+		constexpr int32 TileSize = 8;
+		for (int32 TileZ = 0; TileZ < Size.Z; TileZ += TileSize)
+		{
+			const int32 EndZ = FMath::Min(TileZ + TileSize, Size.Z);
+			for (int32 TileX = 0; TileX < Size.X; TileX += TileSize)
+			{
+				const int32 EndX = FMath::Min(TileX + TileSize, Size.X);
+				for (int32 LocalY = 0; LocalY < Size.Y; LocalY++)
+				{
+					for (int32 LocalZ = TileZ; LocalZ < EndZ; LocalZ++)
+					{
+						for (int32 LocalX = TileX; LocalX < EndX; LocalX++)
+						{
+							Data[BaseIndex + LocalX + StrideY * LocalY + StrideZ * LocalZ] = Source[LocalZ + Size.Z * (LocalY + Size.Y * LocalX)];
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Query zone with the same bounds & LOD, writing to another buffer of Bounds.Size() / Step
+	template<typename U, typename TAllocator>
+	TVoxelQueryZone<U> MakeDenseZone(TArray<U, TAllocator>& OutData) const
+	{
+		const FIntVector Size = GetSize();
+		OutData.Empty(Size.X * Size.Y * Size.Z);
+		OutData.SetNumUninitialized(Size.X * Size.Y * Size.Z);
+		return TVoxelQueryZone<U>(Bounds, Size, LOD, OutData);
+	}
+
 private:
 	T* RESTRICT Data;
 	const FIntVector Offset;
@@ -100,6 +137,64 @@ private:
 		check(Bounds.IsMultipleOf(Step));
 		check(FVoxelUtilities::CountIs32Bits(ArraySize));
 	}
+
+	FORCEINLINE int32 GetIndex(int32 X, int32 Y, int32 Z) const
+	{
+		checkVoxelSlow(Bounds.Contains(X, Y, Z));
+		
+		checkVoxelSlow(X % Step == 0);
+		checkVoxelSlow(Y % Step == 0);
+		checkVoxelSlow(Z % Step == 0);
+		
+		checkVoxelSlow(Offset.X <= X);
+		checkVoxelSlow(Offset.Y <= Y);
+		checkVoxelSlow(Offset.Z <= Z);
+
+		const int32 LocalX = uint32(X - Offset.X) >> LOD;
+		const int32 LocalY = uint32(Y - Offset.Y) >> LOD;
+		const int32 LocalZ = uint32(Z - Offset.Z) >> LOD;
+
+		checkVoxelSlow(0 <= LocalX && LocalX < ArraySize.X);
+		checkVoxelSlow(0 <= LocalY && LocalY < ArraySize.Y);
+		checkVoxelSlow(0 <= LocalZ && LocalZ < ArraySize.Z);
+
+		return LocalX + ArraySize.X * LocalY + ArraySize.X * ArraySize.Y * LocalZ;
+	}
+};
+
+/**
+ * Use this when the loops must be X, Y, Z nested (eg to cache X and XY computations):
+ * Set would then write with a stride of a full XY slab in the inner loop. Instead, values are added sequentially
+ * to a scratch buffer that is copied in tiles to the query zone by Flush
+ */
+template<typename T>
+class TVoxelQueryZoneZMajorBuffer
+{
+public:
+	explicit TVoxelQueryZoneZMajorBuffer(TVoxelQueryZone<T>& QueryZone)
+		: QueryZone(QueryZone)
+	{
+		const FIntVector Size = QueryZone.GetSize();
+		Buffer.Empty(Size.X * Size.Y * Size.Z);
+		Buffer.SetNumUninitialized(Size.X * Size.Y * Size.Z);
+	}
+
+	// Must be called in the VOXEL_QUERY_ZONE_ITERATE X, Y, Z order
+	FORCEINLINE void Add(T Value)
+	{
+		checkVoxelSlow(Buffer.IsValidIndex(Index));
+		Buffer.GetData()[Index++] = Value;
+	}
+	void Flush()
+	{
+		check(Index == Buffer.Num());
+		QueryZone.SetFromZMajor(Buffer.GetData());
+	}
+
+private:
+	TVoxelQueryZone<T>& QueryZone;
+	TArray<T> Buffer;
+	int32 Index = 0;
 };
 
 #define VOXEL_QUERY_ZONE_ITERATE(QueryZone, X) int32 X = QueryZone.Bounds.Min.X; X < QueryZone.Bounds.Max.X; X += QueryZone.Step
\ No newline at end of file
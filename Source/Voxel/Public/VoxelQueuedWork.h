@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Misc/IQueuedWork.h"
 
+enum class EVoxelTaskType : uint8;
+
 class IVoxelQueuedWork : public IQueuedWork
 {
 public:
@@ -13,6 +15,10 @@ public:
 	// Number of seconds a priority can be cached before being recomputed
 	const double PriorityDuration;
 
+	// Set when queued, used for the latency stats
+	EVoxelTaskType TaskType{};
+	uint64 QueuedCycles = 0;
+
 	FORCEINLINE IVoxelQueuedWork(FName Name, double PriorityDuration)
 		: Name(Name)
 		, PriorityDuration(PriorityDuration)
@@ -7,14 +7,20 @@
 #include "Containers/Queue.h"
 
 class UVoxelProceduralMeshComponent;
+struct FVoxelCollisionCookingCaches;
 
 // We don't want to have every component ticking
 // Will be deleted on the game thread when pinned
 class IVoxelProceduralMeshComponent_PhysicsCallbackHandler : public TVoxelSharedFromThis<IVoxelProceduralMeshComponent_PhysicsCallbackHandler>
 {
 public:
+	IVoxelProceduralMeshComponent_PhysicsCallbackHandler();
+	
 	void TickHandler();
 
+	// Used by the cookers of the components of this handler. Cookers keep a reference to it while they run
+	const TVoxelSharedRef<FVoxelCollisionCookingCaches> CookingCaches;
+
 private:
 	struct FCallback
 	{
@@ -21,6 +21,7 @@ class FVoxelData;
 class FVoxelTexturePool;
 class FVoxelDebugManager;
 class FVoxelToolRenderingManager;
+class FVoxelMeshDiskCache;
 class UMaterialInterface;
 class UMaterialInstanceDynamic;
 class UVoxelMaterialCollectionBase;
@@ -87,6 +88,8 @@ struct FVoxelRendererSettingsBase
 	const ECollisionTraceFlag CollisionTraceFlag;
 	const int32 NumConvexHullsPerAxis;
 	const bool bCleanCollisionMeshes;
+	const int32 CollisionDecimationMinLOD;
+	const float CollisionDecimationMaxError;
 
 	const EVoxelRenderType RenderType;
 	const uint32 RenderSharpness;
@@ -94,6 +97,9 @@ struct FVoxelRendererSettingsBase
 	const bool bDitherChunks;
 	const float ChunksDitheringDuration;
 	const bool bOptimizeIndices;
+	const bool bQuantizeMeshVertices;
+	const int32 MeshDecimationMinLOD;
+	const float MeshDecimationMaxError;
 
 	const int32 MaxDistanceFieldLOD;
 	const int32 DistanceFieldBoundsExtension;
@@ -163,6 +169,8 @@ struct FVoxelRendererSettings : FVoxelRendererSettingsBase
 	const TVoxelSharedPtr<FVoxelToolRenderingManager> ToolRenderingManager;
 	const TVoxelSharedRef<FVoxelTexturePool> TexturePool;
 	const TVoxelSharedRef<FVoxelDebugManager> DebugManager;
+	// Null if bEnableMeshDiskCache is false
+	const TVoxelSharedPtr<FVoxelMeshDiskCache> MeshDiskCache;
 
 	FVoxelRendererSettings(
 		const AVoxelWorld* World, 
@@ -203,10 +211,14 @@ public:
 	virtual void ApplyToAllMeshes(TFunctionRef<void(UVoxelProceduralMeshComponent&)> Lambda) = 0;
 	
 	virtual void CreateGeometry_AnyThread(int32 LOD, const FIntVector& ChunkPosition, TArray<uint32>& OutIndices, TArray<FVector>& OutVertices) const = 0;
+
+	// Whether the main mesh of this chunk was built at least once. Used for stats
+	virtual bool IsChunkMeshed(uint64 ChunkId) const = 0;
 	//~ End IVoxelRenderer Interface
 
 	// Called by LOD manager
-	void SetInvokersPositionsForPriorities(const TArray<FIntVector>& NewInvokersPositionsForPriorities);
+	// PrefetchOffsets: see FVoxelInvokerSettings::PrefetchOffset. Can be empty
+	void SetInvokersPositionsForPriorities(const TArray<FIntVector>& NewInvokersPositionsForPriorities, const TArray<FIntVector>& PrefetchOffsets = {});
 	
 	// Used by render chunks to compute the priorities
 	inline const TVoxelSharedRef<FInvokerPositionsArray>& GetInvokersPositionsForPriorities() const
@@ -4,9 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "VoxelMinimal.h"
+#include "VoxelValue.h"
 #include "VoxelIntBox.h"
 #include "VoxelRender/VoxelProcMeshTangent.h"
 #include "VoxelRender/VoxelMaterialIndices.h"
+#include "VoxelUtilities/VoxelMathUtilities.h"
+#include "VoxelUtilities/VoxelVectorUtilities.h"
 
 class FVoxelData;
 class FDistanceFieldVolumeData;
@@ -14,6 +17,22 @@ struct FVoxelRendererSettingsBase;
 
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Voxel Chunk Mesh Memory"), STAT_VoxelChunkMeshMemory, STATGROUP_VoxelMemory, VOXEL_API);
 
+// Compact vertex used when bQuantizeMeshVertices is true, see FVoxelChunkMeshBuffers::Pack. 16 bytes instead of 40
+struct FVoxelPackedChunkVertex
+{
+	// Positions are stored in 1/PositionPrecision of a voxel at the chunk LOD, offset by PositionOffset: this covers [-16, 48) voxels
+	// Powers of 2 so that 0, Step, Size etc are exact, as the transvoxel translation relies on these
+	static constexpr int32 PositionPrecision = 1024;
+	static constexpr int32 PositionOffset = 16384;
+
+	uint16 Position[3];
+	// Bit 0: bFlipTangentY
+	uint16 Flags;
+	// Octahedral encodings, see FVoxelUtilities::UnitVectorToOctahedron
+	int16 Normal[2];
+	int16 Tangent[2];
+};
+
 struct VOXEL_API FVoxelChunkMeshBuffers
 {
 	TArray<uint32> Indices;
@@ -28,6 +47,11 @@ struct VOXEL_API FVoxelChunkMeshBuffers
 	TArray<FColor> TextureData;
 	TArray<FBox> CollisionCubes;
 
+	// Set by Pack, replacing Positions, Normals & Tangents
+	TArray<FVoxelPackedChunkVertex> PackedVertices;
+	// Set by Pack if bHalfPrecisionTextureCoordinates, replacing TextureCoordinates
+	TArray<TArray<FVector2DHalf>> PackedTextureCoordinates;
+
 	FBox Bounds;
 	FGuid Guid; // Use to avoid rebuilding collisions when the mesh didn't change
 
@@ -37,18 +61,86 @@ struct VOXEL_API FVoxelChunkMeshBuffers
 		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelChunkMeshMemory, LastAllocatedSize);
 	}
 
+	bool IsPacked() const
+	{
+		return PackedStep != 0;
+	}
 	int32 GetNumVertices() const
 	{
-		return Positions.Num();
+		return IsPacked() ? PackedVertices.Num() : Positions.Num();
+	}
+	int32 GetNumTextureCoordinates() const
+	{
+		return PackedTextureCoordinates.Num() > 0 ? PackedTextureCoordinates.Num() : TextureCoordinates.Num();
+	}
+	int32 GetAllocatedSize() const
+	{
+		return LastAllocatedSize;
+	}
+
+	FORCEINLINE FVector GetPosition(int32 Index) const
+	{
+		if (!IsPacked())
+		{
+			return FVoxelUtilities::Get(Positions, Index);
+		}
+
+		const FVoxelPackedChunkVertex& Vertex = FVoxelUtilities::Get(PackedVertices, Index);
+		const float Scale = float(PackedStep) / FVoxelPackedChunkVertex::PositionPrecision;
+		return FVector(
+			int32(Vertex.Position[0]) - FVoxelPackedChunkVertex::PositionOffset,
+			int32(Vertex.Position[1]) - FVoxelPackedChunkVertex::PositionOffset,
+			int32(Vertex.Position[2]) - FVoxelPackedChunkVertex::PositionOffset) * Scale;
+	}
+	FORCEINLINE FVector GetNormal(int32 Index) const
+	{
+		if (!IsPacked())
+		{
+			return FVoxelUtilities::Get(Normals, Index);
+		}
+
+		const FVoxelPackedChunkVertex& Vertex = FVoxelUtilities::Get(PackedVertices, Index);
+		return FVoxelUtilities::OctahedronToUnitVector(FVector2D(Vertex.Normal[0], Vertex.Normal[1]) / MAX_int16);
+	}
+	FORCEINLINE FVoxelProcMeshTangent GetTangent(int32 Index) const
+	{
+		if (!IsPacked())
+		{
+			return FVoxelUtilities::Get(Tangents, Index);
+		}
+
+		const FVoxelPackedChunkVertex& Vertex = FVoxelUtilities::Get(PackedVertices, Index);
+		return FVoxelProcMeshTangent(
+			FVoxelUtilities::OctahedronToUnitVector(FVector2D(Vertex.Tangent[0], Vertex.Tangent[1]) / MAX_int16),
+			Vertex.Flags & 0x1);
+	}
+	FORCEINLINE FVector2D GetTextureCoordinate(int32 Channel, int32 Index) const
+	{
+		if (PackedTextureCoordinates.Num() > 0)
+		{
+			return FVoxelUtilities::Get(PackedTextureCoordinates[Channel], Index);
+		}
+		return FVoxelUtilities::Get(TextureCoordinates[Channel], Index);
 	}
 
 	void BuildAdjacency(TArray<uint32>& OutAdjacencyIndices) const;
+	// No vertex of the original mesh ends up further than MaxError from the decimated one. MaxError is in voxels at this LOD
+	// Vertices in the outer layer of cells are never moved so that chunk borders & transitions still match
+	void Decimate(int32 LOD, float MaxError);
+	// Reorders the triangles for vertex cache locality & overdraw, then the vertices in their first use order. Unreferenced vertices are removed
 	void OptimizeIndices();
 	void Shrink();
 	void ComputeBounds();
+	// Quantizes the vertices into PackedVertices. Must be called last, as the other functions work on the full precision buffers
+	// Does nothing if there are no normals (eg collisions only), or if a vertex is outside of the quantization range
+	void Pack(int32 LOD, bool bHalfPrecisionTextureCoordinates);
+	// Used by the mesh disk cache. The Guid isn't serialized: a new one is created when loading
+	void Serialize(FArchive& Ar);
 
 private:
 	int32 LastAllocatedSize = 0;
+	// Step of the LOD the positions were quantized at, 0 if not packed
+	int32 PackedStep = 0;
 
 	void UpdateStats();
 };
@@ -106,7 +198,28 @@ public:
 	}
 	
 public:
-	void BuildDistanceField(int32 LOD, const FIntVector& Position, const FVoxelData& Data, const FVoxelRendererSettingsBase& Settings);
+	int32 GetAllocatedSize() const
+	{
+		int32 AllocatedSize = 0;
+		IterateBuffers([&](const FVoxelChunkMeshBuffers& Buffers) { AllocatedSize += Buffers.GetAllocatedSize(); });
+		return AllocatedSize;
+	}
+
+public:
+	// Bounds of the values needed by BuildDistanceField
+	static FVoxelIntBox GetDistanceFieldValuesBounds(int32 LOD, const FIntVector& Position, const FVoxelRendererSettingsBase& Settings);
+	// CachedValues: optional dense array of the values in CachedValuesBounds at this LOD, eg the mesher snapshot. Only the values outside of it will be queried
+	// If it covers all the values needed, the data isn't locked
+	void BuildDistanceField(
+		int32 LOD,
+		const FIntVector& Position,
+		const FVoxelData& Data,
+		const FVoxelRendererSettingsBase& Settings,
+		const FVoxelIntBox& CachedValuesBounds = FVoxelIntBox(),
+		const FVoxelValue* CachedValues = nullptr);
+
+	// Serializes the buffers, but not the distance field. Check Ar.IsError() after loading
+	void Serialize(FArchive& Ar);
 	
 public:
 	template<typename T>
@@ -7,11 +7,49 @@
 #include "VoxelMinimal.h"
 #include "VoxelPriorityHandler.h"
 #include "VoxelAsyncWork.h"
+#include "Templates/Atomic.h"
 
 struct FVoxelRendererSettings;
 struct FVoxelChunkMesh;
 class FVoxelDefaultRenderer;
 class FVoxelMesherBase;
+enum class EVoxelEmptyState : uint8;
+
+// Result of the mesher empty check of a renderer chunk, so that it's only computed once
+// Invalidated by the renderer when the chunk is updated (edits, items...)
+class FVoxelChunkEmptyStateCache
+{
+public:
+	// OutToken is to be passed to Set
+	bool Get(EVoxelEmptyState& OutState, uint64& OutToken) const
+	{
+		OutToken = Value.Load();
+		if ((OutToken & 0x3) == 0)
+		{
+			return false;
+		}
+		OutState = EVoxelEmptyState((OutToken & 0x3) - 1);
+		return true;
+	}
+	// Does nothing if the cache was invalidated since the Get that returned Token: the state might be outdated
+	void Set(EVoxelEmptyState State, uint64 Token)
+	{
+		ensureVoxelSlow((Token & 0x3) == 0);
+		Value.CompareExchange(Token, Token | (uint64(State) + 1));
+	}
+	void Invalidate()
+	{
+		// Increment the version & clear the state
+		uint64 OldValue = Value.Load();
+		while (!Value.CompareExchange(OldValue, ((OldValue >> 2) + 1) << 2))
+		{
+		}
+	}
+
+private:
+	// Version << 2 | (State + 1), or 0 if not set
+	TAtomic<uint64> Value{ 0 };
+};
 
 class VOXEL_API FVoxelMesherAsyncWork : public FVoxelAsyncWork
 {
@@ -23,6 +61,7 @@ public:
 	const FIntVector ChunkPosition;
 	const bool bIsTransitionTask;
 	const uint8 TransitionsMask; // If bIsTransitionTask is true
+	const uint8 CallbackPriority; // See FVoxelDefaultRenderer::GetCallbackPriority
 
 	// Output
 	TVoxelSharedPtr<FVoxelChunkMesh> Chunk;
@@ -34,7 +73,9 @@ public:
 		int32 LOD,
 		const FVoxelIntBox& Bounds,
 		bool bIsTransitionTask,
-		uint8 TransitionsMask);
+		uint8 TransitionsMask,
+		uint8 CallbackPriority,
+		const TVoxelSharedPtr<FVoxelChunkEmptyStateCache>& EmptyStateCache = nullptr);
 
 	static void CreateGeometry_AnyThread(
 		const FVoxelDefaultRenderer& Renderer,
@@ -63,6 +104,7 @@ private:
 	
 	const TVoxelWeakPtr<FVoxelDefaultRenderer> Renderer;
 	const FVoxelPriorityHandler PriorityHandler;
+	const TVoxelSharedPtr<FVoxelChunkEmptyStateCache> EmptyStateCache;
 
 	template<typename T>
 	friend struct TVoxelAsyncWorkDelete;
@@ -21,6 +21,15 @@ DECLARE_VOXEL_MEMORY_STAT(TEXT("Colors"), STAT_VoxelProcMeshMemory_Colors, STATG
 DECLARE_VOXEL_MEMORY_STAT(TEXT("Adjacency"), STAT_VoxelProcMeshMemory_Adjacency, STATGROUP_VoxelProcMeshMemory, VOXEL_API);
 DECLARE_VOXEL_MEMORY_STAT(TEXT("UVs & Tangents"), STAT_VoxelProcMeshMemory_UVsAndTangents, STATGROUP_VoxelProcMeshMemory, VOXEL_API);
 
+// Part of the buffers holding one of the merged chunk meshes
+struct FVoxelProcMeshBuffersChunkRange
+{
+	int32 FirstVertex = 0;
+	int32 NumVertices = 0;
+	int32 FirstIndex = 0;
+	int32 NumIndices = 0;
+};
+
 struct VOXEL_API FVoxelProcMeshBuffers
 {
 	// We'll be initializing/releasing a single buffer multiple times, so need to keep the data on the CPU!
@@ -28,6 +37,8 @@ struct VOXEL_API FVoxelProcMeshBuffers
 
 	// GUIDs of the meshes merged into these buffers, used to avoid rebuilding collisions & navmesh
 	TArray<FGuid> Guids;
+	// Ranges of the non empty meshes merged into these buffers. Their indices are relative to the whole buffers
+	TArray<FVoxelProcMeshBuffersChunkRange> ChunkRanges;
 	
 	/** Vertex buffer for this section */
 	FStaticMeshVertexBuffers VertexBuffers;
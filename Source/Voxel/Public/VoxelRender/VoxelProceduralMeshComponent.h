@@ -101,6 +101,8 @@ private:
 	int32 NumConvexHullsPerAxis = 2;
 	// Cooks slower, but won't crash in case of weird complex geometry
 	bool bCleanCollisionMesh = false;
+	// If > 0, the collision mesh will be decimated before being cooked. In voxels at this LOD
+	float CollisionDecimationMaxError = 0.f;
 	// Will clear the proc mesh buffers once navmesh + collisions have been built
 	bool bClearProcMeshBuffersOnFinishUpdate = false;
 	// Distance field bias
@@ -47,8 +47,8 @@ public:
 	 */
 	void SetIndices(const TArray<uint32>& InIndices, EIndexBufferStride::Type DesiredStride);
 
-	// Stride set from the num
-	void AllocateData(int32 NumInIndices);
+	// Stride set from the number of vertices: 16 bit if all the indices fit
+	void AllocateData(int32 NumInIndices, int32 NumVertices);
 	
 	/**
 	 * Insert indices at the given position in the buffer
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "VoxelMinimal.h"
 #include "Misc/ScopeLock.h"
+#include "Templates/Atomic.h"
+#include "HAL/PlatformProcess.h"
 #include <mutex>
 #include <condition_variable>
 
@@ -14,13 +16,39 @@ enum class EVoxelLockType
 	Write
 };
 
+#if DO_THREADSAFE_CHECKS
+// Threads currently holding a lock
+class FVoxelMutexThreadIds
+{
+public:
+	void Add()
+	{
+		const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+		FScopeLock ScopeLock(&Section);
+		checkf(!ThreadIds.Contains(ThreadId), TEXT("Mutex already locked by this thread!"));
+		ThreadIds.Add(ThreadId);
+	}
+	void Remove()
+	{
+		const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+		FScopeLock ScopeLock(&Section);
+		checkf(ThreadIds.Contains(ThreadId), TEXT("Mutex not locked by this thread!"));
+		verify(ThreadIds.RemoveSwap(ThreadId) == 1);
+	}
+
+private:
+	FCriticalSection Section;
+	TArray<uint32, TInlineAllocator<16>> ThreadIds;
+};
+#endif
+
 class FVoxelSharedMutex
 {
 public:
 	void Lock(EVoxelLockType LockType)
 	{
 #if DO_THREADSAFE_CHECKS
-		AddThreadId();
+		ThreadIds.Add();
 #endif
 		if (LockType == EVoxelLockType::Read)
 		{
@@ -50,7 +78,7 @@ public:
 	void Unlock(EVoxelLockType LockType)
 	{
 #if DO_THREADSAFE_CHECKS
-		RemoveThreadId();
+		ThreadIds.Remove();
 #endif
 		if (LockType == EVoxelLockType::Read)
 		{
@@ -100,22 +128,125 @@ private:
 	bool bWriting = false;
 
 #if DO_THREADSAFE_CHECKS
-	FCriticalSection ThreadIdsSection;
-	TArray<uint32, TInlineAllocator<16>> ThreadIds;
+	FVoxelMutexThreadIds ThreadIds;
+#endif
+};
 
-	void AddThreadId()
+/**
+ * Word sized version of FVoxelSharedMutex, used by the data octrees as there are millions of them & they are rarely contended
+ * Waiting threads yield a few times, then sleep on a condition variable of a small table shared by all the compact mutexes
+ * Same as FVoxelSharedMutex, a waiting writer blocks new readers
+ */
+class FVoxelCompactSharedMutex
+{
+public:
+	void Lock(EVoxelLockType LockType)
 	{
-		const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
-		FScopeLock ScopeLock(&ThreadIdsSection);
-		checkf(!ThreadIds.Contains(ThreadId), TEXT("Mutex already locked by this thread!"));
-		ThreadIds.Add(ThreadId);
+#if DO_THREADSAFE_CHECKS
+		ThreadIds.Add();
+#endif
+		if (LockType == EVoxelLockType::Read)
+		{
+			for (int32 Iteration = 0; ; Iteration++)
+			{
+				uint32 OldState = State.Load(EMemoryOrder::Relaxed);
+				if (!(OldState & WriterBit))
+				{
+					if (State.CompareExchange(OldState, OldState + 1))
+					{
+						break;
+					}
+					// Another reader came in, no need to wait
+					continue;
+				}
+				Wait(Iteration, WriterBit);
+			}
+		}
+		else
+		{
+			for (int32 Iteration = 0; ; Iteration++)
+			{
+				uint32 OldState = State.Load(EMemoryOrder::Relaxed);
+				if (!(OldState & WriterBit))
+				{
+					if (State.CompareExchange(OldState, OldState | WriterBit))
+					{
+						break;
+					}
+					continue;
+				}
+				Wait(Iteration, WriterBit);
+			}
+			// No new readers can come in: wait for the current ones to leave
+			for (int32 Iteration = 0; State.Load() & ReadersMask; Iteration++)
+			{
+				Wait(Iteration, ReadersMask);
+			}
+		}
 	}
-	void RemoveThreadId()
+	void Unlock(EVoxelLockType LockType)
 	{
-		const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
-		FScopeLock ScopeLock(&ThreadIdsSection);
-		checkf(ThreadIds.Contains(ThreadId), TEXT("Mutex not locked by this thread!"));
-		verify(ThreadIds.RemoveSwap(ThreadId) == 1);
+#if DO_THREADSAFE_CHECKS
+		ThreadIds.Remove();
+#endif
+		if (LockType == EVoxelLockType::Read)
+		{
+			const uint32 OldState = State.DecrementExchange();
+			checkf((OldState & ReadersMask) > 0, TEXT("Unlock Read called, but not locked for read!"));
+			// Only a writer waits for the readers to leave
+			if ((OldState & ReadersMask) == 1 && (OldState & WaitersBit))
+			{
+				Unpark();
+			}
+		}
+		else
+		{
+			checkf((State.Load() & ~WaitersBit) == WriterBit, TEXT("Unlock Write called, but not locked for write!"));
+			const uint32 OldState = State.Exchange(0);
+			if (OldState & WaitersBit)
+			{
+				Unpark();
+			}
+		}
 	}
+
+	FORCEINLINE bool IsLockedForRead() const
+	{
+		return (State.Load() & ~WaitersBit) != 0;
+	}
+	FORCEINLINE bool IsLockedForWrite() const
+	{
+		return (State.Load() & WriterBit) != 0;
+	}
+
+private:
+	static constexpr uint32 WriterBit = 1u << 31;
+	// Set when a thread is sleeping until this mutex state changes
+	static constexpr uint32 WaitersBit = 1u << 30;
+	static constexpr uint32 ReadersMask = WaitersBit - 1;
+	
+	// WriterBit | WaitersBit | NumReaders
+	TAtomic<uint32> State{ 0 };
+
+	void Wait(int32 Iteration, uint32 BlockingMask)
+	{
+		// Locks are usually held for a short time: first only give up the time slice
+		if (Iteration < 16)
+		{
+			FPlatformProcess::Yield();
+		}
+		else
+		{
+			Park(BlockingMask);
+		}
+	}
+
+	// Sleeps until the bits of BlockingMask might have been cleared. Can return spuriously
+	VOXEL_API void Park(uint32 BlockingMask);
+	// Wakes the threads sleeping in Park
+	VOXEL_API void Unpark();
+
+#if DO_THREADSAFE_CHECKS
+	FVoxelMutexThreadIds ThreadIds;
 #endif
 };
\ No newline at end of file
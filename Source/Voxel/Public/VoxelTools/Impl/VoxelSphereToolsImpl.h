@@ -35,14 +35,39 @@ public:
 		bool bForceSingleThread,
 		TGetInterpolator GetInterpolator);
 	
+	// A Z plane of the buffer, with the sums of its voxels neighbors in the plane
 	template<typename TInterpolator>
-	static TInterpolator ApplyKernelSphereImpl_GetNeighborsValue(
-		TInterpolator* RESTRICT Buffer,
+	struct TKernelPlane
+	{
+		TInterpolator* Values = nullptr;
+		// Sum of the 4 neighbors sharing 2 coordinates with the voxel
+		TInterpolator* FirstDegreeSums = nullptr;
+		// Sum of the 4 neighbors sharing 1 coordinate with the voxel
+		TInterpolator* SecondDegreeSums = nullptr;
+	};
+
+	// Separable X then Y pass. Scratch must be a plane
+	template<typename TInterpolator>
+	static void ApplyKernelSphereImpl_ComputePlaneSums(
+		const TKernelPlane<TInterpolator>& Plane,
+		TInterpolator* RESTRICT Scratch,
+		const FIntVector& Size,
+		bool bForceSingleThread);
+
+	// Z pass, from the plane sums of the planes below, at and above the plane to compute
+	template<typename TInterpolator>
+	static void ApplyKernelSphereImpl_ComputePlane(
+		const TKernelPlane<TInterpolator>& Below,
+		const TKernelPlane<TInterpolator>& Plane,
+		const TKernelPlane<TInterpolator>& Above,
+		const float* RESTRICT Strengths,
+		TInterpolator* RESTRICT OutValues,
+		const FIntVector& Size,
+		float CenterMultiplier,
 		float FirstDegreeNeighborMultiplier,
 		float SecondDegreeNeighborMultiplier,
 		float ThirdDegreeNeighborMultiplier,
-		const FIntVector& Size,
-		int32 X, int32 Y, int32 Z);
+		bool bForceSingleThread);
 
 	template<typename TInterpolator, typename TGetStrength>
 	static void ApplyKernelSphereImpl_Iterate(
@@ -6,6 +6,7 @@
 #include "VoxelTools/Impl/VoxelToolsBaseImpl.inl"
 #include "VoxelUtilities/VoxelSDFUtilities.h"
 #include "VoxelInterpolator.h"
+#include "Async/ParallelFor.h"
 
 #define VOXEL_SPHERE_TOOL_IMPL() const FVoxelIntBox Bounds = FVoxelSphereToolsImpl::GetBounds(Position, Radius); VOXEL_TOOL_FUNCTION_COUNTER(Bounds.Count());
 
@@ -88,53 +89,80 @@ void FVoxelSphereToolsImpl::ApplyKernelSphereImpl_GetData(
 }
 
 template<typename TInterpolator>
-TInterpolator FVoxelSphereToolsImpl::ApplyKernelSphereImpl_GetNeighborsValue(
-	TInterpolator* Buffer,
+void FVoxelSphereToolsImpl::ApplyKernelSphereImpl_ComputePlaneSums(
+	const TKernelPlane<TInterpolator>& Plane,
+	TInterpolator* RESTRICT Scratch,
+	const FIntVector& Size,
+	bool bForceSingleThread)
+{
+	const TInterpolator* RESTRICT Values = Plane.Values;
+	TInterpolator* RESTRICT FirstDegreeSums = Plane.FirstDegreeSums;
+	TInterpolator* RESTRICT SecondDegreeSums = Plane.SecondDegreeSums;
+
+	// X pass: Scratch = left + right
+	ParallelFor(Size.Y, [&](int32 Y)
+	{
+		const int32 Offset = Y * Size.X;
+		for (int32 X = 1; X < Size.X - 1; X++)
+		{
+			Scratch[Offset + X] = Values[Offset + X - 1] + Values[Offset + X + 1];
+		}
+	}, bForceSingleThread);
+
+	// Y pass. Borders are left uninitialized, as they are never in the sphere
+	ParallelFor(Size.Y - 2, [&](int32 Row)
+	{
+		const int32 Offset = (Row + 1) * Size.X;
+		const int32 Below = Offset - Size.X;
+		const int32 Above = Offset + Size.X;
+		for (int32 X = 1; X < Size.X - 1; X++)
+		{
+			FirstDegreeSums[Offset + X] = Scratch[Offset + X] + Values[Below + X] + Values[Above + X];
+			SecondDegreeSums[Offset + X] = Scratch[Below + X] + Scratch[Above + X];
+		}
+	}, bForceSingleThread);
+}
+
+template<typename TInterpolator>
+void FVoxelSphereToolsImpl::ApplyKernelSphereImpl_ComputePlane(
+	const TKernelPlane<TInterpolator>& Below,
+	const TKernelPlane<TInterpolator>& Plane,
+	const TKernelPlane<TInterpolator>& Above,
+	const float* RESTRICT Strengths,
+	TInterpolator* RESTRICT OutValues,
+	const FIntVector& Size,
+	float CenterMultiplier,
 	float FirstDegreeNeighborMultiplier,
 	float SecondDegreeNeighborMultiplier,
 	float ThirdDegreeNeighborMultiplier,
-	const FIntVector& Size,
-	int32 X, int32 Y, int32 Z)
+	bool bForceSingleThread)
 {
-	const auto GetNeighbor = [&](int32 DX, int32 DY, int32 DZ)
+	ParallelFor(Size.Y, [&](int32 Y)
 	{
-		const int32 Degree = FMath::Abs(DX) + FMath::Abs(DY) + FMath::Abs(DZ);
-		const float Multiplier =
-			Degree == 1 ? FirstDegreeNeighborMultiplier
-			: Degree == 2 ? SecondDegreeNeighborMultiplier
-			: ThirdDegreeNeighborMultiplier;
-
-		// We can safely query neighbors thanks to the sphere distance check
-		return FVoxelUtilities::Get3D(Buffer, Size, X + DX, Y + DY, Z + DZ) * Multiplier;
-	};
+		const int32 Offset = Y * Size.X;
+		for (int32 Index = Offset; Index < Offset + Size.X; Index++)
+		{
+			const TInterpolator OldValue = Plane.Values[Index];
+			const float Strength = Strengths[Index];
+			if (Strength < 0)
+			{
+				OutValues[Index] = OldValue;
+				continue;
+			}
+
+			const TInterpolator FirstDegree = Plane.FirstDegreeSums[Index] + Below.Values[Index] + Above.Values[Index];
+			const TInterpolator SecondDegree = Plane.SecondDegreeSums[Index] + Below.FirstDegreeSums[Index] + Above.FirstDegreeSums[Index];
+			const TInterpolator ThirdDegree = Below.SecondDegreeSums[Index] + Above.SecondDegreeSums[Index];
+
+			const TInterpolator NewValue =
+				OldValue * CenterMultiplier +
+				FirstDegree * FirstDegreeNeighborMultiplier +
+				SecondDegree * SecondDegreeNeighborMultiplier +
+				ThirdDegree * ThirdDegreeNeighborMultiplier;
 
-	return
-		GetNeighbor(-1, -1, -1) +
-		GetNeighbor(+0, -1, -1) +
-		GetNeighbor(+1, -1, -1) +
-		GetNeighbor(-1, +0, -1) +
-		GetNeighbor(+0, +0, -1) +
-		GetNeighbor(+1, +0, -1) +
-		GetNeighbor(-1, +1, -1) +
-		GetNeighbor(+0, +1, -1) +
-		GetNeighbor(+1, +1, -1) +
-		GetNeighbor(-1, -1, +0) +
-		GetNeighbor(+0, -1, +0) +
-		GetNeighbor(+1, -1, +0) +
-		GetNeighbor(-1, +0, +0) +
-		GetNeighbor(+1, +0, +0) +
-		GetNeighbor(-1, +1, +0) +
-		GetNeighbor(+0, +1, +0) +
-		GetNeighbor(+1, +1, +0) +
-		GetNeighbor(-1, -1, +1) +
-		GetNeighbor(+0, -1, +1) +
-		GetNeighbor(+1, -1, +1) +
-		GetNeighbor(-1, +0, +1) +
-		GetNeighbor(+0, +0, +1) +
-		GetNeighbor(+1, +0, +1) +
-		GetNeighbor(-1, +1, +1) +
-		GetNeighbor(+0, +1, +1) +
-		GetNeighbor(+1, +1, +1);
+			OutValues[Index] = FMath::Lerp(OldValue, NewValue, Strength);
+		}
+	}, bForceSingleThread);
 }
 
 template<typename TInterpolator, typename TGetStrength>
@@ -154,32 +182,93 @@ void FVoxelSphereToolsImpl::ApplyKernelSphereImpl_Iterate(
 {
 	VOXEL_ASYNC_FUNCTION_COUNTER();
 
-	for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+	const int32 PlaneSize = Size.X * Size.Y;
+
+	// Negative if outside the sphere
+	TArray<float> Strengths;
+	Strengths.SetNumUninitialized(PlaneSize * Size.Z);
+	FVoxelIntBox(0, Size).ParallelIterate([&](int32 X, int32 Y, int32 Z)
 	{
-		VOXEL_ASYNC_SCOPE_COUNTER("Step");
-		FVoxelIntBox(0, Size).ParallelIterate([&](int32 X, int32 Y, int32 Z)
-		{
-			const float SquaredDistance = FVector(X - LocalPosition.X, Y - LocalPosition.Y, Z - LocalPosition.Z).SizeSquared();
+		const float SquaredDistance = FVector(X - LocalPosition.X, Y - LocalPosition.Y, Z - LocalPosition.Z).SizeSquared();
+		// Kinda hacky: assume this is false for at least a 1-voxel thick border, making it safe to query neighbors
+		Strengths[FVoxelUtilities::Get3DIndex(Size, X, Y, Z)] = SquaredDistance <= SquaredRadius ? FMath::Max(GetStrength(FMath::Sqrt(SquaredDistance)), 0.f) : -1.f;
+	}, bForceSingleThread);
 
-			const int32 Index = FVoxelUtilities::Get3DIndex(Size, X, Y, Z);
-			if (SquaredDistance <= SquaredRadius) // Kinda hacky: assume this is false for at least a 1-voxel thick border, making it safe to query neighbors
+	// The kernel is applied plane by plane along Z, and several iterations are done in the same sweep:
+	// iteration I computes the plane Z as soon as iteration I - 1 computed the plane Z + 1
+	// Each iteration only needs to keep 3 planes, which stay in cache instead of going through the whole buffer each time
+	constexpr int32 MaxFusedIterations = 4;
+
+	// For each fused iteration, 3 planes of values, first degree sums & second degree sums
+	TArray<TInterpolator> Planes;
+	Planes.SetNumUninitialized(FMath::Min(NumIterations, MaxFusedIterations) * 9 * PlaneSize);
+	TArray<TInterpolator> Scratch;
+	Scratch.SetNumUninitialized(PlaneSize);
+
+	for (int32 Iteration = 0; Iteration < NumIterations; Iteration += MaxFusedIterations)
+	{
+		VOXEL_ASYNC_SCOPE_COUNTER("Sweep");
+
+		const int32 NumFused = FMath::Min(MaxFusedIterations, NumIterations - Iteration);
+
+		// Level 0 is SrcBuffer, level NumFused is DstBuffer
+		const auto GetPlane = [&](int32 Level, int32 Z)
+		{
+			TKernelPlane<TInterpolator> Plane;
+			if (Level < NumFused)
 			{
-				const TInterpolator NeighborsValue = ApplyKernelSphereImpl_GetNeighborsValue(
-					SrcBuffer,
-					FirstDegreeNeighborMultiplier,
-					SecondDegreeNeighborMultiplier,
-					ThirdDegreeNeighborMultiplier,
-					Size,
-					X, Y, Z);
-				const TInterpolator OldValue = SrcBuffer[Index];
-				const TInterpolator NewValue = NeighborsValue + OldValue * CenterMultiplier;
-				DstBuffer[Index] = FMath::Lerp(OldValue, NewValue, GetStrength(FMath::Sqrt(SquaredDistance)));
+				TInterpolator* Ring = Planes.GetData() + (Level * 3 + Z % 3) * 3 * PlaneSize;
+				Plane.Values = Level == 0 ? SrcBuffer + Z * PlaneSize : Ring;
+				Plane.FirstDegreeSums = Ring + PlaneSize;
+				Plane.SecondDegreeSums = Ring + 2 * PlaneSize;
 			}
 			else
 			{
-				DstBuffer[Index] = SrcBuffer[Index];
+				Plane.Values = DstBuffer + Z * PlaneSize;
 			}
-		}, bForceSingleThread);
+			return Plane;
+		};
+
+		for (int32 Step = 0; Step < Size.Z + NumFused; Step++)
+		{
+			for (int32 Level = 0; Level <= NumFused; Level++)
+			{
+				const int32 Z = Step - Level;
+				if (Z < 0 || Z >= Size.Z)
+				{
+					continue;
+				}
+
+				const TKernelPlane<TInterpolator> Plane = GetPlane(Level, Z);
+				if (Level > 0)
+				{
+					if (Z == 0 || Z == Size.Z - 1)
+					{
+						// Never in the sphere
+						FMemory::Memcpy(Plane.Values, GetPlane(Level - 1, Z).Values, PlaneSize * sizeof(TInterpolator));
+					}
+					else
+					{
+						ApplyKernelSphereImpl_ComputePlane(
+							GetPlane(Level - 1, Z - 1),
+							GetPlane(Level - 1, Z),
+							GetPlane(Level - 1, Z + 1),
+							Strengths.GetData() + Z * PlaneSize,
+							Plane.Values,
+							Size,
+							CenterMultiplier,
+							FirstDegreeNeighborMultiplier,
+							SecondDegreeNeighborMultiplier,
+							ThirdDegreeNeighborMultiplier,
+							bForceSingleThread);
+					}
+				}
+				if (Level < NumFused)
+				{
+					ApplyKernelSphereImpl_ComputePlaneSums(Plane, Scratch.GetData(), Size, bForceSingleThread);
+				}
+			}
+		}
 
 		// Swap of RESTRICT is confusing clang
 		auto Copy = SrcBuffer;
@@ -14,6 +14,7 @@ class FVoxelData;
 class AVoxelWorld;
 class UVoxelGenerator;
 class UVoxelHeightmapAsset;
+struct FVoxelDataProgress;
 template<typename T>
 struct TVoxelHeightmapAssetSamplerWrapper;
 
@@ -219,10 +220,12 @@ public:
 	static void GetSave(
 		AVoxelWorld* World, 
 		FVoxelUncompressedWorldSave& OutSave);
-	static void GetSave(
+	// Returns false if cancelled through Progress or if the world isn't created
+	static bool GetSave(
 		AVoxelWorld* World, 
 		FVoxelUncompressedWorldSaveImpl& OutSave, 
-		TArray<FVoxelObjectArchiveEntry>& OutObjects);
+		TArray<FVoxelObjectArchiveEntry>& OutObjects,
+		FVoxelDataProgress* Progress = nullptr);
 	/**
 	 * Get a save of the world and compress it
 	 * @param	World		The voxel world
@@ -232,10 +235,12 @@ public:
 	static void GetCompressedSave(
 		AVoxelWorld* World, 
 		FVoxelCompressedWorldSave& OutSave);
-	static void GetCompressedSave(
+	// Returns false if cancelled through Progress or if the world isn't created
+	static bool GetCompressedSave(
 		AVoxelWorld* World, 
 		FVoxelCompressedWorldSaveImpl& OutSave, 
-		TArray<FVoxelObjectArchiveEntry>& OutObjects);
+		TArray<FVoxelObjectArchiveEntry>& OutObjects,
+		FVoxelDataProgress* Progress = nullptr);
 	/**
 	 * Get a save of the world
 	 * @param	World		The voxel world
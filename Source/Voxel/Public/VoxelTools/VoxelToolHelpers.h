@@ -44,6 +44,15 @@ public:
 	virtual bool IsValid() const = 0;
 	//~ End FVoxelLatentActionAsyncWork Interface
 
+	// Optional, for works that can report their progress and be cancelled
+	// Cancelled if the latent action is destroyed before the work is done, in which case the callback isn't called
+	TVoxelSharedPtr<FVoxelDataProgress> Progress;
+
+	bool IsCancelled() const
+	{
+		return Progress.IsValid() && Progress->bCancel;
+	}
+
 protected:
 	~FVoxelLatentActionAsyncWork() = default;
 
@@ -160,6 +169,11 @@ public:
 	{
 		if (!Work->IsDone())
 		{
+			if (Work->Progress.IsValid())
+			{
+				// No need to finish it: the result won't be used
+				Work->Progress->bCancel = true;
+			}
 			const double StartTime = FPlatformTime::Seconds();
 			Work->WaitForCompletion();
 			const double Elapsed = FPlatformTime::Seconds() - StartTime;
@@ -172,7 +186,7 @@ public:
 					*Name.ToString());
 			}
 		}
-		if (!bCallbackCalled && Work->IsValid() && !Work->WasAbandoned())
+		if (!bCallbackCalled && Work->IsValid() && !Work->WasAbandoned() && !Work->IsCancelled())
 		{
 			// Always call callback
 			GameThreadCallback(*Work);
@@ -193,6 +207,10 @@ public:
 #if WITH_EDITOR
 	virtual FString GetDescription() const override
 	{
+		if (Work->Progress.IsValid())
+		{
+			return FString::Printf(TEXT("%s: %.0f%%"), *Name.ToString(), 100 * Work->Progress->GetProgress());
+		}
 		return FString::Printf(TEXT("%s: Waiting for completion"), *Name.ToString());
 	}
 #endif
@@ -249,7 +267,8 @@ struct VOXEL_API FVoxelToolHelpers
 		bool bHideLatentWarnings,
 		TFunction<void(FVoxelData&)> DoWork,
 		EVoxelUpdateRender UpdateRender,
-		const FVoxelIntBox& BoundsToUpdate);
+		const FVoxelIntBox& BoundsToUpdate,
+		const TVoxelSharedPtr<FVoxelDataProgress>& Progress = nullptr);
 	static bool StartAsyncLatentAction_WithoutWorld(
 		UObject* WorldContextObject,
 		FLatentActionInfo LatentInfo,
@@ -269,7 +288,8 @@ struct VOXEL_API FVoxelToolHelpers
 		TDoWork DoWork,
 		EVoxelUpdateRender UpdateRender,
 		const FVoxelIntBox& BoundsToUpdate,
-		TFunction<void()> GameThreadCallback = nullptr)
+		TFunction<void()> GameThreadCallback = nullptr,
+		const TVoxelSharedPtr<FVoxelDataProgress>& Progress = nullptr)
 	{
 		using FWork = TVoxelLatentActionAsyncWork_WithWorld_WithValue<T>;
 		return StartAsyncLatentActionImpl<FWork>(
@@ -278,7 +298,12 @@ struct VOXEL_API FVoxelToolHelpers
 			World,
 			Name,
 			bHideLatentWarnings,
-			[&]() { return new FWork(Name, World, DoWork); },
+			[&]()
+			{
+				FWork* Work = new FWork(Name, World, DoWork);
+				Work->Progress = Progress;
+				return Work;
+			},
 			[=, WeakWorldContextObject = MakeWeakObjectPtr(WorldContextObject), &Value](FWork& Work)
 			{
 				if (WeakWorldContextObject.IsValid())
@@ -23,6 +23,9 @@ public:
 
 public:
 	static void JumpFlood(const FIntVector& Size, TArray<FVector>& InOutPackedPositions, EVoxelComputeDevice Device, bool bMultiThreaded = false, int32 MaxPasses_Debug = -1);
+	// Alternative to JumpFlood on CPU: exact separable euclidean distance transform, see Felzenszwalb & Huttenlocher, Distance Transforms of Sampled Functions
+	// Each voxel gets the surface position of the closest voxel with a valid one. Linear in the number of voxels, unlike JumpFlood which is 27 * log2(Size) reads per voxel
+	static void ExactDistanceTransform(const FIntVector& Size, TArray<FVector>& InOutSurfacePositions, bool bMultiThreaded = false);
 	// Only the InOutDistances sign will be used, not their actual values
 	static void GetDistancesFromSurfacePositions(const FIntVector& Size, TArrayView<const FVector> SurfacePositions, TArrayView<float> InOutDistances);
 	
@@ -64,4 +67,5 @@ public:
 
 private:
 	static void JumpFloodStep_CPU(const FIntVector& Size, TArrayView<const FVector> InData, TArrayView<FVector> OutData, int32 Step, bool bMultiThreaded);
+	static void ExactDistanceTransformPass(const FIntVector& Size, int32 Axis, TArrayView<float> InOutSquaredDistances, TArrayView<int32> InOutClosestIndices, bool bMultiThreaded);
 };
\ No newline at end of file
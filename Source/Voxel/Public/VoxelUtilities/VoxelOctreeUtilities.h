@@ -12,8 +12,9 @@ enum class EVoxelOctreeLeafQuery
 
 namespace FVoxelOctreeUtilities
 {
-	template<EVoxelOctreeLeafQuery Query, typename T>
-	inline auto GetLeaf(T& Tree, int32 X, int32 Y, int32 Z) -> decltype(&Tree.AsLeaf())
+	// CreateChildrenArgs are forwarded to CreateChildren
+	template<EVoxelOctreeLeafQuery Query, typename T, typename... TArgs>
+	inline auto GetLeaf(T& Tree, int32 X, int32 Y, int32 Z, TArgs&... CreateChildrenArgs) -> decltype(&Tree.AsLeaf())
 	{
 		checkVoxelSlow(Tree.IsInOctree(X, Y, Z));
 		auto* Ptr = &Tree;
@@ -23,7 +24,7 @@ namespace FVoxelOctreeUtilities
 			{
 				if (Query == EVoxelOctreeLeafQuery::CreateIfNull)
 				{
-					Ptr->AsParent().CreateChildren();
+					Ptr->AsParent().CreateChildren(CreateChildrenArgs...);
 				}
 				else
 				{
@@ -35,10 +36,10 @@ namespace FVoxelOctreeUtilities
 		checkVoxelSlow(Ptr->IsInOctree(X, Y, Z));
 		return &Ptr->AsLeaf();
 	}
-	template<EVoxelOctreeLeafQuery Query, typename T>
-	inline auto* GetLeaf(T& Tree, const FIntVector& P)
+	template<EVoxelOctreeLeafQuery Query, typename T, typename... TArgs>
+	inline auto* GetLeaf(T& Tree, const FIntVector& P, TArgs&... CreateChildrenArgs)
 	{
-		return GetLeaf<Query>(Tree, P.X, P.Y, P.Z);
+		return GetLeaf<Query>(Tree, P.X, P.Y, P.Z, CreateChildrenArgs...);
 	}
 
 	template<typename T>
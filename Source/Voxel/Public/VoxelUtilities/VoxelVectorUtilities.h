@@ -102,6 +102,46 @@ namespace FVoxelUtilities
 		return ComponentMax(A, ComponentMax(B, C));
 	}
 
+	// Octahedral encoding of unit vectors, in [-1, 1]^2
+	// See Cigolle et al., A Survey of Efficient Representations for Independent Unit Vectors
+	FORCEINLINE FVector2D UnitVectorToOctahedron(const FVector& Vector)
+	{
+		const float L1Norm = FMath::Abs(Vector.X) + FMath::Abs(Vector.Y) + FMath::Abs(Vector.Z);
+		if (L1Norm == 0)
+		{
+			return FVector2D(0, 0);
+		}
+
+		const float X = Vector.X / L1Norm;
+		const float Y = Vector.Y / L1Norm;
+		if (Vector.Z >= 0)
+		{
+			return FVector2D(X, Y);
+		}
+		else
+		{
+			// Fold the lower hemisphere
+			return FVector2D(
+				(1 - FMath::Abs(Y)) * (X >= 0 ? 1 : -1),
+				(1 - FMath::Abs(X)) * (Y >= 0 ? 1 : -1));
+		}
+	}
+	FORCEINLINE FVector OctahedronToUnitVector(const FVector2D& Octahedron)
+	{
+		const float Z = 1 - FMath::Abs(Octahedron.X) - FMath::Abs(Octahedron.Y);
+		if (Z >= 0)
+		{
+			return FVector(Octahedron.X, Octahedron.Y, Z).GetSafeNormal();
+		}
+		else
+		{
+			return FVector(
+				(1 - FMath::Abs(Octahedron.Y)) * (Octahedron.X >= 0 ? 1 : -1),
+				(1 - FMath::Abs(Octahedron.X)) * (Octahedron.Y >= 0 ? 1 : -1),
+				Z).GetSafeNormal();
+		}
+	}
+
 	FORCEINLINE TVoxelStaticArray<FIntVector, 8> GetNeighbors(const FVoxelVector& P)
 	{
 		const int32 MinX = FloorToInt32(P.X);
@@ -41,6 +41,7 @@ class IVoxelSpawnerManager;
 class FVoxelMultiplayerManager;
 class FVoxelInstancedMeshManager;
 class FVoxelToolRenderingManager;
+class FVoxelCookedCollisionStreamer;
 struct FVoxelLODDynamicSettings;
 struct FVoxelUncompressedWorldSave;
 struct FVoxelRendererDynamicSettings;
@@ -240,6 +241,18 @@ public:
 	// For example, can be useful when used with a Max LOD of 0 for worlds that have the highest resolution LOD everywhere
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - LOD Settings", meta = (RecreateRender))
 	bool bConstantLOD = false;
+
+	// If true, the chunks are laid out as a clipmap around the first local invoker used for LODs, instead of using the invokers LOD ranges:
+	// each LOD is a ring of chunks of that LOD, ClipmapRingRadius chunks away from the invoker.
+	// When the invoker moves, only the chunks entering or leaving the rings are updated, making LOD updates cheap regardless of the view distance
+	// Useful for fast moving invokers, eg flight simulators
+	// Collisions & navmesh are computed using Compute Visible Chunks Collisions/Navmesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - LOD Settings", meta = (RecreateRender))
+	bool bUseClipmapLODs = false;
+
+	// In chunks. The view distance is ClipmapRingRadius * RENDER_CHUNK_SIZE * 2^MaxLOD voxels. Rounded up to an even number, min 6
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - LOD Settings", meta = (RecreateRender, EditCondition = "bUseClipmapLODs", ClampMin = 6, UIMin = 6, UIMax = 16))
+	int32 ClipmapRingRadius = 8;
 	
 	//////////////////////////////////////////////////////////////////////////////
 	
@@ -399,10 +412,39 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, ClampMin = 64, UIMin = 128, UIMax = 2048))
 	int32 TexturePoolTextureSize = 512;
 	
-	// If true, the mesh indices will be sorted to improve GPU cache performance. Adds a cost to the async mesh building. If you don't see any perf difference, leave it off
+	// If true, the mesh triangles will be sorted to improve GPU vertex cache performance & reduce overdraw, and the vertices to improve fetch locality
+	// Adds a cost to the async mesh building. Use voxel.mesher.PrintStats to compare the ACMR/ATVR. If you don't see any perf difference, leave it off
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
 	bool bOptimizeIndices = false;
 
+	// If true, the chunk meshes kept in memory will store quantized positions (1/1024 voxel precision) & octahedral normals and tangents,
+	// as well as half precision UVs if bHalfPrecisionCoordinates is true. Reduces the chunk meshes memory by about 2x
+	// Use voxel.mesher.PrintStats to see the memory used per chunk. Does nothing if bRenderWorld is false
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
+	bool bQuantizeMeshVertices = false;
+
+	// If true, the meshes of chunks with a LOD >= MeshDecimationMinLOD will be simplified by collapsing edges,
+	// reducing vertex & index memory for far chunks. Vertices on the chunk borders are never moved, so transitions stay intact
+	// Does nothing with flat normals or the cubic render type, as every vertex is split
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
+	bool bEnableMeshDecimation = false;
+
+	// Chunks with LOD >= this will be decimated
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, ClampMin = 0, ClampMax = 26, UIMin = 0, UIMax = 26, EditCondition = "bEnableMeshDecimation"))
+	int32 MeshDecimationMinLOD = 2;
+
+	// Max distance from the vertices of the original mesh to the decimated one, in voxels at the chunk LOD
+	// Scales with the LOD: at LOD 3, 0.5 means 4 voxels
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender, ClampMin = 0, UIMin = 0, UIMax = 2, EditCondition = "bEnableMeshDecimation"))
+	float MeshDecimationMaxError = 0.25f;
+
+	// If true, the chunk meshes will be saved in Saved/VoxelMeshCache and loaded from there the next time the world is created instead of being generated again
+	// Only chunks without edits or asset items are cached. Keyed by a hash of the generator, its parameters, the assets it references & the code version
+	// Data that isn't hashed (eg soft references, files read at runtime) isn't detected: override UVoxelGenerator::GetGeneratorHash or bump voxel.renderer.MeshDiskCacheVersion
+	// Game only. Size limited by voxel.renderer.MeshDiskCacheMaxSize. Use voxel.renderer.ClearMeshDiskCache to delete the cached meshes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Rendering", meta = (RecreateRender))
+	bool bEnableMeshDiskCache = false;
+
 	// Will generate distance fields on LOD 0 chunks
 	// Has a cost of around 1 ms per chunk (on async thread)
 	// Doesn't work with chunks merging or single/double index material config with different materials per chunk
@@ -540,6 +582,19 @@ public:
 	// You can check the result in the Player Collision view
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Collisions", meta = (RecreateRender, ClampMin = 1, ClampMax = 32, UIMin = 1, UIMax = 32, EditCondition = bEnableCollisions))
 	int32 NumConvexHullsPerAxis = 2;
+
+	// If true, the collision meshes of chunks with a LOD >= CollisionDecimationMinLOD will be simplified before being cooked
+	// Independent from the render mesh decimation. Reduces collision memory & cooking time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Collisions", meta = (RecreateRender, EditCondition = bEnableCollisions))
+	bool bEnableCollisionDecimation = false;
+
+	// Collision meshes of chunks with LOD >= this will be decimated
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Collisions", meta = (RecreateRender, ClampMin = 0, ClampMax = 26, UIMin = 0, UIMax = 26, EditCondition = "bEnableCollisions && bEnableCollisionDecimation"))
+	int32 CollisionDecimationMinLOD = 0;
+
+	// Max distance from the vertices of the original collision mesh to the decimated one, in voxels at the chunk LOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = "Voxel - Collisions", meta = (RecreateRender, ClampMin = 0, UIMin = 0, UIMax = 2, EditCondition = "bEnableCollisions && bEnableCollisionDecimation"))
+	float CollisionDecimationMaxError = 0.5f;
 	
 	// Clean collisions meshes when cooking them.
 	// Disabling this makes cooking collision slightly faster, but might lead to physx crashing in case of invalid geometry.
@@ -836,6 +891,9 @@ private:
 	
 	TVoxelSharedPtr<FGameThreadTasks> GameThreadTasks;
 	
+	// Only ticked when the world isn't created, see UVoxelCookingLibrary::LoadCookedVoxelDataFromFile
+	TVoxelSharedPtr<FVoxelCookedCollisionStreamer> CookedCollisionStreamer;
+	
 private:
 	void OnWorldLoadedCallback();
 
@@ -859,6 +917,7 @@ public:
 	void UpdateDynamicLODSettings() const;
 	void UpdateDynamicRendererSettings() const;
 	void ApplyCollisionSettingsToRoot() const;
+	void SetCookedCollisionStreamer(const TVoxelSharedPtr<FVoxelCookedCollisionStreamer>& Streamer) { CookedCollisionStreamer = Streamer; }
 
 	void RecreateRender();
 	void RecreateSpawners();
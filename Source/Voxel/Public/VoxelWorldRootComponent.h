@@ -34,8 +34,20 @@ public:
 	virtual FPrimitiveSceneProxy* CreateSceneProxy() override final;
 	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
 	virtual TArray<URuntimeVirtualTexture*> const& GetRuntimeVirtualTextures() const override;
+	virtual bool DoCustomNavigableGeometryExport(FNavigableGeometryExport& GeomExport) const override;
 	//~ End UPrimitiveComponent Interface
 
+protected:
+	//~ Begin UActorComponent Interface
+	virtual void OnCreatePhysicsState() override;
+	virtual void OnDestroyPhysicsState() override;
+	//~ End UActorComponent Interface
+
+	//~ Begin USceneComponent Interface
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport = ETeleportType::None) override;
+	//~ End USceneComponent Interface
+
+public:
 	// Only need to tick when created
 	void TickWorldRoot();
 
@@ -48,12 +60,21 @@ public:
 #if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
 	void UpdateSimpleCollision(FVoxelProcMeshComponentId Id, FVoxelSimpleCollisionData&& SimpleCollision);
 	void SetCookedTriMeshes(const TArray<physx::PxTriangleMesh*>& TriMeshes);
+
+	// Each cooked chunk has its own body, so that chunks can be added/removed without recreating the physics state of the others
+	// Takes ownership of TriMesh
+	void AddCookedChunk(int32 Id, physx::PxTriangleMesh* TriMesh);
+	void RemoveCookedChunk(int32 Id);
 #endif
 
 private:
 	UPROPERTY(Transient)
 	UBodySetup* BodySetup;
 
+	// See AddCookedChunk
+	UPROPERTY(Transient)
+	TMap<int32, UBodySetup*> CookedChunksBodySetups;
+
 	FBoxSphereBounds LocalBounds;
 
 	// For debug draw
@@ -70,8 +91,19 @@ private:
 	TMap<FVoxelProcMeshComponentId, TUniquePtr<FSimpleCollisionDataRef>> ProcMeshesSimpleCollision;
 
 	bool bRebuildQueued = false;
+	bool bNavigationUpdateQueued = false;
 	
 	void RebuildConvexCollision();
+	// Simple collision & cooked chunks
+	void UpdateLocalBounds();
+	void UpdateNavigation();
+
+	// Local bounds of the cooked chunks meshes, for the component bounds & navigation
+	TMap<int32, FBox> CookedChunksBounds;
+	// Only valid when the physics state is created
+	TMap<int32, TUniquePtr<FBodyInstance>> CookedChunksBodyInstances;
+
+	void CreateCookedChunkBody(int32 Id);
 #endif
 
 	friend class FVoxelRenderSimpleCollisionSceneProxy;
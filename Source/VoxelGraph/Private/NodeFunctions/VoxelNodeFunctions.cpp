@@ -8,6 +8,20 @@
 #include "Curves/CurveFloat.h"
 #include "Curves/CurveLinearColor.h"
 #include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarCurveTableMaxSize(
+	TEXT("voxel.graph.CurveTableMaxSize"),
+	4097,
+	TEXT("Max number of samples of the tables baked for the graph curves. Curves needing more samples to be within voxel.graph.CurveTableMaxError are evaluated exactly. ")
+	TEXT("0 to always evaluate the curves exactly. Tables are baked when the graph instance is created"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCurveTableMaxError(
+	TEXT("voxel.graph.CurveTableMaxError"),
+	0.001f,
+	TEXT("Max error of the tables baked for the graph curves, relative to the curve value range"),
+	ECVF_Default);
 
 /** Util to find float value on bezier defined by 4 control points */
 static TVoxelRange<v_flt> BezierInterp(v_flt P0, v_flt P1, v_flt P2, v_flt P3, const TVoxelRange<v_flt>& Alpha)
@@ -119,7 +133,7 @@ inline v_flt GetSuperiorInfinityValue(const FRichCurve& Curve, v_flt InTime)
 	}
 }
 
-TVoxelRange<v_flt> FVoxelNodeFunctions::GetCurveValue(const FVoxelRichCurve& VoxelCurve, const TVoxelRange<v_flt>& Time)
+static TVoxelRange<v_flt> GetExactCurveValue(const FVoxelRichCurve& VoxelCurve, const TVoxelRange<v_flt>& Time)
 {
 	auto& Curve = VoxelCurve.Curve;
 	if (Time.IsSingleValue())
@@ -191,6 +205,25 @@ TVoxelRange<v_flt> FVoxelNodeFunctions::GetCurveValue(const FVoxelRichCurve& Vox
 	}
 }
 
+TVoxelRange<v_flt> FVoxelNodeFunctions::GetCurveValue(const FVoxelRichCurve& VoxelCurve, const TVoxelRange<v_flt>& Time)
+{
+	if (Time.IsSingleValue())
+	{
+		return VoxelCurve.Eval(Time.GetSingleValue());
+	}
+	if (!VoxelCurve.HasTable())
+	{
+		return GetExactCurveValue(VoxelCurve, Time);
+	}
+	if (VoxelCurve.GetTableStart() <= Time.Min && Time.Max <= VoxelCurve.GetTableEnd())
+	{
+		return VoxelCurve.GetTableRange(Time);
+	}
+	
+	// Outside of the table the curve is evaluated exactly
+	return TVoxelRange<v_flt>::Union(VoxelCurve.GetTableRange(Time), GetExactCurveValue(VoxelCurve, Time));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -695,6 +728,7 @@ FVoxelRichCurve::FVoxelRichCurve(const FRichCurve& Curve)
 	: Curve(Curve)
 {
 	Curve.GetValueRange(Min, Max);
+	BakeTable();
 }
 
 FVoxelRichCurve::FVoxelRichCurve(const UCurveFloat* Curve)
@@ -702,6 +736,99 @@ FVoxelRichCurve::FVoxelRichCurve(const UCurveFloat* Curve)
 {
 }
 
+TVoxelRange<v_flt> FVoxelRichCurve::GetTableRange(const TVoxelRange<v_flt>& Time) const
+{
+	check(HasTable());
+
+	const v_flt TimeMin = FMath::Clamp<v_flt>(Time.Min, TableStart, TableEnd);
+	const v_flt TimeMax = FMath::Clamp<v_flt>(Time.Max, TableStart, TableEnd);
+
+	const v_flt ValueA = Eval(TimeMin);
+	const v_flt ValueB = Eval(TimeMax);
+	v_flt RangeMin = FMath::Min(ValueA, ValueB);
+	v_flt RangeMax = FMath::Max(ValueA, ValueB);
+
+	// Linear interpolation: the extrema are either at the ends or on the samples in between
+	const int32 First = FMath::Max(FMath::CeilToInt((TimeMin - TableStart) * TableInvStep), 0);
+	const int32 Last = FMath::Min(FMath::FloorToInt((TimeMax - TableStart) * TableInvStep), Table.Num() - 1);
+	for (int32 Index = First; Index <= Last; Index++)
+	{
+		RangeMin = FMath::Min<v_flt>(RangeMin, Table[Index]);
+		RangeMax = FMath::Max<v_flt>(RangeMax, Table[Index]);
+	}
+
+	return { RangeMin, RangeMax };
+}
+
+void FVoxelRichCurve::BakeTable()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	Table.Reset();
+	
+	const int32 MaxSize = CVarCurveTableMaxSize.GetValueOnAnyThread();
+	const auto& Keys = Curve.GetConstRefOfKeys();
+	if (MaxSize < 2 || Keys.Num() < 2 || !(Keys[0].Time < Keys.Last().Time))
+	{
+		return;
+	}
+	
+	const float MaxError = CVarCurveTableMaxError.GetValueOnAnyThread() * FMath::Max(Max - Min, KINDA_SMALL_NUMBER);
+	
+	TableStart = Keys[0].Time;
+	TableEnd = Keys.Last().Time;
+
+	TArray<float> NewTable;
+	// Start with a few samples per key
+	for (int32 Size = FMath::Clamp(4 * Keys.Num() + 1, 2, MaxSize);; Size = FMath::Min(2 * Size - 1, MaxSize))
+	{
+		const float Step = (TableEnd - TableStart) / (Size - 1);
+		
+		NewTable.SetNumUninitialized(Size);
+		for (int32 Index = 0; Index < Size; Index++)
+		{
+			NewTable[Index] = FVoxelRichCurveUtilities::Eval(Curve, Index < Size - 1 ? TableStart + Index * Step : TableEnd);
+		}
+
+		// Check the error inside each interval, on a few points and on the keys: keys can be sharp corners or spikes that the points would miss
+		// Between two keys, the error is a cubic that is 0 on the samples: its max is at most 1.04x its max on these points, hence the margin
+		const float CheckedMaxError = MaxError / 1.04f;
+		const auto IsValid = [&](int32 Index, float Alpha)
+		{
+			const float Exact = FVoxelRichCurveUtilities::Eval(Curve, TableStart + (Index + Alpha) * Step);
+			return FMath::Abs(FMath::Lerp(NewTable[Index], NewTable[Index + 1], Alpha) - Exact) <= CheckedMaxError;
+		};
+		
+		bool bValid = true;
+		int32 KeyIndex = 0;
+		for (int32 Index = 0; Index < Size - 1 && bValid; Index++)
+		{
+			for (int32 Point = 1; Point < 8 && bValid; Point++)
+			{
+				bValid = IsValid(Index, Point / 8.f);
+			}
+			
+			const float IntervalEnd = TableStart + (Index + 1) * Step;
+			for (; KeyIndex < Keys.Num() && Keys[KeyIndex].Time < IntervalEnd && bValid; KeyIndex++)
+			{
+				bValid = IsValid(Index, FMath::Clamp((Keys[KeyIndex].Time - TableStart) / Step - Index, 0.f, 1.f));
+			}
+		}
+
+		if (bValid)
+		{
+			Table = MoveTemp(NewTable);
+			TableInvStep = 1.f / Step;
+			return;
+		}
+		if (Size == MaxSize)
+		{
+			// eg constant keys: sampling won't help, evaluate exactly
+			return;
+		}
+	}
+}
+
 FVoxelColorRichCurve::FVoxelColorRichCurve(const UCurveLinearColor* Curve)
 {
 	if (Curve)
@@ -1,6 +1,16 @@
 // Copyright 2020 Phyronnaz
 
 #include "VoxelGraphModule.h"
+#include "VoxelGraphTests.h"
+#include "VoxelMinimal.h"
 #include "Modules/ModuleManager.h"
 
+void FVoxelGraphModule::StartupModule()
+{
+	if (VOXEL_DEBUG || !UE_BUILD_SHIPPING)
+	{
+		FVoxelGraphTests::Test();
+	}
+}
+
 IMPLEMENT_MODULE(FVoxelGraphModule, VoxelGraph)
@@ -0,0 +1,107 @@
+// Copyright 2020 Phyronnaz
+
+#include "VoxelGraphTests.h"
+#include "NodeFunctions/VoxelNodeFunctions.h"
+#include "HAL/IConsoleManager.h"
+
+struct FVoxelGraphTestsImpl
+{
+	static FRichCurve MakeCurve(ERichCurveInterpMode InterpMode, const TArray<FVector2D>& Keys)
+	{
+		FRichCurve Curve;
+		for (const FVector2D& Key : Keys)
+		{
+			Curve.SetKeyInterpMode(Curve.AddKey(Key.X, Key.Y), InterpMode);
+		}
+		Curve.AutoSetTangents();
+		return Curve;
+	}
+	
+	static void TestCurveTables()
+	{
+		const float MaxRelativeError = IConsoleManager::Get().FindConsoleVariable(TEXT("voxel.graph.CurveTableMaxError"))->GetFloat();
+		
+		const auto Test = [&](const FRichCurve& RichCurve)
+		{
+			const FVoxelRichCurve Curve(RichCurve);
+			const float MaxError = MaxRelativeError * FMath::Max(Curve.GetMax() - Curve.GetMin(), KINDA_SMALL_NUMBER);
+
+			const auto& Keys = RichCurve.GetConstRefOfKeys();
+			if (Keys.Num() == 0)
+			{
+				check(!Curve.HasTable());
+				return;
+			}
+
+			// Also sample outside of the keys, where the curve is evaluated exactly
+			const float Margin = FMath::Max(Keys.Last().Time - Keys[0].Time, 1.f) / 4;
+			const float Start = Keys[0].Time - Margin;
+			const float End = Keys.Last().Time + Margin;
+			
+			constexpr int32 NumSamples = 100000;
+			TArray<v_flt> Values;
+			TArray<v_flt> ExactValues;
+			for (int32 Index = 0; Index < NumSamples; Index++)
+			{
+				const v_flt Time = FMath::Lerp(Start, End, float(Index) / (NumSamples - 1));
+				// Same as GetExactCurveValue for a single value
+				const v_flt Exact = FVoxelRichCurveUtilities::Eval(RichCurve, Time);
+				const v_flt Value = Curve.Eval(Time);
+				checkf(FMath::Abs(Value - Exact) <= MaxError, TEXT("Time: %f Value: %f Exact: %f MaxError: %f"), Time, Value, Exact, MaxError);
+				
+				Values.Add(Value);
+				ExactValues.Add(Exact);
+			}
+
+			if (!Curve.HasTable())
+			{
+				return;
+			}
+
+			// Ranges over a few sub intervals, including ones partly outside of the table
+			for (int32 Divisions = 1; Divisions <= 64; Divisions *= 4)
+			{
+				for (int32 Division = 0; Division < Divisions; Division++)
+				{
+					const int32 First = Division * (NumSamples - 1) / Divisions;
+					const int32 Last = (Division + 1) * (NumSamples - 1) / Divisions;
+					
+					const TVoxelRange<v_flt> Time(
+						FMath::Lerp(Start, End, float(First) / (NumSamples - 1)),
+						FMath::Lerp(Start, End, float(Last) / (NumSamples - 1)));
+					// GetCurveValue only uses the table range when Time is inside the table
+					const bool bInTable = Curve.GetTableStart() <= Time.Min && Time.Max <= Curve.GetTableEnd();
+					const TVoxelRange<v_flt> Range = bInTable ? Curve.GetTableRange(Time) : FVoxelNodeFunctions::GetCurveValue(Curve, Time);
+					
+					for (int32 Index = First; Index <= Last; Index++)
+					{
+						// The range must contain what Eval returns (up to the lerp float rounding), and the exact values up to the table error
+						check(Range.Min - 1e-5f <= Values[Index] && Values[Index] <= Range.Max + 1e-5f);
+						check(Range.Min - MaxError <= ExactValues[Index] && ExactValues[Index] <= Range.Max + MaxError);
+					}
+				}
+			}
+		};
+
+		// No key & single key: no table
+		Test(FRichCurve());
+		Test(MakeCurve(RCIM_Cubic, { { 0.f, 1.f } }));
+		
+		// Smooth
+		Test(MakeCurve(RCIM_Cubic, { { 0.f, 0.f }, { 1.f, 2.f }, { 2.5f, -1.f }, { 3.f, 0.5f }, { 7.f, 3.f } }));
+		// Corners between the samples
+		Test(MakeCurve(RCIM_Linear, { { 0.f, 0.f }, { 0.37f, 1.f }, { 1.13f, -0.5f }, { 2.71f, 0.2f }, { 3.f, 0.f } }));
+		// Spike much narrower than the initial samples
+		Test(MakeCurve(RCIM_Linear, { { 0.f, 0.f }, { 0.5f, 0.f }, { 0.501f, 1.f }, { 0.502f, 0.f }, { 1.f, 0.f } }));
+		Test(MakeCurve(RCIM_Cubic, { { 0.f, 0.f }, { 0.5f, 0.f }, { 0.501f, 1.f }, { 0.502f, 0.f }, { 1.f, 0.f } }));
+		// Steps can't be linearly interpolated: evaluated exactly
+		Test(MakeCurve(RCIM_Constant, { { 0.f, 0.f }, { 1.f, 1.f }, { 2.f, 0.f } }));
+	}
+};
+
+void FVoxelGraphTests::Test()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FVoxelGraphTestsImpl::TestCurveTables();
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+// Copyright 2020 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVoxelGraphTests
+{
+	static void Test();
+};
\ No newline at end of file
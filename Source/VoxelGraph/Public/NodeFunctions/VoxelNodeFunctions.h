@@ -32,9 +32,38 @@ struct VOXELGRAPH_API FVoxelRichCurve
 	explicit FVoxelRichCurve(const FRichCurve& Curve);
 	explicit FVoxelRichCurve(const UCurveFloat* Curve);
 
+public:
+	// Uses the baked table between the first & last keys, and the exact curve outside
+	FORCEINLINE v_flt Eval(v_flt Time) const
+	{
+		if (Table.Num() > 0 && TableStart <= Time && Time <= TableEnd)
+		{
+			const v_flt Position = (Time - TableStart) * TableInvStep;
+			const int32 Index = FMath::Min(int32(Position), Table.Num() - 2);
+			return FMath::Lerp<v_flt>(Table[Index], Table[Index + 1], Position - Index);
+		}
+		return FVoxelRichCurveUtilities::Eval(Curve, Time);
+	}
+
+	inline bool HasTable() const { return Table.Num() > 0; }
+	inline float GetTableStart() const { return TableStart; }
+	inline float GetTableEnd() const { return TableEnd; }
+	
+	// Range of the values returned by Eval, with Time clamped to the table. Exact as the table is linearly interpolated
+	TVoxelRange<v_flt> GetTableRange(const TVoxelRange<v_flt>& Time) const;
+
 private:
 	float Min = 0;
 	float Max = 0;
+
+	// Curve sampled uniformly between its first & last keys. Empty if the curve is evaluated exactly
+	TArray<float> Table;
+	float TableStart = 0;
+	float TableEnd = 0;
+	float TableInvStep = 0;
+
+	// Doubles the number of samples until the error is below voxel.graph.CurveTableMaxError, or gives up after voxel.graph.CurveTableMaxSize
+	void BakeTable();
 };
 
 struct VOXELGRAPH_API FVoxelColorRichCurve
@@ -584,7 +613,7 @@ namespace FVoxelNodeFunctions
 
 	inline v_flt GetCurveValue(const FVoxelRichCurve& Curve, v_flt Value)
 	{
-		return FVoxelRichCurveUtilities::Eval(Curve.Curve, Value);
+		return Curve.Eval(Value);
 	}
 	VOXELGRAPH_API TVoxelRange<v_flt> GetCurveValue(const FVoxelRichCurve& Curve, const TVoxelRange<v_flt>& Value);
 	
@@ -164,6 +164,9 @@ public:
 		{
 			// We can only use the dependencies analysis if we don't have a transform, or if it's only translation + scale
 			// (and thus not changing the axis). Not checking that second case though.
+			// The X/XY caching requires Z to be the inner loop: write to a Z major buffer to avoid strided writes
+			TVoxelQueryZoneZMajorBuffer<QueryZoneType> Buffer(QueryZone);
+			
 			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 			{
 				Context.LocalX = Context.WorldX = X;
@@ -186,19 +189,21 @@ public:
 						Outputs.Init(FVoxelGraphOutputsInit{ MaterialConfig });
 						Outputs.template Set<T, Index>(DefaultValue);
 						Target.ComputeXYZWithCache(Context, static_cast<const decltype(BufferX)&>(BufferX), static_cast<const decltype(BufferXY)&>(BufferXY), Outputs);
-						QueryZone.Set(X, Y, Z, QueryZoneType(Outputs.template Get<T, Index>()));
+						Buffer.Add(QueryZoneType(Outputs.template Get<T, Index>()));
 					}
 				}
 			}
+
+			Buffer.Flush();
 		}
 		else
 		{
 			// Have to query all the voxels individually
-			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
+			for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
 			{
 				for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Y))
 				{
-					for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, Z))
+					for (VOXEL_QUERY_ZONE_ITERATE(QueryZone, X))
 					{
 						Context.UpdateCoordinates<true>(X, Y, Z);
 
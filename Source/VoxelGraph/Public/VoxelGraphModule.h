@@ -7,4 +7,6 @@
 
 class FVoxelGraphModule : public IModuleInterface
 {
+public:
+	virtual void StartupModule() override;
 };